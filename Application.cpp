@@ -1,23 +1,778 @@
 #include "Application.h"
 #include "imgui/imgui.h"
-#include "classes/TicTacToe.h"
+#include "imgui/imgui_internal.h"
+#include "classes/FrameProfiler.h"
+#include "classes/Game.h"
+#include "classes/GameIds.h"
+#include "classes/GameRecord.h"
+#include "classes/GameRegistry.h"
+#include "classes/LatencyHistogram.h"
+#include "classes/OpeningBook.h"
+#include "classes/Replay.h"
+#include "classes/SearchStats.h"
+#include "classes/Trace.h"
+#include "classes/Turn.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace ClassGame {
         //
         // our global variables
         //
-        TicTacToe *game = nullptr;
+        Game *game = nullptr;
         bool gameOver = false;
         int gameWinner = -1;
 
+        // which game the next new game is, an index into GameRegistry::games()
+        int gameIndex = 0;
+        const char *defaultGameId = kGameIdTicTacToe;
+
+        // board size used for the next new game by games that can change it
+        GameSetup gameSetup;
+
+        // the AI plays both sides, kept across new games
+        bool aiVsAI = false;
+
+        // the AI opens from books/<id>.book when there is one, see tools/openingbook.cpp and BookId()
+        const char *openingBookDir = "books/";
+        OpeningBook openingBook;
+        bool useOpeningBook = true;
+
+        // a finished game, or one out of a game log, being stepped through
+        GameReplay replay;
+        bool replaying = false;
+        bool replayPlaying = false;
+        float replaySpeed = 4.0f;
+        double replayNextStep = 0.0;
+        char replayLogPath[256] = "games.bin";
+        int replayRecord = 0;
+        std::string replayMessage;
+
+        // how long the AI takes to move, by game id, and how long it should take
+        std::map<std::string, MoveLatency> moveLatency;
+        float latencyTargetMs = 0.0f;
+        const char *latencyMetricsFile = "latency_metrics.jsonl";
+        std::string latencyMessage;
+
+        // a Chrome trace of every thread, see classes/Trace.h
+        bool tracing = false;
+        char traceFile[256] = "trace.json";
+        std::string traceMessage;
+
+        // how main.cpp wakes its loop while it sleeps waiting for events
+        static std::atomic<void (*)()> wakeMainLoop { nullptr };
+
+        // every finished turn and new game ends up in the ini file
+        static void GameStateChanged()
+        {
+            if (ImGui::GetCurrentContext()) {
+                ImGui::MarkIniSettingsDirty();
+            }
+        }
+
+        //
+        // books for a resizable game's other board sizes go by its sized id,
+        // books/tictactoe-4x4-4.book
+        //
+        static std::string BookId(const GameInfo &info)
+        {
+            int lineLength = std::min(gameSetup.lineLength, std::max(gameSetup.width, gameSetup.height));
+            if (!info.resizable || (gameSetup.width == info.boardWidth && gameSetup.height == info.boardHeight &&
+                                    lineLength == GameSetup().lineLength)) {
+                return info.id;
+            }
+            return sizedGameId(info.id, gameSetup.width, gameSetup.height, lineLength);
+        }
+
+        //
+        // throw away the current game and start a fresh one of the chosen kind,
+        // only the chosen game ever gets constructed
+        //
+        static void NewGame()
+        {
+            if (game) {
+                game->stopGame();
+                delete game;
+                game = nullptr;
+            }
+            const std::vector<GameInfo> &games = GameRegistry::games();
+            if (gameIndex < 0 || gameIndex >= (int)games.size()) {
+                return;
+            }
+            replay.clear();
+            replaying = false;
+            replayPlaying = false;
+            game = games[gameIndex].create(gameSetup);
+            game->setUpBoard();
+            game->setAIvsAI(aiVsAI);
+
+            const std::string &id = games[gameIndex].id;
+            std::string bookId = BookId(games[gameIndex]);
+            if (openingBook.gameId() != bookId && !openingBook.open(openingBookDir + bookId + ".book")) {
+                openingBook.close();
+            }
+            game->setOpeningBook(useOpeningBook && openingBook.gameId() == bookId ? &openingBook : nullptr);
+            game->setMoveLatency(&moveLatency[id]);
+            game->setLatencyTarget(latencyTargetMs / 1000.0);
+            gameOver = false;
+            gameWinner = -1;
+            GameStateChanged();
+        }
+
+        //
+        // the game in progress lives in imgui.ini under [GameState][Current]: which
+        // game, its options, the board, the turn it is on and every board so far.
+        // ImGui writes the file a few seconds after something marks it dirty and
+        // again on shutdown, so the program comes back where it left off even when
+        // it is killed rather than closed
+        //
+        struct SavedGame
+        {
+            std::string id;
+            GameSetup   setup;
+            bool        aiVsAI = false;
+            bool        openingBook = true;
+            int         depth = 0;
+            unsigned int turn = 0;
+            std::string state;
+            std::vector<std::string> history;
+        };
+        static SavedGame savedGame;
+        // --game picked one, so a saved game of another kind is left alone
+        static bool gameFromCommandLine = false;
+        // and a board size with it, a saved game on another size isn't restored
+        static bool sizeFromCommandLine = false;
+
+        static void *GameStateReadOpen(ImGuiContext *, ImGuiSettingsHandler *, const char *name)
+        {
+            if (strcmp(name, "Current") != 0) {
+                return nullptr;
+            }
+            savedGame = SavedGame();
+            return &savedGame;
+        }
+
+        static void GameStateReadLine(ImGuiContext *, ImGuiSettingsHandler *, void *entry, const char *line)
+        {
+            SavedGame &saved = *(SavedGame *)entry;
+            const char *equals = strchr(line, '=');
+            if (!equals) {
+                return;
+            }
+            std::string key(line, equals - line);
+            const char *value = equals + 1;
+            if (key == "Game") saved.id = value;
+            else if (key == "Width") saved.setup.width = atoi(value);
+            else if (key == "Height") saved.setup.height = atoi(value);
+            else if (key == "LineLength") saved.setup.lineLength = atoi(value);
+            else if (key == "AIvsAI") saved.aiVsAI = atoi(value) != 0;
+            else if (key == "OpeningBook") saved.openingBook = atoi(value) != 0;
+            else if (key == "Depth") saved.depth = atoi(value);
+            else if (key == "Turn") saved.turn = (unsigned int)strtoul(value, nullptr, 10);
+            else if (key == "State") saved.state = value;
+            else if (key == "History") saved.history.push_back(value);
+        }
+
+        //
+        // pieces are made again from the saved board, their textures come out of
+        // the sprite cache rather than being loaded again
+        //
+        static void GameStateApplyAll(ImGuiContext *, ImGuiSettingsHandler *)
+        {
+            int index = GameRegistry::indexOf(savedGame.id);
+            if (index < 0 || savedGame.state.empty() || (gameFromCommandLine && index != gameIndex)) {
+                return;
+            }
+            if (sizeFromCommandLine && (savedGame.setup.width != gameSetup.width || savedGame.setup.height != gameSetup.height ||
+                                        savedGame.setup.lineLength != gameSetup.lineLength)) {
+                return;
+            }
+            gameIndex = index;
+            gameSetup = savedGame.setup;
+            aiVsAI = savedGame.aiVsAI;
+            useOpeningBook = savedGame.openingBook;
+            NewGame();
+            if (savedGame.depth > 0) {
+                game->_gameOptions.AIMAXDepth = savedGame.depth;
+            }
+            game->restoreGame(savedGame.state, savedGame.turn, savedGame.history);
+            EndOfTurn();
+            savedGame = SavedGame();
+        }
+
+        static void GameStateWriteAll(ImGuiContext *, ImGuiSettingsHandler *handler, ImGuiTextBuffer *out)
+        {
+            const std::vector<GameInfo> &games = GameRegistry::games();
+            if (!game || gameIndex < 0 || gameIndex >= (int)games.size()) {
+                return;
+            }
+            out->appendf("[%s][Current]\n", handler->TypeName);
+            out->appendf("Game=%s\n", games[gameIndex].id.c_str());
+            out->appendf("Width=%d\nHeight=%d\nLineLength=%d\n", gameSetup.width, gameSetup.height, gameSetup.lineLength);
+            out->appendf("AIvsAI=%d\nOpeningBook=%d\n", aiVsAI ? 1 : 0, useOpeningBook ? 1 : 0);
+            out->appendf("Depth=%d\n", game->_gameOptions.AIMAXDepth);
+            // a replay only borrows the board, the game itself is still where it got to
+            if (replaying && !game->_turns.empty()) {
+                out->appendf("Turn=%u\n", (unsigned int)game->_turns.size() - 1);
+                out->appendf("State=%s\n", game->_turns.back()->_boardState.c_str());
+            } else {
+                out->appendf("Turn=%u\n", game->getCurrentTurnNo());
+                out->appendf("State=%s\n", game->stateString().c_str());
+            }
+            for (const Turn *turn : game->_turns) {
+                out->appendf("History=%s\n", turn->_boardState.c_str());
+            }
+            out->append("\n");
+        }
+
+        //
+        // --game <id> picks the game to start with, --list-games prints them
+        //
+        bool ParseCommandLine(int argc, char **argv, int &exitCode)
+        {
+            exitCode = 0;
+            gameIndex = GameRegistry::indexOf(defaultGameId);
+            for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--list-games") == 0) {
+                    for (const GameInfo &info : GameRegistry::games()) {
+                        printf("%-12s %s, %dx%d, %d players%s%s\n", info.id.c_str(), info.name.c_str(), info.boardWidth, info.boardHeight,
+                               info.players, info.hasAI ? ", AI: " : "", info.ai.c_str());
+                    }
+                    return false;
+                }
+                // the same ids as the headless tools, sizes included
+                if (strcmp(argv[i], "--game") == 0 && i + 1 < argc) {
+                    std::string id = argv[++i];
+                    GameSetup setup;
+                    if (parseSizedGameId(id, id, setup.width, setup.height, setup.lineLength)) {
+                        const GameInfo *info = GameRegistry::find(id);
+                        if (info && info->resizable && setup.width >= 3 && setup.height >= 3 && setup.width <= info->maxSize &&
+                            setup.height <= info->maxSize && setup.lineLength >= 3 && setup.lineLength <= std::max(setup.width, setup.height)) {
+                            gameSetup = setup;
+                            sizeFromCommandLine = true;
+                        } else {
+                            id.clear();
+                        }
+                    }
+                    gameIndex = GameRegistry::indexOf(id);
+                    gameFromCommandLine = true;
+                    if (gameIndex < 0) {
+                        fprintf(stderr, "no game called %s, --list-games shows them all\n", argv[i]);
+                        exitCode = 1;
+                        return false;
+                    }
+                    continue;
+                }
+                // records from the first frame, saved when the program exits
+                if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                    snprintf(traceFile, sizeof(traceFile), "%s", argv[++i]);
+                    tracing = true;
+                    Trace::setEnabled(true);
+                    continue;
+                }
+                fprintf(stderr, "usage: %s [--game <id>] [--trace <file>] [--list-games]\n", argv[0]);
+                exitCode = 1;
+                return false;
+            }
+            return true;
+        }
+
+        //
+        // show one ply of the replay, the board is put back from its state string
+        //
+        static void ShowReplayPly(int ply)
+        {
+            game->setStateString(replay.seek(ply));
+            game->_gameOptions.currentTurnNo = (unsigned int)replay.ply();
+        }
+
+        //
+        // replay the game on the board from its turns, starting at the end
+        //
+        static void StartReplay()
+        {
+            replay.clear();
+            for (const Turn *turn : game->_turns) {
+                replay.addState(turn->_boardState);
+            }
+            replaying = true;
+            replayPlaying = false;
+            game->_replaying = true;
+            ShowReplayPly(replay.plies());
+        }
+
+        //
+        // a new game of the record's kind with its moves played out, then
+        // replayed from the start
+        //
+        static void StartReplayFromLog(const char *path, int record)
+        {
+            GameRecordReader reader;
+            if (!reader.open(path)) {
+                replayMessage = std::string("can't read a game log from ") + path;
+                return;
+            }
+            GameRecordView view;
+            int found = -1;
+            while (found < record && reader.next(view)) {
+                found++;
+            }
+            if (found != record || record < 0) {
+                replayMessage = "the log has " + std::to_string(found + 1) + " games";
+                return;
+            }
+            int index = GameRegistry::indexOf(std::string(view.gameId));
+            if (index < 0) {
+                replayMessage = "no game called " + std::string(view.gameId);
+                return;
+            }
+
+            gameIndex = index;
+            NewGame();
+            GameRecordCursor moves = view.moves();
+            uint32_t move;
+            int ply = 0;
+            replayMessage.clear();
+            while (moves.next(move)) {
+                if (!game->playRecordedMove((int)move)) {
+                    replayMessage = "move " + std::to_string(ply + 1) + " isn't legal, the replay stops before it";
+                    break;
+                }
+                ply++;
+            }
+            StartReplay();
+            ShowReplayPly(0);
+        }
+
+        //
+        // leave the replay with the game carrying on from the ply on the board
+        //
+        static void StopReplay()
+        {
+            int ply = replay.ply();
+            std::vector<std::string> history;
+            for (int i = 0; i <= ply; i++) {
+                history.push_back(replay.seek(i));
+            }
+            game->restoreGame(history.back(), (unsigned int)ply, history);
+            game->_replaying = false;
+            replaying = false;
+            replayPlaying = false;
+            replay.clear();
+            gameOver = false;
+            gameWinner = -1;
+            EndOfTurn();
+        }
+
+        //
+        // the scrubber and the buttons around it
+        //
+        static void DrawReplay()
+        {
+            ImGui::SeparatorText("Replay");
+            if (!replaying) {
+                ImGui::BeginDisabled(game->_turns.size() < 2);
+                if (ImGui::Button("Replay This Game")) {
+                    StartReplay();
+                }
+                ImGui::EndDisabled();
+                ImGui::InputText("Game Log", replayLogPath, sizeof(replayLogPath));
+                ImGui::InputInt("Record", &replayRecord);
+                if (ImGui::Button("Replay From Log")) {
+                    StartReplayFromLog(replayLogPath, replayRecord);
+                }
+                if (!replayMessage.empty()) {
+                    ImGui::TextWrapped("%s", replayMessage.c_str());
+                }
+                return;
+            }
+
+            if (ImGui::Button("|<")) ShowReplayPly(0);
+            ImGui::SameLine();
+            if (ImGui::Button("<")) ShowReplayPly(replay.ply() - 1);
+            ImGui::SameLine();
+            if (ImGui::Button(">")) ShowReplayPly(replay.ply() + 1);
+            ImGui::SameLine();
+            if (ImGui::Button(">|")) ShowReplayPly(replay.plies());
+            ImGui::SameLine();
+            if (ImGui::Checkbox("Play", &replayPlaying)) {
+                replayNextStep = ImGui::GetTime();
+            }
+
+            int ply = replay.ply();
+            if (ImGui::SliderInt("Ply", &ply, 0, replay.plies())) {
+                ShowReplayPly(ply);
+            }
+            ImGui::SliderFloat("Plies/sec", &replaySpeed, 0.5f, 60.0f, "%.1f");
+            ImGui::TextDisabled("%d plies, %zu keyframes, %zu bytes", replay.plies(), replay.keyframes(), replay.bytes());
+            if (!replayMessage.empty()) {
+                ImGui::TextWrapped("%s", replayMessage.c_str());
+            }
+
+            if (ImGui::Button("Play On From Here")) {
+                StopReplay();
+                return;
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Close Replay")) {
+                ShowReplayPly(replay.plies());
+                StopReplay();
+            }
+        }
+
+        // the replay moves on by itself while Play is ticked
+        static void StepReplay()
+        {
+            if (!replaying || !replayPlaying) {
+                return;
+            }
+            double now = ImGui::GetTime();
+            while (now >= replayNextStep && replay.ply() < replay.plies()) {
+                ShowReplayPly(replay.ply() + 1);
+                replayNextStep += 1.0 / replaySpeed;
+            }
+            if (replayNextStep < now) {
+                replayNextStep = now;
+            }
+            if (replay.ply() >= replay.plies()) {
+                replayPlaying = false;
+            }
+        }
+
+        //
+        // the game picker, with what each game is about in its tooltip
+        //
+        static void DrawGamePicker()
+        {
+            const std::vector<GameInfo> &games = GameRegistry::games();
+            if (gameIndex < 0 || gameIndex >= (int)games.size()) {
+                return;
+            }
+            if (ImGui::BeginCombo("Game", games[gameIndex].name.c_str())) {
+                for (int i = 0; i < (int)games.size(); i++) {
+                    const GameInfo &info = games[i];
+                    if (ImGui::Selectable(info.name.c_str(), i == gameIndex)) {
+                        gameIndex = i;
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("%s\n%dx%d board, %d players\nAI: %s", info.id.c_str(), info.boardWidth, info.boardHeight, info.players,
+                                          info.hasAI ? info.ai.c_str() : "none");
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            const GameInfo &info = games[gameIndex];
+            if (info.resizable) {
+                ImGui::SliderInt("Width", &gameSetup.width, 3, info.maxSize);
+                ImGui::SliderInt("Height", &gameSetup.height, 3, info.maxSize);
+                ImGui::SliderInt("In A Row", &gameSetup.lineLength, 3, gameSetup.width > gameSetup.height ? gameSetup.width : gameSetup.height);
+            }
+        }
+
+        // per move search stats get appended here while logging is switched on
+        bool logSearchStats = false;
+        const char *searchStatsFile = "search_stats.jsonl";
+
+        //
+        // every game played this run, one JSON line per game and board phase
+        //
+        static void WriteLatencyMetrics()
+        {
+            std::ofstream file(latencyMetricsFile);
+            if (!file) {
+                latencyMessage = std::string("can't write ") + latencyMetricsFile;
+                return;
+            }
+            int games = 0;
+            for (const auto &entry : moveLatency) {
+                if (entry.second.count() > 0) {
+                    file << entry.second.toJson(entry.first);
+                    games++;
+                }
+            }
+            latencyMessage = "wrote " + std::to_string(games) + (games == 1 ? " game to " : " games to ") + latencyMetricsFile;
+        }
+
+        //
+        // the tail of the AI's move times for the game being played
+        //
+        static void DrawMoveLatency()
+        {
+            ImGui::SeparatorText("Move Latency");
+            if (ImGui::InputFloat("Target (ms)", &latencyTargetMs, 10.0f, 100.0f, "%.0f")) {
+                latencyTargetMs = std::max(latencyTargetMs, 0.0f);
+                game->setLatencyTarget(latencyTargetMs / 1000.0);
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", latencyTargetMs > 0.0f ? "searches stop early" : "off");
+
+            const MoveLatency *latency = game->_moveLatency;
+            if (!latency) {
+                return;
+            }
+            if (ImGui::BeginTable("latency", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+                const char *headings[] = { "Phase", "Moves", "p50", "p90", "p99", "Max", "Over" };
+                for (const char *heading : headings) {
+                    ImGui::TableSetupColumn(heading);
+                }
+                ImGui::TableHeadersRow();
+                LatencyHistogram all;
+                uint64_t allOver = 0;
+                for (int phase = 0; phase <= kBoardPhases; phase++) {
+                    const LatencyHistogram *moves = &all;
+                    uint64_t over = allOver;
+                    if (phase < kBoardPhases) {
+                        moves = &latency->moves(phase);
+                        over = latency->overTarget(phase);
+                        all.add(*moves);
+                        allOver += over;
+                    }
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(MoveLatency::phaseName(phase));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", (unsigned long long)moves->count());
+                    double percentiles[] = { 50.0, 90.0, 99.0 };
+                    for (double percent : percentiles) {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.1f", moves->percentile(percent) / 1000.0);
+                    }
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", moves->max() / 1000.0);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", (unsigned long long)over);
+                }
+                ImGui::EndTable();
+            }
+            ImGui::TextDisabled("milliseconds for the whole move, book and search");
+            if (ImGui::Button("Write Metrics")) {
+                WriteLatencyMetrics();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear")) {
+                game->_moveLatency->clear();
+                latencyMessage.clear();
+            }
+            if (!latencyMessage.empty()) {
+                ImGui::TextWrapped("%s", latencyMessage.c_str());
+            }
+        }
+
+        //
+        // what the AI's last search cost
+        //
+        static void DrawSearchStats()
+        {
+            ImGui::Begin("AI Search");
+            if (ImGui::Checkbox("Log each move as JSON", &logSearchStats)) {
+                SearchStats::setLogFile(logSearchStats ? searchStatsFile : "");
+            }
+            if (logSearchStats) {
+                ImGui::TextDisabled("appending to %s", searchStatsFile);
+            }
+
+            const SearchStats *stats = game->searchStats();
+            if (!stats) {
+                ImGui::Text("This game has no AI search");
+                ImGui::End();
+                return;
+            }
+            DrawMoveLatency();
+            ImGui::SeparatorText("Last Move");
+            if (stats->fromBook) {
+                ImGui::Text("Best Move: %d, from the opening book", stats->bestMove);
+                ImGui::End();
+                return;
+            }
+            ImGui::Text("Best Move: %d (score %d)%s", stats->bestMove, stats->score, stats->pondered ? ", pondered" : "");
+            ImGui::Text("Time: %.3f ms", stats->seconds * 1000.0);
+            ImGui::Text("Nodes: %llu", (unsigned long long)stats->nodes);
+            ImGui::Text("Nodes/sec: %.0f", stats->nodesPerSecond());
+            ImGui::Text("Depth: %d reached, %d limit", stats->depthReached, stats->depthLimit);
+            ImGui::Text("Beta Cutoffs: %.1f%% of expanded nodes", stats->cutoffRate() * 100.0);
+            ImGui::Text("First Move Cutoffs: %.1f%% of cutoffs", stats->firstMoveCutoffRate() * 100.0);
+            ImGui::Text("Table Hits: %.1f%% of %llu probes", stats->tableHitRate() * 100.0, (unsigned long long)stats->tableProbes);
+
+            std::string line = stats->principalVariationText;
+            if (line.empty()) {
+                for (int move : stats->principalVariation) {
+                    line += std::to_string(move) + " ";
+                }
+            }
+            ImGui::TextWrapped("PV: %s", line.c_str());
+            ImGui::End();
+        }
+
+        // where the frame time goes, see classes/FrameProfiler.h
+        bool showFrameProfiler = false;
+        static const float kFrameBudget = 1000.0f / 60.0f;
+        static const ImU32 kPhaseColors[kPhaseCount] = {
+            IM_COL32(120, 120, 120, 255),   // events
+            IM_COL32( 80, 160, 230, 255),   // input
+            IM_COL32(230,  90,  70, 255),   // AI
+            IM_COL32(110, 200,  90, 255),   // board
+            IM_COL32(230, 190,  60, 255),   // interface
+            IM_COL32(170, 110, 220, 255),   // render
+            IM_COL32( 60,  60,  70, 255),   // swap
+        };
+
+        //
+        // save what has been traced since the last save
+        //
+        static void SaveTrace()
+        {
+            size_t events = Trace::pending();
+            if (Trace::write(traceFile)) {
+                traceMessage = "saved " + std::to_string(events) + " events to " + traceFile;
+            } else {
+                traceMessage = std::string("can't write ") + traceFile;
+            }
+        }
+
+        //
+        // the last few seconds of frames as stacked bars, one per frame, with a
+        // line at 60 fps, and the percentiles of each phase under them
+        //
+        static void DrawFrameProfiler()
+        {
+            if (!showFrameProfiler) {
+                return;
+            }
+            const FrameProfiler &profiler = FrameProfiler::instance();
+            if (!ImGui::Begin("Frame Time", &showFrameProfiler)) {
+                ImGui::End();
+                return;
+            }
+
+            // the graph is scaled to the slowest frame, but never below two budgets
+            int frames = profiler.frames();
+            float scale = kFrameBudget * 2.0f;
+            for (int frame = 0; frame < frames; frame++) {
+                scale = std::max(scale, profiler.milliseconds(frame, kPhaseCount));
+            }
+            ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 100.0f), 120.0f);
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            ImGui::InvisibleButton("##frames", size);
+            ImDrawList *drawList = ImGui::GetWindowDrawList();
+            drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(20, 20, 24, 255));
+            float barWidth = size.x / FrameProfiler::kHistory;
+            float bottom = origin.y + size.y;
+            for (int frame = 0; frame < frames; frame++) {
+                float x = origin.x + size.x - (frames - frame) * barWidth;
+                float y = bottom;
+                for (int phase = 0; phase < kPhaseCount; phase++) {
+                    float height = profiler.milliseconds(frame, phase) / scale * size.y;
+                    if (height <= 0.0f) {
+                        continue;
+                    }
+                    drawList->AddRectFilled(ImVec2(x, y - height), ImVec2(x + std::max(barWidth - 1.0f, 1.0f), y), kPhaseColors[phase]);
+                    y -= height;
+                }
+            }
+            float budget = bottom - kFrameBudget / scale * size.y;
+            drawList->AddLine(ImVec2(origin.x, budget), ImVec2(origin.x + size.x, budget), IM_COL32(255, 255, 255, 160));
+            if (ImGui::IsItemHovered() && frames > 0) {
+                int frame = frames - 1 - (int)((origin.x + size.x - ImGui::GetIO().MousePos.x) / barWidth);
+                if (frame >= 0 && frame < frames) {
+                    ImGui::BeginTooltip();
+                    for (int phase = 0; phase <= kPhaseCount; phase++) {
+                        ImGui::Text("%-9s %7.2f ms", FrameProfiler::phaseName(phase), profiler.milliseconds(frame, phase));
+                    }
+                    ImGui::EndTooltip();
+                }
+            }
+
+            if (ImGui::BeginTable("phases", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+                const char *headings[] = { "Phase", "Last", "p50", "p95", "p99", "Max" };
+                for (const char *heading : headings) {
+                    ImGui::TableSetupColumn(heading);
+                }
+                ImGui::TableHeadersRow();
+                for (int phase = 0; phase <= kPhaseCount; phase++) {
+                    FramePercentiles percentiles = profiler.percentiles(phase);
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    if (phase < kPhaseCount) {
+                        ImVec2 swatch = ImGui::GetCursorScreenPos();
+                        float side = ImGui::GetTextLineHeight();
+                        ImGui::GetWindowDrawList()->AddRectFilled(swatch, ImVec2(swatch.x + side, swatch.y + side), kPhaseColors[phase]);
+                        ImGui::Dummy(ImVec2(side, side));
+                        ImGui::SameLine();
+                    }
+                    ImGui::TextUnformatted(FrameProfiler::phaseName(phase));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", frames > 0 ? profiler.milliseconds(frames - 1, phase) : 0.0f);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", percentiles.p50);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", percentiles.p95);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", percentiles.p99);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", percentiles.max);
+                }
+                ImGui::EndTable();
+            }
+            ImGui::TextDisabled("milliseconds over the last %d frames", frames);
+            ImGui::End();
+        }
+
         //
         // game starting point
         // this is called by the main render loop in main.cpp
         //
         void GameStartUp() 
         {
-            game = new TicTacToe();
-            game->setUpBoard();
+            Trace::setThreadName("main");
+
+            // dragging a piece across the board mustn't drag the window along with it
+            ImGui::GetIO().ConfigWindowsMoveFromTitleBarOnly = true;
+
+            ImGuiSettingsHandler handler;
+            handler.TypeName = "GameState";
+            handler.TypeHash = ImHashStr("GameState");
+            handler.ReadOpenFn = GameStateReadOpen;
+            handler.ReadLineFn = GameStateReadLine;
+            handler.ApplyAllFn = GameStateApplyAll;
+            handler.WriteAllFn = GameStateWriteAll;
+            ImGui::AddSettingsHandler(&handler);
+
+            // ImGui would read the ini file on the first frame anyway, reading it
+            // now means the saved game is the first one built instead of the second
+            const char *iniFile = ImGui::GetIO().IniFilename;
+            if (iniFile) {
+                ImGui::LoadIniSettingsFromDisk(iniFile);
+            }
+            if (!game) {
+                NewGame();
+            }
+        }
+
+        //
+        // anything traced and not saved yet goes to the trace file, and the move
+        // latencies of this run to the metrics file
+        //
+        void GameShutDown()
+        {
+            if (Trace::pending() > 0) {
+                SaveTrace();
+                printf("%s\n", traceMessage.c_str());
+            }
+            for (const auto &entry : moveLatency) {
+                if (entry.second.count() > 0) {
+                    WriteLatencyMetrics();
+                    printf("%s\n", latencyMessage.c_str());
+                    break;
+                }
+            }
         }
 
         //
@@ -26,6 +781,7 @@ namespace ClassGame {
         //
         void RenderGame() 
         {
+                ScopedFrameTimer timer(kPhaseInterface);
                 ImGui::DockSpaceOverViewport();
 
                 //ImGui::ShowDemoWindow();
@@ -37,23 +793,97 @@ namespace ClassGame {
                 ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
                 ImGui::Text("Current Board State: %s", game->stateString().c_str());
 
-                if (gameOver) {
+                ImGui::SeparatorText("Board");
+                DrawGamePicker();
+                if (ImGui::Button("New Game")) {
+                    NewGame();
+                    ImGui::End();
+                    return;
+                }
+                ImGui::SliderInt("AI Search Depth", &game->_gameOptions.AIMAXDepth, 1, game->_gameOptions.rowX * game->_gameOptions.rowY);
+                if (ImGui::Checkbox("AI plays both sides", &aiVsAI)) {
+                    game->setAIvsAI(aiVsAI);
+                }
+                if (openingBook.isOpen()) {
+                    if (ImGui::Checkbox("AI opens from the book", &useOpeningBook)) {
+                        game->setOpeningBook(useOpeningBook ? &openingBook : nullptr);
+                    }
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("%llu positions", (unsigned long long)openingBook.positionCount());
+                }
+
+                DrawReplay();
+                StepReplay();
+
+                ImGui::SeparatorText("Performance");
+                ImGui::Checkbox("Show frame times", &showFrameProfiler);
+                if (ImGui::Checkbox("Record a trace", &tracing)) {
+                    Trace::setEnabled(tracing);
+                }
+                ImGui::InputText("Trace file", traceFile, sizeof(traceFile));
+                ImGui::BeginDisabled(Trace::pending() == 0);
+                if (ImGui::Button("Save Trace")) {
+                    SaveTrace();
+                }
+                ImGui::EndDisabled();
+                ImGui::SameLine();
+                ImGui::TextDisabled("%zu events", Trace::pending());
+                if (!traceMessage.empty()) {
+                    ImGui::TextWrapped("%s", traceMessage.c_str());
+                }
+
+                if (gameOver && !replaying) {
                     ImGui::Text("Game Over!");
                     ImGui::Text("Winner: %d", gameWinner);
                     if (ImGui::Button("Reset Game")) {
                         game->stopGame();
                         game->setUpBoard();
+                        game->setAIvsAI(aiVsAI);
                         gameOver = false;
                         gameWinner = -1;
+                        GameStateChanged();
                     }
                 }
                 ImGui::End();
 
+                DrawSearchStats();
+                DrawFrameProfiler();
+
                 ImGui::Begin("GameWindow");
                 game->drawFrame();
                 ImGui::End();
         }
 
+        //
+        // the AI moves from scanForMouse(), so a frame has to come along for it
+        //
+        bool GameNeedsFrames()
+        {
+            if (!game || !game->getCurrentPlayer()) {
+                return false;
+            }
+            if (replaying) {
+                return replayPlaying;
+            }
+            if (game->_dragBit) {
+                return true;
+            }
+            return !gameOver && game->gameHasAI() && game->getCurrentPlayer()->isAIPlayer();
+        }
+
+        void SetWakeMainLoop(void (*wake)())
+        {
+            wakeMainLoop.store(wake);
+        }
+
+        void WakeMainLoop()
+        {
+            void (*wake)() = wakeMainLoop.load();
+            if (wake) {
+                wake();
+            }
+        }
+
         //
         // end turn is called by the game code at the end of each turn
         // this is where we check for a winner
@@ -70,5 +900,6 @@ namespace ClassGame {
                 gameOver = true;
                 gameWinner = -1;
             }
+            GameStateChanged();
         }
 }
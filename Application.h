@@ -1,7 +1,20 @@
 #pragma once
 
 namespace ClassGame {
+    // false when the program should exit straight away with exitCode (--list-games, a bad argument)
+    bool ParseCommandLine(int argc, char **argv, int &exitCode);
     void GameStartUp();
+    // called once the main loop has finished, before ImGui goes away
+    void GameShutDown();
     void RenderGame();
     void EndOfTurn();
+
+    // true while the screen changes without any input: the AI is about to move, a
+    // replay is playing or a piece is being dragged. the rest of the time the main
+    // loop sleeps until there is input or WakeMainLoop() is called
+    bool GameNeedsFrames();
+    // main.cpp hands over how to wake its loop from another thread
+    void SetWakeMainLoop(void (*wake)());
+    // safe from any thread, for background work that has finished
+    void WakeMainLoop();
 }
@@ -0,0 +1,195 @@
+#include "BoardBatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BOARDBATCH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang need to be told a function may use avx2, msvc always allows it
+#if defined(BOARDBATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BOARDBATCH_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define BOARDBATCH_AVX2_TARGET
+#endif
+
+BoardBatch::BoardBatch(int width, int height, int k)
+{
+    int cells = width * height;
+    _lines = buildLineMasks(width, height, k);
+    _fullMask = cells >= 32 ? 0xFFFFFFFFu : ((1u << cells) - 1);
+}
+
+std::vector<uint32_t> BoardBatch::buildLineMasks(int width, int height, int k)
+{
+    std::vector<uint32_t> lines;
+    const int directions[4][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+    if (width * height > 32 || k <= 0) {
+        return lines;
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (auto &direction : directions) {
+                int endX = x + direction[0] * (k - 1);
+                int endY = y + direction[1] * (k - 1);
+                if (endX < 0 || endX >= width || endY >= height) {
+                    continue;
+                }
+                uint32_t mask = 0;
+                for (int i = 0; i < k; i++) {
+                    mask |= 1u << ((y + direction[1] * i) * width + x + direction[0] * i);
+                }
+                lines.push_back(mask);
+            }
+        }
+    }
+    return lines;
+}
+
+//
+// reference implementation, also used for the tail of a batch
+//
+static void evaluateScalar(const std::vector<uint32_t> &lines, uint32_t fullMask, const uint32_t *first, const uint32_t *second, uint8_t *results, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = first[i];
+        uint32_t b = second[i];
+        uint8_t flags = 0;
+        for (uint32_t line : lines) {
+            if ((a & line) == line) flags |= kBatchFirstWins;
+            if ((b & line) == line) flags |= kBatchSecondWins;
+        }
+        uint32_t occupied = a | b;
+        if (occupied == fullMask) flags |= kBatchFull;
+        if (occupied == 0) flags |= kBatchEmpty;
+        results[i] = flags;
+    }
+}
+
+#ifdef BOARDBATCH_X86
+
+static size_t evaluateSSE2(const std::vector<uint32_t> &lines, uint32_t fullMask, const uint32_t *first, const uint32_t *second, uint8_t *results, size_t count)
+{
+    const __m128i full = _mm_set1_epi32((int)fullMask);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(first + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(second + i));
+        __m128i winA = zero;
+        __m128i winB = zero;
+        for (uint32_t line : lines) {
+            __m128i mask = _mm_set1_epi32((int)line);
+            winA = _mm_or_si128(winA, _mm_cmpeq_epi32(_mm_and_si128(a, mask), mask));
+            winB = _mm_or_si128(winB, _mm_cmpeq_epi32(_mm_and_si128(b, mask), mask));
+        }
+        __m128i occupied = _mm_or_si128(a, b);
+        __m128i flags = _mm_and_si128(winA, _mm_set1_epi32(kBatchFirstWins));
+        flags = _mm_or_si128(flags, _mm_and_si128(winB, _mm_set1_epi32(kBatchSecondWins)));
+        flags = _mm_or_si128(flags, _mm_and_si128(_mm_cmpeq_epi32(occupied, full), _mm_set1_epi32(kBatchFull)));
+        flags = _mm_or_si128(flags, _mm_and_si128(_mm_cmpeq_epi32(occupied, zero), _mm_set1_epi32(kBatchEmpty)));
+
+        // every lane is < 256 so two saturating packs squeeze them down to bytes
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(flags, zero), zero);
+        int bytes = _mm_cvtsi128_si32(packed);
+        results[i + 0] = (uint8_t)(bytes);
+        results[i + 1] = (uint8_t)(bytes >> 8);
+        results[i + 2] = (uint8_t)(bytes >> 16);
+        results[i + 3] = (uint8_t)(bytes >> 24);
+    }
+    return i;
+}
+
+BOARDBATCH_AVX2_TARGET
+static size_t evaluateAVX2(const std::vector<uint32_t> &lines, uint32_t fullMask, const uint32_t *first, const uint32_t *second, uint8_t *results, size_t count)
+{
+    const __m256i full = _mm256_set1_epi32((int)fullMask);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(first + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(second + i));
+        __m256i winA = zero;
+        __m256i winB = zero;
+        for (uint32_t line : lines) {
+            __m256i mask = _mm256_set1_epi32((int)line);
+            winA = _mm256_or_si256(winA, _mm256_cmpeq_epi32(_mm256_and_si256(a, mask), mask));
+            winB = _mm256_or_si256(winB, _mm256_cmpeq_epi32(_mm256_and_si256(b, mask), mask));
+        }
+        __m256i occupied = _mm256_or_si256(a, b);
+        __m256i flags = _mm256_and_si256(winA, _mm256_set1_epi32(kBatchFirstWins));
+        flags = _mm256_or_si256(flags, _mm256_and_si256(winB, _mm256_set1_epi32(kBatchSecondWins)));
+        flags = _mm256_or_si256(flags, _mm256_and_si256(_mm256_cmpeq_epi32(occupied, full), _mm256_set1_epi32(kBatchFull)));
+        flags = _mm256_or_si256(flags, _mm256_and_si256(_mm256_cmpeq_epi32(occupied, zero), _mm256_set1_epi32(kBatchEmpty)));
+
+        // the 256 bit packs work per 128 bit half, so narrow each half separately
+        __m128i low = _mm256_castsi256_si128(flags);
+        __m128i high = _mm256_extracti128_si256(flags, 1);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(low, high), _mm_setzero_si128());
+        _mm_storel_epi64((__m128i *)(results + i), packed);
+    }
+    return i;
+}
+
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    if (!osSavesYmm) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // BOARDBATCH_X86
+
+BoardBatchPath BoardBatch::bestPath()
+{
+#ifdef BOARDBATCH_X86
+    static const BoardBatchPath path = cpuHasAVX2() ? kBatchAVX2 : kBatchSSE2;
+    return path;
+#else
+    return kBatchScalar;
+#endif
+}
+
+const char *BoardBatch::pathName(BoardBatchPath path)
+{
+    switch (path) {
+        case kBatchAVX2: return "avx2";
+        case kBatchSSE2: return "sse2";
+        default:         return "scalar";
+    }
+}
+
+void BoardBatch::evaluate(const uint32_t *first, const uint32_t *second, uint8_t *results, size_t count) const
+{
+    evaluate(first, second, results, count, bestPath());
+}
+
+void BoardBatch::evaluate(const uint32_t *first, const uint32_t *second, uint8_t *results, size_t count, BoardBatchPath path) const
+{
+    size_t done = 0;
+#ifdef BOARDBATCH_X86
+    if (path == kBatchAVX2 && bestPath() == kBatchAVX2) {
+        done = evaluateAVX2(_lines, _fullMask, first, second, results, count);
+    } else if (path != kBatchScalar) {
+        done = evaluateSSE2(_lines, _fullMask, first, second, results, count);
+    }
+#endif
+    evaluateScalar(_lines, _fullMask, first + done, second + done, results + done, count - done);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// evaluates many independent m,n,k boards in one call
+//
+// boards are packed as two bitmasks, one per player, with bit (y * width + x)
+// set for each stone. the masks are passed as two parallel arrays so the SIMD
+// paths can load 4 (SSE2) or 8 (AVX2) boards per instruction. the fastest path
+// the cpu supports is picked once at startup, the scalar path is the reference.
+//
+
+enum BoardBatchFlags
+{
+    kBatchFirstWins     = 1 << 0,
+    kBatchSecondWins    = 1 << 1,
+    kBatchFull          = 1 << 2,
+    kBatchEmpty         = 1 << 3
+};
+
+enum BoardBatchPath
+{
+    kBatchScalar,
+    kBatchSSE2,
+    kBatchAVX2
+};
+
+class BoardBatch
+{
+public:
+    BoardBatch(int width, int height, int k);
+
+    // results[i] gets BoardBatchFlags for board i, a full board with no winner is a draw
+    void            evaluate(const uint32_t *first, const uint32_t *second, uint8_t *results, size_t count) const;
+    void            evaluate(const uint32_t *first, const uint32_t *second, uint8_t *results, size_t count, BoardBatchPath path) const;
+
+    // the path evaluate() uses on this machine, and its name for logging
+    static BoardBatchPath   bestPath();
+    static const char       *pathName(BoardBatchPath path);
+
+    const std::vector<uint32_t> &lines() const { return _lines; }
+    uint32_t        fullMask() const { return _fullMask; }
+
+    // every run of k cells in a row, column or diagonal as a bitmask of cells
+    static std::vector<uint32_t> buildLineMasks(int width, int height, int k);
+
+private:
+    std::vector<uint32_t>   _lines;
+    uint32_t                _fullMask;
+};
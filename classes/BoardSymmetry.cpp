@@ -0,0 +1,208 @@
+#include "BoardSymmetry.h"
+
+#include "CheckersPosition.h"
+#include "ChessPosition.h"
+#include "ConnectFourBoard.h"
+#include "GomokuBoard.h"
+#include "QubicBoard.h"
+#include "ReversiBoard.h"
+#include "UltimateBoard.h"
+
+#include <bit>
+#include <utility>
+
+// splitmix64, for the per cell keys
+static uint64_t mixKey(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// a player's stone on a cell, XORed together into a position key
+static uint64_t cellKey(int cell, int player)
+{
+    return mixKey((uint64_t)cell * 2 + (uint64_t)player + 1);
+}
+
+// mixed in for whatever the stones alone don't say, whose turn or where to play next
+static uint64_t extraKey(int what)
+{
+    return mixKey(0xE7A0000000000000ull + (uint64_t)what);
+}
+
+// the smallest of the keys the symmetries gave, 0 is kept free for empty hash slots
+static uint64_t pickSymmetry(const uint64_t *keys, int count, int &symmetry)
+{
+    symmetry = 0;
+    for (int i = 1; i < count; i++) {
+        if (keys[i] < keys[symmetry]) {
+            symmetry = i;
+        }
+    }
+    return keys[symmetry] ? keys[symmetry] : 1;
+}
+
+int mapConnectFourMove(int column, int symmetry, bool inverse)
+{
+    return symmetry ? ConnectFourBoard::kWidth - 1 - column : column;
+}
+
+int mapSquare(int cell, int size, int symmetry, bool inverse)
+{
+    int row = cell / size;
+    int column = cell % size;
+    if ((symmetry & 1) && !inverse) std::swap(row, column);
+    if (symmetry & 2) row = size - 1 - row;
+    if (symmetry & 4) column = size - 1 - column;
+    if ((symmetry & 1) && inverse) std::swap(row, column);
+    return row * size + column;
+}
+
+int mapRectangle(int cell, int width, int height, int symmetry, bool inverse)
+{
+    if (width == height) {
+        return mapSquare(cell, width, symmetry, inverse);
+    }
+    int row = cell / width;
+    int column = cell % width;
+    if (symmetry & 2) row = height - 1 - row;
+    if (symmetry & 4) column = width - 1 - column;
+    return row * width + column;
+}
+
+int mapCube(int cell, int symmetry, bool inverse)
+{
+    static const int orders[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+    const int *order = orders[symmetry >> 3];
+    int from[3] = { cell & 3, (cell >> 2) & 3, cell >> 4 };
+    int to[3];
+    for (int axis = 0; axis < 3; axis++) {
+        if (!inverse) {
+            int value = from[order[axis]];
+            to[axis] = (symmetry >> axis & 1) ? 3 - value : value;
+        } else {
+            int value = (symmetry >> axis & 1) ? 3 - from[axis] : from[axis];
+            to[order[axis]] = value;
+        }
+    }
+    return to[0] | (to[1] << 2) | (to[2] << 4);
+}
+
+int mapUltimateMove(int move, int symmetry, bool inverse)
+{
+    return mapSquare(move / 9, 3, symmetry, inverse) * 9 + mapSquare(move % 9, 3, symmetry, inverse);
+}
+
+uint64_t canonicalKey(const ConnectFourBoard &board, int &symmetry)
+{
+    const int width = ConnectFourBoard::kWidth;
+    uint64_t keys[2] = { 0, 0 };
+    for (int player = 0; player < 2; player++) {
+        for (uint64_t bits = board.stones(player); bits; bits &= bits - 1) {
+            int bit = std::countr_zero(bits);
+            int column = bit / (ConnectFourBoard::kHeight + 1);
+            int row = bit % (ConnectFourBoard::kHeight + 1);
+            keys[0] ^= cellKey(row * width + column, player);
+            keys[1] ^= cellKey(row * width + width - 1 - column, player);
+        }
+    }
+    return pickSymmetry(keys, 2, symmetry);
+}
+
+uint64_t canonicalKey(const GomokuBoard &board, int &symmetry)
+{
+    uint64_t keys[8] = {};
+    for (int cell = 0; cell < GomokuBoard::kCells; cell++) {
+        int player = board.ownerAt(cell);
+        if (player >= 0) {
+            for (int i = 0; i < 8; i++) {
+                keys[i] ^= cellKey(mapSquare(cell, GomokuBoard::kSize, i, false), player);
+            }
+        }
+    }
+    return pickSymmetry(keys, 8, symmetry);
+}
+
+uint64_t canonicalKey(const QubicBoard &board, int &symmetry)
+{
+    uint64_t keys[48] = {};
+    for (int player = 0; player < 2; player++) {
+        for (uint64_t bits = board.stones(player); bits; bits &= bits - 1) {
+            int cell = std::countr_zero(bits);
+            for (int i = 0; i < 48; i++) {
+                keys[i] ^= cellKey(mapCube(cell, i, false), player);
+            }
+        }
+    }
+    return pickSymmetry(keys, 48, symmetry);
+}
+
+uint64_t canonicalKey(const int *board, int width, int height, int &symmetry)
+{
+    int step = width == height ? 1 : 2;
+    uint64_t keys[8] = {};
+    for (int cell = 0; cell < width * height; cell++) {
+        if (board[cell]) {
+            for (int i = 0; i < 8; i += step) {
+                keys[i / step] ^= cellKey(mapRectangle(cell, width, height, i, false), board[cell] - 1);
+            }
+        }
+    }
+    uint64_t key = pickSymmetry(keys, 8 / step, symmetry);
+    symmetry *= step;
+    return key;
+}
+
+// passes mean the discs alone don't say whose turn it is
+uint64_t canonicalKey(const ReversiBoard &board, int &symmetry)
+{
+    uint64_t keys[8] = {};
+    for (int player = 0; player < 2; player++) {
+        for (uint64_t bits = board.discs(player); bits; bits &= bits - 1) {
+            int square = std::countr_zero(bits);
+            for (int i = 0; i < 8; i++) {
+                keys[i] ^= cellKey(mapSquare(square, 8, i, false), player);
+            }
+        }
+    }
+    if (board.sideToMove()) {
+        for (uint64_t &key : keys) {
+            key ^= extraKey(0);
+        }
+    }
+    return pickSymmetry(keys, 8, symmetry);
+}
+
+// the board to play in turns with the rest
+uint64_t canonicalKey(const UltimateBoard &board, int &symmetry)
+{
+    uint64_t keys[8] = {};
+    for (int move = 0; move < UltimateBoard::kCells; move++) {
+        int player = board.ownerAt(move);
+        if (player >= 0) {
+            for (int i = 0; i < 8; i++) {
+                keys[i] ^= cellKey(mapUltimateMove(move, i, false), player);
+            }
+        }
+    }
+    if (board.target() != UltimateBoard::kAnyBoard) {
+        for (int i = 0; i < 8; i++) {
+            keys[i] ^= extraKey(1 + mapSquare(board.target(), 3, i, false));
+        }
+    }
+    return pickSymmetry(keys, 8, symmetry);
+}
+
+uint64_t canonicalKey(const ChessPosition &position, int &symmetry)
+{
+    symmetry = 0;
+    return position.key() ? position.key() : 1;
+}
+
+uint64_t canonicalKey(const CheckersPosition &position, int &symmetry)
+{
+    symmetry = 0;
+    return position.key() ? position.key() : 1;
+}
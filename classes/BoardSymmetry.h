@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+class CheckersPosition;
+class ChessPosition;
+class ConnectFourBoard;
+class GomokuBoard;
+class QubicBoard;
+class ReversiBoard;
+class UltimateBoard;
+
+//
+// position keys that are the same for a position and its mirror images
+//
+// each board is hashed under every symmetry of the game and the smallest key is
+// kept, symmetry says which one that was. moves are carried between a position
+// and its canonical one with the matching map function, inverse going back.
+// these are what the position database and the opening book are keyed by, so
+// the games and the offline tools have to agree on them. a key is never 0.
+//
+
+uint64_t    canonicalKey(const ConnectFourBoard &board, int &symmetry);
+uint64_t    canonicalKey(const GomokuBoard &board, int &symmetry);
+uint64_t    canonicalKey(const QubicBoard &board, int &symmetry);
+uint64_t    canonicalKey(const ReversiBoard &board, int &symmetry);
+uint64_t    canonicalKey(const UltimateBoard &board, int &symmetry);
+// an m,n,k board of width * height cells holding 0 (empty), 1 or 2 (player
+// number + 1), a key only means something next to the same width, height and k
+uint64_t    canonicalKey(const int *board, int width, int height, int &symmetry);
+// castling and pawns leave chess without a symmetry worth using, and checkers
+// men only move forwards, so these are the Zobrist keys with symmetry 0
+uint64_t    canonicalKey(const ChessPosition &position, int &symmetry);
+uint64_t    canonicalKey(const CheckersPosition &position, int &symmetry);
+
+// connect four only mirrors left to right, symmetry 1 flips the column
+int         mapConnectFourMove(int column, int symmetry, bool inverse);
+// the 8 symmetries of a size x size board: bit 0 swaps rows and columns, then
+// bit 1 turns the rows upside down and bit 2 the columns
+int         mapSquare(int cell, int size, int symmetry, bool inverse);
+// mapSquare on a width x height board, only a square one can swap rows and
+// columns so anything else just has the even symmetries
+int         mapRectangle(int cell, int width, int height, int symmetry, bool inverse);
+// the 48 symmetries of a 4x4x4 cube: symmetry / 8 picks the order of the axes
+// and the low 3 bits which of them run backwards
+int         mapCube(int cell, int symmetry, bool inverse);
+// the big board and every small one turn together
+int         mapUltimateMove(int move, int symmetry, bool inverse);
@@ -0,0 +1,243 @@
+#include "Checkers.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+
+const int AI_PLAYER   = 1;      // index of the AI player (yellow)
+const int HUMAN_PLAYER= 0;      // index of the human player (red)
+
+// how long the AI may think about one move, AIMAXDepth limits it further
+const double AI_TIME_BUDGET = 1.0;
+
+// piece codes kept in the bit's game tag, the same as the state string
+const int TAG_KING = 2;
+
+static GameRegistration registration({
+    .id = kGameIdCheckers, .name = "Checkers", .boardWidth = 8, .boardHeight = 8, .players = 2,
+    .hasAI = true, .ai = "alpha-beta on a 32-square bitboard",
+    .create = [](const GameSetup &) -> Game * { return new Checkers(); },
+});
+
+Checkers::Checkers()
+{
+    _search.setTimeBudget(AI_TIME_BUDGET);
+}
+
+Checkers::~Checkers()
+{
+}
+
+//
+// red for the first player, yellow for the second, kings are framed
+//
+Bit* Checkers::PieceForPlayer(const int playerNumber, bool king)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(playerNumber == 0 ? "red.png" : "yellow.png");
+    bit->setOwner(getPlayerAt(playerNumber));
+    bit->setGameTag(1 + playerNumber + (king ? TAG_KING : 0));
+    bit->setHighlighted(king);
+    return bit;
+}
+
+void Checkers::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = 8;
+    _gameOptions.rowY = 8;
+
+    // no depth limit unless one is set, the time budget ends the search
+    if (_gameOptions.AIMAXDepth <= 0) {
+        _gameOptions.AIMAXDepth = CheckersSearch::kMaxPly - 1;
+    }
+    setAIPlayer(AI_PLAYER);
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            ImVec2 position(x * 100.0f + 50.0f, y * 100.0f + 50.0f);
+            _grid[y][x].initHolder(position, "square.png", x, y);
+            // pieces only ever stand on the dark squares
+            if (CheckersPosition::squareAt(y, x) >= 0) {
+                _grid[y][x].setColor(0.45f, 0.3f, 0.2f, 1.0f);
+            } else {
+                _grid[y][x].setColor(0.95f, 0.9f, 0.8f, 1.0f);
+            }
+        }
+    }
+
+    _position.reset();
+    _search.clearTable();
+    syncPieces();
+
+    startGame();
+}
+
+int Checkers::squareOf(BitHolder *holder) const
+{
+    // every holder in this game is one of our squares
+    Square *square = static_cast<Square *>(holder);
+    return CheckersPosition::squareAt(square->row(), square->column());
+}
+
+//
+// make the bits on the board match the position, leaving alone the ones that already do
+//
+void Checkers::syncPieces()
+{
+    for (int square = 0; square < CheckersPosition::kSquares; square++) {
+        Square &holder = squareAt(square);
+        int owner = _position.ownerAt(square);
+        int tag = owner < 0 ? 0 : 1 + owner + (_position.isKing(square) ? TAG_KING : 0);
+        Bit *bit = holder.bit();
+        if (bit && bit->gameTag() == tag) {
+            continue;
+        }
+        holder.destroyBit();
+        if (owner >= 0) {
+            bit = PieceForPlayer(owner, _position.isKing(square));
+            bit->moveTo(holder.getPosition());
+            holder.setBit(bit);
+        }
+    }
+}
+
+bool Checkers::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    if (checkForWinner() || checkForDraw()) {
+        return false;
+    }
+    // the position knows whose move it is, even after a state string was loaded
+    if (bit->getOwner()->playerNumber() != _position.sideToMove()) {
+        return false;
+    }
+
+    // only pieces that have a legal move, which means only capturing ones when there is a capture
+    int from = squareOf(src);
+    CheckersMoveList list;
+    _position.generateMoves(list);
+    for (const CheckersMove &move : list) {
+        if (move.from == from) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Checkers::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    int from = squareOf(src);
+    int to = squareOf(dst);
+    CheckersMove move;
+    return from >= 0 && to >= 0 && _position.findMove(from, to, move);
+}
+
+//
+// the dragged bit is already on dst, the position catches up and takes off what was captured
+//
+void Checkers::bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst)
+{
+    CheckersMove move;
+    if (!_position.findMove(squareOf(src), squareOf(dst), move)) {
+        // canBitMoveFromTo() already said yes, so this can't happen, put things back as they were
+        syncPieces();
+        return;
+    }
+    playMove(move);
+    endTurn();
+}
+
+void Checkers::playMove(const CheckersMove &move)
+{
+    _position.makeMove(move);
+    syncPieces();
+}
+
+void Checkers::stopGame()
+{
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            _grid[y][x].destroyBit();
+        }
+    }
+}
+
+Player* Checkers::checkForWinner()
+{
+    CheckersMoveList list;
+    _position.generateMoves(list);
+    if (list.count == 0) {
+        // the side that can't move lost
+        return getPlayerAt(_position.sideToMove() ^ 1);
+    }
+    return nullptr;
+}
+
+bool Checkers::checkForDraw()
+{
+    return _position.isDraw();
+}
+
+std::string Checkers::initialStateString()
+{
+    CheckersPosition start;
+    return start.state();
+}
+
+std::string Checkers::stateString() const
+{
+    return _position.state();
+}
+
+void Checkers::setStateString(const std::string &s)
+{
+    if (!_position.setState(s)) {
+        _position.reset();
+    }
+    syncPieces();
+}
+
+void Checkers::updateAI()
+{
+    if (checkForWinner() || checkForDraw()) {
+        return;
+    }
+
+    // book moves are indexes into the generated moves, like the self-play ones
+    int symmetry;
+    int index = openingBookMove(canonicalKey(_position, symmetry));
+    if (index >= 0) {
+        CheckersMoveList list;
+        _position.generateMoves(list);
+        if (index < list.count) {
+            _lastStats.setBookMove(index);
+            _lastStats.logMove("checkers", (int)getCurrentTurnNo());
+            playMove(list.moves[index]);
+            endTurn();
+            return;
+        }
+    }
+
+    CheckersMove move;
+    _search.setTimeBudget(searchTimeBudget(AI_TIME_BUDGET));
+    bool found = _search.findBestMove(_position, _gameOptions.AIMAXDepth, move);
+    _lastStats = _search.stats();
+    _lastStats.logMove("checkers", (int)getCurrentTurnNo());
+
+    if (found) {
+        playMove(move);
+        endTurn();
+    }
+}
+
+// recorded moves are indexes into the generated moves
+bool Checkers::playRecordedMove(int move)
+{
+    CheckersMoveList list;
+    _position.generateMoves(list);
+    if (move < 0 || move >= list.count) {
+        return false;
+    }
+    playMove(list.moves[move]);
+    endTurn();
+    return true;
+}
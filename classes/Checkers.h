@@ -0,0 +1,56 @@
+#pragma once
+#include "Game.h"
+#include "Square.h"
+#include "CheckersPosition.h"
+#include "CheckersSearch.h"
+
+//
+// checkers, the pieces are dragged from square to square
+//
+// a capture is dragged straight to the square the piece ends up on, however
+// many pieces it jumps on the way. like chess, the squares are brought back in
+// step with the 32-bit position after every move, which takes the captured
+// pieces off and crowns kings. kings get a frame. the AI plays yellow.
+//
+class Checkers : public Game
+{
+public:
+    Checkers();
+    ~Checkers();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    // 32 dark squares from the top (0 empty, 1 red, 2 yellow, 3 red king, 4 yellow king) then the side to move
+    std::string stateString() const override;
+    void        setStateString(const std::string &s) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        playRecordedMove(int move) override;
+    bool        gameHasAI() override { return true; }
+    const SearchStats *searchStats() const override { return &_lastStats; }
+
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+
+private:
+    Bit *       PieceForPlayer(const int playerNumber, bool king);
+    Square      &squareAt(int square) { return _grid[CheckersPosition::row(square)][CheckersPosition::column(square)]; }
+    // -1 for the light squares
+    int         squareOf(BitHolder *holder) const;
+    void        syncPieces();
+    void        playMove(const CheckersMove &move);
+
+    Square              _grid[8][8];
+    CheckersPosition    _position;
+
+    CheckersSearch      _search;
+    // what the last AI move cost
+    SearchStats         _lastStats;
+};
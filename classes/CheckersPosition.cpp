@@ -0,0 +1,254 @@
+#include "CheckersPosition.h"
+
+#include <bit>
+
+// rows 0, 2, 4 and 6, where the dark squares are the odd columns
+const uint32_t EVEN_ROWS = 0x0F0F0F0F;
+const uint32_t ODD_ROWS = 0xF0F0F0F0;
+// first and last dark square of every row
+const uint32_t FIRST_IN_ROW = 0x11111111;
+const uint32_t LAST_IN_ROW = 0x88888888;
+
+const uint32_t TOP_ROW = 0x0000000F;
+const uint32_t BOTTOM_ROW = 0xF0000000;
+
+// red, yellow, red king, yellow king for each square, then the side to move
+struct CheckersKeys
+{
+    uint64_t    pieces[4][32];
+    uint64_t    side;
+
+    CheckersKeys()
+    {
+        // splitmix64 with a fixed seed so keys are the same every run
+        uint64_t state = 0x2545F4914F6CDD1Dull;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        };
+        for (auto &kind : pieces) {
+            for (uint64_t &key : kind) {
+                key = next();
+            }
+        }
+        side = next();
+    }
+};
+
+static const CheckersKeys checkersKeys;
+
+static int opposite(int direction)
+{
+    return 3 - direction;
+}
+
+static int popLowest(uint32_t &bits)
+{
+    int square = std::countr_zero(bits);
+    bits &= bits - 1;
+    return square;
+}
+
+uint32_t CheckersPosition::step(uint32_t pieces, int direction)
+{
+    switch (direction) {
+        case kUpLeft:       return ((pieces & EVEN_ROWS) >> 4) | ((pieces & ODD_ROWS & ~FIRST_IN_ROW) >> 5);
+        case kUpRight:      return ((pieces & EVEN_ROWS & ~LAST_IN_ROW) >> 3) | ((pieces & ODD_ROWS) >> 4);
+        case kDownLeft:     return ((pieces & EVEN_ROWS) << 4) | ((pieces & ODD_ROWS & ~FIRST_IN_ROW) << 3);
+        case kDownRight:    return ((pieces & EVEN_ROWS & ~LAST_IN_ROW) << 5) | ((pieces & ODD_ROWS) << 4);
+    }
+    return 0;
+}
+
+CheckersPosition::CheckersPosition()
+{
+    reset();
+}
+
+void CheckersPosition::reset()
+{
+    _pieces[0] = 0xFFF00000;
+    _pieces[1] = 0x00000FFF;
+    _kings = 0;
+    _side = 0;
+    _quietPlies = 0;
+    _key = 0;
+    for (int square = 0; square < kSquares; square++) {
+        int owner = ownerAt(square);
+        if (owner >= 0) {
+            _key ^= checkersKeys.pieces[owner][square];
+        }
+    }
+}
+
+int CheckersPosition::ownerAt(int square) const
+{
+    if (_pieces[0] & checkersBit(square)) return 0;
+    if (_pieces[1] & checkersBit(square)) return 1;
+    return -1;
+}
+
+bool CheckersPosition::setState(const std::string &state)
+{
+    if (state.size() < (size_t)kSquares + 1) {
+        return false;
+    }
+    _pieces[0] = _pieces[1] = _kings = 0;
+    _key = 0;
+    for (int square = 0; square < kSquares; square++) {
+        int code = state[square] - '0';
+        if (code < 1 || code > 4) {
+            continue;
+        }
+        int player = (code - 1) & 1;
+        bool king = code >= 3;
+        _pieces[player] |= checkersBit(square);
+        if (king) {
+            _kings |= checkersBit(square);
+        }
+        _key ^= checkersKeys.pieces[player + (king ? 2 : 0)][square];
+    }
+    _side = state[kSquares] == '1' ? 1 : 0;
+    if (_side) {
+        _key ^= checkersKeys.side;
+    }
+    _quietPlies = 0;
+    return true;
+}
+
+std::string CheckersPosition::state() const
+{
+    std::string state;
+    for (int square = 0; square < kSquares; square++) {
+        int owner = ownerAt(square);
+        state += owner < 0 ? '0' : (char)('1' + owner + (isKing(square) ? 2 : 0));
+    }
+    state += (char)('0' + _side);
+    return state;
+}
+
+uint32_t CheckersPosition::movers(int player, int direction) const
+{
+    // men only go forward, up for red and down for yellow
+    bool forward = player == 0 ? (direction == kUpLeft || direction == kUpRight) : (direction == kDownLeft || direction == kDownRight);
+    return forward ? _pieces[player] : (_pieces[player] & _kings);
+}
+
+bool CheckersPosition::hasCaptures() const
+{
+    uint32_t open = empty();
+    for (int direction = 0; direction < 4; direction++) {
+        uint32_t over = step(movers(_side, direction), direction) & _pieces[1 - _side];
+        if (step(over, direction) & open) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CheckersPosition::addJumps(CheckersMoveList &list, int from, int square, uint32_t captured, bool king) const
+{
+    // the jumping piece has left its square, the pieces it took stay until the move is over
+    uint32_t open = empty() | checkersBit(from);
+    uint32_t farRow = _side == 0 ? TOP_ROW : BOTTOM_ROW;
+    bool jumped = false;
+
+    for (int direction = 0; direction < 4; direction++) {
+        if (!king && !(movers(_side, direction) & checkersBit(from))) {
+            continue;
+        }
+        uint32_t over = step(checkersBit(square), direction) & _pieces[1 - _side] & ~captured;
+        uint32_t land = step(over, direction) & open;
+        if (!land) {
+            continue;
+        }
+        jumped = true;
+        int landing = std::countr_zero(land);
+        if (!king && (land & farRow)) {
+            // crowning ends the move
+            list.add(from, landing, captured | over);
+        } else {
+            addJumps(list, from, landing, captured | over, king);
+        }
+    }
+    if (!jumped && captured) {
+        list.add(from, square, captured);
+    }
+}
+
+void CheckersPosition::generateMoves(CheckersMoveList &list) const
+{
+    list.count = 0;
+    uint32_t open = empty();
+
+    if (hasCaptures()) {
+        uint32_t pieces = _pieces[_side];
+        while (pieces) {
+            int square = popLowest(pieces);
+            addJumps(list, square, square, 0, isKing(square));
+        }
+        return;
+    }
+
+    // each direction moves every piece that can go that way at once
+    for (int direction = 0; direction < 4; direction++) {
+        uint32_t targets = step(movers(_side, direction), direction) & open;
+        while (targets) {
+            int to = popLowest(targets);
+            int from = std::countr_zero(step(checkersBit(to), opposite(direction)));
+            list.add(from, to, 0);
+        }
+    }
+}
+
+bool CheckersPosition::findMove(int from, int to, CheckersMove &move) const
+{
+    CheckersMoveList list;
+    generateMoves(list);
+    for (const CheckersMove &candidate : list) {
+        if (candidate.from == from && candidate.to == to) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CheckersPosition::makeMove(const CheckersMove &move)
+{
+    int me = _side;
+    int them = 1 - me;
+    bool king = isKing(move.from);
+    bool wasKing = king;
+    int kind = me + (king ? 2 : 0);
+
+    _pieces[me] &= ~checkersBit(move.from);
+    _kings &= ~checkersBit(move.from);
+    _key ^= checkersKeys.pieces[kind][move.from];
+
+    uint32_t captures = move.captures;
+    while (captures) {
+        int square = popLowest(captures);
+        _key ^= checkersKeys.pieces[them + (isKing(square) ? 2 : 0)][square];
+    }
+    _pieces[them] &= ~move.captures;
+    _kings &= ~move.captures;
+
+    uint32_t farRow = me == 0 ? TOP_ROW : BOTTOM_ROW;
+    if (!king && (checkersBit(move.to) & farRow)) {
+        king = true;
+        kind += 2;
+    }
+    _pieces[me] |= checkersBit(move.to);
+    if (king) {
+        _kings |= checkersBit(move.to);
+    }
+    _key ^= checkersKeys.pieces[kind][move.to];
+
+    // only king moves that take nothing count towards the draw
+    _quietPlies = (move.isCapture() || !wasKing) ? 0 : _quietPlies + 1;
+    _side = them;
+    _key ^= checkersKeys.side;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//
+// american checkers (english draughts) on a 32-bit board
+//
+// only the 32 dark squares are used, four to a row, square = row * 4 + index in
+// the row with row 0 at the top. red (player 0) starts on the bottom three rows
+// and moves up, yellow (player 1) starts on the top three and moves down. red
+// moves first.
+//
+// the dark squares of even and odd rows are offset by half a square, so a step
+// in one of the four diagonal directions is a shift by 3, 4 or 5 depending on
+// the row, with a mask to keep pieces from wrapping around the board edge. a
+// whole set of pieces steps at once, and a jump is two steps in a row.
+//
+// captures are mandatory and a jump has to be carried on as long as the same
+// piece can keep jumping. a man that reaches the far row is crowned and its move
+// ends there.
+//
+
+struct CheckersMove
+{
+    uint8_t     from;
+    uint8_t     to;
+    // every piece taken on the way
+    uint32_t    captures;
+
+    bool        isCapture() const { return captures != 0; }
+    bool        operator==(const CheckersMove &other) const { return from == other.from && to == other.to && captures == other.captures; }
+};
+
+struct CheckersMoveList
+{
+    CheckersMove    moves[128];
+    int             count = 0;
+
+    void            add(int from, int to, uint32_t captures) { moves[count++] = CheckersMove{ (uint8_t)from, (uint8_t)to, captures }; }
+    CheckersMove    *begin() { return moves; }
+    CheckersMove    *end() { return moves + count; }
+};
+
+inline uint32_t checkersBit(int square) { return 1u << square; }
+
+class CheckersPosition
+{
+public:
+    static const int kSquares = 32;
+    // without a capture or a man moving for this many plies the game is drawn
+    static const int kDrawPlies = 80;
+
+    // the four diagonal directions
+    enum Direction { kUpLeft, kUpRight, kDownLeft, kDownRight };
+
+    CheckersPosition();
+
+    // the usual starting position
+    void        reset();
+    // one character per square (0 empty, 1 red man, 2 yellow man, 3 red king, 4 yellow king) then the side to move (0 or 1)
+    bool        setState(const std::string &state);
+    std::string state() const;
+
+    // every legal move, only captures when there are any
+    void        generateMoves(CheckersMoveList &list) const;
+    void        makeMove(const CheckersMove &move);
+    // the legal move from one square to another, false if there is none
+    bool        findMove(int from, int to, CheckersMove &move) const;
+
+    int         sideToMove() const { return _side; }
+    uint32_t    pieces(int player) const { return _pieces[player]; }
+    uint32_t    kings() const { return _kings; }
+    uint32_t    occupied() const { return _pieces[0] | _pieces[1]; }
+    uint32_t    empty() const { return ~occupied(); }
+    // -1 if empty, otherwise the player
+    int         ownerAt(int square) const;
+    bool        isKing(int square) const { return (_kings & checkersBit(square)) != 0; }
+    int         quietPlies() const { return _quietPlies; }
+    uint64_t    key() const { return _key; }
+    bool        hasCaptures() const;
+    bool        isDraw() const { return _quietPlies >= kDrawPlies; }
+
+    static int  row(int square) { return square >> 2; }
+    // board column 0-7 of a square
+    static int  column(int square) { return ((square & 3) << 1) + ((row(square) & 1) ? 0 : 1); }
+    // the square at a board row and column, -1 for light squares
+    static int  squareAt(int row, int column) { return ((row + column) & 1) ? row * 4 + (column >> 1) : -1; }
+
+    // every piece in pieces moved one square in direction, pieces that would leave the board are dropped
+    static uint32_t step(uint32_t pieces, int direction);
+
+private:
+    // the pieces of player that may move in direction
+    uint32_t    movers(int player, int direction) const;
+    // follow every jump on from a square, adding a move at each place the jumping has to stop
+    void        addJumps(CheckersMoveList &list, int from, int square, uint32_t captured, bool king) const;
+
+    uint32_t    _pieces[2];
+    uint32_t    _kings;
+    int         _side;
+    int         _quietPlies;
+    uint64_t    _key;
+};
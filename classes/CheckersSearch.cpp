@@ -0,0 +1,230 @@
+#include "CheckersSearch.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string>
+
+// larger than any score negamax can return
+const int SCORE_INFINITY = CheckersSearch::kWinScore + 1000;
+
+// scores this close to a win are wins in a known number of plies
+const int SCORE_WIN_BOUND = CheckersSearch::kWinScore - 1000;
+
+const int MAN_VALUE = 100;
+const int KING_VALUE = 150;
+// per row a man has come forward
+const int ADVANCE_VALUE = 3;
+// men still on the home row keep the other side's men from crowning
+const int BACK_ROW_VALUE = 8;
+// the middle eight squares
+const uint32_t CENTER = 0x00666600;
+const int CENTER_VALUE = 4;
+
+const uint32_t TOP_ROW = 0x0000000F;
+const uint32_t BOTTOM_ROW = 0xF0000000;
+
+static int packMove(const CheckersMove &move)
+{
+    return move.from * 32 + move.to;
+}
+
+CheckersSearch::CheckersSearch() : _table(SCORE_WIN_BOUND)
+{
+    clearTable();
+}
+
+void CheckersSearch::clearTable()
+{
+    _table.clear();
+    memset(_history, 0, sizeof(_history));
+}
+
+int CheckersSearch::evaluate(const CheckersPosition &position)
+{
+    int score[2] = { 0, 0 };
+    uint32_t kings = position.kings();
+    for (int player = 0; player < 2; player++) {
+        uint32_t pieces = position.pieces(player);
+        uint32_t men = pieces & ~kings;
+        score[player] += std::popcount(men) * MAN_VALUE + std::popcount(pieces & kings) * KING_VALUE;
+        score[player] += std::popcount(pieces & CENTER) * CENTER_VALUE;
+        score[player] += std::popcount(men & (player == 0 ? BOTTOM_ROW : TOP_ROW)) * BACK_ROW_VALUE;
+        while (men) {
+            int row = CheckersPosition::row(std::countr_zero(men));
+            men &= men - 1;
+            score[player] += (player == 0 ? 7 - row : row) * ADVANCE_VALUE;
+        }
+    }
+    int me = position.sideToMove();
+    return score[me] - score[1 - me];
+}
+
+void CheckersSearch::orderMoves(const CheckersPosition &position, CheckersMoveList &list, int tableMove) const
+{
+    uint32_t farRow = position.sideToMove() == 0 ? TOP_ROW : BOTTOM_ROW;
+    int scores[128];
+    for (int i = 0; i < list.count; i++) {
+        const CheckersMove &move = list.moves[i];
+        int score = _history[move.from][move.to];
+        if (packMove(move) == tableMove) {
+            score = 1 << 30;
+        } else if (move.isCapture()) {
+            score = (1 << 28) + std::popcount(move.captures);
+        } else if (!position.isKing(move.from) && (checkersBit(move.to) & farRow)) {
+            score = 1 << 27;
+        }
+        scores[i] = score;
+    }
+    // insertion sort, there are rarely more than a dozen moves
+    for (int i = 1; i < list.count; i++) {
+        CheckersMove move = list.moves[i];
+        int score = scores[i];
+        int j = i;
+        while (j > 0 && scores[j - 1] < score) {
+            list.moves[j] = list.moves[j - 1];
+            scores[j] = scores[j - 1];
+            j--;
+        }
+        list.moves[j] = move;
+        scores[j] = score;
+    }
+}
+
+//
+// the same position earlier in the line with only quiet king moves in between
+//
+bool CheckersSearch::isRepetition(const CheckersPosition &position, int ply) const
+{
+    int back = std::min(position.quietPlies(), ply);
+    for (int i = 4; i <= back; i += 2) {
+        if (_keys[ply - i] == position.key()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int CheckersSearch::negamax(const CheckersPosition &position, int alpha, int beta, int ply, int depthLeft)
+{
+    if (_clock.tick(++_stats.nodes)) {
+        return 0;
+    }
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+    _keys[ply] = position.key();
+    if (position.isDraw() || isRepetition(position, ply)) {
+        return 0;
+    }
+
+    CheckersMoveList list;
+    position.generateMoves(list);
+    if (list.count == 0) {
+        return -(kWinScore - ply);
+    }
+    // captures are forced, so the search keeps going until they are over
+    if ((depthLeft <= 0 && !list.moves[0].isCapture()) || ply >= kMaxPly) {
+        return evaluate(position);
+    }
+
+    uint64_t key = position.key();
+    int tableMove = -1;
+    int tableScore;
+    if (_table.probe(key, depthLeft, alpha, beta, ply, tableMove, tableScore, _stats)) {
+        return tableScore;
+    }
+
+    orderMoves(position, list, tableMove);
+
+    int originalAlpha = alpha;
+    int bestScore = -SCORE_INFINITY;
+    int bestMove = -1;
+    _stats.expanded++;
+
+    for (int i = 0; i < list.count; i++) {
+        const CheckersMove &move = list.moves[i];
+        CheckersPosition child = position;
+        child.makeMove(move);
+        // a single legal move costs no depth
+        int score = -negamax(child, -beta, -alpha, ply + 1, list.count == 1 ? depthLeft : depthLeft - 1);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = packMove(move);
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        if (alpha >= beta) {
+            _stats.cutoffs++;
+            if (i == 0) {
+                _stats.firstMoveCutoffs++;
+            }
+            if (!move.isCapture()) {
+                _history[move.from][move.to] += depthLeft * depthLeft;
+            }
+            break;
+        }
+    }
+
+    if (_clock.timeUp()) {
+        return 0;
+    }
+
+    _table.store(key, std::max(depthLeft, 0), ply, bestScore, bestMove, originalAlpha, beta);
+    return bestScore;
+}
+
+bool CheckersSearch::findBestMove(const CheckersPosition &position, int maxDepth, CheckersMove &best)
+{
+    _clock.start();
+    _stats.reset();
+
+    CheckersMoveList list;
+    position.generateMoves(list);
+    if (list.count == 0) {
+        return false;
+    }
+    best = list.moves[0];
+    if (list.count == 1) {
+        // nothing to think about
+        _stats.bestMove = packMove(best);
+        _stats.seconds = _clock.elapsed();
+        return true;
+    }
+
+    int limit = (maxDepth > 0 && maxDepth < kMaxPly) ? maxDepth : kMaxPly - 1;
+    _keys[0] = position.key();
+    // ordered once here, from then on deepen() brings each iteration's best move to the front
+    orderMoves(position, list, -1);
+    int bestScore = deepen(list.moves, list.count, limit, SCORE_INFINITY, SCORE_WIN_BOUND, _clock, _stats, [&](const CheckersMove &move, int alpha, int depth) {
+        CheckersPosition child = position;
+        child.makeMove(move);
+        return -negamax(child, -SCORE_INFINITY, -alpha, 1, depth - 1);
+    });
+    best = list.moves[0];
+
+    _stats.seconds = _clock.elapsed();
+    _stats.bestMove = packMove(best);
+    _stats.score = bestScore;
+
+    // principal variation out of the table, as from * 32 + to and as text with the squares numbered from 1
+    CheckersPosition line = position;
+    CheckersMove move = best;
+    for (int i = 0; i < limit; i++) {
+        _stats.principalVariation.push_back(packMove(move));
+        if (i > 0) {
+            _stats.principalVariationText += " ";
+        }
+        _stats.principalVariationText += std::to_string(move.from + 1);
+        _stats.principalVariationText += move.isCapture() ? "x" : "-";
+        _stats.principalVariationText += std::to_string(move.to + 1);
+        line.makeMove(move);
+        int next = _table.move(line.key());
+        if (next < 0 || !line.findMove(next / 32, next % 32, move)) {
+            break;
+        }
+    }
+    return true;
+}
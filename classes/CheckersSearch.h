@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CheckersPosition.h"
+#include "SearchStats.h"
+#include "SearchTable.h"
+
+//
+// alpha-beta search for checkers
+//
+// iterative deepening negamax with a transposition table on copies of the
+// 32-bit position. the search doesn't stop in the middle of a capture: when the
+// depth runs out with a capture on the board it carries on until the captures
+// are over, since they are forced anyway. moves are tried table move first,
+// then captures by how much they take, then crowning moves, then by history.
+//
+
+class CheckersSearch
+{
+public:
+    CheckersSearch();
+
+    // best move for the side to move, false if there are no legal moves
+    bool        findBestMove(const CheckersPosition &position, int maxDepth, CheckersMove &best);
+
+    void        setTimeBudget(double seconds) { _clock.setBudget(seconds); }
+    double      timeBudget() const { return _clock.budget(); }
+    const SearchStats &stats() const { return _stats; }
+
+    void        clearTable();
+
+    // material and position for the side to move
+    static int  evaluate(const CheckersPosition &position);
+
+    static const int kWinScore = 100000;
+    static const int kMaxPly = 64;
+
+private:
+    int         negamax(const CheckersPosition &position, int alpha, int beta, int ply, int depthLeft);
+    void        orderMoves(const CheckersPosition &position, CheckersMoveList &list, int tableMove) const;
+    bool        isRepetition(const CheckersPosition &position, int ply) const;
+
+    // moves are stored as from * 32 + to
+    SearchTable _table;
+    SearchClock _clock;
+    // keys of the positions on the current line, for repetitions
+    uint64_t    _keys[kMaxPly + 1];
+    // how often a quiet move caused a cutoff, by from and to square
+    int         _history[32][32];
+    SearchStats _stats;
+};
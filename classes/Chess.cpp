@@ -0,0 +1,276 @@
+#include "Chess.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+
+// textures indexed by piece, white first, the white knight file really is spelled this way
+static const char *pieceTextures[12] = {
+    "w_pawn.png", "w_kinight.png", "w_bishop.png", "w_rook.png", "w_queen.png", "w_king.png",
+    "b_pawn.png", "b_knight.png", "b_bishop.png", "b_rook.png", "b_queen.png", "b_king.png",
+};
+
+const int AI_PLAYER   = 1;      // index of the AI player (black)
+
+// how long the AI may think about one move, AIMAXDepth limits it further
+const double AI_TIME_BUDGET = 1.0;
+
+static GameRegistration registration({
+    .id = kGameIdChess, .name = "Chess", .boardWidth = 8, .boardHeight = 8, .players = 2,
+    .hasAI = true, .ai = "principal variation search on magic bitboards",
+    .create = [](const GameSetup &) -> Game * { return new Chess(); },
+});
+
+Chess::Chess()
+{
+}
+
+Chess::~Chess()
+{
+}
+
+//
+// player 0 is white, player 1 is black, the piece is kept in the game tag
+//
+Bit* Chess::PieceForPlayer(const int piece)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(pieceTextures[piece]);
+    bit->setOwner(getPlayerAt(chessPieceColor(piece)));
+    bit->setGameTag(piece);
+    return bit;
+}
+
+void Chess::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = 8;
+    _gameOptions.rowY = 8;
+
+    // no depth limit unless one is set, the time budget ends the search
+    if (_gameOptions.AIMAXDepth <= 0) {
+        _gameOptions.AIMAXDepth = ChessEngine::kMaxPly - 1;
+    }
+    setAIPlayer(AI_PLAYER);
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            ImVec2 position(x * 100.0f + 50.0f, y * 100.0f + 50.0f);
+            _grid[y][x].initHolder(position, "square.png", x, y);
+        }
+    }
+
+    _position.setFen(kChessStartFen);
+    _history.assign(1, _position.key());
+    _engine.newGame();
+    syncPieces();
+
+    startGame();
+}
+
+int Chess::squareOf(BitHolder *holder) const
+{
+    // every holder in this game is one of our squares
+    Square *square = static_cast<Square *>(holder);
+    return (7 - square->row()) * 8 + square->column();
+}
+
+//
+// make the bits on the board match the position, only squares that changed are touched
+//
+void Chess::syncPieces()
+{
+    for (int square = 0; square < 64; square++) {
+        Square &holder = squareAt(square);
+        int piece = _position.pieceAt(square);
+        Bit *bit = holder.bit();
+        if (bit && bit->gameTag() == piece) {
+            continue;
+        }
+        holder.destroyBit();
+        if (piece != kNoPiece) {
+            bit = PieceForPlayer(piece);
+            bit->moveTo(holder.getPosition());
+            holder.setBit(bit);
+        }
+    }
+}
+
+bool Chess::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    if (checkForWinner() || checkForDraw()) {
+        return false;
+    }
+    // the position knows whose move it is, even after a state string was loaded
+    if (bit->getOwner()->playerNumber() != _position.sideToMove()) {
+        return false;
+    }
+
+    int from = squareOf(src);
+    ChessMoveList list;
+    _position.generateMoves(list);
+    for (ChessMove move : list) {
+        if (move.from() == from) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Chess::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    return !_position.findMove(squareOf(src), squareOf(dst)).isNull();
+}
+
+//
+// the dragged bit is already on dst, the position catches up and fixes up the rest
+//
+void Chess::bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst)
+{
+    ChessMove move = _position.findMove(squareOf(src), squareOf(dst));
+    if (move.isNull()) {
+        // canBitMoveFromTo() already said yes, so this can't happen, put things back as they were
+        syncPieces();
+        return;
+    }
+    playMove(move);
+    endTurn();
+}
+
+void Chess::playMove(ChessMove move)
+{
+    _lastMove = move.uci();
+    bool irreversible = move.isCapture() || chessPieceType(_position.pieceAt(move.from())) == kPawn;
+    _position.makeMove(move);
+    if (irreversible) {
+        _history.clear();
+    }
+    _history.push_back(_position.key());
+    syncPieces();
+}
+
+void Chess::stopGame()
+{
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            _grid[y][x].destroyBit();
+        }
+    }
+}
+
+Player* Chess::checkForWinner()
+{
+    if (_position.isCheckmate()) {
+        // the side that can't move lost
+        return getPlayerAt(_position.sideToMove() ^ 1);
+    }
+    return nullptr;
+}
+
+bool Chess::isRepetition() const
+{
+    int seen = 0;
+    for (uint64_t key : _history) {
+        if (key == _position.key()) {
+            seen++;
+        }
+    }
+    return seen >= 3;
+}
+
+bool Chess::checkForDraw()
+{
+    return _position.isStalemate() || _position.insufficientMaterial() || _position.fiftyMoveRule() || isRepetition();
+}
+
+std::string Chess::initialStateString()
+{
+    return kChessStartFen;
+}
+
+std::string Chess::stateString() const
+{
+    return _position.fen();
+}
+
+void Chess::setStateString(const std::string &s)
+{
+    if (!_position.setFen(s)) {
+        _position.setFen(kChessStartFen);
+    }
+    _history.assign(1, _position.key());
+    syncPieces();
+}
+
+//
+// setStateString() can only start the repetition history again from the board
+// it was given, so the keys are replayed from the fen of every turn. a halfmove
+// clock of 0 means a capture or pawn move was just made, which clears them the
+// same way playMove() does
+//
+void Chess::restoreGame(const std::string &state, unsigned int turnNo, const std::vector<std::string> &history)
+{
+    Game::restoreGame(state, turnNo, history);
+
+    _history.clear();
+    ChessPosition turn;
+    for (const std::string &fen : history) {
+        if (!turn.setFen(fen)) {
+            continue;
+        }
+        if (turn.halfmoveClock() == 0) {
+            _history.clear();
+        }
+        _history.push_back(turn.key());
+    }
+    if (_history.empty() || _history.back() != _position.key()) {
+        _history.assign(1, _position.key());
+    }
+}
+
+void Chess::updateAI()
+{
+    if (checkForWinner() || checkForDraw()) {
+        return;
+    }
+
+    // book moves are the move bits, checked against the legal moves in case two positions share a key
+    int symmetry;
+    int bits = openingBookMove(canonicalKey(_position, symmetry));
+    if (bits >= 0) {
+        ChessMoveList list;
+        _position.generateMoves(list);
+        for (const ChessMove &legal : list) {
+            if (legal.bits == bits) {
+                _lastStats.setBookMove(bits);
+                _lastStats.logMove("chess", (int)getCurrentTurnNo());
+                playMove(legal);
+                endTurn();
+                return;
+            }
+        }
+    }
+
+    ChessMove move = _engine.findBestMove(_position, _gameOptions.AIMAXDepth, searchTimeBudget(AI_TIME_BUDGET), _history);
+    _lastStats = _engine.stats();
+    _lastStats.logMove("chess", (int)getCurrentTurnNo());
+
+    if (!move.isNull()) {
+        playMove(move);
+        endTurn();
+    }
+}
+
+// recorded moves are the move bits
+bool Chess::playRecordedMove(int move)
+{
+    ChessMoveList list;
+    _position.generateMoves(list);
+    for (const ChessMove &legal : list) {
+        if (legal.bits == move) {
+            playMove(legal);
+            endTurn();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "Game.h"
+#include "Square.h"
+#include "ChessPosition.h"
+#include "ChessEngine.h"
+
+//
+// chess, the pieces are dragged from square to square
+//
+// the sprites only show the position, every rule comes from the bitboard
+// position in _position. after each move the squares are brought back in step
+// with it, which takes care of captures, castling, en passant and promotion
+// (always to a queen) without any special cases here. the AI plays black.
+//
+class Chess : public Game
+{
+public:
+    Chess();
+    ~Chess();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    // the state string is the fen of the position
+    std::string stateString() const override;
+    void        setStateString(const std::string &s) override;
+    // the repetition history is rebuilt from the saved turns as well
+    void        restoreGame(const std::string &state, unsigned int turnNo, const std::vector<std::string> &history) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        playRecordedMove(int move) override;
+    bool        gameHasAI() override { return true; }
+    const SearchStats *searchStats() const override { return &_lastStats; }
+
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+
+    const ChessPosition &position() const { return _position; }
+
+private:
+    Bit *       PieceForPlayer(const int piece);
+    // square 0 is a1 at the bottom left, the grid is stored top row first
+    Square      &squareAt(int square) { return _grid[7 - chessRank(square)][chessFile(square)]; }
+    int         squareOf(BitHolder *holder) const;
+    void        syncPieces();
+    void        playMove(ChessMove move);
+    bool        isRepetition() const;
+
+    Square          _grid[8][8];
+    ChessPosition   _position;
+    // keys of every position since the last capture or pawn move, for threefold repetition
+    std::vector<uint64_t> _history;
+
+    ChessEngine     _engine;
+    // what the last AI move cost
+    SearchStats     _lastStats;
+};
@@ -0,0 +1,196 @@
+#include "ChessBitboards.h"
+
+#include <vector>
+
+ChessTables chessTables;
+
+// every rook table put together is 102400 entries, every bishop table 5248
+static uint64_t rookTable[0x19000];
+static uint64_t bishopTable[0x1480];
+
+//
+// xorshift64*, seeded the same way every run so the same magics come out
+//
+class MagicRandom
+{
+public:
+    MagicRandom(uint64_t seed) : _state(seed) {}
+
+    uint64_t next()
+    {
+        _state ^= _state >> 12;
+        _state ^= _state << 25;
+        _state ^= _state >> 27;
+        return _state * 2685821657736338717ull;
+    }
+    // magics with few bits set are found much faster
+    uint64_t sparse() { return next() & next() & next(); }
+
+private:
+    uint64_t _state;
+};
+
+static bool onBoard(int file, int rank)
+{
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+//
+// the slow way to work out slider attacks, only used to fill in the tables
+//
+static uint64_t slidingAttacks(int square, uint64_t occupied, const int directions[4][2])
+{
+    uint64_t attacks = 0;
+    for (int d = 0; d < 4; d++) {
+        int file = chessFile(square) + directions[d][0];
+        int rank = chessRank(square) + directions[d][1];
+        while (onBoard(file, rank)) {
+            uint64_t bit = squareBit(rank * 8 + file);
+            attacks |= bit;
+            if (occupied & bit) {
+                break;
+            }
+            file += directions[d][0];
+            rank += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+static const int rookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+static const int bishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+//
+// find a magic for every square and fill in its slice of table
+//
+static void initMagics(ChessMagic magics[64], uint64_t *table, const int directions[4][2])
+{
+    // seeds per rank known to find every magic after a few tries, a fixed seed takes a lot longer
+    const uint64_t rankSeeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+    std::vector<uint64_t> occupancy(4096), reference(4096);
+    std::vector<int> epoch(4096, 0);
+    int attempt = 0;
+    uint64_t *attacks = table;
+
+    for (int square = 0; square < 64; square++) {
+        ChessMagic &m = magics[square];
+        uint64_t edges = ((kRank1 | kRank8) & ~(kRank1 << (8 * chessRank(square)))) |
+                         ((kFileA | kFileH) & ~(kFileA << chessFile(square)));
+        m.mask = slidingAttacks(square, 0, directions) & ~edges;
+        m.shift = 64 - std::popcount(m.mask);
+        m.attacks = attacks;
+
+        // every subset of the mask, carry-rippler style
+        int size = 0;
+        uint64_t b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = slidingAttacks(square, b, directions);
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+        // try magics until one maps every subset to a slot holding the right attacks
+        MagicRandom random(rankSeeds[chessRank(square)]);
+        bool found = false;
+        while (!found) {
+            m.magic = random.sparse();
+            if (std::popcount((m.mask * m.magic) >> 56) < 6) {
+                continue;
+            }
+            attempt++;
+            found = true;
+            for (int i = 0; i < size; i++) {
+                unsigned index = m.index(occupancy[i]);
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    m.attacks[index] = reference[i];
+                } else if (m.attacks[index] != reference[i]) {
+                    found = false;
+                    break;
+                }
+            }
+        }
+        attacks += size;
+    }
+}
+
+static void initStepAttacks()
+{
+    const int knightSteps[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+    const int kingSteps[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+
+    for (int square = 0; square < 64; square++) {
+        int file = chessFile(square);
+        int rank = chessRank(square);
+        for (int i = 0; i < 8; i++) {
+            if (onBoard(file + knightSteps[i][0], rank + knightSteps[i][1])) {
+                chessTables.knightAttacks[square] |= squareBit(square + knightSteps[i][1] * 8 + knightSteps[i][0]);
+            }
+            if (onBoard(file + kingSteps[i][0], rank + kingSteps[i][1])) {
+                chessTables.kingAttacks[square] |= squareBit(square + kingSteps[i][1] * 8 + kingSteps[i][0]);
+            }
+        }
+        for (int side = -1; side <= 1; side += 2) {
+            if (onBoard(file + side, rank + 1)) {
+                chessTables.pawnAttacks[kWhite][square] |= squareBit(square + 8 + side);
+            }
+            if (onBoard(file + side, rank - 1)) {
+                chessTables.pawnAttacks[kBlack][square] |= squareBit(square - 8 + side);
+            }
+        }
+    }
+}
+
+static void initLines()
+{
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            if (a == b) {
+                continue;
+            }
+            if (bishopAttacks(a, 0) & squareBit(b)) {
+                chessTables.line[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | squareBit(a) | squareBit(b);
+                chessTables.between[a][b] = bishopAttacks(a, squareBit(b)) & bishopAttacks(b, squareBit(a));
+            } else if (rookAttacks(a, 0) & squareBit(b)) {
+                chessTables.line[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | squareBit(a) | squareBit(b);
+                chessTables.between[a][b] = rookAttacks(a, squareBit(b)) & rookAttacks(b, squareBit(a));
+            }
+        }
+    }
+}
+
+static void initZobrist(MagicRandom &random)
+{
+    for (auto &piece : chessTables.pieceKeys) {
+        for (auto &key : piece) {
+            key = random.next();
+        }
+    }
+    for (auto &key : chessTables.castlingKeys) {
+        key = random.next();
+    }
+    for (auto &key : chessTables.enPassantKeys) {
+        key = random.next();
+    }
+    chessTables.sideKey = random.next();
+}
+
+//
+// runs during static initialization, nothing touches the tables before main()
+//
+struct ChessTablesInit
+{
+    ChessTablesInit()
+    {
+        initMagics(chessTables.rookMagics, rookTable, rookDirections);
+        initMagics(chessTables.bishopMagics, bishopTable, bishopDirections);
+        initStepAttacks();
+        initLines();
+        MagicRandom random(0x9E3779B97F4A7C15ull);
+        initZobrist(random);
+    }
+};
+
+static ChessTablesInit chessTablesInit;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+//
+// attack tables for chess on 64-bit boards
+//
+// square 0 is a1, 7 is h1 and 63 is h8, so a bit shifted left by 8 moves up a rank.
+// knights, kings and pawns look their attacks up directly. rooks and bishops use
+// magic bitboards: the blockers on the piece's lines are multiplied by a magic
+// number, and the top bits of the product index a table holding the attacks for
+// exactly that set of blockers. the magics are found once at startup.
+//
+
+enum ChessColor { kWhite, kBlack };
+enum ChessPieceType { kPawn, kKnight, kBishop, kRook, kQueen, kKing, kNoPieceType };
+
+// a piece is color * 6 + type, kNoPiece for an empty square
+const int kNoPiece = 12;
+
+inline int chessPiece(int color, int type) { return color * 6 + type; }
+inline int chessPieceColor(int piece) { return piece / 6; }
+inline int chessPieceType(int piece) { return piece % 6; }
+
+inline int chessFile(int square) { return square & 7; }
+inline int chessRank(int square) { return square >> 3; }
+inline uint64_t squareBit(int square) { return 1ull << square; }
+
+// lowest set square, and the same while clearing it
+inline int lowestSquare(uint64_t b) { return std::countr_zero(b); }
+inline int popLowestSquare(uint64_t &b)
+{
+    int square = std::countr_zero(b);
+    b &= b - 1;
+    return square;
+}
+
+const uint64_t kFileA = 0x0101010101010101ull;
+const uint64_t kFileH = kFileA << 7;
+const uint64_t kRank1 = 0xFFull;
+const uint64_t kRank2 = kRank1 << 8;
+const uint64_t kRank7 = kRank1 << 48;
+const uint64_t kRank8 = kRank1 << 56;
+
+struct ChessMagic
+{
+    uint64_t    mask;       // blockers that matter, the board edge never does
+    uint64_t    magic;
+    uint64_t    *attacks;
+    int         shift;
+
+    unsigned    index(uint64_t occupied) const { return (unsigned)(((occupied & mask) * magic) >> shift); }
+};
+
+struct ChessTables
+{
+    ChessMagic  rookMagics[64];
+    ChessMagic  bishopMagics[64];
+    uint64_t    knightAttacks[64];
+    uint64_t    kingAttacks[64];
+    uint64_t    pawnAttacks[2][64];
+    // squares strictly between two squares on a line, 0 if they don't share one
+    uint64_t    between[64][64];
+    // the whole line through two squares (edge to edge), 0 if they don't share one
+    uint64_t    line[64][64];
+
+    // zobrist keys
+    uint64_t    pieceKeys[12][64];
+    uint64_t    castlingKeys[16];
+    uint64_t    enPassantKeys[8];
+    uint64_t    sideKey;
+};
+
+// filled in before main() runs
+extern ChessTables chessTables;
+
+inline uint64_t rookAttacks(int square, uint64_t occupied)
+{
+    const ChessMagic &m = chessTables.rookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline uint64_t bishopAttacks(int square, uint64_t occupied)
+{
+    const ChessMagic &m = chessTables.bishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline uint64_t queenAttacks(int square, uint64_t occupied) { return rookAttacks(square, occupied) | bishopAttacks(square, occupied); }
+inline uint64_t knightAttacks(int square) { return chessTables.knightAttacks[square]; }
+inline uint64_t kingAttacks(int square) { return chessTables.kingAttacks[square]; }
+// squares a pawn of color on square attacks
+inline uint64_t pawnAttacks(int color, int square) { return chessTables.pawnAttacks[color][square]; }
@@ -0,0 +1,624 @@
+#include "ChessEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// scores past this are mates, and carry their distance from the root
+const int MATE_BOUND = ChessEngine::kMateScore - ChessEngine::kMaxPly * 2;
+const int SCORE_INFINITY = ChessEngine::kMateScore + 1;
+
+// how many nodes go by between looks at the clock
+const uint64_t CLOCK_CHECK_INTERVAL = 2048;
+
+static const int pieceValues[6] = { 100, 320, 330, 500, 900, 0 };
+
+// how much each piece counts towards the middle game, 24 with everything still on the board
+static const int phaseWeights[6] = { 0, 1, 1, 2, 4, 0 };
+const int MAX_PHASE = 24;
+
+//
+// piece-square tables from white's side, laid out the way the board looks (a8 top left)
+//
+static const int pawnTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+static const int knightTable[64] = {
+   -50,-40,-30,-30,-30,-30,-40,-50,
+   -40,-20,  0,  0,  0,  0,-20,-40,
+   -30,  0, 10, 15, 15, 10,  0,-30,
+   -30,  5, 15, 20, 20, 15,  5,-30,
+   -30,  0, 15, 20, 20, 15,  0,-30,
+   -30,  5, 10, 15, 15, 10,  5,-30,
+   -40,-20,  0,  5,  5,  0,-20,-40,
+   -50,-40,-30,-30,-30,-30,-40,-50,
+};
+
+static const int bishopTable[64] = {
+   -20,-10,-10,-10,-10,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5, 10, 10,  5,  0,-10,
+   -10,  5,  5, 10, 10,  5,  5,-10,
+   -10,  0, 10, 10, 10, 10,  0,-10,
+   -10, 10, 10, 10, 10, 10, 10,-10,
+   -10,  5,  0,  0,  0,  0,  5,-10,
+   -20,-10,-10,-10,-10,-10,-10,-20,
+};
+
+static const int rookTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0,
+};
+
+static const int queenTable[64] = {
+   -20,-10,-10, -5, -5,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5,  5,  5,  5,  0,-10,
+    -5,  0,  5,  5,  5,  5,  0, -5,
+     0,  0,  5,  5,  5,  5,  0, -5,
+   -10,  5,  5,  5,  5,  5,  0,-10,
+   -10,  0,  5,  0,  0,  0,  0,-10,
+   -20,-10,-10, -5, -5,-10,-10,-20,
+};
+
+// the king hides in the middle game and walks to the center in the end game
+static const int kingMiddleTable[64] = {
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -20,-30,-30,-40,-40,-30,-30,-20,
+   -10,-20,-20,-20,-20,-20,-20,-10,
+    20, 20,  0,  0,  0,  0, 20, 20,
+    20, 30, 10,  0,  0, 10, 30, 20,
+};
+
+static const int kingEndTable[64] = {
+   -50,-40,-30,-20,-20,-30,-40,-50,
+   -30,-20,-10,  0,  0,-10,-20,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-30,  0,  0,  0,  0,-30,-30,
+   -50,-30,-30,-30,-30,-30,-30,-50,
+};
+
+static const int *pieceTables[5] = { pawnTable, knightTable, bishopTable, rookTable, queenTable };
+
+// late move reductions by depth and move number
+static int reductions[ChessEngine::kMaxPly][64];
+
+struct ReductionsInit
+{
+    ReductionsInit()
+    {
+        for (int depth = 1; depth < ChessEngine::kMaxPly; depth++) {
+            for (int moves = 1; moves < 64; moves++) {
+                reductions[depth][moves] = (int)(0.75 + std::log((double)depth) * std::log((double)moves) / 2.25);
+            }
+        }
+    }
+};
+
+static ReductionsInit reductionsInit;
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//
+// mates are stored relative to the node so they can be reused at any ply
+//
+static int scoreToTable(int score, int ply)
+{
+    if (score > MATE_BOUND) return score + ply;
+    if (score < -MATE_BOUND) return score - ply;
+    return score;
+}
+
+static int scoreFromTable(int score, int ply)
+{
+    if (score > MATE_BOUND) return score - ply;
+    if (score < -MATE_BOUND) return score + ply;
+    return score;
+}
+
+// -----------------------------------------------------------------------------
+// ChessTable
+// -----------------------------------------------------------------------------
+
+ChessTable::ChessTable(int megabytes)
+{
+    // largest power of two number of slots that fits
+    uint64_t slots = 1;
+    while (slots * 2 * sizeof(Slot) <= (uint64_t)megabytes * 1024 * 1024) {
+        slots *= 2;
+    }
+    _slots.reset(new Slot[slots]);
+    _mask = slots - 1;
+    clear();
+}
+
+void ChessTable::clear()
+{
+    for (uint64_t i = 0; i <= _mask; i++) {
+        _slots[i].check.store(0, std::memory_order_relaxed);
+        _slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+//
+// data layout: move in bits 0-15, score 16-31, depth 32-39, bound 40-41
+//
+bool ChessTable::probe(uint64_t key, Entry &entry) const
+{
+    const Slot &slot = _slots[key & _mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.check.load(std::memory_order_relaxed) ^ data) != key) {
+        return false;
+    }
+    entry.move.bits = (uint16_t)data;
+    entry.score = (int16_t)(data >> 16);
+    entry.depth = (int8_t)(data >> 32);
+    entry.bound = (int)((data >> 40) & 3);
+    return true;
+}
+
+void ChessTable::store(uint64_t key, ChessMove move, int score, int depth, int bound)
+{
+    Slot &slot = _slots[key & _mask];
+    uint64_t old = slot.data.load(std::memory_order_relaxed);
+    // a search that found no move shouldn't wipe out the one we knew
+    if (move.isNull() && (slot.check.load(std::memory_order_relaxed) ^ old) == key) {
+        move.bits = (uint16_t)old;
+    }
+    uint64_t data = (uint64_t)move.bits |
+                    ((uint64_t)(uint16_t)(int16_t)score << 16) |
+                    ((uint64_t)(uint8_t)(int8_t)depth << 32) |
+                    ((uint64_t)bound << 40);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// ChessEngine
+// -----------------------------------------------------------------------------
+
+ChessEngine::ChessEngine(ChessTable *sharedTable) : _stopRequested(false)
+{
+    if (sharedTable) {
+        _table = sharedTable;
+    } else {
+        _ownTable.reset(new ChessTable());
+        _table = _ownTable.get();
+    }
+    _stopped = false;
+    _startSeconds = 0.0;
+    _timeLimit = 0.0;
+    newGame();
+}
+
+void ChessEngine::newGame()
+{
+    _table->clear();
+    memset(_history, 0, sizeof(_history));
+    for (auto &killers : _killers) {
+        killers[0] = killers[1] = ChessMove();
+    }
+}
+
+int ChessEngine::evaluate(const ChessPosition &position)
+{
+    int middle = 0;
+    int end = 0;
+    int phase = 0;
+
+    for (int color = kWhite; color <= kBlack; color++) {
+        int sign = color == kWhite ? 1 : -1;
+        for (int type = kPawn; type <= kQueen; type++) {
+            uint64_t pieces = position.pieces(color, type);
+            while (pieces) {
+                int square = popLowestSquare(pieces);
+                // the tables are drawn from white's side with a8 first
+                int index = color == kWhite ? (7 - chessRank(square)) * 8 + chessFile(square) : square;
+                int value = pieceValues[type] + pieceTables[type][index];
+                middle += sign * value;
+                end += sign * value;
+                phase += phaseWeights[type];
+            }
+        }
+        int king = position.kingSquare(color);
+        int index = color == kWhite ? (7 - chessRank(king)) * 8 + chessFile(king) : king;
+        middle += sign * kingMiddleTable[index];
+        end += sign * kingEndTable[index];
+    }
+
+    // blend the two by how much material is left
+    if (phase > MAX_PHASE) {
+        phase = MAX_PHASE;
+    }
+    int score = (middle * phase + end * (MAX_PHASE - phase)) / MAX_PHASE;
+    return position.sideToMove() == kWhite ? score : -score;
+}
+
+bool ChessEngine::timeUp()
+{
+    if (_stopRequested.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return _timeLimit > 0.0 && nowSeconds() - _startSeconds > _timeLimit;
+}
+
+//
+// a position seen before since the last capture or pawn move counts as a draw,
+// one repeat is enough inside the search, the side that repeats could have done it again
+//
+bool ChessEngine::isRepetition(const ChessPosition &position) const
+{
+    int back = std::min((int)_keys.size(), position.halfmoveClock());
+    for (int i = 2; i <= back; i += 2) {
+        if (_keys[_keys.size() - i] == position.key()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ChessEngine::scoreMoves(const ChessPosition &position, ChessMoveList &list, int *scores, ChessMove tableMove, int ply) const
+{
+    for (int i = 0; i < list.count; i++) {
+        ChessMove move = list.moves[i];
+        if (move == tableMove) {
+            scores[i] = 1 << 30;
+        } else if (move.isCapture() || move.isPromotion()) {
+            // most valuable victim first, cheapest attacker to break ties
+            int victim = move.flags() == ChessMove::kEnPassant ? kPawn : chessPieceType(position.pieceAt(move.to()));
+            int attacker = chessPieceType(position.pieceAt(move.from()));
+            int value = move.isCapture() ? pieceValues[victim] * 16 - attacker : 0;
+            if (move.isPromotion()) {
+                value += pieceValues[move.promotion()] * 16;
+            }
+            scores[i] = (1 << 24) + value;
+        } else if (move == _killers[ply][0]) {
+            scores[i] = (1 << 23) + 1;
+        } else if (move == _killers[ply][1]) {
+            scores[i] = 1 << 23;
+        } else {
+            scores[i] = _history[position.sideToMove()][move.from()][move.to()];
+        }
+    }
+}
+
+// bring the best scored move left in the list to index
+static ChessMove pickMove(ChessMoveList &list, int *scores, int index)
+{
+    int best = index;
+    for (int i = index + 1; i < list.count; i++) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(list.moves[index], list.moves[best]);
+    std::swap(scores[index], scores[best]);
+    return list.moves[index];
+}
+
+int ChessEngine::quiesce(const ChessPosition &position, int alpha, int beta, int ply)
+{
+    if ((++_stats.nodes % CLOCK_CHECK_INTERVAL) == 0 && timeUp()) {
+        _stopped = true;
+    }
+    if (_stopped) {
+        return 0;
+    }
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+    if (ply >= kMaxPly - 1) {
+        return evaluate(position);
+    }
+
+    // in check every evasion is tried, otherwise standing still is an option
+    bool inCheck = position.inCheck();
+    int best = -SCORE_INFINITY;
+    if (!inCheck) {
+        best = evaluate(position);
+        if (best >= beta) {
+            return best;
+        }
+        if (best > alpha) {
+            alpha = best;
+        }
+    }
+
+    ChessMoveList list;
+    position.generateMoves(list, !inCheck);
+    if (list.count == 0) {
+        return inCheck ? -kMateScore + ply : best;
+    }
+
+    int scores[256];
+    scoreMoves(position, list, scores, ChessMove(), ply);
+    _stats.expanded++;
+    for (int i = 0; i < list.count; i++) {
+        ChessMove move = pickMove(list, scores, i);
+        ChessPosition next = position;
+        next.makeMove(move);
+        int score = -quiesce(next, -beta, -alpha, ply + 1);
+        if (_stopped) {
+            return 0;
+        }
+        if (score > best) {
+            best = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    _stats.cutoffs++;
+                    if (i == 0) {
+                        _stats.firstMoveCutoffs++;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+int ChessEngine::search(const ChessPosition &position, int alpha, int beta, int depth, int ply, bool allowNull)
+{
+    bool pvNode = beta - alpha > 1;
+
+    if (ply > 0) {
+        if (position.fiftyMoveRule() || isRepetition(position)) {
+            return 0;
+        }
+        // no point looking for a mate longer than one already found
+        alpha = std::max(alpha, -kMateScore + ply);
+        beta = std::min(beta, kMateScore - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+
+    bool inCheck = position.inCheck();
+    // checks are searched a ply deeper so the reply is never cut off
+    if (inCheck) {
+        depth++;
+    }
+    if (depth <= 0 || ply >= kMaxPly - 1) {
+        return quiesce(position, alpha, beta, ply);
+    }
+
+    if ((++_stats.nodes % CLOCK_CHECK_INTERVAL) == 0 && timeUp()) {
+        _stopped = true;
+    }
+    if (_stopped) {
+        return 0;
+    }
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+
+    ChessTable::Entry entry;
+    ChessMove tableMove;
+    _stats.tableProbes++;
+    if (_table->probe(position.key(), entry)) {
+        _stats.tableHits++;
+        tableMove = entry.move;
+        int score = scoreFromTable(entry.score, ply);
+        if (!pvNode && entry.depth >= depth &&
+            (entry.bound == ChessTable::kBoundExact ||
+             (entry.bound == ChessTable::kBoundLower && score >= beta) ||
+             (entry.bound == ChessTable::kBoundUpper && score <= alpha))) {
+            return score;
+        }
+    }
+
+    _keys.push_back(position.key());
+
+    // if passing still holds beta the position is good enough, skipped when a pass could be the
+    // best move (zugzwang), which is only likely with nothing but pawns left
+    int us = position.sideToMove();
+    bool hasPieces = (position.colorPieces(us) & ~position.pieces(us, kPawn) & ~position.pieces(us, kKing)) != 0;
+    if (!pvNode && !inCheck && allowNull && depth >= 3 && hasPieces && evaluate(position) >= beta) {
+        int reduction = 2 + depth / 4;
+        ChessPosition next = position;
+        next.makeNullMove();
+        int score = -search(next, -beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+        if (_stopped) {
+            _keys.pop_back();
+            return 0;
+        }
+        if (score >= beta) {
+            _keys.pop_back();
+            // a mate found after passing proves nothing
+            return score > MATE_BOUND ? beta : score;
+        }
+    }
+
+    ChessMoveList list;
+    position.generateMoves(list);
+    if (list.count == 0) {
+        _keys.pop_back();
+        return inCheck ? -kMateScore + ply : 0;
+    }
+
+    int scores[256];
+    scoreMoves(position, list, scores, tableMove, ply);
+    _stats.expanded++;
+
+    int originalAlpha = alpha;
+    int best = -SCORE_INFINITY;
+    ChessMove bestMove;
+
+    for (int i = 0; i < list.count; i++) {
+        ChessMove move = pickMove(list, scores, i);
+        bool quiet = !move.isCapture() && !move.isPromotion();
+        ChessPosition next = position;
+        next.makeMove(move);
+
+        int score;
+        if (i == 0) {
+            score = -search(next, -beta, -alpha, depth - 1, ply + 1, true);
+        } else {
+            // late quiet moves are unlikely to be best, look at them less deeply first
+            int reduction = 0;
+            if (depth >= 3 && quiet && !inCheck && !next.inCheck() &&
+                move != _killers[ply][0] && move != _killers[ply][1]) {
+                reduction = reductions[std::min(depth, kMaxPly - 1)][std::min(i, 63)];
+                if (pvNode && reduction > 0) {
+                    reduction--;
+                }
+                reduction = std::min(reduction, depth - 2);
+            }
+            score = -search(next, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1, true);
+            if (score > alpha && reduction > 0) {
+                score = -search(next, -alpha - 1, -alpha, depth - 1, ply + 1, true);
+            }
+            if (score > alpha && score < beta) {
+                score = -search(next, -beta, -alpha, depth - 1, ply + 1, true);
+            }
+        }
+        if (_stopped) {
+            _keys.pop_back();
+            return 0;
+        }
+
+        if (score > best) {
+            best = score;
+            bestMove = move;
+            if (ply == 0) {
+                _rootMove = move;
+            }
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    _stats.cutoffs++;
+                    if (i == 0) {
+                        _stats.firstMoveCutoffs++;
+                    }
+                    if (quiet) {
+                        if (move != _killers[ply][0]) {
+                            _killers[ply][1] = _killers[ply][0];
+                            _killers[ply][0] = move;
+                        }
+                        _history[us][move.from()][move.to()] += depth * depth;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    _keys.pop_back();
+
+    int bound = best >= beta ? ChessTable::kBoundLower : (best > originalAlpha ? ChessTable::kBoundExact : ChessTable::kBoundUpper);
+    _table->store(position.key(), bestMove, scoreToTable(best, ply), depth, bound);
+    return best;
+}
+
+//
+// follow the table from the root for the principal variation
+//
+void ChessEngine::principalVariation(const ChessPosition &position, int depth)
+{
+    _stats.principalVariation.clear();
+    ChessPosition line = position;
+    std::string text;
+    for (int i = 0; i < depth; i++) {
+        ChessTable::Entry entry;
+        if (!_table->probe(line.key(), entry) || entry.move.isNull()) {
+            break;
+        }
+        // the slot could have been written by another position since, check the move is legal
+        ChessMove move = line.findMove(entry.move.from(), entry.move.to(), entry.move.isPromotion() ? entry.move.promotion() : kQueen);
+        if (move != entry.move) {
+            break;
+        }
+        _stats.principalVariation.push_back(move.bits);
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += move.uci();
+        line.makeMove(move);
+    }
+    _stats.principalVariationText = text;
+}
+
+ChessMove ChessEngine::findBestMove(const ChessPosition &position, int maxDepth, double seconds, const std::vector<uint64_t> &history)
+{
+    _startSeconds = nowSeconds();
+    _timeLimit = seconds;
+    _stopRequested.store(false, std::memory_order_relaxed);
+    _stopped = false;
+    _stats.reset();
+    _depthSeconds.clear();
+    _keys = history;
+    // the root pushes its own key, don't count it twice if the caller included it
+    if (!_keys.empty() && _keys.back() == position.key()) {
+        _keys.pop_back();
+    }
+
+    // old history still helps ordering, but the newest search should count most
+    for (auto &side : _history) {
+        for (auto &from : side) {
+            for (int &score : from) {
+                score /= 8;
+            }
+        }
+    }
+
+    ChessMoveList list;
+    position.generateMoves(list);
+    if (list.count == 0) {
+        return ChessMove();
+    }
+
+    if (maxDepth <= 0 || maxDepth >= kMaxPly) {
+        maxDepth = kMaxPly - 1;
+    }
+    ChessMove bestMove = list.moves[0];
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        _rootMove = ChessMove();
+        int score = search(position, -SCORE_INFINITY, SCORE_INFINITY, depth, 0, false);
+        if (_stopped) {
+            break;
+        }
+
+        bestMove = _rootMove;
+        _stats.depthLimit = depth;
+        _stats.score = score;
+        _depthSeconds.push_back(nowSeconds() - _startSeconds);
+
+        // a forced mate won't get any shorter by looking deeper
+        if (score > MATE_BOUND || score < -MATE_BOUND) {
+            break;
+        }
+        // the next depth takes several times as long, don't start what can't finish
+        if (_timeLimit > 0.0 && nowSeconds() - _startSeconds > _timeLimit * 0.5) {
+            break;
+        }
+    }
+
+    _stats.seconds = nowSeconds() - _startSeconds;
+    _stats.bestMove = bestMove.bits;
+    principalVariation(position, _stats.depthLimit);
+    return bestMove;
+}
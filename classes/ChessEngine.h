@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ChessPosition.h"
+#include "SearchStats.h"
+
+//
+// transposition table for the chess search
+//
+// entries are written without locks: each slot keeps its data and the key xor the
+// data, so a slot torn by two threads writing at once no longer matches any key
+// and is simply missed. that makes it safe to hand one table to several engines.
+//
+class ChessTable
+{
+public:
+    enum Bound { kBoundExact, kBoundLower, kBoundUpper };
+
+    struct Entry
+    {
+        ChessMove   move;
+        int         score;
+        int         depth;
+        int         bound;
+    };
+
+    ChessTable(int megabytes = 16);
+
+    void        clear();
+    bool        probe(uint64_t key, Entry &entry) const;
+    void        store(uint64_t key, ChessMove move, int score, int depth, int bound);
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t>   check;
+        std::atomic<uint64_t>   data;
+    };
+
+    std::unique_ptr<Slot[]>     _slots;
+    uint64_t                    _mask;
+};
+
+//
+// alpha-beta search for chess
+//
+// iterative deepening with principal variation search: the first move at each
+// node gets a full window, the rest a null window and only a fail high is searched
+// again. leaves go into a captures only quiescence search. moves are ordered table
+// move first, then captures by most valuable victim / least valuable attacker,
+// then the two killer moves for the ply, then quiet moves by history score. null
+// move pruning and late move reductions cut down the rest of the tree.
+//
+class ChessEngine
+{
+public:
+    // engines can share one table, otherwise each gets its own
+    ChessEngine(ChessTable *sharedTable = nullptr);
+
+    // best move for the side to move, searched to maxDepth or until seconds run out (0 for no limit)
+    // history holds the keys of earlier positions in the game so repetitions are seen as draws
+    ChessMove   findBestMove(const ChessPosition &position, int maxDepth, double seconds, const std::vector<uint64_t> &history = {});
+
+    // ask a running search to give up, it returns the best move of the last finished depth
+    void        stop() { _stopRequested.store(true, std::memory_order_relaxed); }
+
+    // forget everything learned from an earlier game
+    void        newGame();
+
+    const SearchStats   &stats() const { return _stats; }
+    // seconds from the start of the last search until each depth was finished, index 0 is depth 1
+    const std::vector<double>   &depthSeconds() const { return _depthSeconds; }
+
+    // static score in centipawns for the side to move
+    static int  evaluate(const ChessPosition &position);
+
+    static const int kMateScore = 32000;
+    static const int kMaxPly = 64;
+
+private:
+    int         search(const ChessPosition &position, int alpha, int beta, int depth, int ply, bool allowNull);
+    int         quiesce(const ChessPosition &position, int alpha, int beta, int ply);
+    void        scoreMoves(const ChessPosition &position, ChessMoveList &list, int *scores, ChessMove tableMove, int ply) const;
+    bool        isRepetition(const ChessPosition &position) const;
+    bool        timeUp();
+    void        principalVariation(const ChessPosition &position, int depth);
+
+    std::unique_ptr<ChessTable> _ownTable;
+    ChessTable  *_table;
+
+    // best move of the root search so far, the table slot could be overwritten by a sharing engine
+    ChessMove   _rootMove;
+    ChessMove   _killers[kMaxPly][2];
+    int         _history[2][64][64];
+    // keys of the game so far and the current search path
+    std::vector<uint64_t>   _keys;
+
+    std::atomic<bool>       _stopRequested;
+    bool                    _stopped;
+    double                  _startSeconds;
+    double                  _timeLimit;
+
+    SearchStats             _stats;
+    std::vector<double>     _depthSeconds;
+};
@@ -0,0 +1,487 @@
+#include "ChessPosition.h"
+
+#include <cstring>
+#include <sstream>
+
+static const char pieceLetters[] = "PNBRQKpnbrqk";
+
+// castling rights that survive a move touching each square
+static const int castlingMask[64] = {
+    13, 15, 15, 15, 12, 15, 15, 14,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+     7, 15, 15, 15,  3, 15, 15, 11,
+};
+
+static std::string squareName(int square)
+{
+    std::string name;
+    name += (char)('a' + chessFile(square));
+    name += (char)('1' + chessRank(square));
+    return name;
+}
+
+static int parseSquare(const std::string &text, size_t at)
+{
+    if (text.size() < at + 2) return -1;
+    int file = text[at] - 'a';
+    int rank = text[at + 1] - '1';
+    if (file < 0 || file > 7 || rank < 0 || rank > 7) return -1;
+    return rank * 8 + file;
+}
+
+std::string ChessMove::uci() const
+{
+    if (isNull()) {
+        return "0000";
+    }
+    std::string text = squareName(from()) + squareName(to());
+    if (isPromotion()) {
+        text += "nbrq"[promotion() - kKnight];
+    }
+    return text;
+}
+
+ChessPosition::ChessPosition()
+{
+    setFen(kChessStartFen);
+}
+
+void ChessPosition::clear()
+{
+    memset(_pieces, 0, sizeof(_pieces));
+    memset(_colors, 0, sizeof(_colors));
+    memset(_board, kNoPiece, sizeof(_board));
+    _occupied = 0;
+    _side = kWhite;
+    _castling = 0;
+    _enPassant = -1;
+    _halfmoveClock = 0;
+    _fullmove = 1;
+    _key = chessTables.castlingKeys[0];
+}
+
+void ChessPosition::addPiece(int square, int piece)
+{
+    uint64_t bit = squareBit(square);
+    _pieces[chessPieceColor(piece)][chessPieceType(piece)] |= bit;
+    _colors[chessPieceColor(piece)] |= bit;
+    _occupied |= bit;
+    _board[square] = (uint8_t)piece;
+    _key ^= chessTables.pieceKeys[piece][square];
+}
+
+void ChessPosition::removePiece(int square)
+{
+    int piece = _board[square];
+    uint64_t bit = squareBit(square);
+    _pieces[chessPieceColor(piece)][chessPieceType(piece)] ^= bit;
+    _colors[chessPieceColor(piece)] ^= bit;
+    _occupied ^= bit;
+    _board[square] = kNoPiece;
+    _key ^= chessTables.pieceKeys[piece][square];
+}
+
+void ChessPosition::movePiece(int from, int to)
+{
+    int piece = _board[from];
+    removePiece(from);
+    addPiece(to, piece);
+}
+
+bool ChessPosition::setFen(const std::string &fen)
+{
+    clear();
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    stream >> placement >> side >> castling >> enPassant;
+
+    int rank = 7;
+    int file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            rank--;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+        } else {
+            const char *letter = strchr(pieceLetters, c);
+            if (!letter || c == 0 || rank < 0 || file > 7) {
+                clear();
+                return false;
+            }
+            addPiece(rank * 8 + file, (int)(letter - pieceLetters));
+            file++;
+        }
+    }
+    if (std::popcount(_pieces[kWhite][kKing]) != 1 || std::popcount(_pieces[kBlack][kKing]) != 1) {
+        clear();
+        return false;
+    }
+
+    _side = side == "b" ? kBlack : kWhite;
+    for (char c : castling) {
+        if (c == 'K') _castling |= kCastleWhiteKing;
+        if (c == 'Q') _castling |= kCastleWhiteQueen;
+        if (c == 'k') _castling |= kCastleBlackKing;
+        if (c == 'q') _castling |= kCastleBlackQueen;
+    }
+    // only keep the en passant square when a pawn can actually take there, the same as makeMove()
+    int square = parseSquare(enPassant, 0);
+    if (square >= 0 && (pawnAttacks(_side ^ 1, square) & _pieces[_side][kPawn])) {
+        _enPassant = square;
+    }
+
+    if (!(stream >> _halfmoveClock)) _halfmoveClock = 0;
+    if (!(stream >> _fullmove)) _fullmove = 1;
+
+    _key ^= chessTables.castlingKeys[0] ^ chessTables.castlingKeys[_castling];
+    if (_enPassant >= 0) _key ^= chessTables.enPassantKeys[chessFile(_enPassant)];
+    if (_side == kBlack) _key ^= chessTables.sideKey;
+    return true;
+}
+
+std::string ChessPosition::fen() const
+{
+    std::string text;
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            int piece = _board[rank * 8 + file];
+            if (piece == kNoPiece) {
+                empty++;
+                continue;
+            }
+            if (empty) {
+                text += (char)('0' + empty);
+                empty = 0;
+            }
+            text += pieceLetters[piece];
+        }
+        if (empty) {
+            text += (char)('0' + empty);
+        }
+        if (rank) {
+            text += '/';
+        }
+    }
+
+    text += _side == kWhite ? " w " : " b ";
+    if (_castling & kCastleWhiteKing) text += 'K';
+    if (_castling & kCastleWhiteQueen) text += 'Q';
+    if (_castling & kCastleBlackKing) text += 'k';
+    if (_castling & kCastleBlackQueen) text += 'q';
+    if (!_castling) text += '-';
+    text += ' ';
+    text += _enPassant >= 0 ? squareName(_enPassant) : "-";
+    text += ' ';
+    text += std::to_string(_halfmoveClock);
+    text += ' ';
+    text += std::to_string(_fullmove);
+    return text;
+}
+
+uint64_t ChessPosition::attackersTo(int square, uint64_t occupied) const
+{
+    return (pawnAttacks(kBlack, square) & _pieces[kWhite][kPawn]) |
+           (pawnAttacks(kWhite, square) & _pieces[kBlack][kPawn]) |
+           (knightAttacks(square) & (_pieces[kWhite][kKnight] | _pieces[kBlack][kKnight])) |
+           (kingAttacks(square) & (_pieces[kWhite][kKing] | _pieces[kBlack][kKing])) |
+           (bishopAttacks(square, occupied) & (_pieces[kWhite][kBishop] | _pieces[kBlack][kBishop] | _pieces[kWhite][kQueen] | _pieces[kBlack][kQueen])) |
+           (rookAttacks(square, occupied) & (_pieces[kWhite][kRook] | _pieces[kBlack][kRook] | _pieces[kWhite][kQueen] | _pieces[kBlack][kQueen]));
+}
+
+bool ChessPosition::isAttacked(int square, int byColor) const
+{
+    return (attackersTo(square, _occupied) & _colors[byColor]) != 0;
+}
+
+//
+// en passant can uncover an attack along the rank both pawns leave, so it is
+// checked by looking at the king with both pawns gone and ours on the new square
+//
+bool ChessPosition::enPassantIsLegal(int from) const
+{
+    int them = _side ^ 1;
+    int captured = _enPassant + (_side == kWhite ? -8 : 8);
+    uint64_t occupied = (_occupied ^ squareBit(from) ^ squareBit(captured)) | squareBit(_enPassant);
+    int king = kingSquare(_side);
+
+    uint64_t attackers = (rookAttacks(king, occupied) & (_pieces[them][kRook] | _pieces[them][kQueen])) |
+                         (bishopAttacks(king, occupied) & (_pieces[them][kBishop] | _pieces[them][kQueen])) |
+                         (knightAttacks(king) & _pieces[them][kKnight]) |
+                         (pawnAttacks(_side, king) & _pieces[them][kPawn] & ~squareBit(captured));
+    return attackers == 0;
+}
+
+void ChessPosition::addPawnMoves(ChessMoveList &list, int from, uint64_t targets, bool capturesOnly) const
+{
+    int forward = _side == kWhite ? 8 : -8;
+    int lastRank = _side == kWhite ? 7 : 0;
+    int startRank = _side == kWhite ? 1 : 6;
+
+    uint64_t captures = pawnAttacks(_side, from) & _colors[_side ^ 1] & targets;
+    while (captures) {
+        int to = popLowestSquare(captures);
+        if (chessRank(to) == lastRank) {
+            for (int piece = kQueen; piece >= kKnight; piece--) {
+                list.add(from, to, ChessMove::kPromotionCapture + piece - kKnight);
+            }
+        } else {
+            list.add(from, to, ChessMove::kCapture);
+        }
+    }
+
+    int to = from + forward;
+    if (_occupied & squareBit(to)) {
+        return;
+    }
+    if (targets & squareBit(to)) {
+        if (chessRank(to) == lastRank) {
+            // promotions count as captures for the quiescence search
+            for (int piece = kQueen; piece >= kKnight; piece--) {
+                list.add(from, to, ChessMove::kPromotion + piece - kKnight);
+            }
+        } else if (!capturesOnly) {
+            list.add(from, to, ChessMove::kQuiet);
+        }
+    }
+    int twoSquares = to + forward;
+    if (!capturesOnly && chessRank(from) == startRank && !(_occupied & squareBit(twoSquares)) && (targets & squareBit(twoSquares))) {
+        list.add(from, twoSquares, ChessMove::kDoublePush);
+    }
+}
+
+void ChessPosition::generateMoves(ChessMoveList &list, bool capturesOnly) const
+{
+    int us = _side;
+    int them = us ^ 1;
+    uint64_t own = _colors[us];
+    uint64_t enemy = _colors[them];
+    int king = kingSquare(us);
+    uint64_t checking = checkers();
+
+    // the king can't hide behind itself from a slider, so look past it
+    uint64_t kingTargets = kingAttacks(king) & ~own & (capturesOnly ? enemy : ~0ull);
+    uint64_t withoutKing = _occupied ^ squareBit(king);
+    while (kingTargets) {
+        int to = popLowestSquare(kingTargets);
+        if (!(attackersTo(to, withoutKing) & enemy)) {
+            list.add(king, to, (enemy & squareBit(to)) ? ChessMove::kCapture : ChessMove::kQuiet);
+        }
+    }
+    // in double check only the king can move
+    if (checking & (checking - 1)) {
+        return;
+    }
+
+    // out of check everything else has to take the checker or step in the way
+    uint64_t targets = ~own;
+    if (checking) {
+        targets &= checking | chessTables.between[king][lowestSquare(checking)];
+    }
+    uint64_t pieceTargets = capturesOnly ? targets & enemy : targets;
+
+    // our pieces standing alone between the king and an enemy slider can only move along that line
+    uint64_t pinned = 0;
+    uint64_t snipers = (rookAttacks(king, 0) & (_pieces[them][kRook] | _pieces[them][kQueen])) |
+                       (bishopAttacks(king, 0) & (_pieces[them][kBishop] | _pieces[them][kQueen]));
+    while (snipers) {
+        uint64_t blockers = chessTables.between[king][popLowestSquare(snipers)] & _occupied;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & own)) {
+            pinned |= blockers;
+        }
+    }
+
+    uint64_t knights = _pieces[us][kKnight] & ~pinned;
+    while (knights) {
+        int from = popLowestSquare(knights);
+        uint64_t moves = knightAttacks(from) & pieceTargets;
+        while (moves) {
+            int to = popLowestSquare(moves);
+            list.add(from, to, (enemy & squareBit(to)) ? ChessMove::kCapture : ChessMove::kQuiet);
+        }
+    }
+
+    for (int slider = kBishop; slider <= kRook; slider++) {
+        uint64_t pieces = _pieces[us][slider] | _pieces[us][kQueen];
+        while (pieces) {
+            int from = popLowestSquare(pieces);
+            uint64_t moves = (slider == kBishop ? bishopAttacks(from, _occupied) : rookAttacks(from, _occupied)) & pieceTargets;
+            if (pinned & squareBit(from)) {
+                moves &= chessTables.line[king][from];
+            }
+            while (moves) {
+                int to = popLowestSquare(moves);
+                list.add(from, to, (enemy & squareBit(to)) ? ChessMove::kCapture : ChessMove::kQuiet);
+            }
+        }
+    }
+
+    uint64_t pawns = _pieces[us][kPawn];
+    while (pawns) {
+        int from = popLowestSquare(pawns);
+        uint64_t allowed = (pinned & squareBit(from)) ? chessTables.line[king][from] : ~0ull;
+        addPawnMoves(list, from, targets & allowed, capturesOnly);
+    }
+
+    if (_enPassant >= 0) {
+        uint64_t takers = pawnAttacks(them, _enPassant) & _pieces[us][kPawn];
+        while (takers) {
+            int from = popLowestSquare(takers);
+            if (enPassantIsLegal(from)) {
+                list.add(from, _enPassant, ChessMove::kEnPassant);
+            }
+        }
+    }
+
+    if (capturesOnly || checking) {
+        return;
+    }
+    int base = us == kWhite ? 0 : 56;
+    int rook = chessPiece(us, kRook);
+    int kingSide = us == kWhite ? kCastleWhiteKing : kCastleBlackKing;
+    int queenSide = us == kWhite ? kCastleWhiteQueen : kCastleBlackQueen;
+    if ((_castling & kingSide) && _board[base + 7] == rook &&
+        !(_occupied & (squareBit(base + 5) | squareBit(base + 6))) &&
+        !isAttacked(base + 5, them) && !isAttacked(base + 6, them)) {
+        list.add(base + 4, base + 6, ChessMove::kKingCastle);
+    }
+    if ((_castling & queenSide) && _board[base] == rook &&
+        !(_occupied & (squareBit(base + 1) | squareBit(base + 2) | squareBit(base + 3))) &&
+        !isAttacked(base + 3, them) && !isAttacked(base + 2, them)) {
+        list.add(base + 4, base + 2, ChessMove::kQueenCastle);
+    }
+}
+
+void ChessPosition::makeMove(ChessMove move)
+{
+    int from = move.from();
+    int to = move.to();
+    int us = _side;
+
+    _key ^= chessTables.castlingKeys[_castling];
+    if (_enPassant >= 0) {
+        _key ^= chessTables.enPassantKeys[chessFile(_enPassant)];
+        _enPassant = -1;
+    }
+
+    _halfmoveClock++;
+    if (chessPieceType(_board[from]) == kPawn || move.isCapture()) {
+        _halfmoveClock = 0;
+    }
+
+    if (move.flags() == ChessMove::kEnPassant) {
+        removePiece(to + (us == kWhite ? -8 : 8));
+    } else if (move.isCapture()) {
+        removePiece(to);
+    }
+    movePiece(from, to);
+
+    if (move.isPromotion()) {
+        removePiece(to);
+        addPiece(to, chessPiece(us, move.promotion()));
+    } else if (move.flags() == ChessMove::kKingCastle) {
+        movePiece(from + 3, from + 1);
+    } else if (move.flags() == ChessMove::kQueenCastle) {
+        movePiece(from - 4, from - 1);
+    } else if (move.flags() == ChessMove::kDoublePush) {
+        int square = (from + to) / 2;
+        if (pawnAttacks(us, square) & _pieces[us ^ 1][kPawn]) {
+            _enPassant = square;
+            _key ^= chessTables.enPassantKeys[chessFile(square)];
+        }
+    }
+
+    _castling &= castlingMask[from] & castlingMask[to];
+    _key ^= chessTables.castlingKeys[_castling];
+
+    if (us == kBlack) {
+        _fullmove++;
+    }
+    _side ^= 1;
+    _key ^= chessTables.sideKey;
+}
+
+void ChessPosition::makeNullMove()
+{
+    if (_enPassant >= 0) {
+        _key ^= chessTables.enPassantKeys[chessFile(_enPassant)];
+        _enPassant = -1;
+    }
+    _halfmoveClock++;
+    _side ^= 1;
+    _key ^= chessTables.sideKey;
+}
+
+ChessMove ChessPosition::findMove(int from, int to, int promotion) const
+{
+    ChessMoveList list;
+    generateMoves(list);
+    for (ChessMove move : list) {
+        if (move.from() == from && move.to() == to && (!move.isPromotion() || move.promotion() == promotion)) {
+            return move;
+        }
+    }
+    return ChessMove();
+}
+
+ChessMove ChessPosition::parseUci(const std::string &text) const
+{
+    int from = parseSquare(text, 0);
+    int to = parseSquare(text, 2);
+    if (from < 0 || to < 0) {
+        return ChessMove();
+    }
+    int promotion = kQueen;
+    if (text.size() > 4) {
+        const char *letter = strchr("nbrq", text[4]);
+        if (!letter || text[4] == 0) {
+            return ChessMove();
+        }
+        promotion = kKnight + (int)(letter - "nbrq");
+    }
+    return findMove(from, to, promotion);
+}
+
+bool ChessPosition::hasLegalMoves() const
+{
+    ChessMoveList list;
+    generateMoves(list);
+    return list.count > 0;
+}
+
+bool ChessPosition::insufficientMaterial() const
+{
+    uint64_t heavy = _pieces[kWhite][kPawn] | _pieces[kBlack][kPawn] |
+                     _pieces[kWhite][kRook] | _pieces[kBlack][kRook] |
+                     _pieces[kWhite][kQueen] | _pieces[kBlack][kQueen];
+    uint64_t minors = _pieces[kWhite][kKnight] | _pieces[kBlack][kKnight] |
+                      _pieces[kWhite][kBishop] | _pieces[kBlack][kBishop];
+    // a lone knight or bishop can't force mate
+    return !heavy && std::popcount(minors) <= 1;
+}
+
+uint64_t ChessPosition::perft(int depth) const
+{
+    if (depth == 0) {
+        return 1;
+    }
+    ChessMoveList list;
+    generateMoves(list);
+    // the last ply only needs counting
+    if (depth == 1) {
+        return list.count;
+    }
+    uint64_t nodes = 0;
+    for (ChessMove move : list) {
+        ChessPosition next = *this;
+        next.makeMove(move);
+        nodes += next.perft(depth - 1);
+    }
+    return nodes;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "ChessBitboards.h"
+
+//
+// a move packed into 16 bits: from square, to square and what kind of move it is
+//
+struct ChessMove
+{
+    enum Flags
+    {
+        kQuiet          = 0,
+        kDoublePush     = 1,
+        kKingCastle     = 2,
+        kQueenCastle    = 3,
+        kCapture        = 4,
+        kEnPassant      = 5,
+        // promotions are 8 + the piece promoted to minus one (knight = 8 ... queen = 11), + 4 when capturing
+        kPromotion      = 8,
+        kPromotionCapture = 12,
+    };
+
+    uint16_t    bits;
+
+    ChessMove() : bits(0) {}
+    ChessMove(int from, int to, int flags) : bits((uint16_t)(from | (to << 6) | (flags << 12))) {}
+
+    int         from() const { return bits & 63; }
+    int         to() const { return (bits >> 6) & 63; }
+    int         flags() const { return bits >> 12; }
+    bool        isCapture() const { return (flags() & kCapture) != 0; }
+    bool        isPromotion() const { return (flags() & kPromotion) != 0; }
+    bool        isCastle() const { return flags() == kKingCastle || flags() == kQueenCastle; }
+    // kKnight ... kQueen, only meaningful for promotions
+    int         promotion() const { return (flags() & 3) + kKnight; }
+    bool        isNull() const { return bits == 0; }
+
+    // long algebraic, e2e4 / e7e8q
+    std::string uci() const;
+
+    bool operator==(const ChessMove &other) const { return bits == other.bits; }
+    bool operator!=(const ChessMove &other) const { return bits != other.bits; }
+};
+
+struct ChessMoveList
+{
+    ChessMove   moves[256];
+    int         count = 0;
+
+    void        add(int from, int to, int flags) { moves[count++] = ChessMove(from, to, flags); }
+    ChessMove   *begin() { return moves; }
+    ChessMove   *end() { return moves + count; }
+};
+
+// castling rights
+const int kCastleWhiteKing  = 1;
+const int kCastleWhiteQueen = 2;
+const int kCastleBlackKing  = 4;
+const int kCastleBlackQueen = 8;
+
+const char kChessStartFen[] = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+//
+// a chess position on bitboards
+//
+// moves are made on a copy (ChessPosition next = position; next.makeMove(move);)
+// instead of being unmade, the whole position is a couple of hundred bytes.
+// generateMoves() only produces legal moves: pins and checks are worked out up
+// front so no move has to be tried and taken back.
+//
+class ChessPosition
+{
+public:
+    ChessPosition();
+
+    // false if the fen couldn't be read, the position is left empty then
+    bool        setFen(const std::string &fen);
+    std::string fen() const;
+
+    // captures and promotions only when capturesOnly is set
+    void        generateMoves(ChessMoveList &list, bool capturesOnly = false) const;
+    void        makeMove(ChessMove move);
+    // pass the turn, for null move pruning, never call it while in check
+    void        makeNullMove();
+    // the legal move from -> to, queen for promotions unless told otherwise, null if there is none
+    ChessMove   findMove(int from, int to, int promotion = kQueen) const;
+    ChessMove   parseUci(const std::string &text) const;
+
+    // number of leaf nodes depth plies down
+    uint64_t    perft(int depth) const;
+
+    bool        inCheck() const { return checkers() != 0; }
+    bool        hasLegalMoves() const;
+    bool        isCheckmate() const { return inCheck() && !hasLegalMoves(); }
+    bool        isStalemate() const { return !inCheck() && !hasLegalMoves(); }
+    // neither side has enough left to mate
+    bool        insufficientMaterial() const;
+    bool        fiftyMoveRule() const { return _halfmoveClock >= 100; }
+
+    int         sideToMove() const { return _side; }
+    int         pieceAt(int square) const { return _board[square]; }
+    uint64_t    pieces(int color, int type) const { return _pieces[color][type]; }
+    uint64_t    colorPieces(int color) const { return _colors[color]; }
+    uint64_t    occupied() const { return _occupied; }
+    int         kingSquare(int color) const { return lowestSquare(_pieces[color][kKing]); }
+    int         enPassantSquare() const { return _enPassant; }
+    int         castlingRights() const { return _castling; }
+    int         halfmoveClock() const { return _halfmoveClock; }
+    int         fullmoveNumber() const { return _fullmove; }
+    uint64_t    key() const { return _key; }
+
+    // pieces of either color attacking square, with occupied as the blockers
+    uint64_t    attackersTo(int square, uint64_t occupied) const;
+    bool        isAttacked(int square, int byColor) const;
+    // pieces giving check to the side to move
+    uint64_t    checkers() const { return attackersTo(kingSquare(_side), _occupied) & _colors[_side ^ 1]; }
+
+private:
+    void        clear();
+    void        addPiece(int square, int piece);
+    void        removePiece(int square);
+    void        movePiece(int from, int to);
+    void        addPawnMoves(ChessMoveList &list, int from, uint64_t targets, bool capturesOnly) const;
+    bool        enPassantIsLegal(int from) const;
+
+    uint64_t    _pieces[2][6];
+    uint64_t    _colors[2];
+    uint64_t    _occupied;
+    uint8_t     _board[64];
+    int         _side;
+    int         _castling;
+    // square a pawn could capture onto en passant, -1 if none
+    int         _enPassant;
+    int         _halfmoveClock;
+    int         _fullmove;
+    uint64_t    _key;
+};
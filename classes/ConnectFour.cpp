@@ -0,0 +1,217 @@
+#include "ConnectFour.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+
+const int AI_PLAYER   = 1;      // index of the AI player (yellow)
+const int HUMAN_PLAYER= 0;      // index of the human player (red)
+
+// how long the AI may think about one move before it plays its best guess
+const double AI_TIME_BUDGET = 1.0;
+
+static GameRegistration registration({
+    .id = kGameIdConnect4, .name = "Connect Four", .boardWidth = 7, .boardHeight = 6, .players = 2,
+    .hasAI = true, .ai = "bitboard alpha-beta solver",
+    .create = [](const GameSetup &) -> Game * { return new ConnectFour(); },
+});
+
+ConnectFour::ConnectFour()
+{
+    _solver.setTimeBudget(AI_TIME_BUDGET);
+}
+
+ConnectFour::~ConnectFour()
+{
+}
+
+//
+// red for the first player, yellow for the second
+//
+Bit* ConnectFour::PieceForPlayer(const int playerNumber)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(playerNumber == 0 ? "red.png" : "yellow.png");
+    bit->setOwner(getPlayerAt(playerNumber));
+    return bit;
+}
+
+void ConnectFour::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = ConnectFourBoard::kWidth;
+    _gameOptions.rowY = ConnectFourBoard::kHeight;
+
+    // no limit means search until the position is solved or the time budget runs out
+    if (_gameOptions.AIMAXDepth <= 0) {
+        _gameOptions.AIMAXDepth = ConnectFourBoard::kCells;
+    }
+
+    setAIPlayer(AI_PLAYER);
+
+    for (int y = 0; y < ConnectFourBoard::kHeight; y++) {
+        for (int x = 0; x < ConnectFourBoard::kWidth; x++) {
+            ImVec2 position(x * 100.0f + 50.0f, y * 100.0f + 50.0f);
+            _grid[y][x].initHolder(position, "square.png", x, y);
+        }
+    }
+    _board = ConnectFourBoard();
+
+    startGame();
+}
+
+//
+// a click anywhere in a column drops a piece to the lowest empty square of it
+//
+bool ConnectFour::actionForEmptyHolder(BitHolder *holder)
+{
+    if (!holder) return false;
+
+    // every holder in this game is one of our squares
+    Square *square = static_cast<Square *>(holder);
+    return dropInColumn(square->column());
+}
+
+bool ConnectFour::dropInColumn(int column)
+{
+    if (column < 0 || column >= ConnectFourBoard::kWidth) return false;
+    if (gameIsOver() || !_board.canPlay(column)) return false;
+
+    Player *currentPlayer = getCurrentPlayer();
+    if (!currentPlayer) return false;
+
+    int y = ConnectFourBoard::kHeight - 1 - _board.columnHeight(column);
+    Square &square = _grid[y][column];
+
+    Bit *newBit = PieceForPlayer(currentPlayer->playerNumber());
+    newBit->moveTo(square.getPosition());
+    square.setBit(newBit);
+    _board.play(column);
+
+    Player *winner = checkForWinner();
+    if (winner) {
+        _winner = winner;
+    }
+    return true;
+}
+
+bool ConnectFour::gameIsOver() const
+{
+    return _board.hasWon(0) || _board.hasWon(1) || _board.isFull();
+}
+
+bool ConnectFour::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    // pieces stay where they fell
+    return false;
+}
+
+bool ConnectFour::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    return false;
+}
+
+void ConnectFour::stopGame()
+{
+    for (int y = 0; y < ConnectFourBoard::kHeight; y++) {
+        for (int x = 0; x < ConnectFourBoard::kWidth; x++) {
+            _grid[y][x].destroyBit();
+        }
+    }
+    _board = ConnectFourBoard();
+}
+
+Player* ConnectFour::checkForWinner()
+{
+    for (int player = 0; player < 2; player++) {
+        if (_board.hasWon(player)) {
+            return getPlayerAt(player);
+        }
+    }
+    return nullptr;
+}
+
+bool ConnectFour::checkForDraw()
+{
+    return _board.isFull() && !checkForWinner();
+}
+
+//
+// state strings, one character per square row by row from the top, 0 empty, 1 red, 2 yellow
+//
+std::string ConnectFour::initialStateString()
+{
+    return std::string(ConnectFourBoard::kCells, '0');
+}
+
+std::string ConnectFour::stateString() const
+{
+    std::string state;
+    for (int y = 0; y < ConnectFourBoard::kHeight; y++) {
+        for (int x = 0; x < ConnectFourBoard::kWidth; x++) {
+            Bit *bit = _grid[y][x].bit();
+            state += bit ? (char)('1' + bit->getOwner()->playerNumber()) : '0';
+        }
+    }
+    return state;
+}
+
+void ConnectFour::setStateString(const std::string &s)
+{
+    uint64_t stones[2] = { 0, 0 };
+    int index = 0;
+
+    for (int y = 0; y < ConnectFourBoard::kHeight; y++) {
+        for (int x = 0; x < ConnectFourBoard::kWidth; x++) {
+            Square &square = _grid[y][x];
+            int playerNumber = index < (int)s.size() ? s[index] - '0' : 0;
+
+            square.destroyBit();
+            if (playerNumber == 1 || playerNumber == 2) {
+                Bit *bit = PieceForPlayer(playerNumber - 1);
+                bit->moveTo(square.getPosition());
+                square.setBit(bit);
+                int row = ConnectFourBoard::kHeight - 1 - y;
+                stones[playerNumber - 1] |= 1ull << (x * (ConnectFourBoard::kHeight + 1) + row);
+            }
+            index++;
+        }
+    }
+    _board.setStones(stones[0], stones[1]);
+}
+
+void ConnectFour::updateAI()
+{
+    if (gameIsOver()) {
+        return;
+    }
+
+    int symmetry;
+    int column = openingBookMove(canonicalKey(_board, symmetry));
+    if (column >= 0) {
+        column = mapConnectFourMove(column, symmetry, true);
+        if (dropInColumn(column)) {
+            _lastStats.setBookMove(column);
+            _lastStats.logMove("connectfour 7x6", (int)getCurrentTurnNo());
+            endTurn();
+            return;
+        }
+    }
+
+    _solver.setTimeBudget(searchTimeBudget(AI_TIME_BUDGET));
+    column = _solver.findBestMove(_board, _gameOptions.AIMAXDepth);
+    _lastStats = _solver.stats();
+    _lastStats.logMove("connectfour 7x6", (int)getCurrentTurnNo());
+
+    if (dropInColumn(column)) {
+        endTurn();
+    }
+}
+
+bool ConnectFour::playRecordedMove(int move)
+{
+    if (!dropInColumn(move)) {
+        return false;
+    }
+    endTurn();
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "Game.h"
+#include "Square.h"
+#include "ConnectFourBoard.h"
+#include "ConnectFourSolver.h"
+
+//
+// connect four on the usual 7 wide, 6 high board
+//
+// the squares and pieces are only the picture, every rule is answered by the
+// bitboard in _board which is kept in step with them on each drop.
+//
+class ConnectFour : public Game
+{
+public:
+    ConnectFour();
+    ~ConnectFour();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    std::string stateString() const override;
+    void        setStateString(const std::string &s) override;
+    bool        actionForEmptyHolder(BitHolder *holder) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        playRecordedMove(int move) override;
+    bool        gameHasAI() override { return true; }
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+
+    const SearchStats *searchStats() const override { return &_lastStats; }
+
+private:
+    Bit *       PieceForPlayer(const int playerNumber);
+    // drop the current player's piece into column, false if it is full or the game is over
+    bool        dropInColumn(int column);
+    bool        gameIsOver() const;
+
+    // y = 0 is the top row on screen, the bitboard counts rows from the bottom
+    Square              _grid[ConnectFourBoard::kHeight][ConnectFourBoard::kWidth];
+    ConnectFourBoard    _board;
+    ConnectFourSolver   _solver;
+
+    // what the last AI move cost
+    SearchStats         _lastStats;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+//
+// the classic 64-bit connect four bitboard
+//
+// each column takes kHeight + 1 bits, bottom row first, with a spare bit on top
+// so a shift never carries from one column into the next. two words describe
+// the whole position: mask has a bit for every stone, position has a bit for
+// every stone of the player to move. dropping a stone is a single add, since
+// mask + the column's bottom bit lands exactly on the lowest empty cell.
+//
+
+// one bit at the bottom of every column
+constexpr uint64_t connectFourBottomRow(int width, int height)
+{
+    uint64_t mask = 0;
+    for (int column = 0; column < width; column++) {
+        mask |= 1ull << (column * (height + 1));
+    }
+    return mask;
+}
+
+class ConnectFourBoard
+{
+public:
+    static const int kWidth = 7;
+    static const int kHeight = 6;
+    static const int kCells = kWidth * kHeight;
+
+    ConnectFourBoard() : _position(0), _mask(0), _moves(0) {}
+
+    // set up any position from each player's stones, the player to move follows from the count
+    void        setStones(uint64_t first, uint64_t second)
+    {
+        _mask = first | second;
+        _moves = std::popcount(_mask);
+        _position = currentPlayer() == 0 ? first : second;
+    }
+
+    bool        canPlay(int column) const { return (_mask & topMask(column)) == 0; }
+    void        play(int column) { playMove((_mask + bottomMask(column)) & columnMask(column)); }
+    // play a single bit move from possible() / possibleNonLosingMoves()
+    void        playMove(uint64_t move)
+    {
+        _position ^= _mask;
+        _mask |= move;
+        _moves++;
+    }
+
+    // would dropping in column give the player to move four in a row
+    bool        isWinningMove(int column) const { return (winningPositions() & possible() & columnMask(column)) != 0; }
+    bool        canWinNext() const { return (winningPositions() & possible()) != 0; }
+
+    int         moves() const { return _moves; }
+    // zero based number of the player to move, player 0 always starts
+    int         currentPlayer() const { return _moves & 1; }
+    // unique for every position, mask + position sets the bit above each column's top stone
+    uint64_t    key() const { return _position + _mask; }
+
+    uint64_t    stones(int player) const { return player == currentPlayer() ? _position : _position ^ _mask; }
+    bool        hasWon(int player) const { return alignment(stones(player)); }
+    bool        isFull() const { return _moves >= kCells; }
+
+    // -1 if empty, otherwise the zero based player number, row 0 is the bottom row
+    int         ownerAt(int column, int row) const
+    {
+        uint64_t bit = 1ull << (column * (kHeight + 1) + row);
+        if (!(_mask & bit)) {
+            return -1;
+        }
+        return (_position & bit) ? currentPlayer() : 1 - currentPlayer();
+    }
+    int         columnHeight(int column) const { return std::popcount(_mask & columnMask(column)); }
+
+    // cells that would complete a four for the player to move / the opponent
+    uint64_t    winningPositions() const { return computeWinningPositions(_position, _mask); }
+    uint64_t    opponentWinningPositions() const { return computeWinningPositions(_position ^ _mask, _mask); }
+    // lowest empty cell of every column that isn't full
+    uint64_t    possible() const { return (_mask + kBottomMask) & kBoardMask; }
+
+    // moves that don't hand the opponent an immediate win, 0 if every move loses
+    uint64_t    possibleNonLosingMoves() const
+    {
+        uint64_t possibleMask = possible();
+        uint64_t opponentWin = opponentWinningPositions();
+        uint64_t forced = possibleMask & opponentWin;
+        if (forced) {
+            // two threats at once can't both be blocked
+            if (forced & (forced - 1)) {
+                return 0;
+            }
+            possibleMask = forced;
+        }
+        // never play directly under a cell the opponent wants
+        return possibleMask & ~(opponentWin >> 1);
+    }
+
+    // how many winning cells the player to move would have after playing move, used for ordering
+    int         moveScore(uint64_t move) const { return std::popcount(computeWinningPositions(_position | move, _mask)); }
+
+    // four in a row anywhere in a set of stones
+    static bool alignment(uint64_t position)
+    {
+        // horizontal
+        uint64_t m = position & (position >> (kHeight + 1));
+        if (m & (m >> (2 * (kHeight + 1)))) return true;
+        // diagonal down
+        m = position & (position >> kHeight);
+        if (m & (m >> (2 * kHeight))) return true;
+        // diagonal up
+        m = position & (position >> (kHeight + 2));
+        if (m & (m >> (2 * (kHeight + 2)))) return true;
+        // vertical
+        m = position & (position >> 1);
+        if (m & (m >> 2)) return true;
+        return false;
+    }
+
+    // every empty cell that would complete a four for the stones in position
+    static uint64_t computeWinningPositions(uint64_t position, uint64_t mask)
+    {
+        // vertical, only ever on top of three stones
+        uint64_t r = (position << 1) & (position << 2) & (position << 3);
+
+        // horizontal and both diagonals, the gap can be at any of the four cells
+        const int shifts[3] = { kHeight + 1, kHeight, kHeight + 2 };
+        for (int shift : shifts) {
+            uint64_t p = (position << shift) & (position << (2 * shift));
+            r |= p & (position << (3 * shift));
+            r |= p & (position >> shift);
+            p = (position >> shift) & (position >> (2 * shift));
+            r |= p & (position << shift);
+            r |= p & (position >> (3 * shift));
+        }
+        return r & (kBoardMask ^ mask);
+    }
+
+    static constexpr uint64_t bottomMask(int column) { return 1ull << (column * (kHeight + 1)); }
+    static constexpr uint64_t topMask(int column) { return 1ull << (kHeight - 1 + column * (kHeight + 1)); }
+    static constexpr uint64_t columnMask(int column) { return ((1ull << kHeight) - 1) << (column * (kHeight + 1)); }
+
+private:
+    static constexpr uint64_t kBottomMask = connectFourBottomRow(kWidth, kHeight);
+    static constexpr uint64_t kBoardMask = kBottomMask * ((1ull << kHeight) - 1);
+
+    uint64_t    _position;
+    uint64_t    _mask;
+    int         _moves;
+};
@@ -0,0 +1,192 @@
+#include "ConnectFourSolver.h"
+
+#include <algorithm>
+
+// larger than any score negamax can return
+const int SCORE_INFINITY = ConnectFourSolver::kWinScore + 1000;
+
+// scores this close to a win are wins in a known number of plies
+const int SCORE_WIN_BOUND = ConnectFourSolver::kWinScore - 1000;
+
+// the middle column takes part in the most fours, search outwards from it
+const int COLUMN_ORDER[ConnectFourBoard::kWidth] = { 3, 2, 4, 1, 5, 0, 6 };
+
+static int columnOf(uint64_t move)
+{
+    return std::countr_zero(move) / (ConnectFourBoard::kHeight + 1);
+}
+
+ConnectFourSolver::ConnectFourSolver() : _table(SCORE_WIN_BOUND)
+{
+    _solved = false;
+}
+
+void ConnectFourSolver::clearTable()
+{
+    _table.clear();
+}
+
+//
+// heuristic for positions the search didn't finish, from the player to move's point of view
+//
+int ConnectFourSolver::evaluate(const ConnectFourBoard &board) const
+{
+    int me = board.currentPlayer();
+    int threats = std::popcount(board.winningPositions()) - std::popcount(board.opponentWinningPositions());
+    uint64_t center = ConnectFourBoard::columnMask(3);
+    int centerStones = std::popcount(board.stones(me) & center) - std::popcount(board.stones(1 - me) & center);
+    return threats * 8 + centerStones * 2;
+}
+
+//
+// the player to move can never win immediately here, the parent already checked
+//
+int ConnectFourSolver::negamax(const ConnectFourBoard &board, int alpha, int beta, int ply, int depthLeft)
+{
+    if (_clock.tick(++_stats.nodes)) {
+        return 0;
+    }
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+
+    // every move lets the opponent complete a four straight after
+    uint64_t next = board.possibleNonLosingMoves();
+    if (next == 0) {
+        return -(kWinScore - (ply + 1));
+    }
+    // nobody can win in the last two moves once neither side can win right now
+    if (board.moves() >= ConnectFourBoard::kCells - 2) {
+        return 0;
+    }
+    if (depthLeft <= 0) {
+        return evaluate(board);
+    }
+
+    uint64_t key = board.key();
+    int tableMove = -1;
+    int tableScore;
+    if (_table.probe(key, depthLeft, alpha, beta, ply, tableMove, tableScore, _stats)) {
+        return tableScore;
+    }
+
+    // table move first, then the moves that leave us the most winning cells, center first on ties
+    uint64_t moves[ConnectFourBoard::kWidth];
+    int scores[ConnectFourBoard::kWidth];
+    int count = 0;
+    for (int column : COLUMN_ORDER) {
+        uint64_t move = next & ConnectFourBoard::columnMask(column);
+        if (!move) {
+            continue;
+        }
+        int score = (column == tableMove) ? 1000 : board.moveScore(move);
+        int i = count++;
+        while (i > 0 && scores[i - 1] < score) {
+            moves[i] = moves[i - 1];
+            scores[i] = scores[i - 1];
+            i--;
+        }
+        moves[i] = move;
+        scores[i] = score;
+    }
+
+    int originalAlpha = alpha;
+    int bestScore = -SCORE_INFINITY;
+    int bestMove = -1;
+    _stats.expanded++;
+
+    for (int i = 0; i < count; i++) {
+        ConnectFourBoard child = board;
+        child.playMove(moves[i]);
+        int score = -negamax(child, -beta, -alpha, ply + 1, depthLeft - 1);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = columnOf(moves[i]);
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        if (alpha >= beta) {
+            _stats.cutoffs++;
+            if (i == 0) {
+                _stats.firstMoveCutoffs++;
+            }
+            break;
+        }
+    }
+
+    if (_clock.timeUp()) {
+        return 0;
+    }
+
+    _table.store(key, depthLeft, ply, bestScore, bestMove, originalAlpha, beta);
+    return bestScore;
+}
+
+int ConnectFourSolver::findBestMove(const ConnectFourBoard &board, int maxDepth)
+{
+    _clock.start();
+    _solved = false;
+    _stats.reset();
+
+    if (board.isFull()) {
+        return -1;
+    }
+
+    // take a win when there is one
+    for (int column : COLUMN_ORDER) {
+        if (board.canPlay(column) && board.isWinningMove(column)) {
+            _solved = true;
+            _stats.bestMove = column;
+            _stats.score = kWinScore - 1;
+            _stats.principalVariation.push_back(column);
+            _stats.seconds = _clock.elapsed();
+            return column;
+        }
+    }
+
+    std::vector<int> candidates;
+    uint64_t next = board.possibleNonLosingMoves();
+    for (int column : COLUMN_ORDER) {
+        if (board.canPlay(column) && (next == 0 || (next & ConnectFourBoard::columnMask(column)))) {
+            candidates.push_back(column);
+        }
+    }
+    if (next == 0) {
+        // every move loses, just play the first one
+        _solved = true;
+        _stats.bestMove = candidates[0];
+        _stats.score = -(kWinScore - 2);
+        _stats.seconds = _clock.elapsed();
+        return candidates[0];
+    }
+
+    int remaining = ConnectFourBoard::kCells - board.moves();
+    int limit = (maxDepth > 0 && maxDepth < remaining) ? maxDepth : remaining;
+    int bestScore = deepen(candidates.data(), (int)candidates.size(), limit, SCORE_INFINITY, SCORE_WIN_BOUND, _clock, _stats, [&](int column, int alpha, int depth) {
+        ConnectFourBoard child = board;
+        child.play(column);
+        return -negamax(child, -SCORE_INFINITY, -alpha, 1, depth - 1);
+    });
+    int bestMove = candidates[0];
+    _solved = bestScore > SCORE_WIN_BOUND || bestScore < -SCORE_WIN_BOUND || _stats.depthLimit >= remaining;
+
+    _stats.seconds = _clock.elapsed();
+    _stats.bestMove = bestMove;
+    _stats.score = bestScore;
+
+    // principal variation out of the table
+    ConnectFourBoard line = board;
+    int move = bestMove;
+    while (move >= 0 && line.canPlay(move) && (int)_stats.principalVariation.size() < remaining) {
+        _stats.principalVariation.push_back(move);
+        bool won = line.isWinningMove(move);
+        line.play(move);
+        if (won) {
+            break;
+        }
+        move = _table.move(line.key());
+    }
+    return bestMove;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ConnectFourBoard.h"
+#include "SearchStats.h"
+#include "SearchTable.h"
+
+//
+// alpha-beta search for connect four on the bitboard
+//
+// searches deeper and deeper until the position is solved (a forced win or loss
+// was found, or the search reached the end of the board) or the per-move time
+// budget runs out, in which case the deepest finished iteration decides. moves
+// are tried table move first, then by how many new threats they make, then
+// from the center column outwards.
+//
+
+class ConnectFourSolver
+{
+public:
+    ConnectFourSolver();
+
+    // best column for the player to move, -1 if the board is full
+    int         findBestMove(const ConnectFourBoard &board, int maxDepth = 0);
+
+    void        setTimeBudget(double seconds) { _clock.setBudget(seconds); }
+    double      timeBudget() const { return _clock.budget(); }
+    // true if the last findBestMove() proved the result instead of guessing
+    bool        solved() const { return _solved; }
+    // > 0 win, < 0 loss, 0 draw for the player to move, only meaningful when solved()
+    int         score() const { return _stats.score; }
+    const SearchStats &stats() const { return _stats; }
+
+    void        clearTable();
+
+    static const int kWinScore = 100000;
+
+private:
+    int         negamax(const ConnectFourBoard &board, int alpha, int beta, int ply, int depthLeft);
+    int         evaluate(const ConnectFourBoard &board) const;
+
+    SearchTable _table;
+    SearchClock _clock;
+    SearchStats _stats;
+    bool        _solved;
+};
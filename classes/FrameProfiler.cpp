@@ -0,0 +1,94 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+
+// the innermost timer running now
+static ScopedFrameTimer *currentTimer = nullptr;
+
+FrameProfiler::FrameProfiler()
+{
+    std::fill(&_history[0][0], &_history[0][0] + kHistory * (kPhaseCount + 1), 0.0f);
+    std::fill(_current, _current + kPhaseCount, 0.0);
+    _next = 0;
+    _frames = 0;
+    _started = false;
+}
+
+FrameProfiler &FrameProfiler::instance()
+{
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+const char *FrameProfiler::phaseName(int phase)
+{
+    static const char *names[kPhaseCount + 1] = { "Events", "Input", "AI", "Board", "Interface", "Render", "Swap", "Frame" };
+    return phase >= 0 && phase <= kPhaseCount ? names[phase] : "";
+}
+
+void FrameProfiler::beginFrame()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (_started) {
+        float *frame = _history[_next];
+        for (int phase = 0; phase < kPhaseCount; phase++) {
+            frame[phase] = (float)(_current[phase] * 1000.0);
+        }
+        frame[kPhaseCount] = (float)(std::chrono::duration<double>(now - _frameStart).count() * 1000.0);
+        Trace::counter("frame us", (int64_t)(frame[kPhaseCount] * 1000.0f));
+        _next = (_next + 1) % kHistory;
+        _frames = std::min(_frames + 1, kHistory);
+    }
+    std::fill(_current, _current + kPhaseCount, 0.0);
+    _frameStart = now;
+    _started = true;
+}
+
+void FrameProfiler::add(FramePhase phase, double seconds)
+{
+    _current[phase] += seconds;
+}
+
+float FrameProfiler::milliseconds(int frame, int phase) const
+{
+    int slot = (_next - _frames + frame + kHistory) % kHistory;
+    return _history[slot][phase];
+}
+
+FramePercentiles FrameProfiler::percentiles(int phase) const
+{
+    FramePercentiles result;
+    if (_frames == 0) {
+        return result;
+    }
+    float sorted[kHistory];
+    for (int frame = 0; frame < _frames; frame++) {
+        sorted[frame] = milliseconds(frame, phase);
+    }
+    std::sort(sorted, sorted + _frames);
+    auto at = [&](double fraction) { return sorted[std::min(_frames - 1, (int)(fraction * _frames))]; };
+    result.p50 = at(0.50);
+    result.p95 = at(0.95);
+    result.p99 = at(0.99);
+    result.max = sorted[_frames - 1];
+    return result;
+}
+
+ScopedFrameTimer::ScopedFrameTimer(FramePhase phase) : _trace(FrameProfiler::phaseName(phase), "frame")
+{
+    _phase = phase;
+    _inner = 0.0;
+    _outer = currentTimer;
+    currentTimer = this;
+    _start = std::chrono::steady_clock::now();
+}
+
+ScopedFrameTimer::~ScopedFrameTimer()
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    FrameProfiler::instance().add(_phase, seconds - _inner);
+    currentTimer = _outer;
+    if (_outer) {
+        _outer->_inner += seconds;
+    }
+}
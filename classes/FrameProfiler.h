@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Trace.h"
+
+#include <chrono>
+
+//
+// where each frame's time goes, phase by phase
+//
+// a ScopedFrameTimer around a piece of the frame adds its time to that phase.
+// timers nest, and a timer's time leaves out the timers inside it, so the AI
+// running inside the input scan or the board drawn inside the interface count
+// once, under their own phase. the profiler keeps the last kHistory frames for
+// the overlay and works out percentiles only when somebody asks for them.
+//
+// a timer costs two clock reads. everything here is for the main thread only.
+// while tracing is on each timer is also a slice on the trace's timeline.
+//
+
+enum FramePhase
+{
+    kPhaseEvents,       // polling events and starting the ImGui frame
+    kPhaseInput,        // Game::scanForMouse
+    kPhaseAI,           // Game::updateAI
+    kPhaseBoard,        // painting the board and pieces
+    kPhaseInterface,    // the settings and stats windows
+    kPhaseRender,       // ImGui::Render and the draw data going to the GPU
+    kPhaseSwap,         // presenting, which is where vsync waits
+    kPhaseCount
+};
+
+struct FramePercentiles
+{
+    float       p50 = 0.0f;
+    float       p95 = 0.0f;
+    float       p99 = 0.0f;
+    float       max = 0.0f;
+};
+
+class FrameProfiler
+{
+public:
+    static const int kHistory = 240;
+
+    FrameProfiler();
+
+    // the one the timers add to
+    static FrameProfiler &instance();
+    static const char *phaseName(int phase);
+
+    // the start of a frame, which ends the one before it
+    void        beginFrame();
+    void        add(FramePhase phase, double seconds);
+
+    // frames in the history, 0 being the oldest
+    int         frames() const { return _frames; }
+    // milliseconds, phase kPhaseCount being the whole frame
+    float       milliseconds(int frame, int phase) const;
+    // over the history, phase kPhaseCount being the whole frame
+    FramePercentiles percentiles(int phase) const;
+
+private:
+    float       _history[kHistory][kPhaseCount + 1];
+    // where the next frame goes, and how many there are
+    int         _next;
+    int         _frames;
+    // the frame going on now
+    double      _current[kPhaseCount];
+    std::chrono::steady_clock::time_point _frameStart;
+    bool        _started;
+};
+
+class ScopedFrameTimer
+{
+public:
+    ScopedFrameTimer(FramePhase phase);
+    ~ScopedFrameTimer();
+
+private:
+    FramePhase          _phase;
+    std::chrono::steady_clock::time_point _start;
+    // time spent in timers inside this one
+    double              _inner;
+    ScopedFrameTimer    *_outer;
+    TraceScope          _trace;
+};
@@ -2,8 +2,24 @@
 #include "Bit.h"
 #include "BitHolder.h"
 #include "Turn.h"
+#include "FrameProfiler.h"
+#include "LatencyHistogram.h"
+#include "OpeningBook.h"
+#include "SearchStats.h"
+#include "Trace.h"
 #include "../Application.h"
 
+#include <algorithm>
+#include <chrono>
+
+// the part of a latency target a search may use, the rest is for playing the move
+static const double kSearchShareOfTarget = 0.9;
+
+static double nowSeconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 Game::Game()
 {
 	_gameOptions.AIPlayer = false;
@@ -15,6 +31,7 @@ Game::Game()
 	_gameOptions.rowY = 0;
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
+	_gameOptions.AIMAXDepth = 0;
 	_gameOptions.AIvsAI = false;
 	
 	_score = 0;
@@ -22,6 +39,15 @@ Game::Game()
 	_winner = nullptr;
 	_lastMove = "";
 	_gameNumber = -1;
+	_dragBit = nullptr;
+	_dragSource = nullptr;
+	_replaying = false;
+	_openingBook = nullptr;
+	_bookRandom = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+	_moveLatency = nullptr;
+	_latencyTarget = 0.0;
+	_moveStart = 0.0;
+	_startEmptySquares = 0;
 }
 
 
@@ -66,7 +92,15 @@ void Game::setAIPlayer(unsigned int playerNumber)
 {
 	_players.at(playerNumber)->setAIPlayer(true);
 	_gameOptions.AIPlayer = playerNumber;
-	_gameOptions.AIPlayer = true;
+	_gameOptions.AIPlaying = true;
+}
+
+void Game::setAIvsAI(bool on)
+{
+	_gameOptions.AIvsAI = on;
+	for (Player *player : _players) {
+		player->setAIPlayer(on || (_gameOptions.AIPlaying && player->playerNumber() == _gameOptions.AIPlayer));
+	}
 }
 
 void Game::startGame()
@@ -76,10 +110,85 @@ void Game::startGame()
 	turn->_boardState = startState;
 	turn->_gameNumber = _gameNumber;
 	_gameOptions.currentTurnNo = 0;
+	_startEmptySquares = countEmptySquares();
+}
+
+int Game::countEmptySquares() const
+{
+	// getHolderAt() isn't const, but nothing is changed through it here
+	Game *self = const_cast<Game *>(this);
+	int count = 0;
+	for (int y = 0; y < _gameOptions.rowY; y++) {
+		for (int x = 0; x < _gameOptions.rowX; x++) {
+			if (self->getHolderAt(x, y).bit() == nullptr) {
+				count++;
+			}
+		}
+	}
+	return count;
+}
+
+//
+// placing games count the squares filled since the start against the ones that
+// were empty, capturing games count the squares emptied against the ones that
+// were full, and the game is split into thirds of that
+//
+int Game::boardPhase() const
+{
+	int squares = _gameOptions.rowX * _gameOptions.rowY;
+	int empty = countEmptySquares();
+	double progress;
+	if (empty <= _startEmptySquares) {
+		progress = _startEmptySquares > 0 ? (double)(_startEmptySquares - empty) / _startEmptySquares : 1.0;
+	} else {
+		progress = (double)(empty - _startEmptySquares) / std::max(1, squares - _startEmptySquares);
+	}
+	if (progress < 1.0 / 3.0) {
+		return kBoardOpening;
+	}
+	return progress < 2.0 / 3.0 ? kBoardMiddle : kBoardEnd;
+}
+
+//
+// the search gets its share of the target less what updateAI() has spent
+// already. a budget of 0 means no limit to the searches, so it never goes below
+// a millisecond
+//
+double Game::searchTimeBudget(double budget) const
+{
+	if (_latencyTarget <= 0.0) {
+		return budget;
+	}
+	double left = _latencyTarget * kSearchShareOfTarget - (nowSeconds() - _moveStart);
+	if (budget > 0.0) {
+		left = std::min(left, budget);
+	}
+	return std::max(left, 0.001);
+}
+
+void Game::restoreGame(const std::string &state, unsigned int turnNo, const std::vector<std::string> &history)
+{
+	setStateString(state);
+	_gameOptions.currentTurnNo = turnNo;
+
+	for (size_t i = 1; i < _turns.size(); i++) {
+		delete _turns[i];
+	}
+	_turns.resize(1);
+	for (size_t i = 0; i < history.size(); i++) {
+		Turn *turn = i == 0 ? _turns[0] : new Turn;
+		turn->_boardState = history[i];
+		turn->_date = (int)i;
+		turn->_gameNumber = _gameNumber;
+		if (i > 0) {
+			_turns.push_back(turn);
+		}
+	}
 }
 
 void Game::endTurn()
 {
+	TraceScope trace("end turn", "game");
 	_gameOptions.currentTurnNo++;
 	std::string startState = stateString();
 	Turn *turn = new Turn;
@@ -93,9 +202,24 @@ void Game::endTurn()
 
 void Game::scanForMouse()
 {
+    ScopedFrameTimer timer(kPhaseInput);
+    if (_replaying) {
+        return;
+    }
+
     if (gameHasAI() && getCurrentPlayer()->isAIPlayer())
     {
+        ScopedFrameTimer aiTimer(kPhaseAI);
+        int phase = boardPhase();
+        unsigned int turn = getCurrentTurnNo();
+        _moveStart = nowSeconds();
         updateAI();
+        // frames where the AI had nothing to play aren't moves
+        if (_moveLatency && getCurrentTurnNo() != turn) {
+            const SearchStats *stats = searchStats();
+            double searched = stats && !stats->fromBook && !stats->pondered ? stats->seconds : -1.0;
+            _moveLatency->record(phase, nowSeconds() - _moveStart, searched, _latencyTarget);
+        }
         return;
     }
 
@@ -103,12 +227,24 @@ void Game::scanForMouse()
     mousePos.x -= ImGui::GetWindowPos().x;
     mousePos.y -= ImGui::GetWindowPos().y;
 
+    // a picked up bit follows the mouse until the button comes back up
+    if (_dragBit) {
+        ImVec2 size = _dragBit->getSize();
+        _dragBit->moveTo(ImVec2(mousePos.x - size.x / 2, mousePos.y - size.y / 2));
+    }
+
+    BitHolder *holderUnderMouse = nullptr;
     for (int y=0; y<_gameOptions.rowY; y++) {
         for (int x=0; x<_gameOptions.rowX; x++) {
 			BitHolder &holder = getHolderAt(x, y);
             if (holder.isMouseOver(mousePos)) {
-                if (ImGui::IsMouseClicked(0)) {
-                    if (actionForEmptyHolder(&holder)) {
+                holderUnderMouse = &holder;
+                if (_dragBit) {
+                    holder.setHighlighted(&holder != _dragSource && canBitMoveFromTo(_dragBit, _dragSource, &holder));
+                } else if (ImGui::IsMouseClicked(0)) {
+                    if (holder.bit() && canBitMoveFrom(holder.bit(), &holder)) {
+                        pickUpBit(holder);
+                    } else if (actionForEmptyHolder(&holder)) {
                         endTurn();
                     }
                 } else {
@@ -118,7 +254,53 @@ void Game::scanForMouse()
                 holder.setHighlighted(false);
             }
         }
-    }    
+    }
+
+    if (_dragBit && ImGui::IsMouseReleased(0)) {
+        dropBit(holderUnderMouse);
+    }
+}
+
+//
+// the holder has the last word on what gets dragged out of it
+//
+void Game::pickUpBit(BitHolder &holder)
+{
+    Bit *bit = holder.canDragBit(holder.bit());
+    if (!bit) {
+        return;
+    }
+    _dragBit = bit;
+    _dragSource = &holder;
+    _dragBit->setPickedUp(true);
+}
+
+//
+// drop the dragged bit on holder, or send it back where it came from if it can't go there
+//
+void Game::dropBit(BitHolder *holder)
+{
+    Bit *bit = _dragBit;
+    BitHolder *src = _dragSource;
+    _dragBit = nullptr;
+    _dragSource = nullptr;
+    bit->setPickedUp(false);
+
+    ImVec2 point = bit->getPosition();
+    if (holder && holder != src && canBitMoveFromTo(bit, src, holder) && holder->canDropBitAtPoint(bit, point)) {
+        // the holder takes the bit before the source lets go of it, so it is never freed
+        holder->dropBitAtPoint(bit, point);
+        bit->moveTo(holder->getPosition());
+        src->draggedBitTo(bit, holder);
+        holder->setHighlighted(false);
+        bitMovedFromTo(bit, src, holder);
+    } else {
+        if (holder && holder != src) {
+            holder->willNotDropBit(bit);
+        }
+        src->cancelDragBit(bit);
+        bit->moveTo(src->getPosition());
+    }
 }
 
 //
@@ -127,17 +309,22 @@ void Game::scanForMouse()
 //
 void Game::drawFrame()
 {
+    ScopedFrameTimer timer(kPhaseBoard);
     scanForMouse();
 
     for (int y=0; y<_gameOptions.rowY; y++) {
         for (int x=0; x<_gameOptions.rowX; x++) {
 			BitHolder &holder = getHolderAt(x, y);
             holder.paintSprite();
-            if (holder.bit()) {
+            if (holder.bit() && holder.bit() != _dragBit) {
                 holder.bit()->paintSprite();
             }
         }
     }
+    // the dragged bit goes on top of everything
+    if (_dragBit) {
+        _dragBit->paintSprite();
+    }
 }
 
 void Game::bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst)
@@ -174,3 +361,16 @@ void Game::updateAI()
 {
 }
 
+int Game::openingBookMove(uint64_t key)
+{
+	if (!_openingBook) {
+		return -1;
+	}
+	// splitmix64
+	_bookRandom += 0x9E3779B97F4A7C15ull;
+	uint64_t random = _bookRandom;
+	random = (random ^ (random >> 30)) * 0xBF58476D1CE4E5B9ull;
+	random = (random ^ (random >> 27)) * 0x94D049BB133111EBull;
+	return _openingBook->pick(key, random ^ (random >> 31));
+}
+
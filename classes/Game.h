@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -10,6 +11,9 @@
 #include "BitHolder.h"
 
 class GameTable;
+class MoveLatency;
+class OpeningBook;
+struct SearchStats;
 
 struct GameOptions
 {
@@ -30,7 +34,7 @@ class Game
 {
 public:
 	Game();
-	~Game();
+	virtual ~Game();
 
 	void		startGame();
 
@@ -75,13 +79,45 @@ public:
 	virtual		void	stopGame() = 0;
     virtual     bool    gameHasAI();
     virtual     void    updateAI();
+	// a move as the game logs write it (see SelfPlayGame), played with its turn
+	// ended. false if the game doesn't record moves or this one isn't legal here
+	virtual		bool	playRecordedMove(int move) { return false; }
+	// counters from the AI's last move, nullptr if the game has no search to report on
+	virtual		const SearchStats *searchStats() const { return nullptr; }
 
 	virtual		std::string	initialStateString() = 0;
 	virtual		std::string stateString() const = 0;
 	virtual		void setStateString(const std::string &s) = 0;
+	// put back a game saved part way through: the board, the turn it was on, and
+	// the board after each turn so far, the first being the starting position.
+	// games that keep more than the board about earlier turns rebuild it here
+	virtual		void restoreGame(const std::string &state, unsigned int turnNo, const std::vector<std::string> &history);
     
 	void		setNumberOfPlayers(unsigned int playerCount);
 	void		setAIPlayer(unsigned int playerNumber);
+	// the AI moves for every player, or only for the one setAIPlayer() chose
+	void		setAIvsAI(bool on);
+	// the AI plays from this book while the game is in it and searches after, nullptr for no book
+	void		setOpeningBook(const OpeningBook *book) { _openingBook = book; }
+	// a move from the book for the position with this canonical key (see BoardSymmetry.h),
+	// still in the canonical position's frame, -1 when the book has nothing
+	int			openingBookMove(uint64_t key);
+	// every AI move's latency goes here by board phase, nullptr to not keep them
+	void		setMoveLatency(MoveLatency *latency) { _moveLatency = latency; }
+	// an AI move should take no longer than this, 0 for no target. searches stop
+	// early to keep inside it, see searchTimeBudget()
+	void		setLatencyTarget(double seconds) { _latencyTarget = seconds; }
+	double		latencyTarget() const { return _latencyTarget; }
+	// what a search may spend on the move being made, its own budget cut to fit
+	// the latency target with the time updateAI() has already taken
+	double		searchTimeBudget(double budget) const;
+
+	// empty squares on the board, the default counts getHolderAt() over the grid
+	virtual		int		countEmptySquares() const;
+	// kBoardOpening, kBoardMiddle or kBoardEnd (see LatencyHistogram.h), from how
+	// far the empty squares have moved from the start towards a full board, or an
+	// empty one in games that capture
+	int			boardPhase() const;
     void        scanForMouse();
 	// function to return pointer to the [][] array of bitholders
 	virtual BitHolder &getHolderAt(const int x, const int y) = 0;
@@ -104,5 +140,27 @@ public:
 	GameOptions 			_gameOptions;
 
 	int						_gameNumber;
+
+	// the bit being dragged with the mouse and the holder it was picked up from, nullptr when there isn't one
+	Bit						*_dragBit;
+	BitHolder				*_dragSource;
+
+	// a replay is showing, the board takes no clicks and the AI doesn't move
+	bool					_replaying;
+
+	const OpeningBook		*_openingBook;
+	// dice for picking between book moves, different every run
+	uint64_t				_bookRandom;
+
+	MoveLatency				*_moveLatency;
+	double					_latencyTarget;
+	// when the AI move being made started, for searchTimeBudget()
+	double					_moveStart;
+	// countEmptySquares() when the game started
+	int						_startEmptySquares;
+
+private:
+	void	pickUpBit(BitHolder &holder);
+	void	dropBit(BitHolder *holder);
 };
 
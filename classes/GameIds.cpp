@@ -0,0 +1,31 @@
+#include "GameIds.h"
+
+#include <cstdio>
+
+const std::vector<std::string> &gameIds()
+{
+    static const std::vector<std::string> ids = {
+        kGameIdCheckers, kGameIdChess, kGameIdConnect4, kGameIdGomoku,
+        kGameIdQubic, kGameIdReversi, kGameIdTicTacToe, kGameIdUltimate,
+    };
+    return ids;
+}
+
+std::string sizedGameId(const std::string &id, int width, int height, int k)
+{
+    return id + "-" + std::to_string(width) + "x" + std::to_string(height) + "-" + std::to_string(k);
+}
+
+bool parseSizedGameId(const std::string &text, std::string &id, int &width, int &height, int &k)
+{
+    size_t dash = text.find('-');
+    if (dash == std::string::npos || dash == 0) {
+        return false;
+    }
+    int length = 0;
+    if (sscanf(text.c_str() + dash, "-%dx%d-%d%n", &width, &height, &k, &length) != 3 || dash + length != text.size()) {
+        return false;
+    }
+    id = text.substr(0, dash);
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//
+// the ids games go by on the command line, in saved settings, game logs and books
+//
+// every game registers under one of these (GameRegistry) and the headless tools
+// make their SelfPlayGame from the same ones, so the two can't drift apart even
+// though the tools never link the games themselves. a resizable game played on
+// anything but its default board adds the size to its id, "tictactoe-4x4-4" is
+// tic-tac-toe on a 4x4 board with 4 in a row.
+//
+
+const char *const kGameIdCheckers   = "checkers";
+const char *const kGameIdChess      = "chess";
+const char *const kGameIdConnect4   = "connect4";
+const char *const kGameIdGomoku     = "gomoku";
+const char *const kGameIdQubic      = "qubic";
+const char *const kGameIdReversi    = "reversi";
+const char *const kGameIdTicTacToe  = "tictactoe";
+const char *const kGameIdUltimate   = "ultimate";
+
+// all of the above, sorted
+const std::vector<std::string> &gameIds();
+
+// id-WxH-K
+std::string sizedGameId(const std::string &id, int width, int height, int k);
+// splits a sized id back up, false if text isn't one
+bool        parseSizedGameId(const std::string &text, std::string &id, int &width, int &height, int &k);
@@ -0,0 +1,304 @@
+#include "GameRecord.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+//
+// on-disk layout: a fixed header, then records back to back. each record is
+//
+//   varint  length of the rest of the record
+//   u8      flags (kRecordMoveTimes)
+//   u8      game id length, then the id
+//   u8      width, u8 height
+//   u8      result: 0 draw, 1 first player, 2 second player
+//   u8      engine name length, then the name, for each engine
+//   varint  seed, start time, duration, search time of each side
+//   varint  plies
+//   varint  bytes of moves, then a varint per move
+//   varint  per move search time, only with kRecordMoveTimes
+//
+struct GameRecordHeader
+{
+    char        magic[4];
+    uint32_t    version;
+    uint64_t    reserved;
+};
+
+static const char       kGameRecordMagic[4] = { 'G', 'R', 'E', 'C' };
+static const uint32_t   kGameRecordVersion = 1;
+
+static const uint8_t    kRecordMoveTimes = 1;
+
+// names longer than a length byte can say get cut
+static const size_t     kMaxNameLength = 255;
+
+static void putVarint(std::vector<uint8_t> &bytes, uint64_t value)
+{
+    while (value >= 0x80) {
+        bytes.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t)value);
+}
+
+static void putName(std::vector<uint8_t> &bytes, const std::string &name)
+{
+    size_t length = name.size() < kMaxNameLength ? name.size() : kMaxNameLength;
+    bytes.push_back((uint8_t)length);
+    bytes.insert(bytes.end(), name.begin(), name.begin() + length);
+}
+
+// false if the varint runs off the end or past 64 bits
+static bool getVarint(const uint8_t *&at, const uint8_t *end, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (at >= end) {
+            return false;
+        }
+        uint8_t byte = *at++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool getName(const uint8_t *&at, const uint8_t *end, std::string_view &name)
+{
+    if (at >= end || *at > end - at - 1) {
+        return false;
+    }
+    size_t length = *at++;
+    name = std::string_view((const char *)at, length);
+    at += length;
+    return true;
+}
+
+GameRecordWriter::GameRecordWriter()
+{
+    _file = nullptr;
+    _gamesWritten = 0;
+}
+
+GameRecordWriter::~GameRecordWriter()
+{
+    close();
+}
+
+bool GameRecordWriter::open(const std::string &path)
+{
+    close();
+
+    // a log that is already there has to be one of ours before anything goes on the end of it
+    GameRecordHeader header;
+    bool exists = false;
+    if (FILE *existing = fopen(path.c_str(), "rb")) {
+        size_t got = fread(&header, 1, sizeof(header), existing);
+        fclose(existing);
+        if (got > 0) {
+            if (got != sizeof(header) || memcmp(header.magic, kGameRecordMagic, sizeof(header.magic)) != 0 ||
+                header.version != kGameRecordVersion) {
+                std::cerr << "GameRecord: " << path << " is not a game log" << std::endl;
+                return false;
+            }
+            exists = true;
+        }
+    }
+
+    _file = fopen(path.c_str(), "ab");
+    if (!_file) {
+        return false;
+    }
+    if (!exists) {
+        memcpy(header.magic, kGameRecordMagic, sizeof(header.magic));
+        header.version = kGameRecordVersion;
+        header.reserved = 0;
+        if (fwrite(&header, sizeof(header), 1, _file) != 1 || fflush(_file) != 0) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void GameRecordWriter::close()
+{
+    if (_file) {
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+void GameRecordWriter::encode(const GameRecord &record, std::vector<uint8_t> &bytes)
+{
+    // a game of random moves has nothing worth timing
+    bool moveTimes = record.moveMicros.size() == record.moves.size() &&
+                     std::any_of(record.moveMicros.begin(), record.moveMicros.end(), [](uint32_t micros) { return micros != 0; });
+
+    std::vector<uint8_t> moves;
+    for (uint32_t move : record.moves) {
+        putVarint(moves, move);
+    }
+
+    std::vector<uint8_t> body;
+    body.push_back(moveTimes ? kRecordMoveTimes : 0);
+    putName(body, record.gameId);
+    body.push_back((uint8_t)record.width);
+    body.push_back((uint8_t)record.height);
+    body.push_back((uint8_t)(record.winner < 0 ? 0 : record.winner + 1));
+    putName(body, record.engines[0]);
+    putName(body, record.engines[1]);
+    putVarint(body, record.seed);
+    putVarint(body, record.startTime);
+    putVarint(body, record.durationMicros);
+    putVarint(body, record.searchMicros[0]);
+    putVarint(body, record.searchMicros[1]);
+    putVarint(body, record.moves.size());
+    putVarint(body, moves.size());
+    body.insert(body.end(), moves.begin(), moves.end());
+    if (moveTimes) {
+        for (uint32_t micros : record.moveMicros) {
+            putVarint(body, micros);
+        }
+    }
+
+    bytes.clear();
+    putVarint(bytes, body.size());
+    bytes.insert(bytes.end(), body.begin(), body.end());
+}
+
+bool GameRecordWriter::append(const GameRecord &record)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (!_file) {
+        return false;
+    }
+    // one write per record, so a crash can only ever cut the last one short
+    encode(record, _buffer);
+    if (fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size() || fflush(_file) != 0) {
+        return false;
+    }
+    _gamesWritten++;
+    return true;
+}
+
+bool GameRecordCursor::next(uint32_t &value)
+{
+    uint64_t wide;
+    if (_at >= _end || !getVarint(_at, _end, wide)) {
+        return false;
+    }
+    value = (uint32_t)wide;
+    return true;
+}
+
+void GameRecordView::decodeMoves(std::vector<uint32_t> &list) const
+{
+    list.clear();
+    list.reserve(plies);
+    GameRecordCursor cursor = moves();
+    uint32_t move;
+    while (cursor.next(move)) {
+        list.push_back(move);
+    }
+}
+
+GameRecordReader::GameRecordReader()
+{
+    _position = 0;
+    _damaged = false;
+}
+
+GameRecordReader::~GameRecordReader()
+{
+    close();
+}
+
+bool GameRecordReader::open(const std::string &path)
+{
+    close();
+    // logs are read front to back, let the system read ahead
+    if (!_file.open(path, true)) {
+        return false;
+    }
+    const GameRecordHeader *header = (const GameRecordHeader *)_file.data();
+    if (_file.size() < sizeof(GameRecordHeader) || memcmp(header->magic, kGameRecordMagic, sizeof(header->magic)) != 0 ||
+        header->version != kGameRecordVersion) {
+        std::cerr << "GameRecord: " << path << " is not a game log" << std::endl;
+        close();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void GameRecordReader::close()
+{
+    _file.close();
+    _position = 0;
+    _damaged = false;
+}
+
+void GameRecordReader::rewind()
+{
+    _position = sizeof(GameRecordHeader);
+    _damaged = false;
+}
+
+bool GameRecordReader::read(uint64_t offset, GameRecordView &view) const
+{
+    if (!_file.isOpen() || offset < sizeof(GameRecordHeader) || offset >= _file.size()) {
+        return false;
+    }
+    const uint8_t *at = _file.data() + offset;
+    const uint8_t *fileEnd = _file.data() + _file.size();
+    uint64_t length;
+    if (!getVarint(at, fileEnd, length) || length > (uint64_t)(fileEnd - at)) {
+        return false;
+    }
+    const uint8_t *end = at + length;
+
+    if (end - at < 1) {
+        return false;
+    }
+    uint8_t flags = *at++;
+    if (!getName(at, end, view.gameId) || end - at < 3) {
+        return false;
+    }
+    view.width = *at++;
+    view.height = *at++;
+    view.winner = (int)*at++ - 1;
+    if (!getName(at, end, view.engines[0]) || !getName(at, end, view.engines[1])) {
+        return false;
+    }
+    uint64_t plies, moveBytes;
+    if (!getVarint(at, end, view.seed) || !getVarint(at, end, view.startTime) || !getVarint(at, end, view.durationMicros) ||
+        !getVarint(at, end, view.searchMicros[0]) || !getVarint(at, end, view.searchMicros[1]) ||
+        !getVarint(at, end, plies) || !getVarint(at, end, moveBytes) || moveBytes > (uint64_t)(end - at)) {
+        return false;
+    }
+    view.plies = (int)plies;
+    view.offset = offset;
+    view._moves = at;
+    view._movesEnd = at + moveBytes;
+    view.hasMoveTimes = (flags & kRecordMoveTimes) != 0;
+    view._times = view.hasMoveTimes ? view._movesEnd : end;
+    view._timesEnd = end;
+    return true;
+}
+
+bool GameRecordReader::next(GameRecordView &view)
+{
+    if (!_file.isOpen() || _position >= _file.size()) {
+        return false;
+    }
+    if (!read(_position, view)) {
+        _damaged = true;
+        return false;
+    }
+    _position = (uint64_t)(view._timesEnd - _file.data());
+    return true;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+//
+// binary game logs
+//
+// a log is a small file header followed by one record per game, appended as
+// games finish and never rewritten. a record starts with its own length as a
+// varint so a reader can step over it without decoding anything, then holds
+// the game id and board size, the result, both engines, the seed, the timings
+// and the move list. numbers are LEB128 varints (seven bits a byte, low bits
+// first) so a typical move takes a single byte or two.
+//
+// the reader maps the whole file and hands out views into it, nothing is
+// copied until the caller asks for a move. a record cut short by a crash
+// while it was being written ends the log there.
+//
+
+// one finished game, for writing
+struct GameRecord
+{
+    std::string gameId;
+    int         width = 0;
+    int         height = 0;
+    // 0 or 1, -1 for a draw
+    int         winner = -1;
+    // engine 0 moved first
+    std::string engines[2];
+    uint64_t    seed = 0;
+    // unix time the game started
+    uint64_t    startTime = 0;
+    uint64_t    durationMicros = 0;
+    uint64_t    searchMicros[2] = { 0, 0 };
+    // moves as the game's own ints (see SelfPlayGame)
+    std::vector<uint32_t>   moves;
+    // search time of each move, left out of the log when empty or all 0
+    std::vector<uint32_t>   moveMicros;
+};
+
+class GameRecordWriter
+{
+public:
+    GameRecordWriter();
+    ~GameRecordWriter();
+
+    // creates the log or appends to one already there, false if path can't be
+    // written or holds something other than a game log
+    bool        open(const std::string &path);
+    void        close();
+    bool        isOpen() const { return _file != nullptr; }
+
+    // writes the whole record at once and flushes it, safe from any thread
+    bool        append(const GameRecord &record);
+
+    uint64_t    gamesWritten() const { return _gamesWritten; }
+
+    // the bytes append() writes for a record, length prefix included
+    static void encode(const GameRecord &record, std::vector<uint8_t> &bytes);
+
+private:
+    FILE                    *_file;
+    std::mutex              _lock;
+    std::vector<uint8_t>    _buffer;
+    uint64_t                _gamesWritten;
+};
+
+// a varint stream of moves or move times inside a mapped log
+class GameRecordCursor
+{
+public:
+    GameRecordCursor() : _at(nullptr), _end(nullptr) {}
+    GameRecordCursor(const uint8_t *at, const uint8_t *end) : _at(at), _end(end) {}
+
+    // false once the stream is used up
+    bool        next(uint32_t &value);
+
+private:
+    const uint8_t   *_at;
+    const uint8_t   *_end;
+};
+
+// one game inside a mapped log, only valid while the reader keeps it open
+struct GameRecordView
+{
+    std::string_view    gameId;
+    int                 width = 0;
+    int                 height = 0;
+    int                 winner = -1;
+    std::string_view    engines[2];
+    uint64_t            seed = 0;
+    uint64_t            startTime = 0;
+    uint64_t            durationMicros = 0;
+    uint64_t            searchMicros[2] = { 0, 0 };
+    int                 plies = 0;
+    bool                hasMoveTimes = false;
+    // where the record starts in the file, for coming back to it later
+    uint64_t            offset = 0;
+
+    GameRecordCursor    moves() const { return GameRecordCursor(_moves, _movesEnd); }
+    // empty unless hasMoveTimes
+    GameRecordCursor    moveMicros() const { return GameRecordCursor(_times, _timesEnd); }
+    // copies the moves out
+    void                decodeMoves(std::vector<uint32_t> &moves) const;
+
+    const uint8_t       *_moves = nullptr;
+    const uint8_t       *_movesEnd = nullptr;
+    const uint8_t       *_times = nullptr;
+    const uint8_t       *_timesEnd = nullptr;
+};
+
+class GameRecordReader
+{
+public:
+    GameRecordReader();
+    ~GameRecordReader();
+
+    // memory map a log, it stays mapped until close()
+    bool        open(const std::string &path);
+    void        close();
+    bool        isOpen() const { return _file.isOpen(); }
+
+    // the next game, false at the end of the log or at a record that doesn't
+    // decode (see damaged())
+    bool        next(GameRecordView &view);
+    // the game whose record starts at offset, from an earlier view
+    bool        read(uint64_t offset, GameRecordView &view) const;
+    void        rewind();
+
+    // true if next() stopped short of the end of the file
+    bool        damaged() const { return _damaged; }
+    uint64_t    size() const { return _file.size(); }
+
+private:
+    MappedFile      _file;
+    uint64_t        _position;
+    bool            _damaged;
+};
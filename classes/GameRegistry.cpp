@@ -0,0 +1,42 @@
+#include "GameRegistry.h"
+
+#include <algorithm>
+
+//
+// a function static so registrations from other files' static initializers
+// never find it unconstructed, whatever order those files are initialized in
+//
+static std::vector<GameInfo> &registeredGames()
+{
+    static std::vector<GameInfo> games;
+    return games;
+}
+
+void GameRegistry::add(const GameInfo &info)
+{
+    std::vector<GameInfo> &games = registeredGames();
+    auto position = std::upper_bound(games.begin(), games.end(), info, [](const GameInfo &a, const GameInfo &b) { return a.name < b.name; });
+    games.insert(position, info);
+}
+
+const std::vector<GameInfo> &GameRegistry::games()
+{
+    return registeredGames();
+}
+
+const GameInfo *GameRegistry::find(const std::string &id)
+{
+    int index = indexOf(id);
+    return index < 0 ? nullptr : &registeredGames()[index];
+}
+
+int GameRegistry::indexOf(const std::string &id)
+{
+    const std::vector<GameInfo> &games = registeredGames();
+    for (size_t i = 0; i < games.size(); i++) {
+        if (games[i].id == id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class Game;
+
+//
+// every game the program can play, with what the settings window needs to know about it
+//
+// each game registers itself from its own .cpp with a static GameRegistration,
+// so a new game only has to be added to the build. registering stores a factory
+// and the metadata, nothing is constructed until a game is picked.
+//
+
+// board size for games that can change it, the rest ignore it
+struct GameSetup
+{
+    int     width = 3;
+    int     height = 3;
+    int     lineLength = 3;
+};
+
+struct GameInfo
+{
+    // short name for the command line, "connect4"
+    std::string id;
+    // shown in the game picker
+    std::string name;
+    // default board size in squares
+    int         boardWidth = 0;
+    int         boardHeight = 0;
+    int         players = 2;
+    bool        hasAI = false;
+    // what kind of search the AI is, empty without one
+    std::string ai;
+    // width, height and line length in GameSetup are used, from 3 up to maxSize
+    bool        resizable = false;
+    int         maxSize = 0;
+    Game        *(*create)(const GameSetup &setup) = nullptr;
+};
+
+class GameRegistry
+{
+public:
+    static void     add(const GameInfo &info);
+    // sorted by name
+    static const std::vector<GameInfo> &games();
+    // nullptr for an id nobody registered
+    static const GameInfo *find(const std::string &id);
+    // position in games(), -1 if there is no such game
+    static int      indexOf(const std::string &id);
+};
+
+struct GameRegistration
+{
+    GameRegistration(const GameInfo &info) { GameRegistry::add(info); }
+};
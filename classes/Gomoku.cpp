@@ -0,0 +1,200 @@
+#include "Gomoku.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+
+const int AI_PLAYER   = 1;      // index of the AI player (O)
+const int HUMAN_PLAYER= 0;      // index of the human player (X)
+
+// how long the AI may think about one move before it plays its best guess
+const double AI_TIME_BUDGET = 1.0;
+
+// 15 squares a side have to fit in the window
+const float CELL_SIZE = 44.0f;
+
+static GameRegistration registration({
+    .id = kGameIdGomoku, .name = "Gomoku", .boardWidth = 15, .boardHeight = 15, .players = 2,
+    .hasAI = true, .ai = "threat space (VCF) search, then alpha-beta",
+    .create = [](const GameSetup &) -> Game * { return new Gomoku(); },
+});
+
+Gomoku::Gomoku()
+{
+    _search.setTimeBudget(AI_TIME_BUDGET);
+}
+
+Gomoku::~Gomoku()
+{
+}
+
+//
+// X for the first player, O for the second
+//
+Bit* Gomoku::PieceForPlayer(const int playerNumber)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(playerNumber == 0 ? "x.png" : "o.png");
+    bit->setSize(CELL_SIZE, CELL_SIZE);
+    bit->setOwner(getPlayerAt(playerNumber));
+    return bit;
+}
+
+void Gomoku::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = GomokuBoard::kSize;
+    _gameOptions.rowY = GomokuBoard::kSize;
+
+    // no limit means search until the time budget runs out
+    if (_gameOptions.AIMAXDepth <= 0) {
+        _gameOptions.AIMAXDepth = GomokuBoard::kCells;
+    }
+
+    setAIPlayer(AI_PLAYER);
+
+    for (int y = 0; y < GomokuBoard::kSize; y++) {
+        for (int x = 0; x < GomokuBoard::kSize; x++) {
+            ImVec2 position(x * CELL_SIZE + 50.0f, y * CELL_SIZE + 50.0f);
+            _grid[y][x].initHolder(position, "square.png", x, y);
+            _grid[y][x].setSize(CELL_SIZE, CELL_SIZE);
+        }
+    }
+    _board = GomokuBoard();
+
+    startGame();
+}
+
+bool Gomoku::actionForEmptyHolder(BitHolder *holder)
+{
+    if (!holder) return false;
+
+    // every holder in this game is one of our squares
+    Square *square = static_cast<Square *>(holder);
+    return playCell(square->row() * GomokuBoard::kSize + square->column());
+}
+
+bool Gomoku::playCell(int cell)
+{
+    if (cell < 0 || cell >= GomokuBoard::kCells) return false;
+    if (_board.isOver() || !_board.isEmpty(cell)) return false;
+
+    Player *currentPlayer = getCurrentPlayer();
+    if (!currentPlayer) return false;
+
+    Square &square = squareFor(cell);
+    Bit *newBit = PieceForPlayer(currentPlayer->playerNumber());
+    newBit->moveTo(square.getPosition());
+    square.setBit(newBit);
+    _board.play(cell);
+
+    Player *winner = checkForWinner();
+    if (winner) {
+        _winner = winner;
+    }
+    return true;
+}
+
+bool Gomoku::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    // stones stay where they were put
+    return false;
+}
+
+bool Gomoku::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    return false;
+}
+
+void Gomoku::stopGame()
+{
+    for (int y = 0; y < GomokuBoard::kSize; y++) {
+        for (int x = 0; x < GomokuBoard::kSize; x++) {
+            _grid[y][x].destroyBit();
+        }
+    }
+    _board = GomokuBoard();
+}
+
+Player* Gomoku::checkForWinner()
+{
+    int winner = _board.winner();
+    return winner >= 0 ? getPlayerAt(winner) : nullptr;
+}
+
+bool Gomoku::checkForDraw()
+{
+    return _board.isFull() && _board.winner() < 0;
+}
+
+//
+// state strings, one character per cell row by row from the top, 0 empty, 1 X, 2 O
+//
+std::string Gomoku::initialStateString()
+{
+    return std::string(GomokuBoard::kCells, '0');
+}
+
+std::string Gomoku::stateString() const
+{
+    std::string state;
+    for (int cell = 0; cell < GomokuBoard::kCells; cell++) {
+        state += (char)('1' + _board.ownerAt(cell));
+    }
+    return state;
+}
+
+void Gomoku::setStateString(const std::string &s)
+{
+    uint8_t stones[GomokuBoard::kCells] = {};
+
+    for (int cell = 0; cell < GomokuBoard::kCells; cell++) {
+        Square &square = squareFor(cell);
+        int playerNumber = cell < (int)s.size() ? s[cell] - '0' : 0;
+
+        square.destroyBit();
+        if (playerNumber == 1 || playerNumber == 2) {
+            Bit *bit = PieceForPlayer(playerNumber - 1);
+            bit->moveTo(square.getPosition());
+            square.setBit(bit);
+            stones[cell] = (uint8_t)playerNumber;
+        }
+    }
+    _board.setStones(stones);
+}
+
+void Gomoku::updateAI()
+{
+    if (_board.isOver()) {
+        return;
+    }
+
+    int symmetry;
+    int cell = openingBookMove(canonicalKey(_board, symmetry));
+    if (cell >= 0) {
+        cell = mapSquare(cell, GomokuBoard::kSize, symmetry, true);
+        if (playCell(cell)) {
+            _lastStats.setBookMove(cell);
+            _lastStats.logMove("gomoku 15x15", (int)getCurrentTurnNo());
+            endTurn();
+            return;
+        }
+    }
+
+    _search.setTimeBudget(searchTimeBudget(AI_TIME_BUDGET));
+    cell = _search.findBestMove(_board, _gameOptions.AIMAXDepth);
+    _lastStats = _search.stats();
+    _lastStats.logMove("gomoku 15x15", (int)getCurrentTurnNo());
+
+    if (playCell(cell)) {
+        endTurn();
+    }
+}
+
+bool Gomoku::playRecordedMove(int move)
+{
+    if (!playCell(move)) {
+        return false;
+    }
+    endTurn();
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Game.h"
+#include "Square.h"
+#include "GomokuBoard.h"
+#include "GomokuSearch.h"
+
+//
+// gomoku, five in a row on a 15x15 board
+//
+// freestyle rules: six or more in a row also wins and there are no restricted
+// moves for the first player. the AI plays O.
+//
+class Gomoku : public Game
+{
+public:
+    Gomoku();
+    ~Gomoku();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    // 225 cells row by row from the top, 0 empty, 1 X, 2 O
+    std::string stateString() const override;
+    void        setStateString(const std::string &s) override;
+    bool        actionForEmptyHolder(BitHolder *holder) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        playRecordedMove(int move) override;
+    bool        gameHasAI() override { return true; }
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+
+    const SearchStats *searchStats() const override { return &_lastStats; }
+
+private:
+    Bit *       PieceForPlayer(const int playerNumber);
+    Square      &squareFor(int cell) { return _grid[cell / GomokuBoard::kSize][cell % GomokuBoard::kSize]; }
+    bool        playCell(int cell);
+
+    Square          _grid[GomokuBoard::kSize][GomokuBoard::kSize];
+    GomokuBoard     _board;
+    GomokuSearch    _search;
+
+    // what the last AI move cost
+    SearchStats     _lastStats;
+};
@@ -0,0 +1,374 @@
+#include "GomokuBoard.h"
+
+#include <cstring>
+#include <vector>
+
+const GomokuPatternTable gomokuPatternTable;
+
+// what each line pattern is worth to the player who would make it
+static const int patternValues[kGomokuPatternCount] = { 0, 2, 5, 8, 30, 35, 400, 10000 };
+
+// extra for threats that are more than the sum of their lines
+static const int threatBonus[kThreatCount] = { 0, 0, 150, 0, 300, 600, 0 };
+
+// a line of 9 cells with the cell being looked at in the middle, 0 empty, 1 own, 2 blocked
+static const int LINE_CENTER = 4;
+
+static void decodeLine(int key, uint8_t line[9])
+{
+    int j = 0;
+    for (int i = 0; i < 9; i++) {
+        if (i == LINE_CENTER) {
+            line[i] = 1;
+        } else {
+            line[i] = (key >> (2 * j++)) & 3;
+        }
+    }
+}
+
+static int encodeLine(const uint8_t line[9])
+{
+    int key = 0;
+    int j = 0;
+    for (int i = 0; i < 9; i++) {
+        if (i != LINE_CENTER) {
+            key |= line[i] << (2 * j++);
+        }
+    }
+    return key;
+}
+
+// five own stones in a row through the middle
+static bool hasFive(const uint8_t line[9])
+{
+    for (int start = 0; start <= LINE_CENTER; start++) {
+        bool five = true;
+        for (int i = start; i < start + 5; i++) {
+            five = five && line[i] == 1;
+        }
+        if (five) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+// a pattern is defined by what one more stone on the line can turn it into:
+// a four has one cell that makes five, an open four two, an open three can
+// become an open four, a three a four, and so on down
+//
+static uint8_t classifyLine(int key, std::vector<int8_t> &known)
+{
+    if (known[key] >= 0) {
+        return (uint8_t)known[key];
+    }
+    uint8_t line[9];
+    decodeLine(key, line);
+
+    uint8_t pattern = kGomokuNone;
+    if (hasFive(line)) {
+        pattern = kGomokuFive;
+    } else {
+        int fivePoints = 0;
+        for (int i = 0; i < 9; i++) {
+            if (line[i] == 0) {
+                line[i] = 1;
+                fivePoints += hasFive(line) ? 1 : 0;
+                line[i] = 0;
+            }
+        }
+        if (fivePoints >= 2) {
+            pattern = kGomokuOpenFour;
+        } else if (fivePoints == 1) {
+            pattern = kGomokuFour;
+        } else {
+            for (int i = 0; i < 9; i++) {
+                if (line[i] != 0) {
+                    continue;
+                }
+                line[i] = 1;
+                uint8_t next = classifyLine(encodeLine(line), known);
+                line[i] = 0;
+
+                uint8_t becomes = kGomokuNone;
+                if (next == kGomokuOpenFour) becomes = kGomokuOpenThree;
+                else if (next == kGomokuFour) becomes = kGomokuThree;
+                else if (next == kGomokuOpenThree) becomes = kGomokuOpenTwo;
+                else if (next == kGomokuThree) becomes = kGomokuTwo;
+                if (becomes > pattern) {
+                    pattern = becomes;
+                }
+            }
+        }
+    }
+    known[key] = (int8_t)pattern;
+    return pattern;
+}
+
+GomokuPatternTable::GomokuPatternTable()
+{
+    std::vector<int8_t> known(1 << 16, -1);
+    for (int key = 0; key < (1 << 16); key++) {
+        // 3 isn't a cell value, those keys never come up
+        bool valid = true;
+        for (int j = 0; j < 8; j++) {
+            valid = valid && ((key >> (2 * j)) & 3) != 3;
+        }
+        patterns[key] = valid ? classifyLine(key, known) : (uint8_t)kGomokuNone;
+    }
+
+    // splitmix64 with a fixed seed so keys are the same every run
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int player = 0; player < 2; player++) {
+        for (int cell = 0; cell < 225; cell++) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            zobrist[player][cell] = z ^ (z >> 31);
+        }
+    }
+}
+
+//
+// the strongest thing a stone here does, from its four line patterns
+//
+static uint8_t combineThreat(const uint8_t patterns[4])
+{
+    int fours = 0;
+    int openThrees = 0;
+    for (int d = 0; d < 4; d++) {
+        switch (patterns[d]) {
+            case kGomokuFive:       return kThreatFive;
+            case kGomokuOpenFour:   fours += 2; break;
+            case kGomokuFour:       fours++; break;
+            case kGomokuOpenThree:  openThrees++; break;
+            default:                break;
+        }
+    }
+    if (fours >= 2) return kThreatOpenFour;
+    if (fours == 1) return openThrees ? kThreatFourThree : kThreatFour;
+    if (openThrees >= 2) return kThreatDoubleThree;
+    if (openThrees == 1) return kThreatThree;
+    return kThreatNone;
+}
+
+GomokuBoard::GomokuBoard()
+{
+    uint8_t empty[kCells] = {};
+    setStones(empty);
+}
+
+void GomokuBoard::setStones(const uint8_t stones[kCells])
+{
+    memset(_stones, kOutside, sizeof(_stones));
+    memset(_patterns, 0, sizeof(_patterns));
+    memset(_threats, 0, sizeof(_threats));
+    memset(_near, 0, sizeof(_near));
+    memset(_threatCounts, 0, sizeof(_threatCounts));
+    _key = 0;
+    _moves = 0;
+    _winner = -1;
+
+    for (int cell = 0; cell < kCells; cell++) {
+        int index = inside(cell);
+        _stones[index] = kEmpty;
+        if (stones[cell] == 1 || stones[cell] == 2) {
+            int player = stones[cell] - 1;
+            _stones[index] = (uint8_t)(kFirst + player);
+            _key ^= gomokuPatternTable.zobrist[player][cell];
+            _moves++;
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    _near[index + dy * kStride + dx]++;
+                }
+            }
+        }
+    }
+    for (int cell = 0; cell < kCells; cell++) {
+        refresh(inside(cell), -1);
+    }
+
+    // five in a row already on the board
+    for (int cell = 0; cell < kCells && _winner < 0; cell++) {
+        int index = inside(cell);
+        if (_stones[index] != kFirst && _stones[index] != kSecond) {
+            continue;
+        }
+        for (int d = 0; d < 4; d++) {
+            int run = 1;
+            while (run < 5 && _stones[index + run * kSteps[d]] == _stones[index]) {
+                run++;
+            }
+            if (run == 5) {
+                _winner = _stones[index] - kFirst;
+            }
+        }
+    }
+}
+
+void GomokuBoard::setThreat(int player, int index, uint8_t threat)
+{
+    uint8_t &current = _threats[player][index];
+    if (current != threat) {
+        _threatCounts[player][current]--;
+        _threatCounts[player][threat]++;
+        current = threat;
+    }
+}
+
+void GomokuBoard::refresh(int index, int direction)
+{
+    if (_stones[index] != kEmpty) {
+        for (int player = 0; player < 2; player++) {
+            memset(_patterns[player][index], kGomokuNone, 4);
+            setThreat(player, index, kThreatNone);
+        }
+        return;
+    }
+
+    // the 2-bit code of each stone for the first player and for the second
+    static const uint8_t firstCodes[4] = { 0, 1, 2, 2 };
+    static const uint8_t secondCodes[4] = { 0, 2, 1, 2 };
+
+    int first = direction < 0 ? 0 : direction;
+    int last = direction < 0 ? 3 : direction;
+    for (int d = first; d <= last; d++) {
+        int step = kSteps[d];
+        int keys[2] = { 0, 0 };
+        int shift = 0;
+        for (int i = -4; i <= 4; i++) {
+            if (i == 0) {
+                continue;
+            }
+            uint8_t stone = _stones[index + i * step];
+            keys[0] |= firstCodes[stone] << shift;
+            keys[1] |= secondCodes[stone] << shift;
+            shift += 2;
+        }
+        _patterns[0][index][d] = gomokuPatternTable.patterns[keys[0]];
+        _patterns[1][index][d] = gomokuPatternTable.patterns[keys[1]];
+    }
+    setThreat(0, index, combineThreat(_patterns[0][index]));
+    setThreat(1, index, combineThreat(_patterns[1][index]));
+}
+
+//
+// a stone changes what the cells up to 4 away along its lines can make
+//
+void GomokuBoard::refreshAround(int index)
+{
+    refresh(index, -1);
+    for (int d = 0; d < 4; d++) {
+        int step = kSteps[d];
+        for (int i = -4; i <= 4; i++) {
+            int other = index + i * step;
+            if (i != 0 && _stones[other] != kOutside) {
+                refresh(other, d);
+            }
+        }
+    }
+}
+
+void GomokuBoard::play(int cell)
+{
+    int index = inside(cell);
+    int player = currentPlayer();
+    if (_threats[player][index] == kThreatFive) {
+        _winner = player;
+    }
+    _stones[index] = (uint8_t)(kFirst + player);
+    _key ^= gomokuPatternTable.zobrist[player][cell];
+    for (int dy = -2; dy <= 2; dy++) {
+        for (int dx = -2; dx <= 2; dx++) {
+            _near[index + dy * kStride + dx]++;
+        }
+    }
+    refreshAround(index);
+    _moves++;
+}
+
+void GomokuBoard::undo(int cell)
+{
+    _moves--;
+    int index = inside(cell);
+    int player = currentPlayer();
+    _stones[index] = kEmpty;
+    _key ^= gomokuPatternTable.zobrist[player][cell];
+    for (int dy = -2; dy <= 2; dy++) {
+        for (int dx = -2; dx <= 2; dx++) {
+            _near[index + dy * kStride + dx]--;
+        }
+    }
+    refreshAround(index);
+    // a won game ends, so only the move being taken back can have won it
+    _winner = -1;
+}
+
+int GomokuBoard::threatCount(int player, GomokuThreat threat) const
+{
+    int count = 0;
+    for (int t = threat; t < kThreatCount; t++) {
+        count += _threatCounts[player][t];
+    }
+    return count;
+}
+
+int GomokuBoard::threatCells(int player, GomokuThreat threat, int *cells, int max) const
+{
+    int count = 0;
+    for (int cell = 0; cell < kCells && count < max; cell++) {
+        int index = inside(cell);
+        if (_stones[index] == kEmpty && _threats[player][index] >= threat) {
+            cells[count++] = cell;
+        }
+    }
+    return count;
+}
+
+int GomokuBoard::candidates(int *cells) const
+{
+    if (_moves == 0) {
+        cells[0] = (kSize / 2) * kSize + kSize / 2;
+        return 1;
+    }
+    int count = 0;
+    for (int cell = 0; cell < kCells; cell++) {
+        int index = inside(cell);
+        if (_stones[index] == kEmpty && _near[index]) {
+            cells[count++] = cell;
+        }
+    }
+    return count;
+}
+
+int GomokuBoard::moveValue(int player, int cell) const
+{
+    int index = inside(cell);
+    const uint8_t *patterns = _patterns[player][index];
+    return patternValues[patterns[0]] + patternValues[patterns[1]] + patternValues[patterns[2]] + patternValues[patterns[3]] +
+           threatBonus[_threats[player][index]];
+}
+
+//
+// what both sides could make on the cells around the stones, plus the best single
+// move for the side to move since it gets to play first
+//
+int GomokuBoard::evaluate() const
+{
+    int me = currentPlayer();
+    int score = 0;
+    int best = 0;
+    for (int cell = 0; cell < kCells; cell++) {
+        int index = inside(cell);
+        if (_stones[index] != kEmpty || !_near[index]) {
+            continue;
+        }
+        int mine = moveValue(me, cell);
+        score += mine - moveValue(1 - me, cell);
+        if (mine > best) {
+            best = mine;
+        }
+    }
+    return score + best;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// 15x15 five in a row (gomoku, freestyle: six or more also wins)
+//
+// the board keeps, for every empty cell, both players and all four directions,
+// what kind of line a stone there would make: five, open four, four, open three
+// and so on. the line is read as the 8 cells around the cell, 2 bits each (empty,
+// own stone, or blocked by the other player or the edge), and that 16-bit pattern
+// is looked up in a table worked out once at startup. a move only changes the
+// patterns of the cells within 4 of it along its four lines, so those are the
+// only ones looked up again.
+//
+// the patterns of a cell are then combined into one threat (a five, an open four
+// or two fours, a four with an open three...) and the board counts how many cells
+// of each threat each player has, so "can the opponent win next move" is a lookup.
+//
+// inside, the board has a wall of 4 cells around it so reading a line never needs
+// a bounds check. outside, a cell is row * 15 + column.
+//
+
+enum GomokuPattern : uint8_t
+{
+    kGomokuNone,
+    kGomokuTwo,             // can become a three
+    kGomokuOpenTwo,         // can become an open three
+    kGomokuThree,           // can become a four
+    kGomokuOpenThree,       // can become an open four
+    kGomokuFour,            // one cell away from five
+    kGomokuOpenFour,        // two different cells make five, can't be stopped
+    kGomokuFive,
+    kGomokuPatternCount
+};
+
+// the patterns of one cell's four lines put together, strongest last
+enum GomokuThreat : uint8_t
+{
+    kThreatNone,
+    kThreatThree,           // one open three
+    kThreatDoubleThree,     // two open threes
+    kThreatFour,            // one four, the opponent has to answer it
+    kThreatFourThree,       // a four and an open three
+    kThreatOpenFour,        // an open four or two fours, wins unless the opponent has a five first
+    kThreatFive,
+    kThreatCount
+};
+
+struct GomokuPatternTable
+{
+    GomokuPatternTable();
+
+    // pattern of the 8 cells around a cell (2 bits each: 0 empty, 1 own, 2 blocked)
+    uint8_t     patterns[1 << 16];
+    // random keys for the transposition tables
+    uint64_t    zobrist[2][225];
+};
+
+extern const GomokuPatternTable gomokuPatternTable;
+
+class GomokuBoard
+{
+public:
+    static const int kSize = 15;
+    static const int kCells = kSize * kSize;
+
+    GomokuBoard();
+
+    // place a stone for the player to move
+    void        play(int cell);
+    // take back the last move, which was made on cell
+    void        undo(int cell);
+    // set up any position from a stone list (0 empty, 1 first player, 2 second), the player to move follows from the counts
+    void        setStones(const uint8_t stones[kCells]);
+
+    int         moves() const { return _moves; }
+    // zero based number of the player to move, player 0 always starts
+    int         currentPlayer() const { return _moves & 1; }
+    // -1 if empty, otherwise the player
+    int         ownerAt(int cell) const { return _stones[inside(cell)] - 1; }
+    bool        isEmpty(int cell) const { return _stones[inside(cell)] == kEmpty; }
+    int         winner() const { return _winner; }
+    bool        isFull() const { return _moves == kCells; }
+    bool        isOver() const { return _winner >= 0 || isFull(); }
+    uint64_t    key() const { return _key; }
+
+    GomokuPattern   pattern(int player, int cell, int direction) const { return (GomokuPattern)_patterns[player][inside(cell)][direction]; }
+    GomokuThreat    threat(int player, int cell) const { return (GomokuThreat)_threats[player][inside(cell)]; }
+    // empty cells where player would make at least this threat
+    int         threatCount(int player, GomokuThreat threat) const;
+    // the empty cells where player makes at least threat, returns how many
+    int         threatCells(int player, GomokuThreat threat, int *cells, int max) const;
+
+    // empty cells within two of a stone (the center on an empty board), returns how many
+    int         candidates(int *cells) const;
+    // how good a stone on cell is for player, from its four line patterns
+    int         moveValue(int player, int cell) const;
+    // static score for the player to move
+    int         evaluate() const;
+
+private:
+    static const int kWall = 4;
+    static const int kStride = kSize + 2 * kWall;
+    static const int kPadded = kStride * kStride;
+    // across, down, and the two diagonals
+    static constexpr int kSteps[4] = { 1, kStride, kStride + 1, kStride - 1 };
+    enum : uint8_t { kEmpty = 0, kFirst = 1, kSecond = 2, kOutside = 3 };
+
+    static int  inside(int cell) { return (cell / kSize + kWall) * kStride + cell % kSize + kWall; }
+
+    // look up the patterns of an empty cell again, only along direction or along all of them when it is -1
+    void        refresh(int index, int direction);
+    void        setThreat(int player, int index, uint8_t threat);
+    void        refreshAround(int index);
+
+    uint8_t     _stones[kPadded];
+    uint8_t     _patterns[2][kPadded][4];
+    uint8_t     _threats[2][kPadded];
+    // stones within two cells, an empty cell with any is a candidate move
+    uint8_t     _near[kPadded];
+    int         _threatCounts[2][kThreatCount];
+    uint64_t    _key;
+    int         _moves;
+    int         _winner;
+};
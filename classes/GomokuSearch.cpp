@@ -0,0 +1,284 @@
+#include "GomokuSearch.h"
+
+#include <algorithm>
+
+// larger than any score negamax can return
+const int SCORE_INFINITY = GomokuSearch::kWinScore + 1000;
+
+// scores this close to a win are wins in a known number of plies
+const int SCORE_WIN_BOUND = GomokuSearch::kWinScore - 1000;
+
+// a node ranks every candidate cell, so the clock gets looked at more often than in the other searches
+const uint64_t CLOCK_CHECK_INTERVAL = 1024;
+
+// only the best few candidates are searched, more at the root
+const int SEARCH_WIDTH = 12;
+const int ROOT_WIDTH = 24;
+
+// how long a chain of fours the VCF follows, and how many positions it may look at
+const int VCF_MAX_FOURS = 16;
+const uint64_t VCF_NODE_LIMIT = 200000;
+
+// sorts ahead of any move value
+const int TABLE_MOVE_SCORE = 1 << 30;
+
+GomokuSearch::GomokuSearch() : _table(SCORE_WIN_BOUND), _clock(CLOCK_CHECK_INTERVAL)
+{
+    _solved = false;
+    _vcfNodesLeft = 0;
+    _vcfMove = -1;
+}
+
+void GomokuSearch::clearTable()
+{
+    _table.clear();
+}
+
+int GomokuSearch::orderMoves(const GomokuBoard &board, int *moves, int tableMove, int max) const
+{
+    int cells[GomokuBoard::kCells];
+    int count = board.candidates(cells);
+    int me = board.currentPlayer();
+
+    // making our own lines counts a little more than spoiling theirs
+    std::vector<std::pair<int, int>> scored(count);
+    for (int i = 0; i < count; i++) {
+        int cell = cells[i];
+        int score = cell == tableMove ? TABLE_MOVE_SCORE : board.moveValue(me, cell) * 5 + board.moveValue(1 - me, cell) * 4;
+        scored[i] = { score, cell };
+    }
+    int keep = std::min(count, max);
+    std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                      [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first > b.first; });
+    for (int i = 0; i < keep; i++) {
+        moves[i] = scored[i].second;
+    }
+    return keep;
+}
+
+//
+// the side to move attacks with fours only, the other side blocks each one
+//
+bool GomokuSearch::vcf(GomokuBoard &board, int foursLeft, int ply)
+{
+    _stats.nodes++;
+    if (_vcfNodesLeft == 0) {
+        return false;
+    }
+    _vcfNodesLeft--;
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+
+    int me = board.currentPlayer();
+    int cells[GomokuBoard::kCells];
+    if (board.threatCount(me, kThreatFive)) {
+        board.threatCells(me, kThreatFive, cells, 1);
+        _vcfMove = cells[0];
+        return true;
+    }
+    if (foursLeft <= 0) {
+        return false;
+    }
+
+    // a five for them has to be blocked first, and only a block that makes a four keeps the chain going
+    int theirFives = board.threatCells(1 - me, kThreatFive, cells, 2);
+    int count;
+    if (theirFives >= 2) {
+        return false;
+    } else if (theirFives == 1) {
+        if (board.threat(me, cells[0]) < kThreatFour) {
+            return false;
+        }
+        count = 1;
+    } else {
+        count = board.threatCells(me, kThreatFour, cells, GomokuBoard::kCells);
+    }
+
+    for (int i = 0; i < count; i++) {
+        int move = cells[i];
+        // two fives at once can't both be blocked
+        if (board.threat(me, move) >= kThreatOpenFour) {
+            _vcfMove = move;
+            return true;
+        }
+
+        board.play(move);
+        int block;
+        if (!board.threatCells(me, kThreatFive, &block, 1)) {
+            board.undo(move);
+            continue;
+        }
+        board.play(block);
+        bool won = vcf(board, foursLeft - 1, ply + 2);
+        board.undo(block);
+        board.undo(move);
+        if (won) {
+            _vcfMove = move;
+            return true;
+        }
+    }
+    return false;
+}
+
+int GomokuSearch::findVCF(GomokuBoard &board, int maxFours)
+{
+    _vcfNodesLeft = VCF_NODE_LIMIT;
+    _vcfMove = -1;
+    return vcf(board, maxFours, 0) ? _vcfMove : -1;
+}
+
+int GomokuSearch::negamax(GomokuBoard &board, int alpha, int beta, int ply, int depthLeft)
+{
+    if (_clock.tick(++_stats.nodes)) {
+        return 0;
+    }
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+    if (board.isFull()) {
+        return 0;
+    }
+
+    int me = board.currentPlayer();
+    // a five on the board is taken straight away
+    if (board.threatCount(me, kThreatFive)) {
+        return kWinScore - (ply + 1);
+    }
+    // two fives for them can't both be blocked, one has to be
+    int theirFives = board.threatCount(1 - me, kThreatFive);
+    if (theirFives >= 2) {
+        return -(kWinScore - (ply + 2));
+    }
+    int theirFive = -1;
+    bool forced = theirFives == 1;
+    if (forced) {
+        board.threatCells(1 - me, kThreatFive, &theirFive, 1);
+    }
+    if (depthLeft <= 0 && !forced) {
+        return board.evaluate();
+    }
+
+    uint64_t key = board.key();
+    int tableMove = -1;
+    int tableScore;
+    if (_table.probe(key, depthLeft, alpha, beta, ply, tableMove, tableScore, _stats)) {
+        return tableScore;
+    }
+
+    int moves[SEARCH_WIDTH];
+    int count;
+    if (forced) {
+        // the block is the only move and doesn't count against the depth
+        moves[0] = theirFive;
+        count = 1;
+        depthLeft++;
+    } else {
+        count = orderMoves(board, moves, tableMove, SEARCH_WIDTH);
+    }
+
+    int originalAlpha = alpha;
+    int bestScore = -SCORE_INFINITY;
+    int bestMove = -1;
+    _stats.expanded++;
+
+    for (int i = 0; i < count; i++) {
+        board.play(moves[i]);
+        int score = -negamax(board, -beta, -alpha, ply + 1, depthLeft - 1);
+        board.undo(moves[i]);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = moves[i];
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        if (alpha >= beta) {
+            _stats.cutoffs++;
+            if (i == 0) {
+                _stats.firstMoveCutoffs++;
+            }
+            break;
+        }
+    }
+
+    if (_clock.timeUp()) {
+        return 0;
+    }
+
+    _table.store(key, depthLeft, ply, bestScore, bestMove, originalAlpha, beta);
+    return bestScore;
+}
+
+int GomokuSearch::findBestMove(const GomokuBoard &board, int maxDepth)
+{
+    _clock.start();
+    _solved = false;
+    _stats.reset();
+
+    if (board.isOver()) {
+        return -1;
+    }
+
+    GomokuBoard position = board;
+    int me = position.currentPlayer();
+    int cells[GomokuBoard::kCells];
+
+    // a five, a block, or a chain of fours, none of these need the main search
+    int forcedMove = -1;
+    int forcedScore = 0;
+    if (position.threatCells(me, kThreatFive, cells, 1)) {
+        forcedMove = cells[0];
+        forcedScore = kWinScore - 1;
+    } else if (position.threatCells(1 - me, kThreatFive, cells, 2) == 2) {
+        forcedMove = cells[0];
+        forcedScore = -(kWinScore - 2);
+    } else if (!position.threatCount(1 - me, kThreatFive)) {
+        int move = findVCF(position, VCF_MAX_FOURS);
+        if (move >= 0) {
+            forcedMove = move;
+            forcedScore = kWinScore - _stats.depthReached;
+        }
+    }
+    if (forcedMove >= 0) {
+        _solved = true;
+        _stats.bestMove = forcedMove;
+        _stats.score = forcedScore;
+        _stats.principalVariation.push_back(forcedMove);
+        _stats.seconds = _clock.elapsed();
+        return forcedMove;
+    }
+
+    std::vector<int> candidates;
+    if (position.threatCells(1 - me, kThreatFive, cells, 1)) {
+        candidates.push_back(cells[0]);
+    } else {
+        int count = orderMoves(position, cells, -1, ROOT_WIDTH);
+        candidates.assign(cells, cells + count);
+    }
+
+    int remaining = GomokuBoard::kCells - position.moves();
+    int limit = (maxDepth > 0 && maxDepth < remaining) ? maxDepth : remaining;
+    int bestScore = deepen(candidates.data(), (int)candidates.size(), limit, SCORE_INFINITY, SCORE_WIN_BOUND, _clock, _stats, [&](int cell, int alpha, int depth) {
+        position.play(cell);
+        int score = -negamax(position, -SCORE_INFINITY, -alpha, 1, depth - 1);
+        position.undo(cell);
+        return score;
+    });
+    int bestMove = candidates[0];
+    _solved = bestScore > SCORE_WIN_BOUND || bestScore < -SCORE_WIN_BOUND;
+
+    _stats.seconds = _clock.elapsed();
+    _stats.bestMove = bestMove;
+    _stats.score = bestScore;
+
+    // principal variation out of the table
+    int move = bestMove;
+    while (move >= 0 && position.isEmpty(move) && !position.isOver() && (int)_stats.principalVariation.size() < limit) {
+        _stats.principalVariation.push_back(move);
+        position.play(move);
+        move = _table.move(position.key());
+    }
+    return bestMove;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GomokuBoard.h"
+#include "SearchStats.h"
+#include "SearchTable.h"
+
+//
+// threat search and alpha-beta for gomoku
+//
+// before anything else the search looks for a victory by continuous fours (VCF):
+// a chain of fours the opponent has to block one after another that ends in a
+// five or in two fives at once. that only needs the cells where the board says a
+// four can be made, so it reaches much deeper than the main search.
+//
+// if there is no VCF, an iterative deepening alpha-beta search with a
+// transposition table looks at the best few candidate moves near the stones,
+// ranked by what they make for either side. blocking a five is a forced move
+// and doesn't use up depth.
+//
+
+class GomokuSearch
+{
+public:
+    GomokuSearch();
+
+    // best cell for the player to move, -1 if the game is over
+    int         findBestMove(const GomokuBoard &board, int maxDepth = 0);
+
+    // first move of a VCF for the player to move, -1 if there is none in up to maxFours fours
+    int         findVCF(GomokuBoard &board, int maxFours);
+
+    void        setTimeBudget(double seconds) { _clock.setBudget(seconds); }
+    double      timeBudget() const { return _clock.budget(); }
+    // true if the last findBestMove() played a forced win or loss
+    bool        solved() const { return _solved; }
+    const SearchStats &stats() const { return _stats; }
+
+    void        clearTable();
+
+    static const int kWinScore = 100000;
+
+private:
+    int         negamax(GomokuBoard &board, int alpha, int beta, int ply, int depthLeft);
+    bool        vcf(GomokuBoard &board, int foursLeft, int ply);
+    // the best candidate cells first, at most max of them, returns how many
+    int         orderMoves(const GomokuBoard &board, int *moves, int tableMove, int max) const;
+
+    SearchTable _table;
+    SearchClock _clock;
+    SearchStats _stats;
+    bool        _solved;
+    // the VCF gives up after this many positions
+    uint64_t    _vcfNodesLeft;
+    // the move a VCF starts with, set when vcf() returns true
+    int         _vcfMove;
+};
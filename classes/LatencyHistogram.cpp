@@ -0,0 +1,144 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+
+void LatencyHistogram::clear()
+{
+    std::fill(_counts, _counts + kBuckets, 0);
+    _count = 0;
+    _total = 0;
+    _max = 0;
+}
+
+//
+// exact below kSubBuckets, then the top seven bits pick the bucket within the
+// power of two the value falls in
+//
+int LatencyHistogram::bucketFor(uint64_t micros)
+{
+    if (micros < (uint64_t)kSubBuckets) {
+        return (int)micros;
+    }
+    int topBit = std::bit_width(micros) - 1;
+    int shift = topBit - 6;
+    if (shift > kRanges) {
+        return kBuckets - 1;
+    }
+    return kSubBuckets + (shift - 1) * (kSubBuckets / 2) + (int)((micros >> shift) - kSubBuckets / 2);
+}
+
+uint64_t LatencyHistogram::highestIn(int bucket)
+{
+    if (bucket < kSubBuckets) {
+        return (uint64_t)bucket;
+    }
+    int shift = (bucket - kSubBuckets) / (kSubBuckets / 2) + 1;
+    uint64_t top = (uint64_t)((bucket - kSubBuckets) % (kSubBuckets / 2) + kSubBuckets / 2);
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros)
+{
+    _counts[bucketFor(micros)]++;
+    _count++;
+    _total += micros;
+    _max = std::max(_max, micros);
+}
+
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    for (int i = 0; i < kBuckets; i++) {
+        _counts[i] += other._counts[i];
+    }
+    _count += other._count;
+    _total += other._total;
+    _max = std::max(_max, other._max);
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+    uint64_t wanted = std::max<uint64_t>(1, (uint64_t)std::ceil(percent / 100.0 * (double)_count));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += _counts[i];
+        if (seen >= wanted) {
+            return std::min(highestIn(i), _max);
+        }
+    }
+    return _max;
+}
+
+void MoveLatency::clear()
+{
+    for (int phase = 0; phase < kBoardPhases; phase++) {
+        _moves[phase].clear();
+        _searches[phase].clear();
+        _overTarget[phase] = 0;
+    }
+}
+
+void MoveLatency::record(int boardPhase, double moveSeconds, double searchSeconds, double targetSeconds)
+{
+    _moves[boardPhase].record((uint64_t)(moveSeconds * 1e6));
+    if (searchSeconds >= 0.0) {
+        _searches[boardPhase].record((uint64_t)(searchSeconds * 1e6));
+    }
+    if (targetSeconds > 0.0 && moveSeconds > targetSeconds) {
+        _overTarget[boardPhase]++;
+    }
+}
+
+uint64_t MoveLatency::count() const
+{
+    uint64_t total = 0;
+    for (int phase = 0; phase < kBoardPhases; phase++) {
+        total += _moves[phase].count();
+    }
+    return total;
+}
+
+const char *MoveLatency::phaseName(int boardPhase)
+{
+    static const char *names[kBoardPhases + 1] = { "opening", "middle", "end", "all" };
+    return boardPhase >= 0 && boardPhase <= kBoardPhases ? names[boardPhase] : "";
+}
+
+static std::string percentilesJson(const LatencyHistogram &histogram)
+{
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "{\"count\":%llu,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f}",
+             (unsigned long long)histogram.count(), histogram.mean() / 1000.0, histogram.percentile(50.0) / 1000.0,
+             histogram.percentile(90.0) / 1000.0, histogram.percentile(99.0) / 1000.0, histogram.percentile(99.9) / 1000.0,
+             histogram.max() / 1000.0);
+    return buffer;
+}
+
+std::string MoveLatency::toJson(const std::string &game) const
+{
+    LatencyHistogram allMoves;
+    LatencyHistogram allSearches;
+    uint64_t allOver = 0;
+    std::string json;
+    for (int phase = 0; phase <= kBoardPhases; phase++) {
+        const LatencyHistogram *moves = &allMoves;
+        const LatencyHistogram *searches = &allSearches;
+        uint64_t over = allOver;
+        if (phase < kBoardPhases) {
+            moves = &_moves[phase];
+            searches = &_searches[phase];
+            over = _overTarget[phase];
+            allMoves.add(*moves);
+            allSearches.add(*searches);
+            allOver += over;
+        }
+        json += "{\"game\":\"" + game + "\",\"phase\":\"" + phaseName(phase) + "\",\"over_target\":" + std::to_string(over) +
+                ",\"move_ms\":" + percentilesJson(*moves) + ",\"search_ms\":" + percentilesJson(*searches) + "}\n";
+    }
+    return json;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//
+// how long things took, in microseconds, to within a percent or two at any size
+//
+// the buckets are laid out the way HdrHistogram does it: exact up to
+// kSubBuckets, then every doubling of the range is split into kSubBuckets / 2
+// equal buckets. that keeps the bucket width under 1/64 of the value from a
+// microsecond up to hours in a fixed 16 KB, recording is a couple of shifts and
+// an increment, and a percentile is one walk over the counts. it is the tail
+// that matters here, and an average or a fixed set of buckets hides it.
+//
+class LatencyHistogram
+{
+public:
+    static const int kSubBuckets = 128;
+    // up to 2^(kRanges + 6) microseconds, about 19 hours
+    static const int kRanges = 30;
+    static const int kBuckets = kSubBuckets + kRanges * (kSubBuckets / 2);
+
+    LatencyHistogram() { clear(); }
+
+    void        clear();
+    void        record(uint64_t micros);
+    void        add(const LatencyHistogram &other);
+
+    uint64_t    count() const { return _count; }
+    uint64_t    max() const { return _max; }
+    double      mean() const { return _count ? (double)_total / (double)_count : 0.0; }
+    // the value percent of the recordings are at or under, as the top of its bucket
+    uint64_t    percentile(double percent) const;
+
+private:
+    static int      bucketFor(uint64_t micros);
+    static uint64_t highestIn(int bucket);
+
+    uint64_t    _counts[kBuckets];
+    uint64_t    _count;
+    uint64_t    _total;
+    uint64_t    _max;
+};
+
+//
+// how far into a game a position is, from Game::boardPhase()
+//
+enum BoardPhase
+{
+    kBoardOpening,
+    kBoardMiddle,
+    kBoardEnd,
+    kBoardPhases
+};
+
+//
+// every AI move of one kind of game, by board phase
+//
+// moves are the whole of Game::updateAI(), book probe, search and playing the
+// move; searches are the time the search reported for itself. a latency target
+// counts the moves that went over it.
+//
+class MoveLatency
+{
+public:
+    MoveLatency() { clear(); }
+
+    void        clear();
+    // searchSeconds < 0 when the move didn't come from a search
+    void        record(int boardPhase, double moveSeconds, double searchSeconds, double targetSeconds);
+
+    const LatencyHistogram &moves(int boardPhase) const { return _moves[boardPhase]; }
+    const LatencyHistogram &searches(int boardPhase) const { return _searches[boardPhase]; }
+    // moves over the latency target that was set when they were made
+    uint64_t    overTarget(int boardPhase) const { return _overTarget[boardPhase]; }
+    uint64_t    count() const;
+
+    static const char *phaseName(int boardPhase);
+    // one JSON object per phase, and one for the phases together, labelled with game
+    std::string toJson(const std::string &game) const;
+
+private:
+    LatencyHistogram    _moves[kBoardPhases];
+    LatencyHistogram    _searches[kBoardPhases];
+    uint64_t            _overTarget[kBoardPhases];
+};
@@ -0,0 +1,330 @@
+#include "MNKSearch.h"
+
+#include <algorithm>
+#include <chrono>
+
+// larger than any score negamax can return
+const int SCORE_INFINITY = ThreatEvaluator::kWinScore + 1000;
+
+// scores this close to a win are wins in a known number of plies
+const int SCORE_WIN_BOUND = ThreatEvaluator::kWinScore - 1000;
+
+// 16 byte entries, 4MB in total
+const int TABLE_BITS = 18;
+
+// how many nodes go by between checks of the stop flag and the clock
+const uint64_t STOP_CHECK_INTERVAL = 1024;
+
+//
+// small deterministic generator for the zobrist keys
+//
+static uint64_t splitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+//
+// win scores depend on how far from the root they were found, the table stores
+// them relative to the node instead so they can be reused at any depth
+//
+static int scoreToTable(int score, int depth)
+{
+    if (score > SCORE_WIN_BOUND) return score + depth;
+    if (score < -SCORE_WIN_BOUND) return score - depth;
+    return score;
+}
+
+static int scoreFromTable(int score, int depth)
+{
+    if (score > SCORE_WIN_BOUND) return score - depth;
+    if (score < -SCORE_WIN_BOUND) return score + depth;
+    return score;
+}
+
+MNKSearch::MNKSearch(int width, int height, int k) : _stopRequested(false)
+{
+    _width = width;
+    _height = height;
+    _k = k;
+    _searchEmpty = 0;
+    _hash = 0;
+    _aborted = false;
+    _timeBudget = 0.0;
+    _threats.setBoard(width, height, k);
+
+    // search the middle of the board first, those moves take part in the most lines
+    for (int i = 0; i < width * height; i++) {
+        _moveOrder.push_back(i);
+    }
+    auto centerDistance = [width, height](int cell) {
+        int dx = 2 * (cell % width) - (width - 1);
+        int dy = 2 * (cell / width) - (height - 1);
+        return dx * dx + dy * dy;
+    };
+    std::stable_sort(_moveOrder.begin(), _moveOrder.end(), [&](int a, int b) {
+        return centerDistance(a) < centerDistance(b);
+    });
+
+    uint64_t seed = 0x5EED ^ ((uint64_t)width << 32) ^ ((uint64_t)height << 16) ^ (uint64_t)k;
+    _cellKeys.resize(width * height * 2);
+    for (auto &key : _cellKeys) {
+        key = splitMix64(seed);
+    }
+    _sideKey = splitMix64(seed);
+    _table.resize(1 << TABLE_BITS);
+    clearTable();
+}
+
+void MNKSearch::clearTable()
+{
+    std::fill(_table.begin(), _table.end(), TableEntry{ 0, 0, -1, -1, kBoundExact });
+}
+
+void MNKSearch::makeMove(int *board, int cell, int player)
+{
+    board[cell] = player + 1;
+    _threats.makeMove(cell, player);
+    _hash ^= _cellKeys[cell * 2 + player];
+}
+
+void MNKSearch::unmakeMove(int *board, int cell, int player)
+{
+    _hash ^= _cellKeys[cell * 2 + player];
+    _threats.unmakeMove(cell, player);
+    board[cell] = 0;
+}
+
+//
+// negamax algorithm for calculating the best move based on a score
+// scores are from currentPlayer's point of view, with alpha-beta pruning
+//
+int MNKSearch::negamax(int depth, int currentPlayer, int maxDepth, int alpha, int beta, int *board)
+{
+    if ((++_stats.nodes % STOP_CHECK_INTERVAL) == 0 &&
+        (_stopRequested.load(std::memory_order_relaxed) || (_timeBudget > 0.0 && std::chrono::steady_clock::now() > _deadline))) {
+        _aborted = true;
+    }
+    if (depth > _stats.depthReached) {
+        _stats.depthReached = depth;
+    }
+    if (_aborted) {
+        return 0;
+    }
+
+    // a finished line always belongs to the player who just moved, sooner losses score lower
+    if (checkWinnerInBoard() != 0) {
+        return depth - ThreatEvaluator::kWinScore;
+    }
+
+    // every move fills a square, so the board is full once depth reaches the empty count
+    if (depth >= _searchEmpty) {
+        return 0;
+    }
+
+    // out of depth, fall back on the open line counts
+    if (depth >= maxDepth) {
+        return evaluateBoard(currentPlayer);
+    }
+
+    // anything we already know about this position from an earlier search
+    int remaining = maxDepth - depth;
+    uint64_t key = hashFor(currentPlayer);
+    TableEntry &entry = _table[key & (_table.size() - 1)];
+    int tableMove = -1;
+    _stats.tableProbes++;
+    if (entry.key == key) {
+        _stats.tableHits++;
+        tableMove = entry.move;
+        if (entry.depth >= remaining) {
+            int score = scoreFromTable(entry.score, depth);
+            if (entry.bound == kBoundExact ||
+                (entry.bound == kBoundLower && score >= beta) ||
+                (entry.bound == kBoundUpper && score <= alpha)) {
+                return score;
+            }
+        }
+    }
+
+    int originalAlpha = alpha;
+    int bestScore = -SCORE_INFINITY;
+    int bestMove = -1;
+    int movesTried = 0;
+    _stats.expanded++;
+
+    // experiment with all possible moves, the remembered best one first
+    for (int n = -1; n < (int)_moveOrder.size(); n++) {
+        int i = (n < 0) ? tableMove : _moveOrder[n];
+        if (i < 0 || (n >= 0 && i == tableMove) || board[i] != 0) {
+            continue;
+        }
+
+        makeMove(board, i, currentPlayer);
+        int score = -negamax(depth + 1, 1 - currentPlayer, maxDepth, -beta, -alpha, board);
+        unmakeMove(board, i, currentPlayer);
+        movesTried++;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = i;
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        // the opponent already has something better than this line, stop looking
+        if (alpha >= beta) {
+            _stats.cutoffs++;
+            if (movesTried == 1) {
+                _stats.firstMoveCutoffs++;
+            }
+            break;
+        }
+    }
+
+    if (_aborted) {
+        return 0;
+    }
+
+    entry.key = key;
+    entry.score = scoreToTable(bestScore, depth);
+    entry.move = (int16_t)bestMove;
+    entry.depth = (int8_t)std::min(remaining, 127);
+    entry.bound = bestScore <= originalAlpha ? kBoundUpper : (bestScore >= beta ? kBoundLower : kBoundExact);
+    return bestScore;
+}
+
+//
+// heuristic score for a position the search didn't finish
+//
+int MNKSearch::evaluateBoard(int currentPlayer)
+{
+    // whoever moves next completes any line that is one stone short
+    if (_k > 1 && _threats.threats(currentPlayer, _k - 1) > 0) {
+        return ThreatEvaluator::kWinScore / 2;
+    }
+    // and two of them for the opponent can't both be blocked
+    if (_k > 1 && _threats.threats(1 - currentPlayer, _k - 1) > 1) {
+        return -ThreatEvaluator::kWinScore / 2;
+    }
+    return _threats.score(currentPlayer);
+}
+
+//
+// checks the board for a current winner
+// the threat evaluator tracks completed lines as moves are made, so nothing is rescanned
+//
+int MNKSearch::checkWinnerInBoard() const
+{
+    return _threats.winner();
+}
+
+int MNKSearch::findBestMove(int *board, int player, int maxDepth)
+{
+    auto start = std::chrono::steady_clock::now();
+    _deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(_timeBudget));
+    _stats.reset();
+    _stats.depthLimit = maxDepth;
+
+    int cells = _width * _height;
+    _threats.load(board);
+    _hash = 0;
+    _searchEmpty = 0;
+    for (int i = 0; i < cells; i++) {
+        if (board[i] != 0) {
+            _hash ^= _cellKeys[i * 2 + board[i] - 1];
+        } else {
+            _searchEmpty++;
+        }
+    }
+    _aborted = false;
+
+    // nothing to play if the game is already over
+    if (_threats.winner() != 0 || _searchEmpty == 0) {
+        return -1;
+    }
+
+    int bestScore = -SCORE_INFINITY;
+    int bestMoveIndex = -1;
+
+    // try the move the table remembers first, a good early score prunes the rest harder
+    int tableMove = -1;
+    TableEntry &entry = _table[hashFor(player) & (_table.size() - 1)];
+    if (entry.key == hashFor(player)) {
+        tableMove = entry.move;
+    }
+
+    for (int n = -1; n < (int)_moveOrder.size(); n++) {
+        int i = (n < 0) ? tableMove : _moveOrder[n];
+        if (i < 0 || (n >= 0 && i == tableMove) || board[i] != 0) {
+            continue;
+        }
+
+        makeMove(board, i, player);
+        int score = -negamax(1, 1 - player, maxDepth, -SCORE_INFINITY, -bestScore, board);
+        unmakeMove(board, i, player);
+
+        if (_aborted) {
+            return -1;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestMoveIndex = i;
+        }
+    }
+
+    if (bestMoveIndex >= 0) {
+        uint64_t key = hashFor(player);
+        TableEntry &root = _table[key & (_table.size() - 1)];
+        root.key = key;
+        root.score = scoreToTable(bestScore, 0);
+        root.move = (int16_t)bestMoveIndex;
+        root.depth = (int8_t)std::min(maxDepth, 127);
+        root.bound = kBoundExact;
+    }
+
+    _stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    _stats.bestMove = bestMoveIndex;
+    _stats.score = bestScore;
+    principalVariation(board, player, _stats.principalVariation);
+    return bestMoveIndex;
+}
+
+int MNKSearch::expectedMove(const int *board, int player) const
+{
+    uint64_t key = player ? _sideKey : 0;
+    for (int i = 0; i < _width * _height; i++) {
+        if (board[i] != 0) {
+            key ^= _cellKeys[i * 2 + board[i] - 1];
+        }
+    }
+
+    const TableEntry &entry = _table[key & (_table.size() - 1)];
+    if (entry.key != key || entry.move < 0 || board[entry.move] != 0) {
+        return -1;
+    }
+    return entry.move;
+}
+
+//
+// follow the best moves stored in the table from this position
+//
+void MNKSearch::principalVariation(int *board, int player, std::vector<int> &line)
+{
+    line.clear();
+    int cells = _width * _height;
+    while ((int)line.size() < cells) {
+        int move = expectedMove(board, player);
+        if (move < 0) {
+            break;
+        }
+        line.push_back(move);
+        board[move] = player + 1;
+        player = 1 - player;
+    }
+    // put the board back the way we found it
+    for (int move : line) {
+        board[move] = 0;
+    }
+}
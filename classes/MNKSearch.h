@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "SearchStats.h"
+#include "ThreatEvaluator.h"
+
+//
+// alpha-beta search for m,n,k games (tic-tac-toe on any board size)
+//
+// this only works on a plain array of cells (0 empty, 1 or 2 for player number + 1)
+// and never touches the board sprites, so it is safe to run on a background thread.
+// results are kept in a transposition table that survives between searches, so a
+// search of a position that was already looked at (e.g. while pondering) is cheap.
+//
+
+class MNKSearch
+{
+public:
+    MNKSearch(int width, int height, int k);
+
+    // best cell for player (zero based) to play, -1 if there are no moves or the search was stopped
+    int         findBestMove(int *board, int player, int maxDepth);
+    // the move earlier searches expect player to make on board, -1 if it doesn't know
+    int         expectedMove(const int *board, int player) const;
+
+    // ask a running search to give up as soon as possible, this stays set until clearStop()
+    void        stop() { _stopRequested.store(true, std::memory_order_relaxed); }
+    void        clearStop() { _stopRequested.store(false, std::memory_order_relaxed); }
+    // a search that runs longer than this gives up as if stop() had been called, 0 for no limit
+    void        setTimeBudget(double seconds) { _timeBudget = seconds; }
+    // true if the last search was cut short by stop() or the time budget, its result should be thrown away
+    bool        aborted() const { return _aborted; }
+
+    void        clearTable();
+
+    // counters from the last search, only read these once it has finished
+    const SearchStats   &stats() const { return _stats; }
+
+private:
+    int         negamax(int depth, int currentPlayer, int maxDepth, int alpha, int beta, int *board);
+    int         evaluateBoard(int currentPlayer);
+    int         checkWinnerInBoard() const;
+
+    void        makeMove(int *board, int cell, int player);
+    void        unmakeMove(int *board, int cell, int player);
+    uint64_t    hashFor(int player) const { return player ? _hash ^ _sideKey : _hash; }
+    void        principalVariation(int *board, int player, std::vector<int> &line);
+
+    enum Bound : uint8_t { kBoundExact, kBoundLower, kBoundUpper };
+
+    struct TableEntry
+    {
+        uint64_t    key;
+        int32_t     score;
+        int16_t     move;
+        int8_t      depth;
+        Bound       bound;
+    };
+
+    int                     _width;
+    int                     _height;
+    int                     _k;
+    // cells sorted from the middle of the board outwards, searched in this order
+    std::vector<int>        _moveOrder;
+    // open line counts for the board being searched, updated on every make/unmake
+    ThreatEvaluator         _threats;
+    // empty squares when the current search started
+    int                     _searchEmpty;
+
+    // zobrist keys, one per cell per player
+    std::vector<uint64_t>   _cellKeys;
+    uint64_t                _sideKey;
+    uint64_t                _hash;
+    std::vector<TableEntry> _table;
+
+    std::atomic<bool>       _stopRequested;
+    double                  _timeBudget;
+    std::chrono::steady_clock::time_point _deadline;
+    bool                    _aborted;
+    SearchStats             _stats;
+};
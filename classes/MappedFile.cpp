@@ -0,0 +1,92 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+    _mapping = nullptr;
+    _size = 0;
+#ifdef _WIN32
+    _fileHandle = nullptr;
+    _mapHandle = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &path, bool sequential)
+{
+    close();
+
+#ifdef _WIN32
+    DWORD flags = FILE_ATTRIBUTE_NORMAL | (sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS);
+    HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(fileHandle);
+        return false;
+    }
+    HANDLE mapHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *mapping = mapHandle ? MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!mapping) {
+        if (mapHandle) CloseHandle(mapHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+    _fileHandle = fileHandle;
+    _mapHandle = mapHandle;
+    _mapping = mapping;
+    _size = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    madvise(mapping, (size_t)info.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    _mapping = mapping;
+    _size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(_mapping);
+        CloseHandle((HANDLE)_mapHandle);
+        CloseHandle((HANDLE)_fileHandle);
+        _mapHandle = nullptr;
+        _fileHandle = nullptr;
+#else
+        munmap(_mapping, _size);
+#endif
+    }
+    _mapping = nullptr;
+    _size = 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+//
+// a whole file mapped read only, for the on-disk tables and logs
+//
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // sequential asks the system to read ahead, for files that are walked front to back
+    bool        open(const std::string &path, bool sequential = false);
+    void        close();
+    bool        isOpen() const { return _mapping != nullptr; }
+
+    const uint8_t   *data() const { return (const uint8_t *)_mapping; }
+    size_t      size() const { return _size; }
+
+private:
+    void            *_mapping;
+    size_t          _size;
+#ifdef _WIN32
+    void            *_fileHandle;
+    void            *_mapHandle;
+#endif
+};
@@ -0,0 +1,190 @@
+#include "OpeningBook.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+struct OpeningBookHeader
+{
+    char        magic[4];
+    uint32_t    version;
+    char        gameId[16];
+    uint32_t    maxPlies;
+    uint32_t    minGames;
+    uint64_t    positions;
+    uint64_t    moves;
+};
+
+static const char       kBookMagic[4] = { 'G', 'B', 'O', 'K' };
+static const uint32_t   kBookVersion = 1;
+
+// moves scoring this far below the best one from the same position are left out
+static const double     kBookMargin = 0.1;
+
+bool OpeningBook::build(const std::string &logPath, const std::string &gameId, const std::string &outPath,
+                        int maxPlies, int minGames, int threads, OpeningBookStats &stats)
+{
+    stats = OpeningBookStats();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PositionEntry> entries;
+    std::vector<PositionReply> replies;
+    if (!PositionDatabase::collect(logPath, gameId, maxPlies, threads, entries, replies, stats.log)) {
+        return false;
+    }
+    std::vector<PositionEntry>().swap(entries);
+
+    // every position's moves together, most played first
+    std::sort(replies.begin(), replies.end(), [](const PositionReply &a, const PositionReply &b) {
+        if (a.position != b.position) return a.position < b.position;
+        if (a.games != b.games) return a.games > b.games;
+        return a.move < b.move;
+    });
+
+    std::vector<BookPosition> positions;
+    std::vector<BookMove> moves;
+    for (size_t first = 0, last; first < replies.size(); first = last) {
+        double best = 0.0;
+        for (last = first; last < replies.size() && replies[last].position == replies[first].position; last++) {
+            if (replies[last].games >= (uint32_t)minGames) {
+                best = std::max(best, replies[last].score());
+            }
+        }
+
+        BookPosition position;
+        position.key = replies[first].position;
+        position.firstMove = (uint32_t)moves.size();
+        for (size_t i = first; i < last; i++) {
+            const PositionReply &reply = replies[i];
+            if (reply.games >= (uint32_t)minGames && reply.score() >= best - kBookMargin) {
+                BookMove move;
+                move.move = reply.move;
+                move.weight = std::max(1u, (uint32_t)(reply.games * reply.score() * 100.0));
+                moves.push_back(move);
+            }
+        }
+        position.moveCount = (uint32_t)moves.size() - position.firstMove;
+        if (position.moveCount > 0) {
+            positions.push_back(position);
+        }
+    }
+    stats.positions = positions.size();
+    stats.moves = moves.size();
+
+    OpeningBookHeader header = {};
+    memcpy(header.magic, kBookMagic, sizeof(header.magic));
+    header.version = kBookVersion;
+    memcpy(header.gameId, gameId.c_str(), std::min(gameId.size(), sizeof(header.gameId) - 1));
+    header.maxPlies = (uint32_t)maxPlies;
+    header.minGames = (uint32_t)minGames;
+    header.positions = positions.size();
+    header.moves = moves.size();
+
+    std::ofstream file(outPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "OpeningBook: can't write " << outPath << std::endl;
+        return false;
+    }
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)positions.data(), (std::streamsize)(positions.size() * sizeof(BookPosition)));
+    file.write((const char *)moves.data(), (std::streamsize)(moves.size() * sizeof(BookMove)));
+    stats.log.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (bool)file;
+}
+
+OpeningBook::OpeningBook()
+{
+    _maxPlies = 0;
+    _positionCount = 0;
+    _moveCount = 0;
+    _positions = nullptr;
+    _moves = nullptr;
+}
+
+OpeningBook::~OpeningBook()
+{
+    close();
+}
+
+bool OpeningBook::open(const std::string &path)
+{
+    TraceScope trace("open book", "assets");
+    close();
+    if (!_file.open(path)) {
+        return false;
+    }
+
+    const OpeningBookHeader *header = (const OpeningBookHeader *)_file.data();
+    size_t body = _file.size() >= sizeof(OpeningBookHeader) ? _file.size() - sizeof(OpeningBookHeader) : 0;
+    if (_file.size() < sizeof(OpeningBookHeader) || memcmp(header->magic, kBookMagic, sizeof(header->magic)) != 0 ||
+        header->version != kBookVersion || header->positions > body / sizeof(BookPosition) ||
+        header->moves > (body - header->positions * sizeof(BookPosition)) / sizeof(BookMove)) {
+        std::cerr << "OpeningBook: " << path << " is not an opening book" << std::endl;
+        close();
+        return false;
+    }
+
+    _gameId = std::string(header->gameId, strnlen(header->gameId, sizeof(header->gameId)));
+    _maxPlies = (int)header->maxPlies;
+    _positionCount = header->positions;
+    _moveCount = header->moves;
+    _positions = (const BookPosition *)(_file.data() + sizeof(OpeningBookHeader));
+    _moves = (const BookMove *)(_positions + _positionCount);
+
+    // a damaged file mustn't send a probe off the end of the moves
+    for (uint64_t i = 0; i < _positionCount; i++) {
+        if ((uint64_t)_positions[i].firstMove + _positions[i].moveCount > _moveCount) {
+            std::cerr << "OpeningBook: " << path << " is damaged" << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void OpeningBook::close()
+{
+    _file.close();
+    _gameId.clear();
+    _maxPlies = 0;
+    _positionCount = 0;
+    _moveCount = 0;
+    _positions = nullptr;
+    _moves = nullptr;
+}
+
+const BookPosition *OpeningBook::find(uint64_t key) const
+{
+    if (!_positions) {
+        return nullptr;
+    }
+    const BookPosition *end = _positions + _positionCount;
+    const BookPosition *found = std::lower_bound(_positions, end, key, [](const BookPosition &position, uint64_t key) {
+        return position.key < key;
+    });
+    return found != end && found->key == key ? found : nullptr;
+}
+
+int OpeningBook::pick(uint64_t key, uint64_t random) const
+{
+    const BookPosition *position = find(key);
+    if (!position) {
+        return -1;
+    }
+    const BookMove *list = moves(*position);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < position->moveCount; i++) {
+        total += list[i].weight;
+    }
+    uint64_t roll = total ? random % total : 0;
+    for (uint32_t i = 0; i < position->moveCount; i++) {
+        if (roll < list[i].weight) {
+            return list[i].move;
+        }
+        roll -= list[i].weight;
+    }
+    return list[0].move;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "MappedFile.h"
+#include "PositionDatabase.h"
+
+//
+// the moves worth playing in the positions a game log kept reaching
+//
+// built from the same replay as the position database (see PositionDatabase),
+// so positions are canonical keys and moves are in the canonical position's
+// frame: look a position up with canonicalKey() and map the move back with the
+// game's map function (BoardSymmetry.h). a position keeps every move that was
+// played often enough and scored close to its best one, each weighted by how
+// often it was played times how well it scored, and the AI picks between them
+// at random by weight so it doesn't open the same way every game.
+//
+// the file is the positions sorted by key followed by all their moves, memory
+// mapped, so a probe is a binary search over 16 byte entries.
+//
+
+// one position, 16 bytes on disk
+struct BookPosition
+{
+    uint64_t    key;
+    // index of its first move in the move array
+    uint32_t    firstMove;
+    uint32_t    moveCount;
+};
+
+// 8 bytes on disk
+struct BookMove
+{
+    int32_t     move;
+    uint32_t    weight;
+};
+
+struct OpeningBookStats
+{
+    // the replay of the log
+    PositionBuildStats  log;
+    uint64_t    positions = 0;
+    uint64_t    moves = 0;
+};
+
+class OpeningBook
+{
+public:
+    OpeningBook();
+    ~OpeningBook();
+
+    // replay the gameId games in logPath to maxPlies and keep the moves played at
+    // least minGames times. threads <= 0 uses every core
+    static bool build(const std::string &logPath, const std::string &gameId, const std::string &outPath,
+                      int maxPlies, int minGames, int threads, OpeningBookStats &stats);
+
+    // memory map a book written by build(), the file stays mapped until close()
+    bool        open(const std::string &path);
+    void        close();
+    bool        isOpen() const { return _positions != nullptr; }
+
+    // nullptr if the position isn't in the book
+    const BookPosition *find(uint64_t key) const;
+    const BookMove *moves(const BookPosition &position) const { return _moves + position.firstMove; }
+
+    // a move chosen by weight with random as the dice, -1 if the position isn't in the book
+    int         pick(uint64_t key, uint64_t random) const;
+
+    const std::string &gameId() const { return _gameId; }
+    int         maxPlies() const { return _maxPlies; }
+    uint64_t    positionCount() const { return _positionCount; }
+    uint64_t    moveCount() const { return _moveCount; }
+
+private:
+    std::string         _gameId;
+    int                 _maxPlies;
+    uint64_t            _positionCount;
+    uint64_t            _moveCount;
+    const BookPosition  *_positions;
+    const BookMove      *_moves;
+    MappedFile          _file;
+};
@@ -0,0 +1,400 @@
+#include "PositionDatabase.h"
+#include "GameRecord.h"
+#include "SelfPlay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//
+// on-disk layout: a fixed header followed by the hash table, a power of two
+// slots at most half full so a missing key is found out quickly
+//
+struct PositionDatabaseHeader
+{
+    char        magic[4];
+    uint32_t    version;
+    char        gameId[16];
+    uint32_t    maxPlies;
+    uint32_t    reserved;
+    uint64_t    capacity;
+    uint64_t    positions;
+    uint64_t    games;
+};
+
+static const char       kPositionMagic[4] = { 'G', 'P', 'D', 'B' };
+static const uint32_t   kPositionVersion = 1;
+
+// the tables each thread fills are split this many ways by key for merging
+static const int        kPositionShards = 64;
+// games are handed to the worker threads this many at a time
+static const uint64_t   kPositionChunk = 256;
+// replies are scored as if they also had this many drawn games
+static const double     kReplyPriorGames = 2.0;
+
+struct PositionCounts
+{
+    uint32_t    wins = 0;
+    uint32_t    draws = 0;
+    uint32_t    losses = 0;
+    uint32_t    ply = UINT32_MAX;
+};
+
+struct PositionShard
+{
+    std::unordered_map<uint64_t, PositionCounts>    positions;
+    std::unordered_map<uint64_t, PositionReply>       replies;
+};
+
+// canonical keys are the smallest of several, so their top bits are mostly 0 and need mixing first
+static int shardOf(uint64_t key)
+{
+    return (int)((key * 0x9E3779B97F4A7C15ull) >> 58);
+}
+
+// a position and a move from it, as one key
+static uint64_t replyKey(uint64_t position, int move)
+{
+    uint64_t key = position ^ ((uint64_t)(uint32_t)move * 0x9E3779B97F4A7C15ull);
+    key ^= key >> 29;
+    key *= 0xBF58476D1CE4E5B9ull;
+    return key ^ (key >> 32);
+}
+
+double PositionReply::score() const
+{
+    return (halfPoints * 0.5 + kReplyPriorGames * 0.5) / (games + kReplyPriorGames);
+}
+
+// one position of a game being replayed
+struct ReplayStep
+{
+    uint64_t    key;
+    int         move;
+    int         side;
+};
+
+//
+// replays one game into the shards, nothing goes in if a move isn't legal where it was played
+//
+static bool replayGame(SelfPlayGame &game, const GameRecordView &view, int maxPlies, std::vector<PositionShard> &shards,
+                       std::vector<int> &legal, std::vector<ReplayStep> &steps)
+{
+    game.restart();
+    steps.clear();
+    GameRecordCursor moves = view.moves();
+    uint32_t move;
+    for (int ply = 0; ply < maxPlies && moves.next(move); ply++) {
+        if (game.isOver()) {
+            return false;
+        }
+        game.legalMoves(legal);
+        if (std::find(legal.begin(), legal.end(), (int)move) == legal.end()) {
+            return false;
+        }
+        int symmetry;
+        ReplayStep step;
+        step.key = game.canonicalKey(symmetry);
+        step.move = game.mapMove((int)move, symmetry, false);
+        step.side = game.sideToMove();
+        steps.push_back(step);
+        game.play((int)move);
+    }
+
+    for (int ply = 0; ply < (int)steps.size(); ply++) {
+        const ReplayStep &step = steps[ply];
+        PositionShard &shard = shards[shardOf(step.key)];
+        int halfPoints = view.winner < 0 ? 1 : (view.winner == step.side ? 2 : 0);
+
+        PositionCounts &counts = shard.positions[step.key];
+        if (halfPoints == 2) counts.wins++;
+        else if (halfPoints == 1) counts.draws++;
+        else counts.losses++;
+        counts.ply = std::min(counts.ply, (uint32_t)ply);
+
+        PositionReply &reply = shard.replies[replyKey(step.key, step.move)];
+        reply.position = step.key;
+        reply.move = step.move;
+        reply.games++;
+        reply.halfPoints += halfPoints;
+    }
+    return true;
+}
+
+//
+// run fn(begin, end) over [0, count) on a pool of threads pulling chunks off a
+// shared counter, fn also gets the index of the thread running it
+//
+template <typename Fn>
+static void parallelFor(uint64_t count, int threads, Fn fn)
+{
+    std::atomic<uint64_t> next(0);
+    auto worker = [&](int thread) {
+        for (;;) {
+            uint64_t begin = next.fetch_add(kPositionChunk);
+            if (begin >= count) {
+                return;
+            }
+            uint64_t end = begin + kPositionChunk < count ? begin + kPositionChunk : count;
+            fn(thread, begin, end);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+bool PositionDatabase::collect(const std::string &logPath, const std::string &gameId, int maxPlies, int threads,
+                               std::vector<PositionEntry> &positions, std::vector<PositionReply> &replyList, PositionBuildStats &stats)
+{
+    stats = PositionBuildStats();
+    auto start = std::chrono::steady_clock::now();
+
+    SelfPlayGame *probe = SelfPlayGame::create(gameId);
+    if (!probe || gameId.size() >= sizeof(PositionDatabaseHeader::gameId)) {
+        std::cerr << "PositionDatabase: no rules for '" << gameId << "'" << std::endl;
+        delete probe;
+        return false;
+    }
+    delete probe;
+
+    GameRecordReader reader;
+    if (!reader.open(logPath)) {
+        return false;
+    }
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+    }
+
+    // one quick pass to find the games, skipping records is just reading their lengths
+    std::vector<uint64_t> offsets;
+    GameRecordView view;
+    while (reader.next(view)) {
+        stats.gamesRead++;
+        if (view.gameId == gameId) {
+            offsets.push_back(view.offset);
+        }
+    }
+
+    // every thread replays into its own shards
+    std::vector<std::vector<PositionShard>> tables(threads, std::vector<PositionShard>(kPositionShards));
+    std::vector<SelfPlayGame *> games(threads);
+    for (int i = 0; i < threads; i++) {
+        games[i] = SelfPlayGame::create(gameId);
+    }
+    std::atomic<uint64_t> used(0);
+    std::atomic<uint64_t> rejected(0);
+    parallelFor(offsets.size(), threads, [&](int thread, uint64_t begin, uint64_t end) {
+        std::vector<int> legal;
+        std::vector<ReplayStep> steps;
+        GameRecordView game;
+        for (uint64_t i = begin; i < end; i++) {
+            if (reader.read(offsets[i], game) && replayGame(*games[thread], game, maxPlies, tables[thread], legal, steps)) {
+                used++;
+            } else {
+                rejected++;
+            }
+        }
+    });
+    for (SelfPlayGame *game : games) {
+        delete game;
+    }
+    stats.gamesUsed = used;
+    stats.gamesRejected = rejected;
+
+    // each shard is merged by one thread, then picks the best reply for each of its positions
+    std::vector<std::vector<PositionEntry>> merged(kPositionShards);
+    std::vector<std::vector<PositionReply>> mergedReplies(kPositionShards);
+    std::atomic<uint64_t> replies(0);
+    std::atomic<int> nextShard(0);
+    auto merge = [&]() {
+        for (int s = nextShard++; s < kPositionShards; s = nextShard++) {
+            PositionShard &into = tables[0][s];
+            for (int t = 1; t < threads; t++) {
+                for (auto &item : tables[t][s].positions) {
+                    PositionCounts &counts = into.positions[item.first];
+                    counts.wins += item.second.wins;
+                    counts.draws += item.second.draws;
+                    counts.losses += item.second.losses;
+                    counts.ply = std::min(counts.ply, item.second.ply);
+                }
+                for (auto &item : tables[t][s].replies) {
+                    PositionReply &reply = into.replies[item.first];
+                    reply.position = item.second.position;
+                    reply.move = item.second.move;
+                    reply.games += item.second.games;
+                    reply.halfPoints += item.second.halfPoints;
+                }
+                tables[t][s] = PositionShard();
+            }
+
+            std::unordered_map<uint64_t, const PositionReply *> best;
+            for (auto &item : into.replies) {
+                const PositionReply *&current = best[item.second.position];
+                if (!current || item.second.score() > current->score() ||
+                    (item.second.score() == current->score() && item.second.games > current->games)) {
+                    current = &item.second;
+                }
+            }
+            replies += into.replies.size();
+
+            std::vector<PositionEntry> &entries = merged[s];
+            entries.reserve(into.positions.size());
+            for (auto &item : into.positions) {
+                PositionEntry entry = {};
+                entry.key = item.first;
+                entry.wins = item.second.wins;
+                entry.draws = item.second.draws;
+                entry.losses = item.second.losses;
+                entry.ply = item.second.ply;
+                entry.bestReply = -1;
+                auto found = best.find(item.first);
+                if (found != best.end()) {
+                    entry.bestReply = found->second->move;
+                    entry.bestReplyGames = found->second->games;
+                }
+                entries.push_back(entry);
+            }
+            std::vector<PositionReply> &shardReplies = mergedReplies[s];
+            shardReplies.reserve(into.replies.size());
+            for (auto &item : into.replies) {
+                shardReplies.push_back(item.second);
+            }
+            tables[0][s] = PositionShard();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(merge);
+    }
+    merge();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    stats.replies = replies;
+
+    for (auto &entries : merged) {
+        stats.positions += entries.size();
+    }
+    positions.clear();
+    positions.reserve(stats.positions);
+    for (auto &entries : merged) {
+        positions.insert(positions.end(), entries.begin(), entries.end());
+        std::vector<PositionEntry>().swap(entries);
+    }
+    replyList.clear();
+    replyList.reserve(stats.replies);
+    for (auto &shard : mergedReplies) {
+        replyList.insert(replyList.end(), shard.begin(), shard.end());
+        std::vector<PositionReply>().swap(shard);
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool PositionDatabase::build(const std::string &logPath, const std::string &gameId, const std::string &outPath,
+                             int maxPlies, int threads, PositionBuildStats &stats)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PositionEntry> positions;
+    std::vector<PositionReply> replies;
+    if (!collect(logPath, gameId, maxPlies, threads, positions, replies, stats)) {
+        return false;
+    }
+    std::vector<PositionReply>().swap(replies);
+
+    uint64_t capacity = 16;
+    while (capacity < stats.positions * 2) {
+        capacity <<= 1;
+    }
+    std::vector<PositionEntry> table(capacity);
+    for (const PositionEntry &entry : positions) {
+        uint64_t slot = entry.key & (capacity - 1);
+        while (table[slot].key != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        table[slot] = entry;
+    }
+
+    PositionDatabaseHeader header = {};
+    memcpy(header.magic, kPositionMagic, sizeof(header.magic));
+    header.version = kPositionVersion;
+    memcpy(header.gameId, gameId.c_str(), gameId.size());
+    header.maxPlies = (uint32_t)maxPlies;
+    header.capacity = capacity;
+    header.positions = stats.positions;
+    header.games = stats.gamesUsed;
+
+    std::ofstream file(outPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "PositionDatabase: can't write " << outPath << std::endl;
+        return false;
+    }
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)table.data(), (std::streamsize)(table.size() * sizeof(PositionEntry)));
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (bool)file;
+}
+
+PositionDatabase::PositionDatabase()
+{
+    _maxPlies = 0;
+    _positions = 0;
+    _games = 0;
+    _mask = 0;
+    _entries = nullptr;
+}
+
+PositionDatabase::~PositionDatabase()
+{
+    close();
+}
+
+bool PositionDatabase::open(const std::string &path)
+{
+    close();
+    if (!_file.open(path)) {
+        return false;
+    }
+
+    const PositionDatabaseHeader *header = (const PositionDatabaseHeader *)_file.data();
+    if (_file.size() < sizeof(PositionDatabaseHeader) || memcmp(header->magic, kPositionMagic, sizeof(header->magic)) != 0 ||
+        header->version != kPositionVersion || header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0 ||
+        header->capacity > (_file.size() - sizeof(PositionDatabaseHeader)) / sizeof(PositionEntry)) {
+        std::cerr << "PositionDatabase: " << path << " is not a position database" << std::endl;
+        close();
+        return false;
+    }
+
+    _gameId = std::string(header->gameId, strnlen(header->gameId, sizeof(header->gameId)));
+    _maxPlies = (int)header->maxPlies;
+    _positions = header->positions;
+    _games = header->games;
+    _mask = header->capacity - 1;
+    _entries = (const PositionEntry *)(_file.data() + sizeof(PositionDatabaseHeader));
+    return true;
+}
+
+void PositionDatabase::close()
+{
+    _file.close();
+    _gameId.clear();
+    _maxPlies = 0;
+    _positions = 0;
+    _games = 0;
+    _mask = 0;
+    _entries = nullptr;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+//
+// how often each position came up in a game log and how it turned out
+//
+// built by replaying every game of one kind in a log through its rules (see
+// SelfPlayGame) up to a ply limit. positions are keyed by canonicalKey(), so a
+// position and its mirror images count as one, and the best reply is kept in
+// that canonical position's frame: map it back with mapMove(..., inverse).
+//
+// building runs on every core: each thread replays its share of the games into
+// its own tables, split into shards by key, then each shard is merged across
+// the threads by one thread. the file is a single open addressing hash table
+// that is memory mapped for lookups, a probe touches one or two cache lines.
+//
+
+// one position, 32 bytes on disk
+struct PositionEntry
+{
+    // 0 for an empty slot
+    uint64_t    key;
+    // for the side to move in the position
+    uint32_t    wins;
+    uint32_t    draws;
+    uint32_t    losses;
+    // earliest ply it was seen at
+    uint32_t    ply;
+    // the reply that scored best for the side to move, -1 for none
+    int32_t     bestReply;
+    uint32_t    bestReplyGames;
+
+    uint32_t    games() const { return wins + draws + losses; }
+    double      score() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+};
+
+// what came of one move from one position over a whole log
+struct PositionReply
+{
+    uint64_t    position = 0;
+    int32_t     move = -1;
+    uint32_t    games = 0;
+    // for the side that played it, in half points so draws stay whole
+    uint32_t    halfPoints = 0;
+
+    // as if it also had two drawn games, so one lucky win doesn't make a best reply
+    double      score() const;
+};
+
+struct PositionBuildStats
+{
+    uint64_t    gamesRead = 0;
+    // games of the right kind that replayed cleanly
+    uint64_t    gamesUsed = 0;
+    // games with a move the rules didn't allow
+    uint64_t    gamesRejected = 0;
+    uint64_t    positions = 0;
+    uint64_t    replies = 0;
+    double      seconds = 0.0;
+};
+
+class PositionDatabase
+{
+public:
+    PositionDatabase();
+    ~PositionDatabase();
+
+    // replay the gameId games in logPath, the first maxPlies positions of each,
+    // and write the table to outPath. threads <= 0 uses every core
+    static bool build(const std::string &logPath, const std::string &gameId, const std::string &outPath,
+                      int maxPlies, int threads, PositionBuildStats &stats);
+    // the same replay without writing anything: every position, and every move
+    // played from one, for builders of other tables (see OpeningBook)
+    static bool collect(const std::string &logPath, const std::string &gameId, int maxPlies, int threads,
+                        std::vector<PositionEntry> &positions, std::vector<PositionReply> &replies, PositionBuildStats &stats);
+
+    // memory map a table written by build(), the file stays mapped until close()
+    bool        open(const std::string &path);
+    void        close();
+    bool        isOpen() const { return _entries != nullptr; }
+
+    // nullptr if the position never came up
+    const PositionEntry *probe(uint64_t key) const
+    {
+        if (!_entries) return nullptr;
+        for (uint64_t slot = key & _mask;; slot = (slot + 1) & _mask) {
+            const PositionEntry &entry = _entries[slot];
+            if (entry.key == key) return &entry;
+            if (entry.key == 0) return nullptr;
+        }
+    }
+
+    const std::string &gameId() const { return _gameId; }
+    int         maxPlies() const { return _maxPlies; }
+    uint64_t    positions() const { return _positions; }
+    uint64_t    games() const { return _games; }
+    uint64_t    capacity() const { return _mask + 1; }
+    const PositionEntry *entries() const { return _entries; }
+
+private:
+    std::string     _gameId;
+    int             _maxPlies;
+    uint64_t        _positions;
+    uint64_t        _games;
+    uint64_t        _mask;
+    const PositionEntry *_entries;
+    MappedFile      _file;
+};
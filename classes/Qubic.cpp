@@ -0,0 +1,230 @@
+#include "Qubic.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+
+const int AI_PLAYER   = 1;      // index of the AI player (O)
+const int HUMAN_PLAYER= 0;      // index of the human player (X)
+
+// how long the AI may think about one move before it plays its best guess
+const double AI_TIME_BUDGET = 1.0;
+
+// the four layers are drawn smaller than a normal board
+const float CELL_SIZE = 64.0f;
+// space between the layers
+const float LAYER_GAP = 24.0f;
+
+static GameRegistration registration({
+    .id = kGameIdQubic, .name = "Qubic (4x4x4)", .boardWidth = 8, .boardHeight = 8, .players = 2,
+    .hasAI = true, .ai = "alpha-beta with forced block extensions",
+    .create = [](const GameSetup &) -> Game * { return new Qubic(); },
+});
+
+Qubic::Qubic()
+{
+    _search.setTimeBudget(AI_TIME_BUDGET);
+}
+
+Qubic::~Qubic()
+{
+}
+
+//
+// X for the first player, O for the second
+//
+Bit* Qubic::PieceForPlayer(const int playerNumber)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(playerNumber == 0 ? "x.png" : "o.png");
+    bit->setSize(CELL_SIZE, CELL_SIZE);
+    bit->setOwner(getPlayerAt(playerNumber));
+    return bit;
+}
+
+void Qubic::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = 8;
+    _gameOptions.rowY = 8;
+
+    // no limit means search until the position is solved or the time budget runs out
+    if (_gameOptions.AIMAXDepth <= 0) {
+        _gameOptions.AIMAXDepth = QubicBoard::kCells;
+    }
+
+    setAIPlayer(AI_PLAYER);
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            ImVec2 position(x * CELL_SIZE + (x / 4) * LAYER_GAP + 50.0f, y * CELL_SIZE + (y / 4) * LAYER_GAP + 50.0f);
+            _grid[y][x].initHolder(position, "square.png", x, y);
+            _grid[y][x].setSize(CELL_SIZE, CELL_SIZE);
+        }
+    }
+    _board = QubicBoard();
+    colorSquares();
+
+    startGame();
+}
+
+//
+// each layer gets its own shade, the winning line is picked out in gold
+//
+void Qubic::colorSquares()
+{
+    const ImVec4 layerColors[4] = {
+        ImVec4(1.0f, 1.0f, 1.0f, 1.0f),
+        ImVec4(0.8f, 0.9f, 1.0f, 1.0f),
+        ImVec4(0.8f, 1.0f, 0.85f, 1.0f),
+        ImVec4(1.0f, 0.9f, 0.8f, 1.0f),
+    };
+    uint64_t line = _board.winningLine();
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            int cell = cellAt(x, y);
+            const ImVec4 &color = layerColors[cell / 16];
+            if (line & (1ull << cell)) {
+                _grid[y][x].setColor(1.0f, 0.8f, 0.2f, 1.0f);
+            } else {
+                _grid[y][x].setColor(color.x, color.y, color.z, color.w);
+            }
+        }
+    }
+}
+
+bool Qubic::actionForEmptyHolder(BitHolder *holder)
+{
+    if (!holder) return false;
+
+    // every holder in this game is one of our squares
+    Square *square = static_cast<Square *>(holder);
+    return playCell(cellAt(square->column(), square->row()));
+}
+
+bool Qubic::playCell(int cell)
+{
+    if (cell < 0 || cell >= QubicBoard::kCells) return false;
+    if (_board.isOver() || !_board.isEmpty(cell)) return false;
+
+    Player *currentPlayer = getCurrentPlayer();
+    if (!currentPlayer) return false;
+
+    Square &square = squareFor(cell);
+    Bit *newBit = PieceForPlayer(currentPlayer->playerNumber());
+    newBit->moveTo(square.getPosition());
+    square.setBit(newBit);
+    _board.play(cell);
+    colorSquares();
+
+    Player *winner = checkForWinner();
+    if (winner) {
+        _winner = winner;
+    }
+    return true;
+}
+
+bool Qubic::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    // pieces stay where they were put
+    return false;
+}
+
+bool Qubic::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    return false;
+}
+
+void Qubic::stopGame()
+{
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            _grid[y][x].destroyBit();
+        }
+    }
+    _board = QubicBoard();
+}
+
+Player* Qubic::checkForWinner()
+{
+    int winner = _board.winner();
+    return winner >= 0 ? getPlayerAt(winner) : nullptr;
+}
+
+bool Qubic::checkForDraw()
+{
+    return _board.isFull() && _board.winner() < 0;
+}
+
+//
+// state strings, one character per cell from the bottom layer up, 0 empty, 1 X, 2 O
+//
+std::string Qubic::initialStateString()
+{
+    return std::string(QubicBoard::kCells, '0');
+}
+
+std::string Qubic::stateString() const
+{
+    std::string state;
+    for (int cell = 0; cell < QubicBoard::kCells; cell++) {
+        state += (char)('1' + _board.ownerAt(cell));
+    }
+    return state;
+}
+
+void Qubic::setStateString(const std::string &s)
+{
+    uint64_t stones[2] = { 0, 0 };
+
+    for (int cell = 0; cell < QubicBoard::kCells; cell++) {
+        Square &square = squareFor(cell);
+        int playerNumber = cell < (int)s.size() ? s[cell] - '0' : 0;
+
+        square.destroyBit();
+        if (playerNumber == 1 || playerNumber == 2) {
+            Bit *bit = PieceForPlayer(playerNumber - 1);
+            bit->moveTo(square.getPosition());
+            square.setBit(bit);
+            stones[playerNumber - 1] |= 1ull << cell;
+        }
+    }
+    _board.setStones(stones[0], stones[1]);
+    colorSquares();
+}
+
+void Qubic::updateAI()
+{
+    if (_board.isOver()) {
+        return;
+    }
+
+    int symmetry;
+    int cell = openingBookMove(canonicalKey(_board, symmetry));
+    if (cell >= 0) {
+        cell = mapCube(cell, symmetry, true);
+        if (playCell(cell)) {
+            _lastStats.setBookMove(cell);
+            _lastStats.logMove("qubic", (int)getCurrentTurnNo());
+            endTurn();
+            return;
+        }
+    }
+
+    _search.setTimeBudget(searchTimeBudget(AI_TIME_BUDGET));
+    cell = _search.findBestMove(_board, _gameOptions.AIMAXDepth);
+    _lastStats = _search.stats();
+    _lastStats.logMove("qubic", (int)getCurrentTurnNo());
+
+    if (playCell(cell)) {
+        endTurn();
+    }
+}
+
+bool Qubic::playRecordedMove(int move)
+{
+    if (!playCell(move)) {
+        return false;
+    }
+    endTurn();
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Game.h"
+#include "Square.h"
+#include "QubicBoard.h"
+#include "QubicSearch.h"
+
+//
+// qubic, tic-tac-toe on a 4x4x4 cube
+//
+// the four layers of the cube are drawn as four 4x4 boards, bottom layer at the
+// top left and top layer at the bottom right. a line can run inside one layer or
+// through all four of them. the AI plays O.
+//
+class Qubic : public Game
+{
+public:
+    Qubic();
+    ~Qubic();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    // 64 cells layer by layer, 0 empty, 1 X, 2 O
+    std::string stateString() const override;
+    void        setStateString(const std::string &s) override;
+    bool        actionForEmptyHolder(BitHolder *holder) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        playRecordedMove(int move) override;
+    bool        gameHasAI() override { return true; }
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+
+    const SearchStats *searchStats() const override { return &_lastStats; }
+
+private:
+    Bit *       PieceForPlayer(const int playerNumber);
+    // the layers sit 2x2 on an 8x8 grid of squares
+    static int  cellAt(int x, int y) { return ((y / 4) * 2 + x / 4) * 16 + (y % 4) * 4 + x % 4; }
+    Square      &squareFor(int cell) { return _grid[(cell / 32) * 4 + (cell / 4) % 4][((cell / 16) % 2) * 4 + cell % 4]; }
+    bool        playCell(int cell);
+    void        colorSquares();
+
+    Square          _grid[8][8];
+    QubicBoard      _board;
+    QubicSearch     _search;
+
+    // what the last AI move cost
+    SearchStats     _lastStats;
+};
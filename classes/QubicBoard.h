@@ -0,0 +1,212 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+//
+// 4x4x4 tic-tac-toe (qubic) on 64-bit masks
+//
+// cell = layer * 16 + row * 4 + column, so one uint64_t holds a player's stones
+// and every one of the 76 winning lines is a mask with four bits set: 48 straight
+// lines (rows, columns and verticals), 24 diagonals across the flat planes and 4
+// through the middle of the cube. they are found by walking the 13 directions
+// from every cell.
+//
+// the board also keeps how many stones each player has on every line. a move only
+// touches the 4 to 7 lines through its cell, so wins, threats and the evaluation
+// are all updated in a few steps instead of looking at every line again.
+//
+
+struct QubicLines
+{
+    static const int kLines = 76;
+
+    uint64_t    masks[kLines];
+    // the lines through each cell, corners and the 8 center cells have 7, the rest 4
+    uint8_t     cellLineCount[64];
+    uint8_t     cellLines[64][7];
+
+    constexpr QubicLines() : masks(), cellLineCount(), cellLines()
+    {
+        int count = 0;
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    // one of each pair of opposite directions
+                    int first = dz != 0 ? dz : (dy != 0 ? dy : dx);
+                    if (first <= 0) {
+                        continue;
+                    }
+                    for (int cell = 0; cell < 64; cell++) {
+                        int x = cell & 3, y = (cell >> 2) & 3, z = cell >> 4;
+                        // only lines that start here and stay on the board
+                        if (inside(x - dx, y - dy, z - dz) || !inside(x + 3 * dx, y + 3 * dy, z + 3 * dz)) {
+                            continue;
+                        }
+                        uint64_t mask = 0;
+                        for (int i = 0; i < 4; i++) {
+                            int c = (z + i * dz) * 16 + (y + i * dy) * 4 + (x + i * dx);
+                            mask |= 1ull << c;
+                            cellLines[c][cellLineCount[c]++] = (uint8_t)count;
+                        }
+                        masks[count++] = mask;
+                    }
+                }
+            }
+        }
+    }
+
+    static constexpr bool inside(int x, int y, int z)
+    {
+        return x >= 0 && x < 4 && y >= 0 && y < 4 && z >= 0 && z < 4;
+    }
+};
+
+inline constexpr QubicLines qubicLines;
+
+class QubicBoard
+{
+public:
+    static const int kCells = 64;
+    static const int kLines = QubicLines::kLines;
+
+    // what a line with 0..3 stones of one player and none of the other is worth to that player
+    static constexpr int kLineValue[4] = { 0, 1, 5, 40 };
+
+    QubicBoard() : _stones(), _counts(), _score(0), _moves(0), _winner(-1), _winningLine(-1) {}
+
+    int         moves() const { return _moves; }
+    // zero based number of the player to move, player 0 always starts
+    int         currentPlayer() const { return _moves & 1; }
+    uint64_t    stones(int player) const { return _stones[player]; }
+    uint64_t    occupied() const { return _stones[0] | _stones[1]; }
+    uint64_t    empty() const { return ~occupied(); }
+    bool        isEmpty(int cell) const { return !(occupied() & (1ull << cell)); }
+    // -1 if empty, otherwise the player
+    int         ownerAt(int cell) const
+    {
+        if (_stones[0] & (1ull << cell)) return 0;
+        if (_stones[1] & (1ull << cell)) return 1;
+        return -1;
+    }
+    int         winner() const { return _winner; }
+    // mask of the four in a row, 0 if nobody has won
+    uint64_t    winningLine() const { return _winningLine >= 0 ? qubicLines.masks[_winningLine] : 0; }
+    bool        isFull() const { return _moves == kCells; }
+    bool        isOver() const { return _winner >= 0 || isFull(); }
+    // unique enough for a transposition table
+    uint64_t    key() const
+    {
+        uint64_t a = _stones[0] * 0x9E3779B97F4A7C15ull;
+        uint64_t b = _stones[1] * 0xC2B2AE3D27D4EB4Full;
+        return a ^ ((b << 29) | (b >> 35)) ^ b;
+    }
+
+    // sum of line values, player 0's minus player 1's
+    int         score() const { return _score; }
+    // the same from the player to move's side
+    int         evaluate() const { return currentPlayer() == 0 ? _score : -_score; }
+
+    void        play(int cell)
+    {
+        int player = currentPlayer();
+        _stones[player] |= 1ull << cell;
+        for (int i = 0; i < qubicLines.cellLineCount[cell]; i++) {
+            int line = qubicLines.cellLines[cell][i];
+            _score -= lineScore(line);
+            if (++_counts[player][line] == 4) {
+                _winner = player;
+                _winningLine = line;
+            }
+            _score += lineScore(line);
+        }
+        _moves++;
+    }
+
+    // take back the last move, which was made on cell
+    void        undo(int cell)
+    {
+        _moves--;
+        int player = currentPlayer();
+        _stones[player] &= ~(1ull << cell);
+        for (int i = 0; i < qubicLines.cellLineCount[cell]; i++) {
+            int line = qubicLines.cellLines[cell][i];
+            _score -= lineScore(line);
+            _counts[player][line]--;
+            _score += lineScore(line);
+        }
+        // a won game ends, so only the move being taken back can have won it
+        _winner = -1;
+        _winningLine = -1;
+    }
+
+    // empty cells that would complete a line for player
+    uint64_t    threats(int player) const
+    {
+        uint64_t cells = 0;
+        for (int line = 0; line < kLines; line++) {
+            if (_counts[player][line] == 3 && _counts[1 - player][line] == 0) {
+                cells |= qubicLines.masks[line] & ~_stones[player];
+            }
+        }
+        return cells;
+    }
+
+    // how much playing cell improves the position for the player to move, used to order moves
+    int         moveScore(int cell) const
+    {
+        int me = currentPlayer();
+        int score = 0;
+        for (int i = 0; i < qubicLines.cellLineCount[cell]; i++) {
+            int line = qubicLines.cellLines[cell][i];
+            int mine = _counts[me][line];
+            int theirs = _counts[1 - me][line];
+            if (theirs == 0 && mine < 3) {
+                score += kLineValue[mine + 1] - kLineValue[mine];
+            } else if (mine == 0 && theirs > 0) {
+                // blocking takes their line away
+                score += kLineValue[theirs];
+            }
+        }
+        return score;
+    }
+
+    // set up any position from each player's stones, the player to move follows from the counts
+    void        setStones(uint64_t first, uint64_t second)
+    {
+        _stones[0] = first;
+        _stones[1] = second & ~first;
+        _moves = std::popcount(_stones[0]) + std::popcount(_stones[1]);
+        _score = 0;
+        _winner = -1;
+        _winningLine = -1;
+        for (int line = 0; line < kLines; line++) {
+            for (int player = 0; player < 2; player++) {
+                _counts[player][line] = (uint8_t)std::popcount(_stones[player] & qubicLines.masks[line]);
+                if (_counts[player][line] == 4) {
+                    _winner = player;
+                    _winningLine = line;
+                }
+            }
+            _score += lineScore(line);
+        }
+    }
+
+private:
+    // a line counts for whoever is alone on it, player 0 positive
+    int         lineScore(int line) const
+    {
+        int first = _counts[0][line];
+        int second = _counts[1][line];
+        if (second == 0 && first < 4) return kLineValue[first];
+        if (first == 0 && second < 4) return -kLineValue[second];
+        return 0;
+    }
+
+    uint64_t    _stones[2];
+    uint8_t     _counts[2][kLines];
+    int         _score;
+    int         _moves;
+    int8_t      _winner;
+    int8_t      _winningLine;
+};
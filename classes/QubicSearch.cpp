@@ -0,0 +1,183 @@
+#include "QubicSearch.h"
+
+#include <algorithm>
+
+// larger than any score negamax can return
+const int SCORE_INFINITY = QubicSearch::kWinScore + 1000;
+
+// scores this close to a win are wins in a known number of plies
+const int SCORE_WIN_BOUND = QubicSearch::kWinScore - 1000;
+
+// sorts ahead of any move score
+const int TABLE_MOVE_SCORE = 1 << 20;
+
+QubicSearch::QubicSearch() : _table(SCORE_WIN_BOUND)
+{
+    _solved = false;
+}
+
+void QubicSearch::clearTable()
+{
+    _table.clear();
+}
+
+int QubicSearch::orderMoves(const QubicBoard &board, uint8_t *moves, int tableMove) const
+{
+    // score in the high bits, cell in the low byte, so one sort orders both
+    int keys[QubicBoard::kCells];
+    int count = 0;
+    uint64_t empty = board.empty();
+    while (empty) {
+        int cell = std::countr_zero(empty);
+        empty &= empty - 1;
+        int score = cell == tableMove ? TABLE_MOVE_SCORE : board.moveScore(cell);
+        keys[count++] = (score << 8) | cell;
+    }
+    std::sort(keys, keys + count, [](int a, int b) { return a > b; });
+    for (int i = 0; i < count; i++) {
+        moves[i] = (uint8_t)(keys[i] & 0xFF);
+    }
+    return count;
+}
+
+//
+// the player to move never has a win on the board here, the parent already took it
+//
+int QubicSearch::negamax(QubicBoard &board, int alpha, int beta, int ply, int depthLeft)
+{
+    if (_clock.tick(++_stats.nodes)) {
+        return 0;
+    }
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+    if (board.isFull()) {
+        return 0;
+    }
+
+    int me = board.currentPlayer();
+    // a win on the board is taken straight away
+    if (board.threats(me) & board.empty()) {
+        return kWinScore - (ply + 1);
+    }
+    // two threats can't both be blocked, one has to be
+    uint64_t theirs = board.threats(1 - me) & board.empty();
+    if (std::popcount(theirs) >= 2) {
+        return -(kWinScore - (ply + 2));
+    }
+    bool forced = theirs != 0;
+    if (depthLeft <= 0 && !forced) {
+        return board.evaluate();
+    }
+
+    uint64_t key = board.key();
+    int tableMove = -1;
+    int tableScore;
+    if (_table.probe(key, depthLeft, alpha, beta, ply, tableMove, tableScore, _stats)) {
+        return tableScore;
+    }
+
+    uint8_t moves[QubicBoard::kCells];
+    int count;
+    if (forced) {
+        // the block is the only move and doesn't count against the depth
+        moves[0] = (uint8_t)std::countr_zero(theirs);
+        count = 1;
+        depthLeft++;
+    } else {
+        count = orderMoves(board, moves, tableMove);
+    }
+
+    int originalAlpha = alpha;
+    int bestScore = -SCORE_INFINITY;
+    int bestMove = -1;
+    _stats.expanded++;
+
+    for (int i = 0; i < count; i++) {
+        board.play(moves[i]);
+        int score = -negamax(board, -beta, -alpha, ply + 1, depthLeft - 1);
+        board.undo(moves[i]);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = moves[i];
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        if (alpha >= beta) {
+            _stats.cutoffs++;
+            if (i == 0) {
+                _stats.firstMoveCutoffs++;
+            }
+            break;
+        }
+    }
+
+    if (_clock.timeUp()) {
+        return 0;
+    }
+
+    _table.store(key, depthLeft, ply, bestScore, bestMove, originalAlpha, beta);
+    return bestScore;
+}
+
+int QubicSearch::findBestMove(const QubicBoard &board, int maxDepth)
+{
+    _clock.start();
+    _solved = false;
+    _stats.reset();
+
+    if (board.isOver()) {
+        return -1;
+    }
+
+    int me = board.currentPlayer();
+    uint64_t wins = board.threats(me) & board.empty();
+    if (wins) {
+        // take a win when there is one
+        int cell = std::countr_zero(wins);
+        _solved = true;
+        _stats.bestMove = cell;
+        _stats.score = kWinScore - 1;
+        _stats.principalVariation.push_back(cell);
+        _stats.seconds = _clock.elapsed();
+        return cell;
+    }
+
+    std::vector<uint8_t> candidates;
+    uint64_t theirs = board.threats(1 - me) & board.empty();
+    if (theirs) {
+        // block, with two threats on the board this only delays the loss
+        candidates.push_back((uint8_t)std::countr_zero(theirs));
+    } else {
+        uint8_t moves[QubicBoard::kCells];
+        int count = orderMoves(board, moves, -1);
+        candidates.assign(moves, moves + count);
+    }
+
+    int remaining = QubicBoard::kCells - board.moves();
+    int limit = (maxDepth > 0 && maxDepth < remaining) ? maxDepth : remaining;
+    QubicBoard position = board;
+    int bestScore = deepen(candidates.data(), (int)candidates.size(), limit, SCORE_INFINITY, SCORE_WIN_BOUND, _clock, _stats, [&](int cell, int alpha, int depth) {
+        position.play(cell);
+        int score = -negamax(position, -SCORE_INFINITY, -alpha, 1, depth - 1);
+        position.undo(cell);
+        return score;
+    });
+    int bestMove = candidates[0];
+    _solved = bestScore > SCORE_WIN_BOUND || bestScore < -SCORE_WIN_BOUND || _stats.depthLimit >= remaining;
+
+    _stats.seconds = _clock.elapsed();
+    _stats.bestMove = bestMove;
+    _stats.score = bestScore;
+
+    // principal variation out of the table
+    int move = bestMove;
+    while (move >= 0 && position.isEmpty(move) && !position.isOver() && (int)_stats.principalVariation.size() < remaining) {
+        _stats.principalVariation.push_back(move);
+        position.play(move);
+        move = _table.move(position.key());
+    }
+    return bestMove;
+}
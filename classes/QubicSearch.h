@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "QubicBoard.h"
+#include "SearchStats.h"
+#include "SearchTable.h"
+
+//
+// alpha-beta search for 4x4x4 tic-tac-toe
+//
+// iterative deepening negamax with a transposition table, on one board that is
+// played and taken back as the search goes so the line counts stay incremental.
+// a move that answers a single threat is forced and doesn't use up depth, which
+// lets the search follow the long chains of forcing moves qubic is won with. two
+// open threats at once lose on the spot. moves are tried table move first, then
+// by how much they add to the line counts.
+//
+
+class QubicSearch
+{
+public:
+    QubicSearch();
+
+    // best cell for the player to move, -1 if the game is over
+    int         findBestMove(const QubicBoard &board, int maxDepth = 0);
+
+    void        setTimeBudget(double seconds) { _clock.setBudget(seconds); }
+    double      timeBudget() const { return _clock.budget(); }
+    // true if the last findBestMove() proved the result instead of guessing
+    bool        solved() const { return _solved; }
+    const SearchStats &stats() const { return _stats; }
+
+    void        clearTable();
+
+    static const int kWinScore = 100000;
+
+private:
+    int         negamax(QubicBoard &board, int alpha, int beta, int ply, int depthLeft);
+    // empty cells of board best first, returns how many
+    int         orderMoves(const QubicBoard &board, uint8_t *moves, int tableMove) const;
+
+    SearchTable _table;
+    SearchClock _clock;
+    SearchStats _stats;
+    bool        _solved;
+};
@@ -0,0 +1,108 @@
+#include "Replay.h"
+
+#include <algorithm>
+
+GameReplay::GameReplay()
+{
+    clear();
+}
+
+void GameReplay::clear()
+{
+    _text.clear();
+    _deltas.clear();
+    _keyframePlies.clear();
+    _keyframes.clear();
+    _sinceKeyframe = 0;
+    _last.clear();
+    _ply = 0;
+    _current.clear();
+}
+
+void GameReplay::addState(const std::string &state)
+{
+    if (_keyframes.empty()) {
+        _keyframePlies.push_back(0);
+        _keyframes.push_back(state);
+        _last = state;
+        _current = state;
+        _ply = 0;
+        return;
+    }
+
+    // trim what the two boards share at either end
+    size_t shorter = std::min(_last.size(), state.size());
+    size_t prefix = 0;
+    while (prefix < shorter && _last[prefix] == state[prefix]) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < shorter - prefix && _last[_last.size() - 1 - suffix] == state[state.size() - 1 - suffix]) {
+        suffix++;
+    }
+
+    Delta delta;
+    delta.offset = (uint32_t)prefix;
+    delta.beforeStart = (uint32_t)_text.size();
+    delta.beforeLength = (uint32_t)(_last.size() - prefix - suffix);
+    _text.append(_last, prefix, delta.beforeLength);
+    delta.afterStart = (uint32_t)_text.size();
+    delta.afterLength = (uint32_t)(state.size() - prefix - suffix);
+    _text.append(state, prefix, delta.afterLength);
+    _deltas.push_back(delta);
+    _last = state;
+
+    _sinceKeyframe += delta.afterLength;
+    if (_sinceKeyframe >= state.size()) {
+        _keyframePlies.push_back(plies());
+        _keyframes.push_back(state);
+        _sinceKeyframe = 0;
+    }
+}
+
+size_t GameReplay::bytes() const
+{
+    size_t total = _text.size() + _deltas.size() * sizeof(Delta) + _keyframePlies.size() * sizeof(int);
+    for (const std::string &keyframe : _keyframes) {
+        total += keyframe.size();
+    }
+    return total;
+}
+
+void GameReplay::applyForward(int ply)
+{
+    const Delta &delta = _deltas[ply];
+    _current.replace(delta.offset, delta.beforeLength, _text, delta.afterStart, delta.afterLength);
+}
+
+void GameReplay::applyBackward(int ply)
+{
+    const Delta &delta = _deltas[ply];
+    _current.replace(delta.offset, delta.afterLength, _text, delta.beforeStart, delta.beforeLength);
+}
+
+const std::string &GameReplay::seek(int ply)
+{
+    if (_keyframes.empty()) {
+        return _current;
+    }
+    ply = std::max(0, std::min(ply, plies()));
+
+    // the last keyframe at or before ply
+    size_t keyframe = std::upper_bound(_keyframePlies.begin(), _keyframePlies.end(), ply) - _keyframePlies.begin() - 1;
+    int fromKeyframe = ply - _keyframePlies[keyframe];
+    int fromHere = ply > _ply ? ply - _ply : _ply - ply;
+
+    // deltas are about the same size either way, so the fewer of them wins
+    if (fromKeyframe < fromHere) {
+        _current = _keyframes[keyframe];
+        _ply = _keyframePlies[keyframe];
+    }
+    for (; _ply < ply; _ply++) {
+        applyForward(_ply);
+    }
+    for (; _ply > ply; _ply--) {
+        applyBackward(_ply - 1);
+    }
+    return _current;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// a finished game as the board after every ply, for stepping and seeking
+//
+// boards are the games' own state strings (Game::stateString()), so any game
+// replays the same way and showing a ply is one setStateString(). each ply is
+// stored as a delta from the one before: the changed middle of the string,
+// before and after, with the unchanged start and end left out. that is a
+// character or two for a placed stone and a short run for a reversi flip or a
+// chess move. a full copy, a keyframe, is kept whenever the deltas since the
+// last one add up to more than a board, so rebuilding any ply never costs more
+// than about two boards of copying.
+//
+// seeking finds the last keyframe at or before the ply with a binary search
+// and applies the deltas after it, or steps from wherever the replay already is
+// when that is closer. stepping one ply either way is one delta.
+//
+class GameReplay
+{
+public:
+    GameReplay();
+
+    void        clear();
+    // the board after the next ply, the first one added is the starting position
+    void        addState(const std::string &state);
+
+    // plies after the start, so seek() takes 0 to plies()
+    int         plies() const { return (int)_deltas.size(); }
+    int         ply() const { return _ply; }
+    bool        empty() const { return _keyframes.empty(); }
+    size_t      keyframes() const { return _keyframePlies.size(); }
+    // what the deltas and keyframes take up
+    size_t      bytes() const;
+
+    // the board at that ply, clamped to the game
+    const std::string &seek(int ply);
+    const std::string &stepForward() { return seek(_ply + 1); }
+    const std::string &stepBack() { return seek(_ply - 1); }
+    const std::string &state() const { return _current; }
+
+private:
+    // the characters from offset on that change between one ply and the next
+    struct Delta
+    {
+        uint32_t    offset;
+        // where the old and new characters are in _text
+        uint32_t    beforeStart;
+        uint32_t    beforeLength;
+        uint32_t    afterStart;
+        uint32_t    afterLength;
+    };
+
+    // _current from ply to ply + 1 and back
+    void        applyForward(int ply);
+    void        applyBackward(int ply);
+
+    // the replaced text of every delta, before and after, back to back
+    std::string             _text;
+    // _deltas[n] takes ply n to ply n + 1
+    std::vector<Delta>      _deltas;
+    // sorted, 0 is always one
+    std::vector<int>        _keyframePlies;
+    std::vector<std::string> _keyframes;
+    // delta bytes added since the last keyframe
+    size_t                  _sinceKeyframe;
+    // the last board added, to diff the next one against
+    std::string             _last;
+
+    int                     _ply;
+    std::string             _current;
+};
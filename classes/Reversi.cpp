@@ -0,0 +1,221 @@
+#include "Reversi.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+
+const int AI_PLAYER   = 1;      // index of the AI player (yellow)
+const int HUMAN_PLAYER= 0;      // index of the human player (red)
+
+// how long the AI may think about one move before it plays its best guess
+const double AI_TIME_BUDGET = 1.0;
+
+static GameRegistration registration({
+    .id = kGameIdReversi, .name = "Reversi", .boardWidth = 8, .boardHeight = 8, .players = 2,
+    .hasAI = true, .ai = "alpha-beta, exact solver for the last 14 empties",
+    .create = [](const GameSetup &) -> Game * { return new Reversi(); },
+});
+
+Reversi::Reversi()
+{
+    _search.setTimeBudget(AI_TIME_BUDGET);
+}
+
+Reversi::~Reversi()
+{
+}
+
+//
+// red for the first player, yellow for the second
+//
+Bit* Reversi::PieceForPlayer(const int playerNumber)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(playerNumber == 0 ? "red.png" : "yellow.png");
+    bit->setOwner(getPlayerAt(playerNumber));
+    bit->setGameTag(1 + playerNumber);
+    return bit;
+}
+
+void Reversi::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = 8;
+    _gameOptions.rowY = 8;
+
+    // no limit means search until the time budget runs out
+    if (_gameOptions.AIMAXDepth <= 0) {
+        _gameOptions.AIMAXDepth = ReversiBoard::kSquares;
+    }
+
+    setAIPlayer(AI_PLAYER);
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            ImVec2 position(x * 100.0f + 50.0f, y * 100.0f + 50.0f);
+            _grid[y][x].initHolder(position, "square.png", x, y);
+        }
+    }
+    _board.reset();
+    _search.clearTable();
+    syncDiscs();
+    showLegalMoves();
+
+    startGame();
+}
+
+//
+// make the bits on the board match the discs, a flipped disc gets a new bit
+//
+void Reversi::syncDiscs()
+{
+    for (int square = 0; square < ReversiBoard::kSquares; square++) {
+        Square &holder = squareAt(square);
+        int owner = _board.ownerAt(square);
+        int tag = owner + 1;
+        Bit *bit = holder.bit();
+        if ((bit ? bit->gameTag() : 0) == tag) {
+            continue;
+        }
+        holder.destroyBit();
+        if (owner >= 0) {
+            bit = PieceForPlayer(owner);
+            bit->moveTo(holder.getPosition());
+            holder.setBit(bit);
+        }
+    }
+}
+
+//
+// green felt, a lighter green where the player to move may put a disc
+//
+void Reversi::showLegalMoves()
+{
+    uint64_t moves = _board.moves();
+    for (int square = 0; square < ReversiBoard::kSquares; square++) {
+        bool legal = moves >> square & 1;
+        squareAt(square).setColor(legal ? 0.45f : 0.2f, legal ? 0.8f : 0.55f, legal ? 0.5f : 0.3f, 1.0f);
+    }
+}
+
+bool Reversi::actionForEmptyHolder(BitHolder *holder)
+{
+    if (!holder) return false;
+
+    // every holder in this game is one of our squares
+    Square *square = static_cast<Square *>(holder);
+    return playSquare(square->row() * 8 + square->column());
+}
+
+bool Reversi::playSquare(int square)
+{
+    if (!_board.isLegal(square)) return false;
+
+    _board.play(square);
+    if (_board.mustPass()) {
+        // the other side's turn goes by without a move, the caller ends the one after it
+        endTurn();
+        _board.pass();
+    }
+    syncDiscs();
+    showLegalMoves();
+
+    Player *winner = checkForWinner();
+    if (winner) {
+        _winner = winner;
+    }
+    return true;
+}
+
+bool Reversi::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    // discs stay where they were put, they only change colour
+    return false;
+}
+
+bool Reversi::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    return false;
+}
+
+void Reversi::stopGame()
+{
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            _grid[y][x].destroyBit();
+        }
+    }
+    _board.reset();
+}
+
+Player* Reversi::checkForWinner()
+{
+    int winner = _board.winner();
+    return winner >= 0 ? getPlayerAt(winner) : nullptr;
+}
+
+bool Reversi::checkForDraw()
+{
+    return _board.isOver() && _board.winner() < 0;
+}
+
+std::string Reversi::initialStateString()
+{
+    ReversiBoard start;
+    return start.state();
+}
+
+std::string Reversi::stateString() const
+{
+    return _board.state();
+}
+
+void Reversi::setStateString(const std::string &s)
+{
+    if (!_board.setState(s)) {
+        _board.reset();
+    }
+    syncDiscs();
+    showLegalMoves();
+}
+
+void Reversi::updateAI()
+{
+    if (_board.isOver()) {
+        return;
+    }
+
+    int symmetry;
+    int square = openingBookMove(canonicalKey(_board, symmetry));
+    if (square >= 0) {
+        square = mapSquare(square, 8, symmetry, true);
+        if (playSquare(square)) {
+            _lastStats.setBookMove(square);
+            _lastStats.logMove("reversi", (int)getCurrentTurnNo());
+            endTurn();
+            return;
+        }
+    }
+
+    _search.setTimeBudget(searchTimeBudget(AI_TIME_BUDGET));
+    square = _search.findBestMove(_board, _gameOptions.AIMAXDepth);
+    _lastStats = _search.stats();
+    _lastStats.logMove(_search.solved() ? "reversi solved" : "reversi", (int)getCurrentTurnNo());
+
+    if (square < 0) {
+        // nothing to play, only happens when a loaded position left the AI to pass
+        _board.pass();
+        showLegalMoves();
+        endTurn();
+    } else if (playSquare(square)) {
+        endTurn();
+    }
+}
+
+bool Reversi::playRecordedMove(int move)
+{
+    if (!playSquare(move)) {
+        return false;
+    }
+    endTurn();
+    return true;
+}
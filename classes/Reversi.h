@@ -0,0 +1,56 @@
+#pragma once
+#include "Game.h"
+#include "Square.h"
+#include "ReversiBoard.h"
+#include "ReversiSearch.h"
+
+//
+// reversi (othello) on an 8x8 board
+//
+// a disc goes on an empty square by clicking it, and the squares where the
+// player to move may put one are lit up. the discs live in two bitboards and
+// the squares are brought back in step with them after every move. a player
+// with no move passes, which is recorded as a turn of its own. the AI plays
+// yellow.
+//
+class Reversi : public Game
+{
+public:
+    Reversi();
+    ~Reversi();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    // 64 squares row by row from the top (0 empty, 1 red, 2 yellow) then the side to move
+    std::string stateString() const override;
+    void        setStateString(const std::string &s) override;
+    bool        actionForEmptyHolder(BitHolder *holder) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        playRecordedMove(int move) override;
+    bool        gameHasAI() override { return true; }
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+
+    const SearchStats *searchStats() const override { return &_lastStats; }
+
+private:
+    Bit *       PieceForPlayer(const int playerNumber);
+    Square      &squareAt(int square) { return _grid[square / 8][square % 8]; }
+    bool        playSquare(int square);
+    void        syncDiscs();
+    void        showLegalMoves();
+
+    Square          _grid[8][8];
+    ReversiBoard    _board;
+    ReversiSearch   _search;
+
+    // what the last AI move cost
+    SearchStats     _lastStats;
+};
@@ -0,0 +1,314 @@
+#include "ReversiBoard.h"
+
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define REVERSI_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang need to be told a function may use avx2, msvc always allows it
+#if defined(REVERSI_X86) && (defined(__GNUC__) || defined(__clang__))
+#define REVERSI_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define REVERSI_AVX2_TARGET
+#endif
+
+// a shift left by 1, 9 or right by 7 can't land in the first column without
+// having wrapped round from the row before, the other way round for the last
+const uint64_t NOT_FIRST_COLUMN = 0xFEFEFEFEFEFEFEFEull;
+const uint64_t NOT_LAST_COLUMN = 0x7F7F7F7F7F7F7F7Full;
+const uint64_t ALL_SQUARES = ~0ull;
+
+// the four directions towards higher squares (east, south, south east, south
+// west) by their shift, the other four are the same shifts to the right
+const int SHIFTS[4] = { 1, 8, 9, 7 };
+const uint64_t LEFT_MASKS[4] = { NOT_FIRST_COLUMN, ALL_SQUARES, NOT_FIRST_COLUMN, NOT_LAST_COLUMN };
+const uint64_t RIGHT_MASKS[4] = { NOT_LAST_COLUMN, ALL_SQUARES, NOT_LAST_COLUMN, NOT_FIRST_COLUMN };
+
+//
+// Kogge-Stone occluded fills: gen spreads over the squares in pro that join up
+// with it, doubling the distance each step. three steps cover a run of seven.
+//
+static inline uint64_t fillLeft(uint64_t gen, uint64_t pro, int shift)
+{
+    gen |= pro & (gen << shift);
+    pro &= pro << shift;
+    gen |= pro & (gen << (2 * shift));
+    pro &= pro << (2 * shift);
+    gen |= pro & (gen << (4 * shift));
+    return gen;
+}
+
+static inline uint64_t fillRight(uint64_t gen, uint64_t pro, int shift)
+{
+    gen |= pro & (gen >> shift);
+    pro &= pro >> shift;
+    gen |= pro & (gen >> (2 * shift));
+    pro &= pro >> (2 * shift);
+    gen |= pro & (gen >> (4 * shift));
+    return gen;
+}
+
+static uint64_t movesScalar(uint64_t own, uint64_t opp)
+{
+    uint64_t empty = ~(own | opp);
+    uint64_t moves = 0;
+    for (int i = 0; i < 4; i++) {
+        // runs of opponent discs that start next to one of ours, the square past the run is a move if it's empty
+        uint64_t run = fillLeft(own, opp & LEFT_MASKS[i], SHIFTS[i]) & opp;
+        moves |= (run << SHIFTS[i]) & LEFT_MASKS[i];
+        run = fillRight(own, opp & RIGHT_MASKS[i], SHIFTS[i]) & opp;
+        moves |= (run >> SHIFTS[i]) & RIGHT_MASKS[i];
+    }
+    return moves & empty;
+}
+
+static uint64_t flipsScalar(uint64_t own, uint64_t opp, int square)
+{
+    uint64_t disc = 1ull << square;
+    uint64_t flips = 0;
+    for (int i = 0; i < 4; i++) {
+        // the run of opponent discs from the new disc flips if one of ours is at the end of it
+        uint64_t run = fillLeft(disc, opp & LEFT_MASKS[i], SHIFTS[i]) & opp;
+        if ((run << SHIFTS[i]) & LEFT_MASKS[i] & own) {
+            flips |= run;
+        }
+        run = fillRight(disc, opp & RIGHT_MASKS[i], SHIFTS[i]) & opp;
+        if ((run >> SHIFTS[i]) & RIGHT_MASKS[i] & own) {
+            flips |= run;
+        }
+    }
+    return flips;
+}
+
+#ifdef REVERSI_X86
+
+//
+// the same fills with the four left shifts in one register and the four right
+// shifts in another, so all eight directions go at once
+//
+REVERSI_AVX2_TARGET
+static inline __m256i fillLeftAVX2(__m256i gen, __m256i pro, __m256i shift)
+{
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, shift)));
+    pro = _mm256_and_si256(pro, _mm256_sllv_epi64(pro, shift));
+    shift = _mm256_add_epi64(shift, shift);
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, shift)));
+    pro = _mm256_and_si256(pro, _mm256_sllv_epi64(pro, shift));
+    shift = _mm256_add_epi64(shift, shift);
+    return _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_sllv_epi64(gen, shift)));
+}
+
+REVERSI_AVX2_TARGET
+static inline __m256i fillRightAVX2(__m256i gen, __m256i pro, __m256i shift)
+{
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, shift)));
+    pro = _mm256_and_si256(pro, _mm256_srlv_epi64(pro, shift));
+    shift = _mm256_add_epi64(shift, shift);
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, shift)));
+    pro = _mm256_and_si256(pro, _mm256_srlv_epi64(pro, shift));
+    shift = _mm256_add_epi64(shift, shift);
+    return _mm256_or_si256(gen, _mm256_and_si256(pro, _mm256_srlv_epi64(gen, shift)));
+}
+
+REVERSI_AVX2_TARGET
+static inline uint64_t orLanes(__m256i bits)
+{
+    __m128i half = _mm_or_si128(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1));
+    return (uint64_t)_mm_extract_epi64(half, 0) | (uint64_t)_mm_extract_epi64(half, 1);
+}
+
+REVERSI_AVX2_TARGET
+static uint64_t movesAVX2(uint64_t own, uint64_t opp)
+{
+    const __m256i shifts = _mm256_set_epi64x(SHIFTS[3], SHIFTS[2], SHIFTS[1], SHIFTS[0]);
+    const __m256i leftMasks = _mm256_set_epi64x((long long)LEFT_MASKS[3], (long long)LEFT_MASKS[2], (long long)LEFT_MASKS[1], (long long)LEFT_MASKS[0]);
+    const __m256i rightMasks = _mm256_set_epi64x((long long)RIGHT_MASKS[3], (long long)RIGHT_MASKS[2], (long long)RIGHT_MASKS[1], (long long)RIGHT_MASKS[0]);
+    __m256i ownLanes = _mm256_set1_epi64x((long long)own);
+    __m256i oppLanes = _mm256_set1_epi64x((long long)opp);
+
+    __m256i run = _mm256_and_si256(fillLeftAVX2(ownLanes, _mm256_and_si256(oppLanes, leftMasks), shifts), oppLanes);
+    __m256i moves = _mm256_and_si256(_mm256_sllv_epi64(run, shifts), leftMasks);
+    run = _mm256_and_si256(fillRightAVX2(ownLanes, _mm256_and_si256(oppLanes, rightMasks), shifts), oppLanes);
+    moves = _mm256_or_si256(moves, _mm256_and_si256(_mm256_srlv_epi64(run, shifts), rightMasks));
+    return orLanes(moves) & ~(own | opp);
+}
+
+REVERSI_AVX2_TARGET
+static uint64_t flipsAVX2(uint64_t own, uint64_t opp, int square)
+{
+    const __m256i shifts = _mm256_set_epi64x(SHIFTS[3], SHIFTS[2], SHIFTS[1], SHIFTS[0]);
+    const __m256i leftMasks = _mm256_set_epi64x((long long)LEFT_MASKS[3], (long long)LEFT_MASKS[2], (long long)LEFT_MASKS[1], (long long)LEFT_MASKS[0]);
+    const __m256i rightMasks = _mm256_set_epi64x((long long)RIGHT_MASKS[3], (long long)RIGHT_MASKS[2], (long long)RIGHT_MASKS[1], (long long)RIGHT_MASKS[0]);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i ownLanes = _mm256_set1_epi64x((long long)own);
+    __m256i oppLanes = _mm256_set1_epi64x((long long)opp);
+    __m256i disc = _mm256_set1_epi64x((long long)(1ull << square));
+
+    // a lane keeps its run only if the square past the end of it is ours
+    __m256i run = _mm256_and_si256(fillLeftAVX2(disc, _mm256_and_si256(oppLanes, leftMasks), shifts), oppLanes);
+    __m256i end = _mm256_and_si256(_mm256_and_si256(_mm256_sllv_epi64(run, shifts), leftMasks), ownLanes);
+    __m256i flips = _mm256_andnot_si256(_mm256_cmpeq_epi64(end, zero), run);
+    run = _mm256_and_si256(fillRightAVX2(disc, _mm256_and_si256(oppLanes, rightMasks), shifts), oppLanes);
+    end = _mm256_and_si256(_mm256_and_si256(_mm256_srlv_epi64(run, shifts), rightMasks), ownLanes);
+    flips = _mm256_or_si256(flips, _mm256_andnot_si256(_mm256_cmpeq_epi64(end, zero), run));
+    return orLanes(flips);
+}
+
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    if (!osSavesYmm) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // REVERSI_X86
+
+ReversiPath ReversiBoard::bestPath()
+{
+#ifdef REVERSI_X86
+    static const ReversiPath path = cpuHasAVX2() ? kReversiAVX2 : kReversiScalar;
+    return path;
+#else
+    return kReversiScalar;
+#endif
+}
+
+const char *ReversiBoard::pathName(ReversiPath path)
+{
+    return path == kReversiAVX2 ? "avx2" : "scalar";
+}
+
+// looked up once so the search doesn't pay for the function static on every call
+static const ReversiPath activePath = ReversiBoard::bestPath();
+
+uint64_t ReversiBoard::movesFor(uint64_t own, uint64_t opp, ReversiPath path)
+{
+#ifdef REVERSI_X86
+    if (path == kReversiAVX2 && activePath == kReversiAVX2) {
+        return movesAVX2(own, opp);
+    }
+#endif
+    return movesScalar(own, opp);
+}
+
+uint64_t ReversiBoard::flipsFor(uint64_t own, uint64_t opp, int square, ReversiPath path)
+{
+#ifdef REVERSI_X86
+    if (path == kReversiAVX2 && activePath == kReversiAVX2) {
+        return flipsAVX2(own, opp, square);
+    }
+#endif
+    return flipsScalar(own, opp, square);
+}
+
+uint64_t ReversiBoard::movesFor(uint64_t own, uint64_t opp)
+{
+    return movesFor(own, opp, activePath);
+}
+
+uint64_t ReversiBoard::flipsFor(uint64_t own, uint64_t opp, int square)
+{
+    return flipsFor(own, opp, square, activePath);
+}
+
+ReversiBoard::ReversiBoard()
+{
+    reset();
+}
+
+void ReversiBoard::reset()
+{
+    // d5 and e4 for the first player, d4 and e5 for the second
+    _discs[0] = (1ull << (4 * 8 + 3)) | (1ull << (3 * 8 + 4));
+    _discs[1] = (1ull << (3 * 8 + 3)) | (1ull << (4 * 8 + 4));
+    _side = 0;
+}
+
+int ReversiBoard::emptyCount() const
+{
+    return std::popcount(empty());
+}
+
+int ReversiBoard::count(int player) const
+{
+    return std::popcount(_discs[player]);
+}
+
+int ReversiBoard::ownerAt(int square) const
+{
+    if (_discs[0] >> square & 1) return 0;
+    if (_discs[1] >> square & 1) return 1;
+    return -1;
+}
+
+bool ReversiBoard::mustPass() const
+{
+    return moves() == 0 && movesFor(_discs[1 - _side], _discs[_side]) != 0;
+}
+
+bool ReversiBoard::isOver() const
+{
+    return moves() == 0 && movesFor(_discs[1 - _side], _discs[_side]) == 0;
+}
+
+int ReversiBoard::winner() const
+{
+    if (!isOver() || count(0) == count(1)) {
+        return -1;
+    }
+    return count(0) > count(1) ? 0 : 1;
+}
+
+void ReversiBoard::play(int square)
+{
+    uint64_t &own = _discs[_side];
+    uint64_t &opp = _discs[1 - _side];
+    uint64_t flips = flipsFor(own, opp, square);
+    own |= flips | (1ull << square);
+    opp &= ~flips;
+    _side ^= 1;
+}
+
+std::string ReversiBoard::state() const
+{
+    std::string state;
+    for (int square = 0; square < kSquares; square++) {
+        state += (char)('1' + ownerAt(square));
+    }
+    state += (char)('0' + _side);
+    return state;
+}
+
+bool ReversiBoard::setState(const std::string &state)
+{
+    if (state.size() < (size_t)kSquares) {
+        return false;
+    }
+    _discs[0] = _discs[1] = 0;
+    for (int square = 0; square < kSquares; square++) {
+        if (state[square] == '1' || state[square] == '2') {
+            _discs[state[square] - '1'] |= 1ull << square;
+        }
+    }
+    _side = (state.size() > (size_t)kSquares && state[kSquares] == '1') ? 1 : 0;
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//
+// reversi on two 64-bit boards, one bit per square
+//
+// square = row * 8 + column with row 0 at the top. legal moves and the discs a
+// move flips come from Kogge-Stone fills: each direction spreads the mover's
+// discs across runs of the opponent's in three shift-and-mask steps instead of
+// walking square by square. the AVX2 path runs all eight directions at once,
+// four to a register, and is picked at startup when the cpu has it. the scalar
+// path is the reference.
+//
+
+enum ReversiPath
+{
+    kReversiScalar,
+    kReversiAVX2
+};
+
+class ReversiBoard
+{
+public:
+    ReversiBoard();
+
+    // the four discs in the middle, first player to move
+    void        reset();
+
+    int         sideToMove() const { return _side; }
+    uint64_t    discs(int player) const { return _discs[player]; }
+    uint64_t    empty() const { return ~(_discs[0] | _discs[1]); }
+    int         emptyCount() const;
+    int         count(int player) const;
+    // -1 for an empty square
+    int         ownerAt(int square) const;
+
+    // legal moves for the side to move as a bitboard
+    uint64_t    moves() const { return movesFor(_discs[_side], _discs[1 - _side]); }
+    bool        isLegal(int square) const { return square >= 0 && square < 64 && (moves() >> square & 1); }
+    // the side to move has no move but the game goes on
+    bool        mustPass() const;
+    // neither side can move
+    bool        isOver() const;
+    // player with more discs once the game is over, -1 before that and for a tie
+    int         winner() const;
+
+    // plays a legal move and flips what it brackets, the other side moves next
+    void        play(int square);
+    void        pass() { _side ^= 1; }
+
+    // 64 squares from the top (0 empty, 1 first player, 2 second) then the side to move
+    std::string state() const;
+    bool        setState(const std::string &state);
+
+    // moves for own against opp, and the discs of opp a disc of own on square would flip
+    static uint64_t movesFor(uint64_t own, uint64_t opp);
+    static uint64_t flipsFor(uint64_t own, uint64_t opp, int square);
+    static uint64_t movesFor(uint64_t own, uint64_t opp, ReversiPath path);
+    static uint64_t flipsFor(uint64_t own, uint64_t opp, int square, ReversiPath path);
+
+    // the path movesFor() and flipsFor() use on this machine, and its name for logging
+    static ReversiPath  bestPath();
+    static const char   *pathName(ReversiPath path);
+
+    static const int kSquares = 64;
+
+private:
+    uint64_t    _discs[2];
+    int         _side;
+};
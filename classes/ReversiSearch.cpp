@@ -0,0 +1,342 @@
+#include "ReversiSearch.h"
+
+#include <algorithm>
+#include <bit>
+
+// larger than any score negamax can return
+const int SCORE_INFINITY = ReversiSearch::kWinScore + 1000;
+
+// sorts ahead of any move score
+const int TABLE_MOVE_SCORE = 1 << 20;
+
+// with this many empties or fewer the solver stops sorting moves
+const int SOLVE_SORT_EMPTIES = 6;
+
+const int MOBILITY_VALUE = 8;
+const int CORNER_VALUE = 40;
+// the squares next to an empty corner give it away
+const int X_SQUARE_VALUE = 20;
+const int C_SQUARE_VALUE = 6;
+// discs next to an empty square give the opponent moves later on
+const int FRONTIER_VALUE = 3;
+// per reply left to the opponent when ordering moves
+const int REPLY_ORDER_VALUE = 16;
+
+const uint64_t CORNERS = 0x8100000000000081ull;
+const uint64_t NOT_FIRST_COLUMN = 0xFEFEFEFEFEFEFEFEull;
+const uint64_t NOT_LAST_COLUMN = 0x7F7F7F7F7F7F7F7Full;
+
+// each corner with its X square (diagonally in) and two C squares (along the edges)
+const int CORNER_SQUARES[4][4] = {
+    {  0,  9,  1,  8 },
+    {  7, 14,  6, 15 },
+    { 56, 49, 57, 48 },
+    { 63, 54, 62, 55 },
+};
+
+// rough worth of each square for move ordering, corners best and the squares next to them worst
+const int SQUARE_VALUE[64] = {
+    20, -6,  4,  2,  2,  4, -6, 20,
+    -6, -8, -1, -1, -1, -1, -8, -6,
+     4, -1,  1,  0,  0,  1, -1,  4,
+     2, -1,  0,  0,  0,  0, -1,  2,
+     2, -1,  0,  0,  0,  0, -1,  2,
+     4, -1,  1,  0,  0,  1, -1,  4,
+    -6, -8, -1, -1, -1, -1, -8, -6,
+    20, -6,  4,  2,  2,  4, -6, 20,
+};
+
+static uint64_t positionKey(uint64_t own, uint64_t opp)
+{
+    // splitmix64's finisher over both boards
+    uint64_t z = own * 0x9E3779B97F4A7C15ull ^ std::rotl(opp * 0xC2B2AE3D27D4EB4Full, 31);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// squares next to any of bits, not counting bits themselves
+static uint64_t neighbours(uint64_t bits)
+{
+    uint64_t row = bits | ((bits << 1) & NOT_FIRST_COLUMN) | ((bits >> 1) & NOT_LAST_COLUMN);
+    return (row | (row << 8) | (row >> 8)) & ~bits;
+}
+
+//
+// disc difference once nobody can move, the empty squares go to the winner
+//
+static int finalDifference(uint64_t own, uint64_t opp)
+{
+    int difference = std::popcount(own) - std::popcount(opp);
+    int empties = std::popcount(~(own | opp));
+    if (difference > 0) return difference + empties;
+    if (difference < 0) return difference - empties;
+    return 0;
+}
+
+// a finished game is worth more than any evaluation, more so the more discs it was won by
+static int finalScore(uint64_t own, uint64_t opp)
+{
+    int difference = finalDifference(own, opp);
+    if (difference > 0) return ReversiSearch::kWinScore + difference;
+    if (difference < 0) return -ReversiSearch::kWinScore + difference;
+    return 0;
+}
+
+// finished games score by discs rather than plies, so the table keeps every score as it is
+ReversiSearch::ReversiSearch() : _table(SCORE_INFINITY)
+{
+    _solved = false;
+}
+
+void ReversiSearch::clearTable()
+{
+    _table.clear();
+}
+
+int ReversiSearch::evaluate(uint64_t own, uint64_t opp)
+{
+    int score = MOBILITY_VALUE * (std::popcount(ReversiBoard::movesFor(own, opp)) - std::popcount(ReversiBoard::movesFor(opp, own)));
+    score += CORNER_VALUE * (std::popcount(own & CORNERS) - std::popcount(opp & CORNERS));
+
+    uint64_t empty = ~(own | opp);
+    for (const int *corner : CORNER_SQUARES) {
+        if (!(empty >> corner[0] & 1)) {
+            continue;
+        }
+        score -= X_SQUARE_VALUE * ((int)(own >> corner[1] & 1) - (int)(opp >> corner[1] & 1));
+        for (int i = 2; i < 4; i++) {
+            score -= C_SQUARE_VALUE * ((int)(own >> corner[i] & 1) - (int)(opp >> corner[i] & 1));
+        }
+    }
+
+    uint64_t frontier = neighbours(empty);
+    score -= FRONTIER_VALUE * (std::popcount(own & frontier) - std::popcount(opp & frontier));
+    return score;
+}
+
+//
+// the table move, then moves that leave the opponent the fewest replies, on better squares
+//
+int ReversiSearch::orderMoves(uint64_t own, uint64_t opp, uint64_t moves, uint8_t *list, int tableMove) const
+{
+    int scores[64];
+    int count = 0;
+    while (moves) {
+        int square = std::countr_zero(moves);
+        moves &= moves - 1;
+        int score;
+        if (square == tableMove) {
+            score = TABLE_MOVE_SCORE;
+        } else {
+            uint64_t flips = ReversiBoard::flipsFor(own, opp, square);
+            uint64_t replies = ReversiBoard::movesFor(opp & ~flips, own | flips | (1ull << square));
+            score = SQUARE_VALUE[square] - REPLY_ORDER_VALUE * std::popcount(replies);
+        }
+        // insertion sort, there are rarely more than a dozen moves
+        int i = count++;
+        while (i > 0 && scores[i - 1] < score) {
+            scores[i] = scores[i - 1];
+            list[i] = list[i - 1];
+            i--;
+        }
+        scores[i] = score;
+        list[i] = (uint8_t)square;
+    }
+    return count;
+}
+
+int ReversiSearch::negamax(uint64_t own, uint64_t opp, int alpha, int beta, int ply, int depthLeft, bool passed)
+{
+    if (_clock.tick(++_stats.nodes)) {
+        return 0;
+    }
+    if (ply > _stats.depthReached) {
+        _stats.depthReached = ply;
+    }
+
+    uint64_t moves = ReversiBoard::movesFor(own, opp);
+    if (!moves) {
+        // a pass costs no depth, two in a row end the game
+        if (passed) {
+            return finalScore(own, opp);
+        }
+        return -negamax(opp, own, -beta, -alpha, ply + 1, depthLeft, true);
+    }
+    if (depthLeft <= 0) {
+        return evaluate(own, opp);
+    }
+
+    uint64_t key = positionKey(own, opp);
+    int tableMove = -1;
+    int tableScore;
+    if (_table.probe(key, depthLeft, alpha, beta, ply, tableMove, tableScore, _stats)) {
+        return tableScore;
+    }
+
+    uint8_t list[64];
+    int count = orderMoves(own, opp, moves, list, tableMove);
+
+    int originalAlpha = alpha;
+    int bestScore = -SCORE_INFINITY;
+    int bestMove = -1;
+    _stats.expanded++;
+
+    for (int i = 0; i < count; i++) {
+        int square = list[i];
+        uint64_t flips = ReversiBoard::flipsFor(own, opp, square);
+        int score = -negamax(opp & ~flips, own | flips | (1ull << square), -beta, -alpha, ply + 1, depthLeft - 1, false);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = square;
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        if (alpha >= beta) {
+            _stats.cutoffs++;
+            if (i == 0) {
+                _stats.firstMoveCutoffs++;
+            }
+            break;
+        }
+    }
+
+    if (_clock.timeUp()) {
+        return 0;
+    }
+
+    _table.store(key, depthLeft, ply, bestScore, bestMove, originalAlpha, beta);
+    return bestScore;
+}
+
+int ReversiSearch::solve(uint64_t own, uint64_t opp, int alpha, int beta, bool passed)
+{
+    if (_clock.tick(++_stats.nodes)) {
+        return 0;
+    }
+
+    uint64_t moves = ReversiBoard::movesFor(own, opp);
+    if (!moves) {
+        if (passed) {
+            return finalDifference(own, opp);
+        }
+        return -solve(opp, own, -beta, -alpha, true);
+    }
+
+    _stats.expanded++;
+    int bestScore = -SCORE_INFINITY;
+
+    if (std::popcount(~(own | opp)) <= SOLVE_SORT_EMPTIES) {
+        while (moves) {
+            int square = std::countr_zero(moves);
+            moves &= moves - 1;
+            uint64_t flips = ReversiBoard::flipsFor(own, opp, square);
+            int score = -solve(opp & ~flips, own | flips | (1ull << square), -beta, -alpha, false);
+            bestScore = std::max(bestScore, score);
+            alpha = std::max(alpha, score);
+            if (alpha >= beta) {
+                _stats.cutoffs++;
+                break;
+            }
+        }
+        return bestScore;
+    }
+
+    uint8_t list[64];
+    int count = orderMoves(own, opp, moves, list, -1);
+    for (int i = 0; i < count; i++) {
+        int square = list[i];
+        uint64_t flips = ReversiBoard::flipsFor(own, opp, square);
+        int score = -solve(opp & ~flips, own | flips | (1ull << square), -beta, -alpha, false);
+        bestScore = std::max(bestScore, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) {
+            _stats.cutoffs++;
+            if (i == 0) {
+                _stats.firstMoveCutoffs++;
+            }
+            break;
+        }
+    }
+    return bestScore;
+}
+
+int ReversiSearch::findBestMove(const ReversiBoard &board, int maxDepth)
+{
+    _clock.start();
+    _solved = false;
+    _stats.reset();
+
+    uint64_t own = board.discs(board.sideToMove());
+    uint64_t opp = board.discs(1 - board.sideToMove());
+    uint64_t moves = ReversiBoard::movesFor(own, opp);
+    if (!moves) {
+        return -1;
+    }
+
+    uint8_t list[64];
+    int count = orderMoves(own, opp, moves, list, -1);
+    int bestMove = list[0];
+    int bestScore = 0;
+    int empties = board.emptyCount();
+
+    if (empties <= kEndgameEmpties) {
+        // play every line out, if the clock runs out first the best move finished so far still stands
+        int alpha = -SCORE_INFINITY;
+        int finished = 0;
+        for (int i = 0; i < count; i++) {
+            uint64_t flips = ReversiBoard::flipsFor(own, opp, list[i]);
+            int score = -solve(opp & ~flips, own | flips | (1ull << list[i]), -SCORE_INFINITY, -alpha, false);
+            if (_clock.timeUp()) {
+                break;
+            }
+            finished++;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = list[i];
+            }
+        }
+        _solved = finished == count;
+        bestScore = alpha > 0 ? kWinScore + alpha : (alpha < 0 ? -kWinScore + alpha : 0);
+        _stats.depthLimit = empties;
+        _stats.depthReached = empties;
+    } else {
+        // a won ending can still be won by more discs, so a proven result doesn't stop the deepening
+        int limit = (maxDepth > 0 && maxDepth < empties) ? maxDepth : empties;
+        bestScore = deepen(list, count, limit, SCORE_INFINITY, SCORE_INFINITY, _clock, _stats, [&](int square, int alpha, int depth) {
+            uint64_t flips = ReversiBoard::flipsFor(own, opp, square);
+            return -negamax(opp & ~flips, own | flips | (1ull << square), -SCORE_INFINITY, -alpha, 1, depth - 1, false);
+        });
+        bestMove = list[0];
+    }
+
+    _stats.seconds = _clock.elapsed();
+    _stats.bestMove = bestMove;
+    _stats.score = bestScore;
+
+    // principal variation out of the table, the solver doesn't store its lines so after it only the move itself
+    uint64_t lineOwn = own;
+    uint64_t lineOpp = opp;
+    int square = bestMove;
+    int lineLength = empties <= kEndgameEmpties ? 1 : 64;
+    for (int i = 0; i < lineLength && square >= 0; i++) {
+        _stats.principalVariation.push_back(square);
+        // the usual names, a to h from the left and 1 to 8 from the top
+        if (i > 0) {
+            _stats.principalVariationText += " ";
+        }
+        _stats.principalVariationText += (char)('a' + square % 8);
+        _stats.principalVariationText += (char)('1' + square / 8);
+        uint64_t flips = ReversiBoard::flipsFor(lineOwn, lineOpp, square);
+        uint64_t next = lineOpp & ~flips;
+        lineOpp = lineOwn | flips | (1ull << square);
+        lineOwn = next;
+        square = _table.move(positionKey(lineOwn, lineOpp));
+        if (square < 0 || !(ReversiBoard::movesFor(lineOwn, lineOpp) >> square & 1)) {
+            break;
+        }
+    }
+    return bestMove;
+}
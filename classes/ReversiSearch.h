@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ReversiBoard.h"
+#include "SearchStats.h"
+#include "SearchTable.h"
+
+//
+// alpha-beta search for reversi
+//
+// iterative deepening negamax with a transposition table on pairs of bitboards
+// (the mover's discs and the opponent's), scored by mobility, corners and the
+// squares next to empty corners. with kEndgameEmpties or fewer empty squares
+// left the search switches to an exact solver that plays every line to the end
+// and counts discs: moves that leave the opponent fewest replies go first, and
+// the last few empties are played in plain square order since sorting them
+// costs more than it saves.
+//
+
+class ReversiSearch
+{
+public:
+    ReversiSearch();
+
+    // best square for the side to move, -1 if it has to pass or the game is over
+    int         findBestMove(const ReversiBoard &board, int maxDepth = 0);
+
+    void        setTimeBudget(double seconds) { _clock.setBudget(seconds); }
+    double      timeBudget() const { return _clock.budget(); }
+    // true if the last findBestMove() played the game out instead of guessing
+    bool        solved() const { return _solved; }
+    const SearchStats &stats() const { return _stats; }
+
+    void        clearTable();
+
+    // for own, the side to move
+    static int  evaluate(uint64_t own, uint64_t opp);
+
+    static const int kWinScore = 100000;
+    static const int kEndgameEmpties = 14;
+
+private:
+    int         negamax(uint64_t own, uint64_t opp, int alpha, int beta, int ply, int depthLeft, bool passed);
+    // exact final disc difference for own
+    int         solve(uint64_t own, uint64_t opp, int alpha, int beta, bool passed);
+    // moves best first, table move ahead of the rest, returns how many
+    int         orderMoves(uint64_t own, uint64_t opp, uint64_t moves, uint8_t *list, int tableMove) const;
+
+    SearchTable _table;
+    SearchClock _clock;
+    SearchStats _stats;
+    bool        _solved;
+};
@@ -0,0 +1,82 @@
+#include "SearchStats.h"
+#include "Trace.h"
+
+#include <cstdio>
+#include <fstream>
+
+static std::string searchLogFile;
+
+void SearchStats::reset()
+{
+    nodes = 0;
+    expanded = 0;
+    cutoffs = 0;
+    firstMoveCutoffs = 0;
+    tableProbes = 0;
+    tableHits = 0;
+    depthLimit = 0;
+    depthReached = 0;
+    seconds = 0.0;
+    bestMove = -1;
+    score = 0;
+    pondered = false;
+    fromBook = false;
+    principalVariation.clear();
+    principalVariationText.clear();
+}
+
+void SearchStats::setBookMove(int move)
+{
+    reset();
+    bestMove = move;
+    fromBook = true;
+}
+
+std::string SearchStats::toJson(const std::string &label, int turn) const
+{
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "{\"game\":\"%s\",\"turn\":%d,\"move\":%d,\"score\":%d,\"pondered\":%s,\"book\":%s,"
+        "\"nodes\":%llu,\"nps\":%.0f,\"depth_limit\":%d,\"depth_reached\":%d,\"time_ms\":%.3f,"
+        "\"cutoff_rate\":%.4f,\"first_move_cutoff_rate\":%.4f,\"tt_probes\":%llu,\"tt_hit_rate\":%.4f,\"pv\":[",
+        label.c_str(), turn, bestMove, score, pondered ? "true" : "false", fromBook ? "true" : "false",
+        (unsigned long long)nodes, nodesPerSecond(), depthLimit, depthReached, seconds * 1000.0,
+        cutoffRate(), firstMoveCutoffRate(), (unsigned long long)tableProbes, tableHitRate());
+
+    std::string json = buffer;
+    for (size_t i = 0; i < principalVariation.size(); i++) {
+        if (i > 0) {
+            json += ",";
+        }
+        json += std::to_string(principalVariation[i]);
+    }
+    json += "]";
+    if (!principalVariationText.empty()) {
+        json += ",\"pv_text\":\"" + principalVariationText + "\"";
+    }
+    json += "}";
+    return json;
+}
+
+void SearchStats::setLogFile(const std::string &path)
+{
+    searchLogFile = path;
+}
+
+const std::string &SearchStats::logFile()
+{
+    return searchLogFile;
+}
+
+void SearchStats::logMove(const std::string &label, int turn) const
+{
+    Trace::counter("AI nodes", (int64_t)nodes);
+    Trace::counter("AI depth", depthReached);
+    if (searchLogFile.empty()) {
+        return;
+    }
+    std::ofstream file(searchLogFile, std::ios::app);
+    if (file) {
+        file << toJson(label, turn) << "\n";
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// counters collected by an AI search, one set per move
+//
+// the search bumps plain integers as it goes (no atomics, no timing per node),
+// so leaving them on costs next to nothing. the derived rates are worked out
+// only when somebody looks at them.
+//
+
+struct SearchStats
+{
+    SearchStats() { reset(); }
+
+    void        reset();
+    // nothing searched, the move came out of the opening book
+    void        setBookMove(int move);
+
+    uint64_t    nodes;              // every call into the search
+    uint64_t    expanded;           // nodes whose moves were searched
+    uint64_t    cutoffs;            // expanded nodes that failed high
+    uint64_t    firstMoveCutoffs;   // ... on the first move tried
+    uint64_t    tableProbes;        // transposition table lookups
+    uint64_t    tableHits;          // ... that found the position
+    int         depthLimit;         // nominal depth the search was asked for
+    int         depthReached;       // deepest ply actually visited
+    double      seconds;            // wall time for the whole move
+    int         bestMove;
+    int         score;
+    bool        pondered;           // answered from a search done on the opponent's time
+    bool        fromBook;           // taken from the opening book without a search
+    std::vector<int>    principalVariation;
+    // the same line in the game's own notation (e2e4 e7e5), empty if the game has none
+    std::string         principalVariationText;
+
+    double      nodesPerSecond() const { return seconds > 0.0 ? (double)nodes / seconds : 0.0; }
+    double      cutoffRate() const { return expanded ? (double)cutoffs / (double)expanded : 0.0; }
+    double      firstMoveCutoffRate() const { return cutoffs ? (double)firstMoveCutoffs / (double)cutoffs : 0.0; }
+    double      tableHitRate() const { return tableProbes ? (double)tableHits / (double)tableProbes : 0.0; }
+
+    // one line JSON object, label says which game/board it came from
+    std::string toJson(const std::string &label, int turn) const;
+
+    // when a log file is set, logMove() appends one JSON line per move to it
+    static void                 setLogFile(const std::string &path);
+    static const std::string    &logFile();
+    void        logMove(const std::string &label, int turn) const;
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "SearchStats.h"
+
+//
+// what the alpha-beta engines have in common: the transposition table, the
+// per-move clock and the iterative deepening loop at the root
+//
+// it all lives in the header so the table probes and clock ticks inline into
+// each engine's negamax.
+//
+
+//
+// one slot per key hash, always replaced. win scores depend on how far from the
+// root they were found, so scores past winBound are stored relative to the node
+// instead and can be reused at any depth.
+//
+class SearchTable
+{
+public:
+    // 16 byte entries, 16MB in total
+    static const int kBits = 20;
+
+    enum Bound : uint8_t { kBoundExact, kBoundLower, kBoundUpper };
+
+    struct Entry
+    {
+        uint64_t    key;
+        int32_t     score;
+        // -1 for none
+        int16_t     move;
+        int8_t      depth;
+        Bound       bound;
+    };
+
+    SearchTable(int winBound) : _entries(1 << kBits), _winBound(winBound) { clear(); }
+
+    void        clear() { std::fill(_entries.begin(), _entries.end(), Entry{ 0, 0, -1, -1, kBoundExact }); }
+
+    // the move stored for key, -1 if the table doesn't have it
+    int         move(uint64_t key) const
+    {
+        const Entry &entry = slot(key);
+        return entry.key == key ? entry.move : -1;
+    }
+
+    //
+    // tableMove is set whenever key is in the table, true with score when the
+    // stored bound already settles the node at depthLeft
+    //
+    bool        probe(uint64_t key, int depthLeft, int alpha, int beta, int ply, int &tableMove, int &score, SearchStats &stats) const
+    {
+        const Entry &entry = slot(key);
+        stats.tableProbes++;
+        if (entry.key != key) {
+            return false;
+        }
+        stats.tableHits++;
+        tableMove = entry.move;
+        if (entry.depth < depthLeft) {
+            return false;
+        }
+        score = fromTable(entry.score, ply);
+        return entry.bound == kBoundExact ||
+               (entry.bound == kBoundLower && score >= beta) ||
+               (entry.bound == kBoundUpper && score <= alpha);
+    }
+
+    // bestScore came out of a search of the window originalAlpha, beta
+    void        store(uint64_t key, int depthLeft, int ply, int bestScore, int bestMove, int originalAlpha, int beta)
+    {
+        Entry &entry = slot(key);
+        entry.key = key;
+        entry.score = toTable(bestScore, ply);
+        entry.move = (int16_t)bestMove;
+        entry.depth = (int8_t)depthLeft;
+        entry.bound = bestScore <= originalAlpha ? kBoundUpper : (bestScore >= beta ? kBoundLower : kBoundExact);
+    }
+
+private:
+    Entry       &slot(uint64_t key) { return _entries[(key * 0x9E3779B97F4A7C15ull) >> (64 - kBits)]; }
+    const Entry &slot(uint64_t key) const { return _entries[(key * 0x9E3779B97F4A7C15ull) >> (64 - kBits)]; }
+
+    int         toTable(int score, int ply) const
+    {
+        if (score > _winBound) return score + ply;
+        if (score < -_winBound) return score - ply;
+        return score;
+    }
+    int         fromTable(int score, int ply) const
+    {
+        if (score > _winBound) return score - ply;
+        if (score < -_winBound) return score + ply;
+        return score;
+    }
+
+    std::vector<Entry>  _entries;
+    int                 _winBound;
+};
+
+//
+// the time budget for one move, <= 0 for none. tick() once per node, it only
+// looks at the clock every interval nodes and once the time is up it stays up
+// until the next start()
+//
+class SearchClock
+{
+public:
+    SearchClock(uint64_t interval = 4096) : _interval(interval) {}
+
+    void        setBudget(double seconds) { _budget = seconds; }
+    double      budget() const { return _budget; }
+
+    void        start() { _start = now(); _timeUp = false; }
+    double      elapsed() const { return now() - _start; }
+    bool        timeUp() const { return _timeUp; }
+    bool        tick(uint64_t nodes)
+    {
+        if (nodes % _interval == 0 && _budget > 0.0 && now() - _start > _budget) {
+            _timeUp = true;
+        }
+        return _timeUp;
+    }
+
+    static double now() { return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+private:
+    uint64_t    _interval;
+    double      _budget = 1.0;
+    double      _start = 0.0;
+    bool        _timeUp = false;
+};
+
+//
+// iterative deepening over the count root moves: each depth from 1 to limit
+// scores every move with search(move, alpha, depth), from the side to move's
+// point of view, the last iteration's best move first. an unfinished iteration
+// can't be compared with the finished ones, so once the clock stops one the
+// last finished result stands. a finished iteration scoring past winBound
+// proved the result and ends the loop.
+//
+// leaves the best move in moves[0] and the depth it was found at in
+// stats.depthLimit, and returns its score (0 if no iteration finished)
+//
+template <typename Move, typename Search>
+int deepen(Move *moves, int count, int limit, int infinity, int winBound, const SearchClock &clock, SearchStats &stats, Search search)
+{
+    int best = 0;
+    int bestScore = 0;
+    for (int depth = 1; depth <= limit; depth++) {
+        std::rotate(moves, moves + best, moves + best + 1);
+        best = 0;
+
+        int alpha = -infinity;
+        int iterationBest = 0;
+        for (int i = 0; i < count; i++) {
+            int score = search(moves[i], alpha, depth);
+            if (clock.timeUp()) {
+                break;
+            }
+            if (score > alpha) {
+                alpha = score;
+                iterationBest = i;
+            }
+        }
+        if (clock.timeUp()) {
+            break;
+        }
+
+        best = iterationBest;
+        bestScore = alpha;
+        stats.depthLimit = depth;
+        if (bestScore > winBound || bestScore < -winBound) {
+            break;
+        }
+    }
+    std::rotate(moves, moves + best, moves + best + 1);
+    return bestScore;
+}
@@ -0,0 +1,627 @@
+#include "SelfPlay.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRecord.h"
+#include "Trace.h"
+
+#include "CheckersSearch.h"
+#include "ChessEngine.h"
+#include "ConnectFourSolver.h"
+#include "GomokuSearch.h"
+#include "MNKSearch.h"
+#include "QubicSearch.h"
+#include "ReversiSearch.h"
+#include "UltimateMCTS.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <sstream>
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool SelfPlayEngine::parse(const std::string &text, SelfPlayEngine &engine)
+{
+    engine = SelfPlayEngine();
+    if (text == "random") {
+        engine.random = true;
+        return true;
+    }
+
+    bool timeGiven = false;
+    bool limitGiven = false;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string key = item.substr(0, equals);
+        const char *value = item.c_str() + equals + 1;
+        if (key == "depth") {
+            engine.depth = atoi(value);
+            limitGiven = true;
+        } else if (key == "time") {
+            engine.seconds = atof(value);
+            timeGiven = true;
+        } else if (key == "playouts") {
+            engine.playouts = strtoull(value, nullptr, 10);
+            limitGiven = true;
+        } else {
+            return false;
+        }
+    }
+    if (limitGiven && !timeGiven) {
+        engine.seconds = 0.0;
+    }
+    return true;
+}
+
+std::string SelfPlayEngine::describe() const
+{
+    if (random) {
+        return "random";
+    }
+    std::string text;
+    if (depth > 0) {
+        text += "depth " + std::to_string(depth);
+    }
+    if (playouts > 0) {
+        text += (text.empty() ? "" : ", ") + std::to_string(playouts) + " playouts";
+    }
+    if (seconds > 0.0) {
+        std::ostringstream time;
+        time << seconds << "s";
+        text += (text.empty() ? "" : ", ") + time.str();
+    }
+    return text.empty() ? "unlimited" : text;
+}
+
+//
+// one adapter per game, each with a search per side
+//
+
+class ConnectFourSelfPlay : public SelfPlayGame
+{
+public:
+    void        restart() override { _board = ConnectFourBoard(); }
+    void        reset(uint64_t) override
+    {
+        restart();
+        for (ConnectFourSolver &solver : _solvers) {
+            solver.clearTable();
+        }
+    }
+    int         sideToMove() const override { return _board.currentPlayer(); }
+    bool        isOver() const override { return winner() >= 0 || _board.isFull(); }
+    int         winner() const override { return _board.hasWon(0) ? 0 : (_board.hasWon(1) ? 1 : -1); }
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        moves.clear();
+        for (int column = 0; column < ConnectFourBoard::kWidth; column++) {
+            if (_board.canPlay(column)) {
+                moves.push_back(column);
+            }
+        }
+    }
+    void        play(int move) override { _board.play(move); }
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        ConnectFourSolver &solver = _solvers[sideToMove()];
+        solver.setTimeBudget(engine.seconds);
+        int column = solver.findBestMove(_board, engine.depth);
+        _lastNodes = solver.stats().nodes;
+        return column;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_board, symmetry); }
+    int         mapMove(int move, int symmetry, bool inverse) const override { return mapConnectFourMove(move, symmetry, inverse); }
+    int         width() const override { return ConnectFourBoard::kWidth; }
+    int         height() const override { return ConnectFourBoard::kHeight; }
+
+private:
+    ConnectFourBoard    _board;
+    ConnectFourSolver   _solvers[2];
+    uint64_t            _lastNodes = 0;
+};
+
+class ChessSelfPlay : public SelfPlayGame
+{
+public:
+    void        restart() override
+    {
+        _position = ChessPosition();
+        _history.assign(1, _position.key());
+    }
+    void        reset(uint64_t) override
+    {
+        restart();
+        for (ChessEngine &engine : _engines) {
+            engine.newGame();
+        }
+    }
+    int         sideToMove() const override { return _position.sideToMove(); }
+    bool        isOver() const override
+    {
+        if (!_position.hasLegalMoves() || _position.insufficientMaterial() || _position.fiftyMoveRule()) {
+            return true;
+        }
+        int seen = 0;
+        for (uint64_t key : _history) {
+            seen += key == _position.key();
+        }
+        return seen >= 3;
+    }
+    int         winner() const override { return _position.isCheckmate() ? 1 - _position.sideToMove() : -1; }
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        ChessMoveList list;
+        _position.generateMoves(list);
+        moves.clear();
+        for (const ChessMove &move : list) {
+            moves.push_back(move.bits);
+        }
+    }
+    void        play(int move) override
+    {
+        ChessMove chessMove;
+        chessMove.bits = (uint16_t)move;
+        _position.makeMove(chessMove);
+        _history.push_back(_position.key());
+    }
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        ChessEngine &search = _engines[sideToMove()];
+        ChessMove move = search.findBestMove(_position, engine.depth, engine.seconds, _history);
+        _lastNodes = search.stats().nodes;
+        return move.bits;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_position, symmetry); }
+    int         width() const override { return 8; }
+    int         height() const override { return 8; }
+
+private:
+    ChessPosition           _position;
+    std::vector<uint64_t>   _history;
+    ChessEngine             _engines[2];
+    uint64_t                _lastNodes = 0;
+};
+
+class CheckersSelfPlay : public SelfPlayGame
+{
+public:
+    void        restart() override { _position.reset(); }
+    void        reset(uint64_t) override
+    {
+        restart();
+        for (CheckersSearch &search : _searches) {
+            search.clearTable();
+        }
+    }
+    int         sideToMove() const override { return _position.sideToMove(); }
+    bool        isOver() const override
+    {
+        CheckersMoveList list;
+        _position.generateMoves(list);
+        return list.count == 0 || _position.isDraw();
+    }
+    int         winner() const override
+    {
+        CheckersMoveList list;
+        _position.generateMoves(list);
+        return list.count == 0 ? 1 - _position.sideToMove() : -1;
+    }
+    // moves are indexes into the generated list, two captures can share a start and end square
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        CheckersMoveList list;
+        _position.generateMoves(list);
+        moves.clear();
+        for (int i = 0; i < list.count; i++) {
+            moves.push_back(i);
+        }
+    }
+    void        play(int move) override
+    {
+        CheckersMoveList list;
+        _position.generateMoves(list);
+        _position.makeMove(list.moves[move]);
+    }
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        CheckersSearch &search = _searches[sideToMove()];
+        search.setTimeBudget(engine.seconds);
+        CheckersMove best;
+        if (!search.findBestMove(_position, engine.depth, best)) {
+            return -1;
+        }
+        _lastNodes = search.stats().nodes;
+        CheckersMoveList list;
+        _position.generateMoves(list);
+        for (int i = 0; i < list.count; i++) {
+            if (list.moves[i].from == best.from && list.moves[i].to == best.to && list.moves[i].captures == best.captures) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_position, symmetry); }
+    int         width() const override { return 8; }
+    int         height() const override { return 8; }
+
+private:
+    CheckersPosition    _position;
+    CheckersSearch      _searches[2];
+    uint64_t            _lastNodes = 0;
+};
+
+class GomokuSelfPlay : public SelfPlayGame
+{
+public:
+    void        restart() override { _board = GomokuBoard(); }
+    void        reset(uint64_t) override
+    {
+        restart();
+        for (GomokuSearch &search : _searches) {
+            search.clearTable();
+        }
+    }
+    int         sideToMove() const override { return _board.currentPlayer(); }
+    bool        isOver() const override { return _board.isOver(); }
+    int         winner() const override { return _board.winner(); }
+    // only the cells near the stones, a random stone in a far corner isn't an opening
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        int cells[GomokuBoard::kCells];
+        int count = _board.candidates(cells);
+        moves.assign(cells, cells + count);
+    }
+    void        play(int move) override { _board.play(move); }
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        GomokuSearch &search = _searches[sideToMove()];
+        search.setTimeBudget(engine.seconds);
+        int cell = search.findBestMove(_board, engine.depth);
+        _lastNodes = search.stats().nodes;
+        return cell;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_board, symmetry); }
+    int         mapMove(int move, int symmetry, bool inverse) const override { return mapSquare(move, GomokuBoard::kSize, symmetry, inverse); }
+    int         width() const override { return GomokuBoard::kSize; }
+    int         height() const override { return GomokuBoard::kSize; }
+
+private:
+    GomokuBoard     _board;
+    GomokuSearch    _searches[2];
+    uint64_t        _lastNodes = 0;
+};
+
+class QubicSelfPlay : public SelfPlayGame
+{
+public:
+    void        restart() override { _board = QubicBoard(); }
+    void        reset(uint64_t) override
+    {
+        restart();
+        for (QubicSearch &search : _searches) {
+            search.clearTable();
+        }
+    }
+    int         sideToMove() const override { return _board.currentPlayer(); }
+    bool        isOver() const override { return _board.isOver(); }
+    int         winner() const override { return _board.winner(); }
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        moves.clear();
+        for (int cell = 0; cell < QubicBoard::kCells; cell++) {
+            if (_board.isEmpty(cell)) {
+                moves.push_back(cell);
+            }
+        }
+    }
+    void        play(int move) override { _board.play(move); }
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        QubicSearch &search = _searches[sideToMove()];
+        search.setTimeBudget(engine.seconds);
+        int cell = search.findBestMove(_board, engine.depth);
+        _lastNodes = search.stats().nodes;
+        return cell;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_board, symmetry); }
+    int         mapMove(int move, int symmetry, bool inverse) const override { return mapCube(move, symmetry, inverse); }
+    int         width() const override { return 8; }
+    int         height() const override { return 8; }
+
+private:
+    QubicBoard      _board;
+    QubicSearch     _searches[2];
+    uint64_t        _lastNodes = 0;
+};
+
+class ReversiSelfPlay : public SelfPlayGame
+{
+public:
+    void        restart() override { _board.reset(); }
+    void        reset(uint64_t) override
+    {
+        restart();
+        for (ReversiSearch &search : _searches) {
+            search.clearTable();
+        }
+    }
+    int         sideToMove() const override { return _board.sideToMove(); }
+    bool        isOver() const override { return _board.isOver(); }
+    int         winner() const override { return _board.winner(); }
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        moves.clear();
+        for (uint64_t bits = _board.moves(); bits; bits &= bits - 1) {
+            moves.push_back(std::countr_zero(bits));
+        }
+    }
+    // a side left without a move passes straight away, so the side to move always has one
+    void        play(int move) override
+    {
+        _board.play(move);
+        if (_board.mustPass()) {
+            _board.pass();
+        }
+    }
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        ReversiSearch &search = _searches[sideToMove()];
+        search.setTimeBudget(engine.seconds);
+        int square = search.findBestMove(_board, engine.depth);
+        _lastNodes = search.stats().nodes;
+        return square;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_board, symmetry); }
+    int         mapMove(int move, int symmetry, bool inverse) const override { return mapSquare(move, 8, symmetry, inverse); }
+    int         width() const override { return 8; }
+    int         height() const override { return 8; }
+
+private:
+    ReversiBoard    _board;
+    ReversiSearch   _searches[2];
+    uint64_t        _lastNodes = 0;
+};
+
+class UltimateSelfPlay : public SelfPlayGame
+{
+public:
+    void        restart() override { _board = UltimateBoard(); }
+    void        reset(uint64_t seed) override
+    {
+        restart();
+        _searches[0] = UltimateMCTS(seed * 2 + 1);
+        _searches[1] = UltimateMCTS(seed * 2 + 2);
+    }
+    int         sideToMove() const override { return _board.sideToMove(); }
+    bool        isOver() const override { return _board.isOver(); }
+    int         winner() const override { return _board.winner(); }
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        uint8_t list[UltimateBoard::kCells];
+        int count = _board.legalMoves(list);
+        moves.assign(list, list + count);
+    }
+    void        play(int move) override { _board.play(move); }
+    // without any limit the tree search would never stop, so it gets the default budget
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        UltimateMCTS &search = _searches[sideToMove()];
+        double seconds = (engine.seconds > 0.0 || engine.playouts > 0) ? engine.seconds : SelfPlayEngine().seconds;
+        int move = search.findBestMove(_board, seconds, engine.playouts);
+        _lastNodes = search.stats().nodes;
+        return move;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_board, symmetry); }
+    int         mapMove(int move, int symmetry, bool inverse) const override { return mapUltimateMove(move, symmetry, inverse); }
+    int         width() const override { return 9; }
+    int         height() const override { return 9; }
+
+private:
+    UltimateBoard   _board;
+    UltimateMCTS    _searches[2];
+    uint64_t        _lastNodes = 0;
+};
+
+//
+// tic-tac-toe on any board the game allows, "tictactoe" is the 3x3 one and
+// "tictactoe-WxH-K" any other, say tictactoe-4x4-4
+//
+class MNKSelfPlay : public SelfPlayGame
+{
+public:
+    MNKSelfPlay(int width, int height, int k)
+        : _width(width), _height(height), _board(width * height), _searches{ { width, height, k }, { width, height, k } }
+    {
+        _threats.setBoard(width, height, k);
+    }
+
+    void        restart() override
+    {
+        std::fill(_board.begin(), _board.end(), 0);
+        _threats.clear();
+        _stones = 0;
+    }
+    void        reset(uint64_t) override
+    {
+        restart();
+        for (MNKSearch &search : _searches) {
+            search.clearTable();
+        }
+    }
+    int         sideToMove() const override { return _stones & 1; }
+    bool        isOver() const override { return _threats.winner() != 0 || _stones == (int)_board.size(); }
+    int         winner() const override { return _threats.winner() - 1; }
+    void        legalMoves(std::vector<int> &moves) const override
+    {
+        moves.clear();
+        for (int cell = 0; cell < (int)_board.size(); cell++) {
+            if (_board[cell] == 0) {
+                moves.push_back(cell);
+            }
+        }
+    }
+    void        play(int move) override
+    {
+        int player = sideToMove();
+        _board[move] = player + 1;
+        _threats.makeMove(move, player);
+        _stones++;
+    }
+    // the search doesn't deepen by itself, so a time limit runs it a ply deeper
+    // at a time until the clock stops one, the first depth always finishes
+    int         searchMove(const SelfPlayEngine &engine) override
+    {
+        MNKSearch &search = _searches[sideToMove()];
+        int maxDepth = (int)_board.size() - _stones;
+        if (engine.depth > 0) {
+            maxDepth = std::min(maxDepth, engine.depth);
+        }
+        if (engine.seconds <= 0.0) {
+            int cell = search.findBestMove(_board.data(), sideToMove(), maxDepth);
+            _lastNodes = search.stats().nodes;
+            return cell;
+        }
+
+        double deadline = nowSeconds() + engine.seconds;
+        int bestCell = -1;
+        _lastNodes = 0;
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            double left = deadline - nowSeconds();
+            if (depth > 1 && left <= 0.0) {
+                break;
+            }
+            search.setTimeBudget(depth == 1 ? 0.0 : left);
+            int cell = search.findBestMove(_board.data(), sideToMove(), depth);
+            _lastNodes += search.stats().nodes;
+            if (search.aborted()) {
+                break;
+            }
+            bestCell = cell;
+        }
+        search.setTimeBudget(0.0);
+        return bestCell;
+    }
+    uint64_t    lastNodes() const override { return _lastNodes; }
+    uint64_t    canonicalKey(int &symmetry) const override { return ::canonicalKey(_board.data(), _width, _height, symmetry); }
+    int         mapMove(int move, int symmetry, bool inverse) const override { return mapRectangle(move, _width, _height, symmetry, inverse); }
+    int         width() const override { return _width; }
+    int         height() const override { return _height; }
+
+private:
+    int                 _width;
+    int                 _height;
+    // 0 empty, 1 or 2 for player number + 1, as MNKSearch wants it
+    std::vector<int>    _board;
+    // for spotting k in a row after every move
+    ThreatEvaluator     _threats;
+    int                 _stones = 0;
+    MNKSearch           _searches[2];
+    uint64_t            _lastNodes = 0;
+};
+
+//
+// the sizes TicTacToe's registration allows, up to 9x9 with k no longer than
+// the longest side
+//
+static SelfPlayGame *createTicTacToe(const std::string &text)
+{
+    if (text == kGameIdTicTacToe) {
+        return new MNKSelfPlay(3, 3, 3);
+    }
+    std::string id;
+    int width, height, k;
+    if (!parseSizedGameId(text, id, width, height, k) || id != kGameIdTicTacToe) {
+        return nullptr;
+    }
+    if (width < 3 || height < 3 || width > 9 || height > 9 || k < 3 || k > std::max(width, height)) {
+        return nullptr;
+    }
+    return new MNKSelfPlay(width, height, k);
+}
+
+SelfPlayGame *SelfPlayGame::create(const std::string &id)
+{
+    if (id == kGameIdCheckers) return new CheckersSelfPlay();
+    if (id == kGameIdChess) return new ChessSelfPlay();
+    if (id == kGameIdConnect4) return new ConnectFourSelfPlay();
+    if (id == kGameIdGomoku) return new GomokuSelfPlay();
+    if (id == kGameIdQubic) return new QubicSelfPlay();
+    if (id == kGameIdReversi) return new ReversiSelfPlay();
+    if (id == kGameIdUltimate) return new UltimateSelfPlay();
+    return createTicTacToe(id);
+}
+
+SelfPlayResult playSelfPlayGame(SelfPlayGame &game, const SelfPlayEngine engines[2], int randomPlies, uint64_t seed)
+{
+    SelfPlayResult result;
+    double start = nowSeconds();
+    std::mt19937_64 rng(seed);
+    std::vector<int> moves;
+
+    game.reset(seed);
+    while (!game.isOver() && result.plies < SELF_PLAY_MAX_PLIES) {
+        int side = game.sideToMove();
+        game.legalMoves(moves);
+        int move = -1;
+        double searched = 0.0;
+        if (result.plies < randomPlies || engines[side].random) {
+            move = moves[rng() % moves.size()];
+        } else {
+            TraceScope trace("search", "ai");
+            double searchStart = nowSeconds();
+            move = game.searchMove(engines[side]);
+            searched = nowSeconds() - searchStart;
+            result.searchSeconds[side] += searched;
+            result.nodes[side] += game.lastNodes();
+            Trace::counter("AI nodes", (int64_t)game.lastNodes());
+        }
+        if (move < 0) {
+            // the search had nothing to say, which a game that isn't over shouldn't allow
+            break;
+        }
+        game.play(move);
+        result.moves.push_back((uint32_t)move);
+        result.moveMicros.push_back((uint32_t)(searched * 1e6));
+        result.plies++;
+    }
+
+    result.winner = game.isOver() ? game.winner() : -1;
+    result.seconds = nowSeconds() - start;
+    return result;
+}
+
+void makeGameRecord(const SelfPlayGame &game, const std::string &gameId, const SelfPlayResult &result,
+                    const std::string engines[2], uint64_t seed, GameRecord &record)
+{
+    record.gameId = gameId;
+    record.width = game.width();
+    record.height = game.height();
+    record.winner = result.winner;
+    record.engines[0] = engines[0];
+    record.engines[1] = engines[1];
+    record.seed = seed;
+    record.startTime = (uint64_t)time(nullptr) - (uint64_t)result.seconds;
+    record.durationMicros = (uint64_t)(result.seconds * 1e6);
+    record.searchMicros[0] = (uint64_t)(result.searchSeconds[0] * 1e6);
+    record.searchMicros[1] = (uint64_t)(result.searchSeconds[1] * 1e6);
+    record.moves = result.moves;
+    record.moveMicros = result.moveMicros;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct GameRecord;
+
+//
+// AI against AI without a window
+//
+// the Game classes need textures for their pieces, so headless games go through
+// the engines directly: each SelfPlayGame wraps one game's board and two copies
+// of its search, one per side, so the sides never share a table. games are
+// looked up by the ids in GameIds.h, the ones GameRegistry has them under, and
+// tic-tac-toe also takes its board size there, "tictactoe-4x4-4".
+//
+
+// how one side picks its moves
+struct SelfPlayEngine
+{
+    // 0 for no limit
+    int         depth = 0;
+    // per move budget, 0 for no limit
+    double      seconds = 0.1;
+    // for the Monte Carlo search, 0 for no limit
+    uint64_t    playouts = 0;
+    // a uniformly random legal move instead of a search
+    bool        random = false;
+
+    // "random", or any of depth=N, time=S, playouts=N separated by commas. a
+    // depth or playout limit without a time= turns the time limit off. false if
+    // the text doesn't parse
+    static bool parse(const std::string &text, SelfPlayEngine &engine);
+    std::string describe() const;
+};
+
+class SelfPlayGame
+{
+public:
+    virtual ~SelfPlayGame() {}
+
+    // the starting position, both searches forget earlier games and any search
+    // that rolls dice starts again from the seed
+    virtual void        reset(uint64_t seed) = 0;
+    // just the starting position, for replaying games without searching them
+    virtual void        restart() = 0;
+    virtual int         sideToMove() const = 0;
+    virtual bool        isOver() const = 0;
+    // 0 or 1 once the game is over, -1 for a draw or a game still going
+    virtual int         winner() const = 0;
+    // moves as ints only this game understands, the side to move always has one until isOver()
+    virtual void        legalMoves(std::vector<int> &moves) const = 0;
+    virtual void        play(int move) = 0;
+    // what the side to move's own search plays
+    virtual int         searchMove(const SelfPlayEngine &engine) = 0;
+    // nodes (or playouts) the last searchMove() looked at
+    virtual uint64_t    lastNodes() const = 0;
+    // the same key for a position and every mirror or rotation of it on games
+    // with a symmetric board, symmetry says which one of the game's symmetries
+    // takes this position to the one the key is for
+    virtual uint64_t    canonicalKey(int &symmetry) const = 0;
+    // a move in this position through that symmetry, or back with inverse
+    virtual int         mapMove(int move, int symmetry, bool inverse) const { return move; }
+    // board size, for game logs
+    virtual int         width() const = 0;
+    virtual int         height() const = 0;
+
+    // any id in GameIds.h, nullptr for an unknown one or a board size the game doesn't allow
+    static SelfPlayGame *create(const std::string &id);
+};
+
+struct SelfPlayResult
+{
+    // 0 or 1, -1 for a draw
+    int         winner = -1;
+    int         plies = 0;
+    double      seconds = 0.0;
+    // search time and nodes spent by each side
+    double      searchSeconds[2] = { 0.0, 0.0 };
+    uint64_t    nodes[2] = { 0, 0 };
+    // every move played, and how long each one was searched (0 for random moves)
+    std::vector<uint32_t>   moves;
+    std::vector<uint32_t>   moveMicros;
+};
+
+// games longer than this are stopped and counted as draws
+const int SELF_PLAY_MAX_PLIES = 1000;
+
+//
+// one game from the start: randomPlies uniformly random moves taken from the
+// seed to spread the openings out, then engines[side] plays for each side
+//
+SelfPlayResult playSelfPlayGame(SelfPlayGame &game, const SelfPlayEngine engines[2], int randomPlies, uint64_t seed);
+
+//
+// a finished game as a log record, engines[0] being the one that moved first
+//
+void makeGameRecord(const SelfPlayGame &game, const std::string &gameId, const SelfPlayResult &result,
+                    const std::string engines[2], uint64_t seed, GameRecord &record);
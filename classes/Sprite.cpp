@@ -1,13 +1,38 @@
 #include "Sprite.h"
+#include "Trace.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include <iostream>
 #include <filesystem>
+#include <string>
+#include <unordered_map>
+
+//
+// every piece and square of the same kind draws the same image, so each file is
+// decoded and uploaded once and the texture handed to every sprite after that.
+// boards with hundreds of squares, and games put back from the ini file, no
+// longer load anything once the first board has been drawn. textures live as
+// long as the program does, as they always have
+//
+struct CachedTexture
+{
+    ImTextureID texture;
+    ImVec2      size;
+};
+static std::unordered_map<std::string, CachedTexture> textureCache;
 
 // Simple helper function to load an image into a OpenGL texture with common settings
 bool Sprite::LoadTextureFromFile(const char* filename)
 {
+    auto cached = textureCache.find(filename);
+    if (cached != textureCache.end()) {
+        _texture = cached->second.texture;
+        _size = cached->second.size;
+        return true;
+    }
+
     // Load from file
+    TraceScope trace("load texture", "assets");
     int image_width = 0;
     int image_height = 0;
     std::filesystem::path resourcePath = std::filesystem::path("resources") / filename;
@@ -25,6 +50,7 @@ bool Sprite::LoadTextureFromFile(const char* filename)
         return false;
     }
     _size = ImVec2((float)image_width, (float)image_height);
+    textureCache[filename] = { _texture, _size };
     return true;
 }
 
@@ -8,6 +8,8 @@ public:
     Square() : BitHolder() { _column = 0; _row = 0; }
 	// initialize the holder with a position, color, and a sprite
 	void	initHolder(const ImVec2 &position, const char *spriteName, const int column, const int row);
+	int		column() const { return _column; }
+	int		row() const { return _row; }
 private:
     int _column;
     int _row;
@@ -0,0 +1,368 @@
+#include "Tablebase.h"
+#include "BoardBatch.h"
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//
+// on-disk layout: a fixed header followed by one byte per base-3 index
+//
+struct TablebaseHeader
+{
+    char        magic[4];
+    uint32_t    version;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    k;
+    uint32_t    reserved;
+    uint64_t    entryCount;
+};
+
+static const char       kTablebaseMagic[4] = { 'T', 'T', 'T', 'B' };
+static const uint32_t   kTablebaseVersion = 1;
+
+// positions are handed to the worker threads in chunks of this many indices
+static const uint64_t   kTablebaseChunk = 1 << 14;
+
+// marks an index that still needs solving while generating
+static const uint8_t    kLayerInvalid = 0xFF;
+
+Tablebase::Tablebase()
+{
+    _width = 0;
+    _height = 0;
+    _k = 0;
+    _entryCount = 0;
+    _entries = nullptr;
+    _mapping = nullptr;
+    _mappingSize = 0;
+#ifdef _WIN32
+    _fileHandle = nullptr;
+    _mapHandle = nullptr;
+#endif
+}
+
+Tablebase::~Tablebase()
+{
+    close();
+}
+
+std::string Tablebase::fileName(int width, int height, int k)
+{
+    return "tictactoe_" + std::to_string(width) + "x" + std::to_string(height) + "_" + std::to_string(k) + ".tb";
+}
+
+//
+// run fn(begin, end) over [0, count) on a pool of threads pulling chunks off a shared counter
+//
+template <typename Fn>
+static void parallelFor(uint64_t count, int threads, Fn fn)
+{
+    std::atomic<uint64_t> next(0);
+    auto worker = [&]() {
+        for (;;) {
+            uint64_t begin = next.fetch_add(kTablebaseChunk);
+            if (begin >= count) {
+                return;
+            }
+            uint64_t end = begin + kTablebaseChunk < count ? begin + kTablebaseChunk : count;
+            fn(begin, end);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+//
+// retrograde analysis: every move adds a stone, so a position with p stones only
+// ever leads to positions with p + 1 stones. classify the terminal positions
+// first, then solve the board one stone count at a time from full back to empty.
+//
+bool Tablebase::generate(int width, int height, int k, const std::string &path, int threads)
+{
+    const int cells = width * height;
+    if (width <= 0 || height <= 0 || k <= 0 || cells > kTablebaseMaxCells || (k > width && k > height)) {
+        std::cerr << "Tablebase: unsupported board " << width << "x" << height << " k=" << k << std::endl;
+        return false;
+    }
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+    }
+
+    uint64_t pow3[kTablebaseMaxCells + 1];
+    pow3[0] = 1;
+    for (int i = 1; i <= cells; i++) {
+        pow3[i] = pow3[i - 1] * 3;
+    }
+    const uint64_t count = pow3[cells];
+    const BoardBatch batch(width, height, k);
+
+    std::vector<uint8_t> table(count, 0);
+    std::vector<uint8_t> layer(count, kLayerInvalid);
+
+    // pass 1: legality, stone counts and terminal positions. each chunk is unpacked
+    // into bitmasks and the line checks run through the SIMD batch evaluator.
+    parallelFor(count, threads, [&](uint64_t begin, uint64_t end) {
+        size_t size = (size_t)(end - begin);
+        std::vector<uint32_t> first(size, 0), second(size, 0);
+        std::vector<uint8_t> flags(size);
+        for (size_t i = 0; i < size; i++) {
+            uint64_t value = begin + i;
+            for (int cell = 0; cell < cells; cell++) {
+                int digit = (int)(value % 3);
+                value /= 3;
+                if (digit == 1) first[i] |= 1u << cell;
+                else if (digit == 2) second[i] |= 1u << cell;
+            }
+        }
+        batch.evaluate(first.data(), second.data(), flags.data(), size);
+
+        for (size_t i = 0; i < size; i++) {
+            int firstCount = std::popcount(first[i]);
+            int secondCount = std::popcount(second[i]);
+            if (firstCount != secondCount && firstCount != secondCount + 1) {
+                continue;
+            }
+
+            bool firstWins = (flags[i] & kBatchFirstWins) != 0;
+            bool secondWins = (flags[i] & kBatchSecondWins) != 0;
+            // the side to move can't already have a line, the game would have ended
+            bool firstToMove = firstCount == secondCount;
+            if ((firstToMove && firstWins) || (!firstToMove && secondWins)) {
+                continue;
+            }
+
+            uint64_t index = begin + i;
+            if (firstWins || secondWins) {
+                table[index] = makeEntry(kTablebaseLoss, 0);
+            } else if (flags[i] & kBatchFull) {
+                table[index] = makeEntry(kTablebaseDraw, 0);
+            } else {
+                layer[index] = (uint8_t)(firstCount + secondCount);
+            }
+        }
+    });
+
+    // pass 2: back up results one stone count at a time, children are always one layer deeper
+    for (int stones = cells - 1; stones >= 0; stones--) {
+        parallelFor(count, threads, [&](uint64_t begin, uint64_t end) {
+            for (uint64_t index = begin; index < end; index++) {
+                if (layer[index] != stones) {
+                    continue;
+                }
+                int mover = (stones % 2 == 0) ? 1 : 2;
+                int bestWin = 64, worstLoss = -1, longestDraw = -1;
+
+                uint64_t value = index;
+                for (int cell = 0; cell < cells; cell++) {
+                    int digit = (int)(value % 3);
+                    value /= 3;
+                    if (digit != 0) {
+                        continue;
+                    }
+                    uint8_t child = table[index + pow3[cell] * mover];
+                    int distance = distanceOf(child);
+                    switch (resultOf(child)) {
+                        case kTablebaseLoss:
+                            if (distance < bestWin) bestWin = distance;
+                            break;
+                        case kTablebaseDraw:
+                            if (distance > longestDraw) longestDraw = distance;
+                            break;
+                        case kTablebaseWin:
+                            if (distance > worstLoss) worstLoss = distance;
+                            break;
+                    }
+                }
+
+                if (bestWin < 64) {
+                    table[index] = makeEntry(kTablebaseWin, bestWin + 1);
+                } else if (longestDraw >= 0) {
+                    table[index] = makeEntry(kTablebaseDraw, longestDraw + 1);
+                } else {
+                    table[index] = makeEntry(kTablebaseLoss, worstLoss + 1);
+                }
+            }
+        });
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Tablebase: unable to write " << path << std::endl;
+        return false;
+    }
+    TablebaseHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kTablebaseMagic, sizeof(header.magic));
+    header.version = kTablebaseVersion;
+    header.width = width;
+    header.height = height;
+    header.k = k;
+    header.entryCount = count;
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)table.data(), (std::streamsize)table.size());
+    return (bool)file;
+}
+
+bool Tablebase::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(TablebaseHeader)) {
+        CloseHandle(fileHandle);
+        return false;
+    }
+    HANDLE mapHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *mapping = mapHandle ? MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!mapping) {
+        if (mapHandle) CloseHandle(mapHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+    _fileHandle = fileHandle;
+    _mapHandle = mapHandle;
+    _mapping = mapping;
+    _mappingSize = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(TablebaseHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    _mapping = mapping;
+    _mappingSize = (size_t)info.st_size;
+#endif
+
+    const TablebaseHeader *header = (const TablebaseHeader *)_mapping;
+    if (memcmp(header->magic, kTablebaseMagic, sizeof(header->magic)) != 0 || header->version != kTablebaseVersion ||
+        header->width * header->height > (uint32_t)kTablebaseMaxCells ||
+        header->entryCount > _mappingSize - sizeof(TablebaseHeader)) {
+        std::cerr << "Tablebase: " << path << " is not a valid table" << std::endl;
+        close();
+        return false;
+    }
+
+    _width = (int)header->width;
+    _height = (int)header->height;
+    _k = (int)header->k;
+    _entryCount = header->entryCount;
+    _entries = (const uint8_t *)_mapping + sizeof(TablebaseHeader);
+    return true;
+}
+
+void Tablebase::close()
+{
+    if (_mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(_mapping);
+        CloseHandle((HANDLE)_mapHandle);
+        CloseHandle((HANDLE)_fileHandle);
+        _mapHandle = nullptr;
+        _fileHandle = nullptr;
+#else
+        munmap(_mapping, _mappingSize);
+#endif
+    }
+    _mapping = nullptr;
+    _mappingSize = 0;
+    _entries = nullptr;
+    _entryCount = 0;
+    _width = 0;
+    _height = 0;
+    _k = 0;
+}
+
+uint64_t Tablebase::indexOf(const int *board) const
+{
+    uint64_t index = 0;
+    for (int cell = _width * _height - 1; cell >= 0; cell--) {
+        index = index * 3 + (uint64_t)board[cell];
+    }
+    return index;
+}
+
+//
+// pick the quickest win, else a draw, else the loss that holds out the longest
+//
+int Tablebase::bestMove(const int *board) const
+{
+    if (!isOpen()) {
+        return -1;
+    }
+    const int cells = _width * _height;
+    uint64_t index = indexOf(board);
+    uint8_t entry = probe(index);
+    // a finished game (a line on the board or no empty cell) is stored 0 plies from the end
+    if (resultOf(entry) == kTablebaseInvalid || distanceOf(entry) == 0) {
+        return -1;
+    }
+
+    int stones = 0;
+    for (int cell = 0; cell < cells; cell++) {
+        if (board[cell] != 0) stones++;
+    }
+    int mover = (stones % 2 == 0) ? 1 : 2;
+
+    int bestMove = -1;
+    int bestRank = -1;
+    uint64_t power = 1;
+    for (int cell = 0; cell < cells; cell++, power *= 3) {
+        if (board[cell] != 0) {
+            continue;
+        }
+        uint8_t child = probe(index + power * mover);
+        int distance = distanceOf(child);
+        // rank children from the mover's point of view, higher is better
+        int rank = 0;
+        switch (resultOf(child)) {
+            case kTablebaseLoss: rank = 300 - distance; break;
+            case kTablebaseDraw: rank = 200; break;
+            case kTablebaseWin:  rank = 100 + distance; break;
+            default: break;
+        }
+        if (rank > bestRank) {
+            bestRank = rank;
+            bestMove = cell;
+        }
+    }
+    return bestMove;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+//
+// perfect play tables for m,n,k games (tic-tac-toe and its bigger cousins)
+//
+// every layout of a width x height board is indexed by its base-3 value, where
+// cell i contributes (0 empty, 1 first player, 2 second player) * 3^i. that
+// index is a perfect hash, so the table is a flat array with one byte per
+// layout and layouts that can't come up in a real game are marked invalid.
+//
+// each byte holds the result for the side to move in the top 2 bits and the
+// number of plies until the game ends (with best play) in the low 6 bits.
+//
+
+enum TablebaseResult
+{
+    kTablebaseInvalid = 0,
+    kTablebaseWin = 1,
+    kTablebaseLoss = 2,
+    kTablebaseDraw = 3
+};
+
+// 3^16 bytes (43MB) for a 4x4 board is as large as we are willing to go
+const int kTablebaseMaxCells = 16;
+
+class Tablebase
+{
+public:
+    Tablebase();
+    ~Tablebase();
+
+    // solve every position by retrograde analysis and write the table to path
+    // threads <= 0 uses every core on the machine
+    static bool generate(int width, int height, int k, const std::string &path, int threads = 0);
+
+    // memory map a table written by generate(), the file stays mapped until close()
+    bool        open(const std::string &path);
+    void        close();
+    bool        isOpen() const { return _entries != nullptr; }
+
+    int         width() const { return _width; }
+    int         height() const { return _height; }
+    int         k() const { return _k; }
+    bool        matches(int width, int height, int k) const { return isOpen() && _width == width && _height == height && _k == k; }
+
+    // board is width * height cells holding 0 (empty), 1 or 2 (player number + 1)
+    uint64_t    indexOf(const int *board) const;
+    uint8_t     probe(uint64_t index) const { return index < _entryCount ? _entries[index] : 0; }
+    uint8_t     probe(const int *board) const { return probe(indexOf(board)); }
+
+    // best cell for the side to move, or -1 if the position isn't in the table or the game is over
+    int         bestMove(const int *board) const;
+
+    static int      resultOf(uint8_t entry) { return entry >> 6; }
+    static int      distanceOf(uint8_t entry) { return entry & 63; }
+    static uint8_t  makeEntry(int result, int distance) { return (uint8_t)((result << 6) | (distance > 63 ? 63 : distance)); }
+
+    // conventional resource name for a table, e.g. "tictactoe_3x3_3.tb"
+    static std::string fileName(int width, int height, int k);
+
+private:
+    int             _width;
+    int             _height;
+    int             _k;
+    uint64_t        _entryCount;
+    const uint8_t   *_entries;
+
+    // platform mapping handles
+    void            *_mapping;
+    size_t          _mappingSize;
+#ifdef _WIN32
+    void            *_fileHandle;
+    void            *_mapHandle;
+#endif
+};
@@ -0,0 +1,146 @@
+#include "ThreatEvaluator.h"
+
+#include <algorithm>
+
+ThreatEvaluator::ThreatEvaluator()
+{
+    _width = 0;
+    _height = 0;
+    _k = 0;
+    _score[0] = 0;
+    _score[1] = 0;
+}
+
+void ThreatEvaluator::setBoard(int width, int height, int k)
+{
+    _width = width;
+    _height = height;
+    _k = k;
+    _lineCells.clear();
+
+    const int directions[4][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+    std::vector<std::vector<int>> linesThroughCell(width * height);
+    int lines = 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (auto &direction : directions) {
+                int endX = x + direction[0] * (k - 1);
+                int endY = y + direction[1] * (k - 1);
+                if (endX < 0 || endX >= width || endY >= height) {
+                    continue;
+                }
+                for (int i = 0; i < k; i++) {
+                    int cell = (y + direction[1] * i) * width + x + direction[0] * i;
+                    _lineCells.push_back(cell);
+                    linesThroughCell[cell].push_back(lines);
+                }
+                lines++;
+            }
+        }
+    }
+
+    // flatten the per cell lists so a move walks one contiguous run
+    _cellLineStart.assign(width * height + 1, 0);
+    _cellLines.clear();
+    for (int cell = 0; cell < width * height; cell++) {
+        _cellLineStart[cell] = (int)_cellLines.size();
+        _cellLines.insert(_cellLines.end(), linesThroughCell[cell].begin(), linesThroughCell[cell].end());
+    }
+    _cellLineStart[width * height] = (int)_cellLines.size();
+    _lineCount.assign(lines * 2, 0);
+
+    // each stone closer to k in a row is worth 8 times more
+    _weights.assign(k + 1, 0);
+    for (int stones = 1; stones < k; stones++) {
+        _weights[stones] = 1 << (3 * (stones - 1));
+    }
+    clear();
+}
+
+void ThreatEvaluator::clear()
+{
+    std::fill(_lineCount.begin(), _lineCount.end(), 0);
+    for (int player = 0; player < 2; player++) {
+        _threats[player].assign(_k + 1, 0);
+        _score[player] = 0;
+    }
+    // every line starts out open for both players with no stones in it
+    _threats[0][0] = lineCount();
+    _threats[1][0] = lineCount();
+}
+
+void ThreatEvaluator::load(const int *board)
+{
+    clear();
+    for (int cell = 0; cell < _width * _height; cell++) {
+        if (board[cell] != 0) {
+            makeMove(cell, board[cell] - 1);
+        }
+    }
+}
+
+//
+// a line only counts for a player while the opponent has nothing in it
+//
+void ThreatEvaluator::removeLine(int line)
+{
+    int first = _lineCount[line * 2];
+    int second = _lineCount[line * 2 + 1];
+    if (second == 0) {
+        _threats[0][first]--;
+        _score[0] -= _weights[first];
+    }
+    if (first == 0) {
+        _threats[1][second]--;
+        _score[1] -= _weights[second];
+    }
+}
+
+void ThreatEvaluator::addLine(int line)
+{
+    int first = _lineCount[line * 2];
+    int second = _lineCount[line * 2 + 1];
+    if (second == 0) {
+        _threats[0][first]++;
+        _score[0] += _weights[first];
+    }
+    if (first == 0) {
+        _threats[1][second]++;
+        _score[1] += _weights[second];
+    }
+}
+
+void ThreatEvaluator::makeMove(int cell, int player)
+{
+    for (int i = _cellLineStart[cell]; i < _cellLineStart[cell + 1]; i++) {
+        int line = _cellLines[i];
+        removeLine(line);
+        _lineCount[line * 2 + player]++;
+        addLine(line);
+    }
+}
+
+void ThreatEvaluator::unmakeMove(int cell, int player)
+{
+    for (int i = _cellLineStart[cell]; i < _cellLineStart[cell + 1]; i++) {
+        int line = _cellLines[i];
+        removeLine(line);
+        _lineCount[line * 2 + player]--;
+        addLine(line);
+    }
+}
+
+int ThreatEvaluator::winner() const
+{
+    if (_k == 0) {
+        return 0;
+    }
+    if (_threats[0][_k] > 0) {
+        return 1;
+    }
+    if (_threats[1][_k] > 0) {
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//
+// heuristic evaluation for m,n,k games that is updated one move at a time
+//
+// every window of k cells in a row, column or diagonal is a line. for each line
+// we keep how many stones each player has in it, and for each player how many
+// lines they have n stones in while the opponent has none (open twos, threes,
+// fours...). placing or removing a stone only touches the lines through that
+// cell, so the score is always current without rescanning the board.
+//
+
+class ThreatEvaluator
+{
+public:
+    ThreatEvaluator();
+
+    // build the lines for a board, this also clears it
+    void        setBoard(int width, int height, int k);
+    void        clear();
+    // set up from a board of width * height cells holding 0 (empty), 1 or 2 (player number + 1)
+    void        load(const int *board);
+
+    // player is the zero based player number
+    void        makeMove(int cell, int player);
+    void        unmakeMove(int cell, int player);
+
+    // heuristic score from player's point of view, positive is good for player
+    int         score(int player) const { return _score[player] - _score[1 - player]; }
+    // player number + 1 of anyone with k in a row, or 0
+    int         winner() const;
+    // number of open lines where player has exactly stones stones
+    int         threats(int player, int stones) const { return _threats[player][stones]; }
+
+    int         lineCount() const { return (int)_lineCount.size() / 2; }
+    int         lineCell(int line, int i) const { return _lineCells[line * _k + i]; }
+    int         k() const { return _k; }
+
+    // score for k in a row, the heuristic always stays well below this
+    static const int kWinScore = 1000000;
+
+private:
+    void        removeLine(int line);
+    void        addLine(int line);
+
+    int                     _width;
+    int                     _height;
+    int                     _k;
+    // k cells for each line
+    std::vector<int>        _lineCells;
+    // lines through each cell, _cellLines[_cellLineStart[c] .. _cellLineStart[c + 1]]
+    std::vector<int>        _cellLineStart;
+    std::vector<int>        _cellLines;
+    // stones per player per line, [line * 2 + player]
+    std::vector<uint8_t>    _lineCount;
+    // open lines per player indexed by stone count, and what each count is worth
+    std::vector<int>        _threats[2];
+    std::vector<int>        _weights;
+    int                     _score[2];
+};
@@ -1,38 +1,63 @@
 #include "TicTacToe.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+#include "Trace.h"
+#include "../Application.h"
+
+#include <algorithm>
+#include <chrono>
 
 // -----------------------------------------------------------------------------
 // TicTacToe.cpp
 // -----------------------------------------------------------------------------
-// This file is intentionally *full of comments* and gentle TODOs that guide you
-// through wiring up a complete Tic‑Tac‑Toe implementation using the game engine’s
-// Bit / BitHolder grid system.
-//
-// Rules recap:
-//  - Two players place X / O on a 3x3 grid.
-//  - Players take turns; you can only place into an empty square.
-//  - First player to get three-in-a-row (row, column, or diagonal) wins.
-//  - If all 9 squares are filled and nobody wins, it’s a draw.
-//
-// Notes about the provided engine types you'll use here:
-//  - Bit              : a visual piece (sprite) that belongs to a Player
-//  - BitHolder        : a square on the board that can hold at most one Bit
-//  - Player           : the engine’s player object (you can ask who owns a Bit)
-//  - Game options     : let the mouse know the grid is 3x3 (rowX, rowY)
-//  - Helpers you’ll see used: setNumberOfPlayers, getPlayerAt, startGame, etc.
+// Tic-tac-toe as an m,n,k game: X and O take turns placing a piece on an empty
+// square of a width x height board (3x3 to 9x9), the first to get k in a row,
+// column or diagonal wins, and a full board with no line is a draw.
 //
-// I’ve already fully implemented PieceForPlayer() for you. Please leave that as‑is.
-// The rest of the routines are written as “comment-first” TODOs for you to complete.
+// The AI plays O. It opens from the book when one is loaded, plays perfectly
+// from the tablebase on boards small enough to have one, and otherwise runs
+// MNKSearch (alpha-beta with a transposition table) to the end of the game, to
+// the depth in the settings, or as deep as a latency target allows. While the
+// human thinks, a background thread ponders the AI's answer to each reply on a
+// copy of the board.
 // -----------------------------------------------------------------------------
 
 const int AI_PLAYER   = 1;      // index of the AI player (O)
 const int HUMAN_PLAYER= 0;      // index of the human player (X)
 
-TicTacToe::TicTacToe()
+// bigger boards can't be searched to the end, this is how far ahead they look by default
+const int DEFAULT_SEARCH_DEPTH = 4;
+
+// ponder target values that aren't cells
+const int PONDER_NONE  = -1;    // the human hasn't moved yet
+const int PONDER_ABORT = -2;    // throw everything away
+
+static GameRegistration registration({
+    .id = kGameIdTicTacToe, .name = "Tic-Tac-Toe", .boardWidth = 3, .boardHeight = 3, .players = 2,
+    .hasAI = true, .ai = "negamax with a tablebase on 3x3, depth limited on bigger boards",
+    .resizable = true, .maxSize = 9,
+    .create = [](const GameSetup &setup) -> Game * {
+        int longestSide = std::max(setup.width, setup.height);
+        return new TicTacToe(setup.width, setup.height, std::min(setup.lineLength, longestSide));
+    },
+});
+
+TicTacToe::TicTacToe(int width, int height, int k) : _search(width, height, k), _ponderTarget(PONDER_NONE), _ponderCurrent(PONDER_NONE)
 {
+    _width = width;
+    _height = height;
+    _k = k;
+    _ponderPlayer = AI_PLAYER;
+    _ponderDepth = 0;
+    // sized once here, the squares must not move after the bits are parented to them
+    _grid.resize(width * height);
+    _threats.setBoard(width, height, k);
 }
 
 TicTacToe::~TicTacToe()
 {
+    stopPondering(nullptr);
 }
 
 // -----------------------------------------------------------------------------
@@ -54,25 +79,35 @@ Bit* TicTacToe::PieceForPlayer(const int playerNumber)
 //
 void TicTacToe::setUpBoard()
 {
-    // create baseline for tic-tac-toe game with 2 players and a 3x3 grid
+    // create baseline for tic-tac-toe game with 2 players and a width x height grid
     setNumberOfPlayers(2);
-    _gameOptions.rowX = 3;
-    _gameOptions.rowY = 3;
+    _gameOptions.rowX = _width;
+    _gameOptions.rowY = _height;
+
+    // small boards are searched to the end, bigger ones stop early and use the threat evaluation
+    if (_gameOptions.AIMAXDepth <= 0) {
+        _gameOptions.AIMAXDepth = (_width * _height <= 9) ? _width * _height : DEFAULT_SEARCH_DEPTH;
+    }
 
     // Set player 1 (O) as the AI player
     setAIPlayer(AI_PLAYER);
 
     // here we initialize the images for the board
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
+    for (int y = 0; y < _height; y++) {
+        for (int x = 0; x < _width; x++) {
             // give some spacing to create a nicer-looking board
             ImVec2 position(x * 100.0f + 50.0f, y * 100.0f + 50.0f);
 
             // initialization statement
-            _grid[y][x].initHolder(position, "square.png", x, y);
+            _grid[y * _width + x].initHolder(position, "square.png", x, y);
         }
     }
 
+    // map the solved table if it has been generated, otherwise the AI falls back to negamax
+    if (!_tablebase.isOpen() && _width * _height <= kTablebaseMaxCells) {
+        _tablebase.open("resources/" + Tablebase::fileName(_width, _height, _k));
+    }
+
     startGame();
 }
 
@@ -131,11 +166,12 @@ bool TicTacToe::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
 //
 void TicTacToe::stopGame()
 {
+    // anything pondered belongs to the game that is going away
+    stopPondering(nullptr);
+
     // go through the array and call destroyBit on each square
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            _grid[y][x].destroyBit();
-        }
+    for (auto &square : _grid) {
+        square.destroyBit();
     }
 }
 
@@ -144,11 +180,8 @@ void TicTacToe::stopGame()
 //
 Player* TicTacToe::ownerAt(int index ) const
 {
-    // convert the index to coordinates, return nullptr if no bit, else return the owner
-    int y = index / 3;
-    int x = index % 3;
-
-    Bit *bit = _grid[y][x].bit();
+    // the grid is stored row by row so the index is the cell, return nullptr if no bit, else return the owner
+    Bit *bit = _grid[index].bit();
 
     if (!bit) return nullptr;
 
@@ -157,29 +190,19 @@ Player* TicTacToe::ownerAt(int index ) const
 
 Player* TicTacToe::checkForWinner()
 {
-    // check winning triples given to me before starting the assignment
-    int winningCombinations[8][3] = {
-        // rows
-        {0, 1, 2},
-        {3, 4, 5},
-        {6, 7, 8},
-        // columns
-        {0, 3, 6},
-        {1, 4, 7},
-        {2, 5, 8},
-        // diagonals
-        {0, 4, 8},
-        {2, 4, 6}
-    };
-
-    // check each winning combination
-    for (int i = 0; i < 8; i++) {
-        Player *owner1 = ownerAt(winningCombinations[i][0]);
-        Player *owner2 = ownerAt(winningCombinations[i][1]);
-        Player *owner3 = ownerAt(winningCombinations[i][2]);
-
-        if (owner1 && owner1 == owner2 && owner2 == owner3) {
-            return owner1;
+    // the evaluator already knows every row, column and diagonal of k cells
+    for (int line = 0; line < _threats.lineCount(); line++) {
+        Player *owner = ownerAt(_threats.lineCell(line, 0));
+        if (!owner) {
+            continue;
+        }
+
+        int i = 1;
+        while (i < _k && ownerAt(_threats.lineCell(line, i)) == owner) {
+            i++;
+        }
+        if (i == _k) {
+            return owner;
         }
     }
 
@@ -189,15 +212,7 @@ Player* TicTacToe::checkForWinner()
 bool TicTacToe::checkForDraw()
 {
     // if the board is full and a winner hasn't been found, it's a draw
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            if (_grid[y][x].empty()) {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    return countEmptySquares() == 0;
 }
 
 //
@@ -205,21 +220,21 @@ bool TicTacToe::checkForDraw()
 //
 std::string TicTacToe::initialStateString()
 {
-    return "000000000";
+    return std::string(_width * _height, '0');
 }
 
 //
-// this still needs to be tied into imguis init and shutdown
-// we will read the state string and store it in each turn object
+// one digit per square, stored in each turn object and in imgui.ini so the
+// game comes back after a restart (see the GameState handler in Application.cpp)
 //
 std::string TicTacToe::stateString() const
 {
     std::string state = "";
 
     // return a string representing the current state of the board
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            Bit *bit = _grid[y][x].bit();
+    for (int y = 0; y < _height; y++) {
+        for (int x = 0; x < _width; x++) {
+            Bit *bit = _grid[y * _width + x].bit();
 
             if (!bit) {
                 state += '0';
@@ -234,24 +249,25 @@ std::string TicTacToe::stateString() const
 }
 
 //
-// this still needs to be tied into imguis init and shutdown
-// when the program starts it will load the current game from the imgui ini file and set the game state to the last saved state
+// when the program starts the GameState settings handler in Application.cpp
+// reads the last game from the imgui ini file and puts it back through here
 //
 void TicTacToe::setStateString(const std::string &s)
 {
     // set the state of the board from the given string, done by looping through the string and calling setBit on each position on the baord
     int index = 0;
 
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            int playerNumber = s[index] - '0';
+    for (int y = 0; y < _height; y++) {
+        for (int x = 0; x < _width; x++) {
+            Square &square = _grid[y * _width + x];
+            int playerNumber = index < (int)s.size() ? s[index] - '0' : 0;
 
             if (playerNumber == 0) {
-                _grid[y][x].setBit(nullptr);
+                square.setBit(nullptr);
             } else if (playerNumber == 1 || playerNumber == 2) {
                 Bit *bit = PieceForPlayer(playerNumber - 1);
-                bit->moveTo(_grid[y][x].getPosition());
-                _grid[y][x].setBit(bit);
+                bit->moveTo(square.getPosition());
+                square.setBit(bit);
             }
 
             index++;
@@ -265,167 +281,238 @@ void TicTacToe::setStateString(const std::string &s)
 //
 void TicTacToe::updateAI()
 {
+    if (checkForWinner() || checkForDraw()) {
+        return;
+    }
+
+    // a book move needs no search at all
+    std::vector<int> board;
+    copyBoard(board);
+    int symmetry;
+    int bookMove = openingBookMove(canonicalKey(board.data(), _width, _height, symmetry));
+    if (bookMove >= 0 && bookMove < _width * _height) {
+        bookMove = mapRectangle(bookMove, _width, _height, symmetry, true);
+        if (actionForEmptyHolder(&_grid[bookMove])) {
+            _lastStats.setBookMove(bookMove);
+            _lastStats.logMove(statsLabel(), (int)getCurrentTurnNo());
+            endTurn();
+            startPondering();
+            return;
+        }
+    }
+
     // find the best move and place the piece
     int bestMoveIndex = findBestMove();
+    _lastStats.logMove(statsLabel(), (int)getCurrentTurnNo());
 
-    if (bestMoveIndex >= 0 && bestMoveIndex < 9) {
-        int y = bestMoveIndex / 3;
-        int x = bestMoveIndex % 3;
-
-        if (actionForEmptyHolder(&_grid[y][x])) {
+    if (bestMoveIndex >= 0 && bestMoveIndex < _width * _height) {
+        if (actionForEmptyHolder(&_grid[bestMoveIndex])) {
             endTurn();
+            // use the human's thinking time to work out our answers
+            startPondering();
         }
     }
 }
 
 //
-// negamax algorithm for calculating the best move based on a score
+// the board as the search and the book see it, 0 for empty or player number + 1
 //
-int TicTacToe::negamax(int depth, int currentPlayer, int maxDepth, int board[9])
+void TicTacToe::copyBoard(std::vector<int> &board) const
 {
-    int winner = checkWinnerInBoard(board);
-    if (winner != 0) {
-        // simple winner checks
-        if (winner == AI_PLAYER + 1) {
-            return 10 - depth;
-        } else {
-            return depth - 10;
+    board.assign(_width * _height, 0);
+    for (int i = 0; i < _width * _height; i++) {
+        Bit *bit = _grid[i].bit();
+        if (bit) {
+            board[i] = bit->getOwner()->playerNumber() + 1;
         }
     }
+}
 
-    if (isBoardFullArray(board)) {
-        return 0;
+int TicTacToe::countEmptySquares() const
+{
+    int count = 0;
+    for (auto &square : _grid) {
+        if (square.bit() == nullptr) {
+            count++;
+        }
     }
+    return count;
+}
 
-    if (depth >= maxDepth) {
-        return 0;
+//
+// returns the position for where the best move would be located
+//
+int TicTacToe::findBestMove()
+{
+    int cells = _width * _height;
+    int currentPlayer = getCurrentPlayer()->playerNumber();
+
+    // search to the end of the game unless the depth has been limited
+    int maxDepth = _gameOptions.AIMAXDepth > 0 ? _gameOptions.AIMAXDepth : cells;
+
+    std::vector<int> board;
+    copyBoard(board);
+
+    // a solved position needs no search at all
+    auto start = std::chrono::steady_clock::now();
+    if (_tablebase.matches(_width, _height, _k)) {
+        int tableMove = _tablebase.bestMove(board.data());
+        if (tableMove >= 0) {
+            _lastStats.reset();
+            _lastStats.bestMove = tableMove;
+            _lastStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return tableMove;
+        }
     }
 
-    int bestScore = -1000;
-
-    // experiment with all possible moves
-    for (int i = 0; i < 9; i++) {
-        // check empty tiles
-        if (board[i] == 0) {
-            // place the move
-            board[i] = currentPlayer + 1;
-
-            // use recursion to validate the moves and decide if its good
-            int score = -negamax(depth + 1, 1 - currentPlayer, maxDepth, board);
-
-            // reset the move
-            board[i] = 0;
+    // if we already worked out the answer to this move while the human was thinking, use it
+    int ponderedMove = stopPondering(board.data());
+    if (ponderedMove >= 0) {
+        // report the search that found it on the human's time
+        _lastStats.pondered = true;
+        return ponderedMove;
+    }
 
-            // update if better move was found
-            if (score > bestScore) {
-                bestScore = score;
+    // with a latency target the search deepens a ply at a time, so when the clock
+    // stops it there is the last depth it finished to fall back on. the first
+    // depth always runs to the end so there is always a move
+    if (latencyTarget() > 0.0) {
+        int bestMove = -1;
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            _search.setTimeBudget(depth == 1 ? 0.0 : searchTimeBudget(0.0));
+            int move = _search.findBestMove(board.data(), currentPlayer, depth);
+            if (_search.aborted()) {
+                break;
             }
+            bestMove = move;
+            _lastStats = _search.stats();
         }
+        _search.setTimeBudget(0.0);
+        _lastStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return bestMove;
     }
 
-    return bestScore;
+    int bestMove = _search.findBestMove(board.data(), currentPlayer, maxDepth);
+    _lastStats = _search.stats();
+    return bestMove;
+}
+
+std::string TicTacToe::statsLabel() const
+{
+    return "tictactoe " + std::to_string(_width) + "x" + std::to_string(_height) + " k" + std::to_string(_k);
 }
 
 //
-// checks the board for a current winner
+// pondering: once the AI has moved, search our answer to each of the human's
+// replies on a background thread, the predicted reply first. the search only ever
+// sees a copy of the board so the sprites are never touched off the main thread.
 //
-int TicTacToe::checkWinnerInBoard(int board[9])
+void TicTacToe::startPondering()
 {
-    // check all winning combinations
-    int winningCombinations[8][3] = {
-        {0, 1, 2},
-        {3, 4, 5},
-        {6, 7, 8},
-
-        {0, 3, 6},
-        {1, 4, 7},
-        {2, 5, 8},
-
-        {0, 4, 8},
-        {2, 4, 6}
-    };
-
-    for (int i = 0; i < 8; i++) {
-        int val1 = board[winningCombinations[i][0]];
-        int val2 = board[winningCombinations[i][1]];
-        int val3 = board[winningCombinations[i][2]];
-
-        if (val1 != 0 && val1 == val2 && val2 == val3) {
-            return val1;
-        }
-    }
-
-    return 0;
-}
+    stopPondering(nullptr);
 
+    Player *human = getCurrentPlayer();
+    if (!human || human->isAIPlayer() || checkForWinner() || checkForDraw()) {
+        return;
+    }
+    if (_tablebase.matches(_width, _height, _k)) {
+        // the table answers instantly, there is nothing to get ahead on
+        return;
+    }
 
-bool TicTacToe::isBoardFullArray(int board[9]) const
-{
-    for (int i = 0; i < 9; i++) {
-        if (board[i] == 0) {
-            return false;
+    int cells = _width * _height;
+    int humanPlayer = human->playerNumber();
+    _ponderPlayer = 1 - humanPlayer;
+    _ponderDepth = _gameOptions.AIMAXDepth > 0 ? _gameOptions.AIMAXDepth : cells;
+    copyBoard(_ponderBoard);
+    _ponderAnswers.clear();
+    _ponderStats.clear();
+    _ponderTarget.store(PONDER_NONE);
+    _ponderCurrent.store(PONDER_NONE);
+    _search.clearStop();
+
+    // the reply our own search expected goes first, then the rest of the empty squares
+    std::vector<int> replies;
+    int predicted = _search.expectedMove(_ponderBoard.data(), humanPlayer);
+    for (int i = 0; i < cells; i++) {
+        if (_ponderBoard[i] == 0) {
+            replies.push_back(i);
         }
     }
-    return true;
-}
-
+    if (predicted >= 0) {
+        std::stable_partition(replies.begin(), replies.end(), [predicted](int cell) { return cell == predicted; });
+    }
 
-int TicTacToe::countEmptySquares() const
-{
-    int count = 0;
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            if (_grid[y][x].bit() == nullptr) {
-                count++;
+    _ponderThread = std::thread([this, replies, humanPlayer]() {
+        Trace::setThreadName("ponder");
+        std::vector<int> board = _ponderBoard;
+        for (int reply : replies) {
+            int target = _ponderTarget.load();
+            // once the human has moved only their actual reply is worth finishing
+            if (target == PONDER_ABORT || (target != PONDER_NONE && target != reply)) {
+                break;
+            }
+            _ponderCurrent.store(reply);
+            board[reply] = humanPlayer + 1;
+            TraceScope trace("ponder reply", "ai");
+            int answer = _search.findBestMove(board.data(), _ponderPlayer, _ponderDepth);
+            board[reply] = 0;
+            if (_search.aborted()) {
+                break;
+            }
+            // only read by the main thread after it has joined us
+            _ponderAnswers[reply] = answer;
+            _ponderStats[reply] = _search.stats();
+            if (target != PONDER_NONE) {
+                break;
             }
         }
-    }
-    return count;
+        _ponderCurrent.store(PONDER_NONE);
+        // the answers are ready, the main loop may be asleep waiting for input
+        ClassGame::WakeMainLoop();
+    });
 }
 
 //
-// returns the position for where the best move would be located
+// stop the ponder thread and return our pondered answer if board is the pondered position
+// plus one human move, otherwise -1. pass nullptr to just throw the results away.
 //
-int TicTacToe::findBestMove()
+int TicTacToe::stopPondering(const int *board)
 {
-    int bestScore = -1000;
-    int bestMoveIndex = -1;
-
-    // use full DEPTH search of 9 for 9 squares
-    int maxDepth = 9;
-
-    int board[9];
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            int index = y * 3 + x;
-            Bit *bit = _grid[y][x].bit();
-            if (bit == nullptr) {
-                board[index] = 0;
-            } else {
-                board[index] = bit->getOwner()->playerNumber() + 1;
-            }
-        }
+    if (!_ponderThread.joinable()) {
+        return -1;
     }
 
-    // try all possible moves
-    for (int i = 0; i < 9; i++) {
-        if (board[i] == 0) {
-            board[i] = AI_PLAYER + 1;
-
-            // call negamax to evaluate the move
-            int score = -negamax(1, HUMAN_PLAYER, maxDepth, board);
-
-            // reset it
-            board[i] = 0;
-
-            // update if better move
-            if (score > bestScore) {
-                bestScore = score;
-                bestMoveIndex = i;
+    // find the one square the human filled since we started pondering
+    int reply = PONDER_ABORT;
+    if (board) {
+        for (int i = 0; i < _width * _height; i++) {
+            if (board[i] == _ponderBoard[i]) {
+                continue;
+            }
+            if (_ponderBoard[i] != 0 || board[i] != (1 - _ponderPlayer) + 1 || reply != PONDER_ABORT) {
+                // anything other than a single human move means the board changed under us
+                reply = PONDER_ABORT;
+                break;
             }
+            reply = i;
         }
     }
 
-    return bestMoveIndex;
+    _ponderTarget.store(reply);
+    // let the search run on if it is already answering the move the human made
+    if (reply == PONDER_ABORT || _ponderCurrent.load() != reply) {
+        _search.stop();
+    }
+    _ponderThread.join();
+    _search.clearStop();
+
+    if (reply >= 0) {
+        auto found = _ponderAnswers.find(reply);
+        if (found != _ponderAnswers.end()) {
+            _lastStats = _ponderStats[reply];
+            return found->second;
+        }
+    }
+    return -1;
 }
-
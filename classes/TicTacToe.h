@@ -1,9 +1,17 @@
 #pragma once
 #include "Game.h"
 #include "Square.h"
+#include "MNKSearch.h"
+#include "Tablebase.h"
+#include "ThreatEvaluator.h"
+
+#include <atomic>
+#include <map>
+#include <thread>
 
 //
 // the classic game of tic tac toe
+// the board size and line length are configurable, so this plays any m,n,k game
 //
 
 //
@@ -12,7 +20,7 @@
 class TicTacToe : public Game
 {
 public:
-    TicTacToe();
+    TicTacToe(int width = 3, int height = 3, int k = 3);
     ~TicTacToe();
 
     // set up the board
@@ -30,19 +38,48 @@ public:
 
 	void        updateAI() override;
     bool        gameHasAI() override { return true; }
-    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y * _width + x]; }
+    int         countEmptySquares() const override;
+
+    int         boardWidth() const { return _width; }
+    int         boardHeight() const { return _height; }
+    int         lineLength() const { return _k; }
+
+    const SearchStats *searchStats() const override { return &_lastStats; }
 private:
     Bit *       PieceForPlayer(const int playerNumber);
     Player*     ownerAt(int index ) const;
 
     // added helper functions for the AI
-    int         negamax(int depth, int currentPlayer, int maxDepth, int board[9]);
-    int         evaluateBoard(int board[9]);
-    int         checkWinnerInBoard(int board[9]);
-    bool        isBoardFullArray(int board[9]) const;
     int         findBestMove();
-    int         countEmptySquares() const;
+    void        copyBoard(std::vector<int> &board) const;
+    void        startPondering();
+    int         stopPondering(const int *board);
+    std::string statsLabel() const;
 
-    Square      _grid[3][3];
-};
+    int         _width;
+    int         _height;
+    int         _k;
+    std::vector<Square> _grid;
 
+    // line geometry for the winner check
+    ThreatEvaluator     _threats;
+    // the AI's search, also used by the ponder thread while the human is thinking
+    MNKSearch           _search;
+
+    // pondering state, the thread owns _search until it is joined
+    std::thread         _ponderThread;
+    std::vector<int>    _ponderBoard;
+    std::map<int, int>  _ponderAnswers;
+    std::map<int, SearchStats> _ponderStats;
+    std::atomic<int>    _ponderTarget;
+    std::atomic<int>    _ponderCurrent;
+    int                 _ponderPlayer;
+    int                 _ponderDepth;
+
+    // what the last AI move cost, only touched on the main thread
+    SearchStats         _lastStats;
+
+    // perfect play table, mapped from resources when one has been generated
+    Tablebase   _tablebase;
+};
@@ -0,0 +1,296 @@
+#include "Tournament.h"
+#include "GameRecord.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+// a game that hasn't reported back yet
+const int RESULT_PENDING = -3;
+// a game past the point where the SPRT stopped its pairing
+const int RESULT_SKIPPED = -2;
+
+// two sided 95% interval
+const double CONFIDENCE_Z = 1.959964;
+// keep a clean sweep from turning into an infinite rating
+const double SCORE_EPSILON = 1e-3;
+// pretend games of each outcome for the variance only
+const double PRIOR_GAMES = 0.5;
+
+bool TournamentEngine::parse(const std::string &text, TournamentEngine &engine)
+{
+    size_t colon = text.find(':');
+    std::string spec = colon == std::string::npos ? text : text.substr(colon + 1);
+    engine.name = colon == std::string::npos ? text : text.substr(0, colon);
+    return !engine.name.empty() && SelfPlayEngine::parse(spec, engine.engine);
+}
+
+double MatchScore::score() const
+{
+    return games() > 0 ? (wins + 0.5 * draws) / games() : 0.5;
+}
+
+static double eloFromScore(double score)
+{
+    score = std::min(std::max(score, SCORE_EPSILON), 1.0 - SCORE_EPSILON);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+static double scoreFromElo(double elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+//
+// variance of a single game's points around the mean score. a clean sweep has
+// none at all, which would make both the interval and the SPRT meaningless, so
+// every outcome gets PRIOR_GAMES of weight here on top of what was played
+//
+static double scoreVariance(const MatchScore &score)
+{
+    double mean = score.score();
+    double wins = score.wins + PRIOR_GAMES;
+    double draws = score.draws + PRIOR_GAMES;
+    double losses = score.losses + PRIOR_GAMES;
+    return (wins * (1.0 - mean) * (1.0 - mean) + draws * (0.5 - mean) * (0.5 - mean) + losses * mean * mean) / (wins + draws + losses);
+}
+
+EloEstimate estimateElo(const MatchScore &score)
+{
+    EloEstimate estimate;
+    if (score.games() == 0) {
+        return estimate;
+    }
+    double mean = score.score();
+    double margin = CONFIDENCE_Z * std::sqrt(scoreVariance(score) / score.games());
+    estimate.elo = eloFromScore(mean);
+    estimate.low = eloFromScore(mean - margin);
+    estimate.high = eloFromScore(mean + margin);
+    return estimate;
+}
+
+bool Sprt::parse(const std::string &text, Sprt &sprt)
+{
+    double values[4] = { 0.0, 5.0, 0.05, 0.05 };
+    int count = 0;
+    const char *cursor = text.c_str();
+    while (count < 4 && *cursor) {
+        char *end = nullptr;
+        values[count++] = strtod(cursor, &end);
+        if (end == cursor || (*end && *end != ',')) {
+            return false;
+        }
+        cursor = *end ? end + 1 : end;
+    }
+    if ((count != 2 && count != 4) || values[0] >= values[1] || values[2] <= 0.0 || values[3] <= 0.0) {
+        return false;
+    }
+    sprt.elo0 = values[0];
+    sprt.elo1 = values[1];
+    sprt.alpha = values[2];
+    sprt.beta = values[3];
+    return true;
+}
+
+//
+// with the score per game roughly normal, the log of how much likelier the
+// results are under elo1 than elo0 is n (s1 - s0) (2 mean - s0 - s1) / (2 var)
+//
+double Sprt::llr(const MatchScore &score) const
+{
+    if (score.games() == 0) {
+        return 0.0;
+    }
+    double variance = scoreVariance(score);
+    double s0 = scoreFromElo(elo0);
+    double s1 = scoreFromElo(elo1);
+    return score.games() * (s1 - s0) * (2.0 * score.score() - s0 - s1) / (2.0 * variance);
+}
+
+double Sprt::lowerBound() const
+{
+    return std::log(beta / (1.0 - alpha));
+}
+
+double Sprt::upperBound() const
+{
+    return std::log((1.0 - beta) / alpha);
+}
+
+Sprt::Result Sprt::test(const MatchScore &score) const
+{
+    double ratio = llr(score);
+    if (ratio >= upperBound()) return kAcceptH1;
+    if (ratio <= lowerBound()) return kAcceptH0;
+    return kContinue;
+}
+
+// splitmix64, spreads the tournament seed out over the openings
+static uint64_t mixSeed(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+//
+// bookkeeping for one pairing while its games come back in any order
+//
+struct PairingProgress
+{
+    // games counted so far, always a prefix of the pairing's games
+    int         counted = 0;
+    // games the SPRT needed, the rest of the pairing is skipped
+    int         stopAt = 0;
+    std::vector<int>    plies;
+};
+
+bool runTournament(const TournamentSettings &settings, const std::vector<TournamentEngine> &engines,
+                   TournamentResult &result, void (*progress)(int played, int total))
+{
+    result = TournamentResult();
+    SelfPlayGame *probe = SelfPlayGame::create(settings.gameId);
+    if (!probe || engines.size() < 2) {
+        delete probe;
+        return false;
+    }
+    delete probe;
+
+    int engineCount = (int)engines.size();
+    for (int first = 0; first < (settings.roundRobin ? engineCount : 1); first++) {
+        for (int second = first + 1; second < engineCount; second++) {
+            TournamentPairing pairing;
+            pairing.first = first;
+            pairing.second = second;
+            result.pairings.push_back(pairing);
+        }
+    }
+
+    const int pairingCount = (int)result.pairings.size();
+    const int perPairing = (std::max(settings.gamesPerPairing, 1) + 1) & ~1;
+    const int total = pairingCount * perPairing;
+    std::vector<PairingProgress> progressByPairing(pairingCount);
+    for (int p = 0; p < pairingCount; p++) {
+        result.pairings[p].results.assign(perPairing, RESULT_PENDING);
+        progressByPairing[p].stopAt = perPairing;
+        progressByPairing[p].plies.assign(perPairing, 0);
+    }
+
+    int threads = settings.threads;
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+    }
+    threads = std::min(threads, total);
+    result.threads = threads;
+
+    std::mutex lock;
+    int next = 0;
+    int finished = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    //
+    // games go out a pair of every pairing at a time, so the SPRT can stop a
+    // pairing early while the others are still being played
+    //
+    auto worker = [&]() {
+        Trace::setThreadName("tournament worker");
+        SelfPlayGame *game = SelfPlayGame::create(settings.gameId);
+        for (;;) {
+            int p, pair, g;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                int index = next++;
+                if (index >= total) {
+                    break;
+                }
+                p = (index / 2) % pairingCount;
+                pair = index / (2 * pairingCount);
+                g = pair * 2 + (index & 1);
+                if (g >= progressByPairing[p].stopAt) {
+                    result.pairings[p].results[g] = RESULT_SKIPPED;
+                    finished++;
+                    if (progress) {
+                        progress(finished, total);
+                    }
+                    continue;
+                }
+            }
+            TournamentPairing &pairing = result.pairings[p];
+            PairingProgress &state = progressByPairing[p];
+
+            // the first engine moves first in the even game of every pair, both games get the same opening
+            int firstMover = (g & 1) ? pairing.second : pairing.first;
+            int secondMover = (g & 1) ? pairing.first : pairing.second;
+            SelfPlayEngine sides[2] = { engines[firstMover].engine, engines[secondMover].engine };
+            uint64_t seed = mixSeed(settings.seed ^ mixSeed(((uint64_t)p << 32) | (uint64_t)pair));
+            Trace::begin("game", "tournament");
+            SelfPlayResult played = playSelfPlayGame(*game, sides, settings.randomPlies, seed);
+            Trace::end("game", "tournament");
+            Trace::counter("plies", played.plies);
+            if (settings.log) {
+                std::string names[2] = { engines[firstMover].name, engines[secondMover].name };
+                GameRecord record;
+                makeGameRecord(*game, settings.gameId, played, names, seed, record);
+                settings.log->append(record);
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+            int winner = played.winner < 0 ? -1 : (played.winner == 0 ? firstMover : secondMover);
+            if (g < state.stopAt) {
+                pairing.results[g] = winner;
+                state.plies[g] = played.plies;
+            } else {
+                pairing.results[g] = RESULT_SKIPPED;
+            }
+            result.searchSeconds += played.searchSeconds[0] + played.searchSeconds[1];
+            result.nodes += played.nodes[0] + played.nodes[1];
+
+            // count the finished prefix in game order, testing after every whole pair
+            while (state.counted < state.stopAt && pairing.results[state.counted] != RESULT_PENDING) {
+                int counted = pairing.results[state.counted];
+                if (counted == pairing.first) pairing.score.wins++;
+                else if (counted == pairing.second) pairing.score.losses++;
+                else pairing.score.draws++;
+                pairing.plies += state.plies[state.counted];
+                state.counted++;
+                if (settings.useSprt && (state.counted & 1) == 0 && pairing.sprtResult == Sprt::kContinue) {
+                    pairing.sprtResult = settings.sprt.test(pairing.score);
+                    if (pairing.sprtResult != Sprt::kContinue) {
+                        state.stopAt = state.counted;
+                    }
+                }
+            }
+
+            finished++;
+            if (progress) {
+                progress(finished, total);
+            }
+        }
+        delete game;
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+
+    for (int p = 0; p < pairingCount; p++) {
+        TournamentPairing &pairing = result.pairings[p];
+        for (int g = progressByPairing[p].stopAt; g < perPairing; g++) {
+            pairing.results[g] = RESULT_SKIPPED;
+        }
+        result.gamesPlayed += pairing.score.games();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
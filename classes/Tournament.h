@@ -0,0 +1,130 @@
+#pragma once
+
+#include "SelfPlay.h"
+
+class GameRecordWriter;
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// engine against engine matches across every core
+//
+// a tournament is a list of pairings (every engine against every other for a
+// round robin, the first engine against each of the rest for a gauntlet), each
+// played as pairs of games on the same random opening with the colors swapped.
+// every game is queued up front and a pool of workers, each with its own
+// SelfPlayGame and so its own tables, takes the next one off a shared counter.
+//
+// a game's seed only depends on the tournament seed, its pairing and its pair,
+// and a pairing's results are only ever read in game order, so an SPRT stop
+// lands on the same game whichever worker finished first. engines limited by
+// depth or playouts replay the same games from the same seed, time limits
+// depend on the machine.
+//
+
+struct TournamentEngine
+{
+    std::string     name;
+    SelfPlayEngine  engine;
+
+    // "name:spec" or just a spec, which is then also the name
+    static bool     parse(const std::string &text, TournamentEngine &engine);
+};
+
+// wins, draws and losses from one side's point of view
+struct MatchScore
+{
+    int         wins = 0;
+    int         draws = 0;
+    int         losses = 0;
+
+    int         games() const { return wins + draws + losses; }
+    // points per game, draws count half
+    double      score() const;
+};
+
+struct EloEstimate
+{
+    double      elo = 0.0;
+    // 95% confidence interval
+    double      low = 0.0;
+    double      high = 0.0;
+};
+
+// the Elo difference the score implies, with the interval from its per game variance
+EloEstimate estimateElo(const MatchScore &score);
+
+//
+// sequential probability ratio test between "the difference is elo0" and "the
+// difference is elo1", on the normal approximation to the log likelihood ratio.
+// it stops when the ratio leaves [lowerBound(), upperBound()], which keeps the
+// chance of a false pass under alpha and a false fail under beta
+//
+struct Sprt
+{
+    double      elo0 = 0.0;
+    double      elo1 = 5.0;
+    double      alpha = 0.05;
+    double      beta = 0.05;
+
+    enum Result { kContinue, kAcceptH0, kAcceptH1 };
+
+    // "elo0,elo1" or "elo0,elo1,alpha,beta"
+    static bool parse(const std::string &text, Sprt &sprt);
+
+    double      llr(const MatchScore &score) const;
+    double      lowerBound() const;
+    double      upperBound() const;
+    Result      test(const MatchScore &score) const;
+};
+
+struct TournamentSettings
+{
+    std::string gameId;
+    // false for a gauntlet
+    bool        roundRobin = true;
+    // per pairing, rounded up to an even number so both sides get each opening
+    int         gamesPerPairing = 10;
+    int         randomPlies = 2;
+    uint64_t    seed = 1;
+    // 0 for one per core
+    int         threads = 0;
+    bool        useSprt = false;
+    Sprt        sprt;
+    // every game played goes to this log when set, including ones the SPRT then leaves out
+    GameRecordWriter    *log = nullptr;
+};
+
+struct TournamentPairing
+{
+    // indexes into the engine list, first is the one the score is for
+    int         first = 0;
+    int         second = 0;
+    // from first's point of view, over the games counted
+    MatchScore  score;
+    // games in order, winner as an engine index or -1 for a draw, -2 for a game
+    // that was never played since the SPRT had already stopped
+    std::vector<int>    results;
+    Sprt::Result        sprtResult = Sprt::kContinue;
+    long long   plies = 0;
+};
+
+struct TournamentResult
+{
+    std::vector<TournamentPairing>  pairings;
+    int         gamesPlayed = 0;
+    double      seconds = 0.0;
+    double      searchSeconds = 0.0;
+    uint64_t    nodes = 0;
+    int         threads = 0;
+};
+
+//
+// plays every pairing out, false if the game id has no self-play adapter or
+// fewer than two engines were given. progress is called from the worker
+// threads, one at a time, after every game played or skipped
+//
+bool runTournament(const TournamentSettings &settings, const std::vector<TournamentEngine> &engines,
+                   TournamentResult &result, void (*progress)(int played, int total) = nullptr);
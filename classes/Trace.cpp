@@ -0,0 +1,163 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+struct TraceEvent
+{
+    uint64_t    nanoseconds;
+    const char  *name;
+    const char  *category;
+    int64_t     value;
+    char        phase;
+};
+
+//
+// one thread's events, written only by that thread
+//
+struct TraceBuffer
+{
+    TraceEvent              events[Trace::kEventsPerThread];
+    // events ever written, the newest is at (head - 1) % kEventsPerThread
+    std::atomic<uint64_t>   head { 0 };
+    std::atomic<const char *> name { nullptr };
+    int                     threadId = 0;
+    // where the last write() got to, only touched while holding buffersLock
+    uint64_t                written = 0;
+};
+
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+// every ring made so far, they live until the program exits so write() can
+// still read the ones belonging to threads that have finished
+static std::mutex buffersLock;
+static std::vector<TraceBuffer *> buffers;
+
+static thread_local TraceBuffer *threadBuffer = nullptr;
+static thread_local const char *threadName = nullptr;
+
+void Trace::setEnabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::setThreadName(const char *name)
+{
+    threadName = name;
+    if (threadBuffer) {
+        threadBuffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+void Trace::record(char phase, const char *name, const char *category, int64_t value)
+{
+    TraceBuffer *buffer = threadBuffer;
+    if (!buffer) {
+        buffer = new TraceBuffer;
+        buffer->name.store(threadName, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> guard(buffersLock);
+        buffer->threadId = (int)buffers.size() + 1;
+        buffers.push_back(buffer);
+        threadBuffer = buffer;
+    }
+
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer->events[head % kEventsPerThread];
+    event.nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+    event.name = name;
+    event.category = category;
+    event.value = value;
+    event.phase = phase;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+size_t Trace::pending()
+{
+    std::lock_guard<std::mutex> guard(buffersLock);
+    size_t total = 0;
+    for (TraceBuffer *buffer : buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        total += (size_t)std::min<uint64_t>(head - buffer->written, kEventsPerThread);
+    }
+    return total;
+}
+
+//
+// names are string literals from our own code, but a quote or backslash would
+// still break the file
+//
+static void writeString(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (; text && *text; text++) {
+        if (*text == '"' || *text == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+bool Trace::write(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gameboard\"}}");
+
+    std::lock_guard<std::mutex> guard(buffersLock);
+    std::vector<TraceEvent> events;
+    for (TraceBuffer *buffer : buffers) {
+        // copy first, then drop whatever the thread may have written over meanwhile
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = std::max(buffer->written, head > kEventsPerThread ? head - kEventsPerThread : 0);
+        events.clear();
+        for (uint64_t i = first; i < head; i++) {
+            events.push_back(buffer->events[i % kEventsPerThread]);
+        }
+        uint64_t after = buffer->head.load(std::memory_order_acquire);
+        uint64_t overwritten = after > kEventsPerThread ? after - kEventsPerThread : 0;
+        size_t skip = overwritten > first ? (size_t)std::min<uint64_t>(overwritten - first, events.size()) : 0;
+        buffer->written = head;
+
+        const char *name = buffer->name.load(std::memory_order_relaxed);
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer->threadId);
+        if (name) {
+            writeString(file, name);
+        } else {
+            fprintf(file, "\"thread %d\"", buffer->threadId);
+        }
+        fprintf(file, "}}");
+
+        // ends whose begins were overwritten, or went out in an earlier write, are left out
+        int depth = 0;
+        for (size_t i = skip; i < events.size(); i++) {
+            const TraceEvent &event = events[i];
+            if (event.phase == 'B') {
+                depth++;
+            } else if (event.phase == 'E') {
+                if (depth == 0) {
+                    continue;
+                }
+                depth--;
+            }
+            fprintf(file, ",\n{\"name\":");
+            writeString(file, event.name);
+            fprintf(file, ",\"cat\":");
+            writeString(file, event.category);
+            fprintf(file, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d", event.phase, event.nanoseconds / 1000.0, buffer->threadId);
+            if (event.phase == 'C') {
+                fprintf(file, ",\"args\":{\"value\":%" PRId64 "}", event.value);
+            }
+            fprintf(file, "}");
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
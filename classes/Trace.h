@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+//
+// timelines of what every thread was doing, saved as a Chrome trace
+//
+// each thread writes begin, end and counter events into a ring buffer of its
+// own, so recording takes no locks: the writer fills a slot and then bumps the
+// ring's head, and write() copies out whatever the heads say is there, keeping
+// only the events that can't have been overwritten while it was copying. a
+// thread's ring is made the first time it records something, so threads never
+// traced cost nothing. a ring holds the last kEventsPerThread events, older
+// ones are overwritten.
+//
+// when tracing is off every TraceScope and counter() is one test of a flag.
+// names and categories must be string literals, only the pointers are kept.
+//
+// write() saves the events recorded since the last write() in the JSON that
+// chrome://tracing and ui.perfetto.dev load.
+//
+
+class Trace
+{
+public:
+    static const int kEventsPerThread = 1 << 16;
+
+    static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+    // shown as the thread's name in the viewer, the default is "thread N"
+    static void setThreadName(const char *name);
+
+    static void begin(const char *name, const char *category) { if (enabled()) record('B', name, category, 0); }
+    static void end(const char *name, const char *category) { if (enabled()) record('E', name, category, 0); }
+    static void counter(const char *name, int64_t value) { if (enabled()) record('C', name, "counter", value); }
+
+    // events recorded since the last write() that are still in the rings
+    static size_t pending();
+    // false if the file can't be written
+    static bool write(const std::string &path);
+
+private:
+    static void record(char phase, const char *name, const char *category, int64_t value);
+
+    static inline std::atomic<bool> _enabled { false };
+};
+
+//
+// a begin event here and the matching end when the scope closes
+//
+class TraceScope
+{
+public:
+    TraceScope(const char *name, const char *category)
+    {
+        _name = Trace::enabled() ? name : nullptr;
+        if (_name) {
+            _category = category;
+            Trace::begin(name, category);
+        }
+    }
+    ~TraceScope()
+    {
+        if (_name) {
+            Trace::end(_name, _category);
+        }
+    }
+
+private:
+    // null when tracing was off at the start, so the end matches the begin
+    const char  *_name;
+    const char  *_category;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+//
+// ultimate tic-tac-toe on nine 9-bit masks
+//
+// the board is nine small tic-tac-toe boards laid out 3x3. a move is board * 9 +
+// cell, and the cell you play in sends your opponent to the board with that
+// number, unless it is already won or full in which case they can play anywhere.
+// winning a small board claims that square of the big (macro) board, three of
+// those in a row wins the game.
+//
+// each small board is one 9-bit mask per player, bit = row * 3 + column, so
+// checking for three in a row is a lookup in a 512 entry table. everything fits
+// in a few dozen bytes and copies in a handful of instructions, which is what the
+// random playouts of the MCTS need.
+//
+
+struct UltimateWinTable
+{
+    bool    wins[512];
+
+    constexpr UltimateWinTable() : wins()
+    {
+        // rows, columns and diagonals as 9-bit masks
+        const int lines[8] = { 0007, 0070, 0700, 0111, 0222, 0444, 0421, 0124 };
+        for (int mask = 0; mask < 512; mask++) {
+            for (int line : lines) {
+                if ((mask & line) == line) {
+                    wins[mask] = true;
+                }
+            }
+        }
+    }
+};
+
+inline constexpr UltimateWinTable ultimateWinTable;
+
+// small fast generator for the playouts (splitmix64)
+inline uint64_t ultimateRandom(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+class UltimateBoard
+{
+public:
+    static const int kCells = 81;
+    static const int kFull = 0x1FF;
+    // target when the player to move can go anywhere
+    static const int kAnyBoard = -1;
+
+    UltimateBoard() : _cells(), _macro(), _closed(0), _target(kAnyBoard), _side(0), _moves(0) {}
+
+    int         sideToMove() const { return _side; }
+    int         moves() const { return _moves; }
+    // the small board that must be played in, kAnyBoard if any open one will do
+    int         target() const { return _target; }
+    uint16_t    cells(int player, int board) const { return _cells[player][board]; }
+    uint16_t    macro(int player) const { return _macro[player]; }
+    // small boards that are won or full
+    uint16_t    closed() const { return _closed; }
+    // -1 if empty, otherwise the player
+    int         ownerAt(int move) const
+    {
+        int board = move / 9;
+        uint16_t bit = 1 << (move % 9);
+        if (_cells[0][board] & bit) return 0;
+        if (_cells[1][board] & bit) return 1;
+        return -1;
+    }
+
+    bool        isOver() const { return winner() >= 0 || _closed == kFull; }
+    // the player who won the macro board, -1 if nobody has (yet)
+    int         winner() const
+    {
+        if (ultimateWinTable.wins[_macro[0]]) return 0;
+        if (ultimateWinTable.wins[_macro[1]]) return 1;
+        return -1;
+    }
+
+    uint16_t    emptyCells(int board) const { return ~(_cells[0][board] | _cells[1][board]) & kFull; }
+    bool        boardIsOpen(int board) const { return !(_closed & (1 << board)); }
+
+    bool        isLegal(int move) const
+    {
+        if (move < 0 || move >= kCells || isOver()) return false;
+        int board = move / 9;
+        if (!boardIsOpen(board)) return false;
+        if (_target != kAnyBoard && _target != board) return false;
+        return (emptyCells(board) & (1 << (move % 9))) != 0;
+    }
+
+    // every legal move, returns how many
+    int         legalMoves(uint8_t *moves) const
+    {
+        int count = 0;
+        if (isOver()) return 0;
+        for (int board = 0; board < 9; board++) {
+            if (!boardIsOpen(board) || (_target != kAnyBoard && _target != board)) continue;
+            uint16_t empty = emptyCells(board);
+            while (empty) {
+                moves[count++] = (uint8_t)(board * 9 + std::countr_zero(empty));
+                empty &= empty - 1;
+            }
+        }
+        return count;
+    }
+
+    void        play(int move)
+    {
+        int board = move / 9;
+        int cell = move % 9;
+        uint16_t &mine = _cells[_side][board];
+        mine |= 1 << cell;
+        if (ultimateWinTable.wins[mine]) {
+            _macro[_side] |= 1 << board;
+            _closed |= 1 << board;
+        } else if ((_cells[0][board] | _cells[1][board]) == kFull) {
+            _closed |= 1 << board;
+        }
+        _target = boardIsOpen(cell) ? cell : kAnyBoard;
+        _side ^= 1;
+        _moves++;
+    }
+
+    // a uniformly random legal move, the board must not be over
+    int         randomMove(uint64_t &rng) const
+    {
+        uint64_t r = ultimateRandom(rng);
+        if (_target != kAnyBoard) {
+            return _target * 9 + pickBit(emptyCells(_target), r);
+        }
+        int counts[9];
+        int total = 0;
+        for (int board = 0; board < 9; board++) {
+            counts[board] = boardIsOpen(board) ? std::popcount(emptyCells(board)) : 0;
+            total += counts[board];
+        }
+        int k = (int)(r % (uint64_t)total);
+        int board = 0;
+        while (k >= counts[board]) {
+            k -= counts[board];
+            board++;
+        }
+        return board * 9 + pickBit(emptyCells(board), (uint64_t)k);
+    }
+
+    // random moves until the game ends, returns the winner or -1 for a draw
+    int         playout(uint64_t &rng)
+    {
+        while (!isOver()) {
+            play(randomMove(rng));
+        }
+        return winner();
+    }
+
+    // set up any position from each player's cells, the side to move follows from the counts
+    void        setCells(const uint16_t cells[2][9], int target)
+    {
+        _closed = 0;
+        _macro[0] = _macro[1] = 0;
+        _moves = 0;
+        for (int board = 0; board < 9; board++) {
+            for (int player = 0; player < 2; player++) {
+                _cells[player][board] = cells[player][board] & kFull;
+                _moves += std::popcount(_cells[player][board]);
+                if (ultimateWinTable.wins[_cells[player][board]]) {
+                    _macro[player] |= 1 << board;
+                    _closed |= 1 << board;
+                }
+            }
+            if ((_cells[0][board] | _cells[1][board]) == kFull) {
+                _closed |= 1 << board;
+            }
+        }
+        _side = _moves & 1;
+        _target = (target >= 0 && target < 9 && boardIsOpen(target)) ? target : kAnyBoard;
+    }
+
+private:
+    // the k-th set bit of mask (k taken modulo the count)
+    static int  pickBit(uint16_t mask, uint64_t k)
+    {
+        k %= (uint64_t)std::popcount(mask);
+        while (k--) {
+            mask &= mask - 1;
+        }
+        return std::countr_zero(mask);
+    }
+
+    uint16_t    _cells[2][9];
+    uint16_t    _macro[2];
+    uint16_t    _closed;
+    int8_t      _target;
+    uint8_t     _side;
+    uint8_t     _moves;
+};
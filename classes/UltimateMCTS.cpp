@@ -0,0 +1,166 @@
+#include "UltimateMCTS.h"
+
+#include <chrono>
+#include <cmath>
+
+// exploration constant, sqrt(2) is the textbook value
+const float UCT_EXPLORATION = 1.41f;
+
+// the tree stops growing here (about 40MB), playouts carry on from its leaves
+const size_t MAX_NODES = 2 * 1024 * 1024;
+
+// how many playouts go by between looks at the clock
+const uint64_t CLOCK_CHECK_INTERVAL = 256;
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+UltimateMCTS::UltimateMCTS(uint64_t seed)
+{
+    _rng = seed;
+}
+
+//
+// the child with the best UCT score, unvisited children come first
+//
+int UltimateMCTS::select(int node) const
+{
+    const Node &parent = _nodes[node];
+    float logVisits = std::log((float)parent.visits);
+    int best = parent.firstChild;
+    float bestScore = -1.0f;
+    for (int i = 0; i < parent.childCount; i++) {
+        const Node &child = _nodes[parent.firstChild + i];
+        if (child.visits == 0) {
+            return parent.firstChild + i;
+        }
+        float score = child.wins / child.visits + UCT_EXPLORATION * std::sqrt(logVisits / child.visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = parent.firstChild + i;
+        }
+    }
+    return best;
+}
+
+void UltimateMCTS::expand(int node, const UltimateBoard &board)
+{
+    uint8_t moves[UltimateBoard::kCells];
+    int count = board.legalMoves(moves);
+    _nodes[node].expanded = true;
+    if (count == 0 || _nodes.size() + count > MAX_NODES) {
+        return;
+    }
+
+    // shuffle so ties between unvisited children don't always go to the lowest cell
+    for (int i = count - 1; i > 0; i--) {
+        int j = (int)(ultimateRandom(_rng) % (uint64_t)(i + 1));
+        uint8_t swap = moves[i];
+        moves[i] = moves[j];
+        moves[j] = swap;
+    }
+
+    _nodes[node].firstChild = (int32_t)_nodes.size();
+    _nodes[node].childCount = (uint8_t)count;
+    for (int i = 0; i < count; i++) {
+        _nodes.push_back(Node{ node, -1, 0, 0.0f, 0, moves[i], (uint8_t)board.sideToMove(), false });
+    }
+}
+
+int UltimateMCTS::findBestMove(const UltimateBoard &board, double seconds, uint64_t maxPlayouts)
+{
+    double start = nowSeconds();
+    _stats.reset();
+    _nodes.clear();
+    _nodes.reserve(1 << 16);
+    _nodes.push_back(Node{ -1, -1, 0, 0.0f, 0, 0, (uint8_t)(board.sideToMove() ^ 1), false });
+
+    uint8_t moves[UltimateBoard::kCells];
+    if (board.legalMoves(moves) == 0) {
+        return -1;
+    }
+
+    uint64_t playouts = 0;
+    int deepest = 0;
+    while (maxPlayouts == 0 || playouts < maxPlayouts) {
+        if (seconds > 0.0 && (playouts % CLOCK_CHECK_INTERVAL) == 0 && nowSeconds() - start > seconds) {
+            break;
+        }
+
+        // walk down the tree
+        UltimateBoard position = board;
+        int node = 0;
+        int depth = 0;
+        while (_nodes[node].expanded && _nodes[node].childCount > 0) {
+            node = select(node);
+            position.play(_nodes[node].move);
+            depth++;
+        }
+        // grow it by one level and step into a new child
+        if (!position.isOver() && !_nodes[node].expanded) {
+            expand(node, position);
+            if (_nodes[node].childCount > 0) {
+                node = select(node);
+                position.play(_nodes[node].move);
+                depth++;
+            }
+        }
+        if (depth > deepest) {
+            deepest = depth;
+        }
+
+        // finish the game at random and credit everyone on the way back up
+        int winner = position.playout(_rng);
+        playouts++;
+        for (int n = node; n >= 0; n = _nodes[n].parent) {
+            Node &current = _nodes[n];
+            current.visits++;
+            if (winner < 0) {
+                current.wins += 0.5f;
+            } else if (winner == current.player) {
+                current.wins += 1.0f;
+            }
+        }
+    }
+
+    // the most tried move is the most trusted one
+    const Node &root = _nodes[0];
+    if (root.childCount == 0) {
+        return moves[0];
+    }
+    int bestChild = root.firstChild;
+    for (int i = 0; i < root.childCount; i++) {
+        if (_nodes[root.firstChild + i].visits > _nodes[bestChild].visits) {
+            bestChild = root.firstChild + i;
+        }
+    }
+
+    _stats.seconds = nowSeconds() - start;
+    _stats.nodes = playouts;
+    _stats.expanded = _nodes.size();
+    _stats.depthReached = deepest;
+    _stats.bestMove = _nodes[bestChild].move;
+    _stats.score = _nodes[bestChild].visits ? (int)(1000.0f * _nodes[bestChild].wins / _nodes[bestChild].visits) : 0;
+
+    // most visited line
+    for (int n = bestChild; n >= 0; ) {
+        _stats.principalVariation.push_back(_nodes[n].move);
+        const Node &current = _nodes[n];
+        if (current.childCount == 0) {
+            break;
+        }
+        int next = current.firstChild;
+        for (int i = 0; i < current.childCount; i++) {
+            if (_nodes[current.firstChild + i].visits > _nodes[next].visits) {
+                next = current.firstChild + i;
+            }
+        }
+        if (_nodes[next].visits == 0) {
+            break;
+        }
+        n = next;
+    }
+    return _nodes[bestChild].move;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SearchStats.h"
+#include "UltimateBoard.h"
+
+//
+// monte carlo tree search for ultimate tic-tac-toe
+//
+// each iteration walks down the tree picking children by UCT (win rate plus an
+// exploration bonus for rarely tried moves), adds the children of the leaf it
+// reaches, plays one random game from there on a copy of the compact board and
+// credits the result to every node on the way back up. the move played is the
+// root child that was tried the most.
+//
+class UltimateMCTS
+{
+public:
+    UltimateMCTS(uint64_t seed = 0x2545F4914F6CDD1Dull);
+
+    // best move for the side to move, stops after seconds or maxPlayouts (0 for no limit on either)
+    int         findBestMove(const UltimateBoard &board, double seconds, uint64_t maxPlayouts = 0);
+
+    // nodes in the stats are playouts, expanded is tree nodes, score is the win rate in tenths of a percent
+    const SearchStats   &stats() const { return _stats; }
+
+private:
+    struct Node
+    {
+        int32_t     parent;
+        int32_t     firstChild;
+        uint32_t    visits;
+        float       wins;           // for the player who made the move into this node, draws count half
+        uint8_t     childCount;
+        uint8_t     move;
+        uint8_t     player;
+        bool        expanded;
+    };
+
+    int         select(int node) const;
+    void        expand(int node, const UltimateBoard &board);
+
+    std::vector<Node>   _nodes;
+    uint64_t            _rng;
+    SearchStats         _stats;
+};
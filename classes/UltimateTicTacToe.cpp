@@ -0,0 +1,228 @@
+#include "UltimateTicTacToe.h"
+#include "BoardSymmetry.h"
+#include "GameIds.h"
+#include "GameRegistry.h"
+
+const int AI_PLAYER   = 1;      // index of the AI player (O)
+const int HUMAN_PLAYER= 0;      // index of the human player (X)
+
+// how long the AI may think about one move
+const double AI_TIME_BUDGET = 1.0;
+
+// 81 squares at full size don't fit, so everything is drawn smaller
+const float CELL_SIZE = 64.0f;
+// space between the small boards
+const float BOARD_GAP = 12.0f;
+
+static GameRegistration registration({
+    .id = kGameIdUltimate, .name = "Ultimate Tic-Tac-Toe", .boardWidth = 9, .boardHeight = 9, .players = 2,
+    .hasAI = true, .ai = "Monte Carlo tree search",
+    .create = [](const GameSetup &) -> Game * { return new UltimateTicTacToe(); },
+});
+
+UltimateTicTacToe::UltimateTicTacToe()
+{
+}
+
+UltimateTicTacToe::~UltimateTicTacToe()
+{
+}
+
+//
+// X for the first player, O for the second
+//
+Bit* UltimateTicTacToe::PieceForPlayer(const int playerNumber)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(playerNumber == 0 ? "x.png" : "o.png");
+    bit->setSize(CELL_SIZE, CELL_SIZE);
+    bit->setOwner(getPlayerAt(playerNumber));
+    return bit;
+}
+
+void UltimateTicTacToe::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = 9;
+    _gameOptions.rowY = 9;
+
+    setAIPlayer(AI_PLAYER);
+
+    for (int y = 0; y < 9; y++) {
+        for (int x = 0; x < 9; x++) {
+            ImVec2 position(x * CELL_SIZE + (x / 3) * BOARD_GAP + 50.0f, y * CELL_SIZE + (y / 3) * BOARD_GAP + 50.0f);
+            _grid[y][x].initHolder(position, "square.png", x, y);
+            _grid[y][x].setSize(CELL_SIZE, CELL_SIZE);
+        }
+    }
+    _board = UltimateBoard();
+    showPlayableSquares();
+
+    startGame();
+}
+
+//
+// full brightness where the next move may go, dimmed everywhere else
+//
+void UltimateTicTacToe::showPlayableSquares()
+{
+    for (int y = 0; y < 9; y++) {
+        for (int x = 0; x < 9; x++) {
+            int board = moveAt(x, y) / 9;
+            bool playable = !_board.isOver() && _board.boardIsOpen(board) &&
+                            (_board.target() == UltimateBoard::kAnyBoard || _board.target() == board);
+            // alternate small boards get a tint so they read as separate boards
+            float tint = (board % 2) ? 0.8f : 1.0f;
+            float light = playable ? 1.0f : 0.45f;
+            _grid[y][x].setColor(light * tint, light * tint, light, 1.0f);
+        }
+    }
+}
+
+bool UltimateTicTacToe::actionForEmptyHolder(BitHolder *holder)
+{
+    if (!holder) return false;
+
+    // every holder in this game is one of our squares
+    Square *square = static_cast<Square *>(holder);
+    return playMove(moveAt(square->column(), square->row()));
+}
+
+bool UltimateTicTacToe::playMove(int move)
+{
+    if (!_board.isLegal(move)) return false;
+
+    Player *currentPlayer = getCurrentPlayer();
+    if (!currentPlayer) return false;
+
+    Square &square = squareFor(move);
+    Bit *newBit = PieceForPlayer(currentPlayer->playerNumber());
+    newBit->moveTo(square.getPosition());
+    square.setBit(newBit);
+    _board.play(move);
+    showPlayableSquares();
+
+    Player *winner = checkForWinner();
+    if (winner) {
+        _winner = winner;
+    }
+    return true;
+}
+
+bool UltimateTicTacToe::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    // pieces stay where they were put
+    return false;
+}
+
+bool UltimateTicTacToe::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    return false;
+}
+
+void UltimateTicTacToe::stopGame()
+{
+    for (int y = 0; y < 9; y++) {
+        for (int x = 0; x < 9; x++) {
+            _grid[y][x].destroyBit();
+        }
+    }
+    _board = UltimateBoard();
+}
+
+Player* UltimateTicTacToe::checkForWinner()
+{
+    int winner = _board.winner();
+    return winner >= 0 ? getPlayerAt(winner) : nullptr;
+}
+
+bool UltimateTicTacToe::checkForDraw()
+{
+    return _board.isOver() && _board.winner() < 0;
+}
+
+//
+// state strings, 81 squares row by row from the top (0 empty, 1 X, 2 O) and
+// then the small board the next move must go in, 9 for any
+//
+std::string UltimateTicTacToe::initialStateString()
+{
+    return std::string(UltimateBoard::kCells, '0') + "9";
+}
+
+std::string UltimateTicTacToe::stateString() const
+{
+    std::string state;
+    for (int y = 0; y < 9; y++) {
+        for (int x = 0; x < 9; x++) {
+            Bit *bit = _grid[y][x].bit();
+            state += bit ? (char)('1' + bit->getOwner()->playerNumber()) : '0';
+        }
+    }
+    int target = _board.target();
+    state += (char)('0' + (target == UltimateBoard::kAnyBoard ? 9 : target));
+    return state;
+}
+
+void UltimateTicTacToe::setStateString(const std::string &s)
+{
+    uint16_t cells[2][9] = {};
+    int index = 0;
+
+    for (int y = 0; y < 9; y++) {
+        for (int x = 0; x < 9; x++) {
+            Square &square = _grid[y][x];
+            int playerNumber = index < (int)s.size() ? s[index] - '0' : 0;
+
+            square.destroyBit();
+            if (playerNumber == 1 || playerNumber == 2) {
+                Bit *bit = PieceForPlayer(playerNumber - 1);
+                bit->moveTo(square.getPosition());
+                square.setBit(bit);
+                int move = moveAt(x, y);
+                cells[playerNumber - 1][move / 9] |= 1 << (move % 9);
+            }
+            index++;
+        }
+    }
+    int target = index < (int)s.size() ? s[index] - '0' : 9;
+    _board.setCells(cells, target);
+    showPlayableSquares();
+}
+
+void UltimateTicTacToe::updateAI()
+{
+    if (_board.isOver()) {
+        return;
+    }
+
+    int symmetry;
+    int move = openingBookMove(canonicalKey(_board, symmetry));
+    if (move >= 0) {
+        move = mapUltimateMove(move, symmetry, true);
+        if (playMove(move)) {
+            _lastStats.setBookMove(move);
+            _lastStats.logMove("ultimate", (int)getCurrentTurnNo());
+            endTurn();
+            return;
+        }
+    }
+
+    // the search runs on time alone, AIMAXDepth doesn't mean anything to it
+    move = _search.findBestMove(_board, searchTimeBudget(AI_TIME_BUDGET));
+    _lastStats = _search.stats();
+    _lastStats.logMove("ultimate", (int)getCurrentTurnNo());
+
+    if (playMove(move)) {
+        endTurn();
+    }
+}
+
+bool UltimateTicTacToe::playRecordedMove(int move)
+{
+    if (!playMove(move)) {
+        return false;
+    }
+    endTurn();
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Game.h"
+#include "Square.h"
+#include "UltimateBoard.h"
+#include "UltimateMCTS.h"
+
+//
+// ultimate tic-tac-toe, nine tic-tac-toe boards inside a big one
+//
+// the 81 squares are laid out as a 9x9 grid with a gap between the small boards.
+// squares you can't play in this turn are dimmed. the AI plays O with monte
+// carlo tree search on the compact UltimateBoard.
+//
+class UltimateTicTacToe : public Game
+{
+public:
+    UltimateTicTacToe();
+    ~UltimateTicTacToe();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    // 81 squares row by row (0 empty, 1 X, 2 O) then the board to play in (0-8, or 9 for any)
+    std::string stateString() const override;
+    void        setStateString(const std::string &s) override;
+    bool        actionForEmptyHolder(BitHolder *holder) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        playRecordedMove(int move) override;
+    bool        gameHasAI() override { return true; }
+    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
+
+    const SearchStats *searchStats() const override { return &_lastStats; }
+
+private:
+    Bit *       PieceForPlayer(const int playerNumber);
+    // board * 9 + cell for the square at column x, row y of the 9x9 grid
+    static int  moveAt(int x, int y) { return ((y / 3) * 3 + x / 3) * 9 + (y % 3) * 3 + x % 3; }
+    Square      &squareFor(int move) { return _grid[(move / 9) / 3 * 3 + (move % 9) / 3][(move / 9) % 3 * 3 + (move % 9) % 3]; }
+    bool        playMove(int move);
+    void        showPlayableSquares();
+
+    Square          _grid[9][9];
+    UltimateBoard   _board;
+    UltimateMCTS    _search;
+
+    // what the last AI move cost
+    SearchStats     _lastStats;
+};
@@ -17,6 +17,7 @@
 #endif
 #include <GLFW/glfw3.h> // Will drag system OpenGL headers
 #include "Application.h"
+#include "classes/FrameProfiler.h"
 
 // [Win32] Our example includes a copy of glfw3.lib pre-compiled with VS2010 to maximize ease of testing and compatibility with old VS compilers.
 // To link with VS2010-era libraries, VS2015+ requires linking with legacy_stdio_definitions.lib, which we do using this pragma.
@@ -30,14 +31,26 @@
 #include "../libs/emscripten/emscripten_mainloop_stub.h"
 #endif
 
+// with nothing moving on screen the loop sleeps until there is input, then draws
+// a couple more frames for ImGui to settle. it still wakes now and then so the
+// text cursor blinks and ImGui gets to save imgui.ini
+static const int kFramesAfterEvents = 3;
+static const double kIdleTimeout = 1.0;
+static const double kTextInputTimeout = 0.25;
+
 static void glfw_error_callback(int error, const char* description)
 {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
 }
 
 // Main code
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    // pick the game before any window opens, --list-games doesn't need one
+    int exitCode = 0;
+    if (!ClassGame::ParseCommandLine(argc, argv, exitCode))
+        return exitCode;
+
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit())
         return 1;
@@ -120,7 +133,9 @@ int main(int, char**)
     bool show_demo_window = true;
     bool show_another_window = false;
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+    ClassGame::SetWakeMainLoop(glfwPostEmptyEvent);
     ClassGame::GameStartUp();
+    int framesSinceEvents = 0;
     
     // Main loop
 #ifdef __EMSCRIPTEN__
@@ -137,16 +152,29 @@ int main(int, char**)
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
-        glfwPollEvents();
+#ifndef __EMSCRIPTEN__
+        // the sleep comes before the frame starts, so it counts in no phase and no frame
+        if (!ClassGame::GameNeedsFrames() && framesSinceEvents >= kFramesAfterEvents) {
+            glfwWaitEventsTimeout(io.WantTextInput ? kTextInputTimeout : kIdleTimeout);
+            framesSinceEvents = 0;
+        }
+        framesSinceEvents++;
+#endif
+        FrameProfiler::instance().beginFrame();
+        {
+            ScopedFrameTimer timer(kPhaseEvents);
+            glfwPollEvents();
 
-        // Start the Dear ImGui frame
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+            // Start the Dear ImGui frame
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+        }
 
         ClassGame::RenderGame();
 
         // Rendering
+        ScopedFrameTimer renderTimer(kPhaseRender);
         ImGui::Render();
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
@@ -166,6 +194,7 @@ int main(int, char**)
             glfwMakeContextCurrent(backup_current_context);
         }
 
+        ScopedFrameTimer swapTimer(kPhaseSwap);
         glfwSwapBuffers(window);
     }
 #ifdef __EMSCRIPTEN__
@@ -173,6 +202,7 @@ int main(int, char**)
 #endif
 
     // Cleanup
+    ClassGame::GameShutDown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -12,6 +12,7 @@
 #include <d3d11.h>
 #include <tchar.h>
 #include "Application.h"
+#include "classes/FrameProfiler.h"
 
 // Data
 ID3D11Device*            g_pd3dDevice = nullptr;
@@ -20,6 +21,20 @@ static IDXGISwapChain*          g_pSwapChain = nullptr;
 static bool                     g_SwapChainOccluded = false;
 static UINT                     g_ResizeWidth = 0, g_ResizeHeight = 0;
 static ID3D11RenderTargetView*  g_mainRenderTargetView = nullptr;
+static HWND                     g_hWnd = nullptr;
+
+// with nothing moving on screen the loop sleeps until there is input, then draws
+// a couple more frames for ImGui to settle. it still wakes now and then so the
+// text cursor blinks and ImGui gets to save imgui.ini
+static const int kFramesAfterEvents = 3;
+static const DWORD kIdleTimeoutMs = 1000;
+static const DWORD kTextInputTimeoutMs = 250;
+
+// an empty message is enough to end MsgWaitForMultipleObjects() in the main loop
+static void WakeMainLoop()
+{
+    ::PostMessage(g_hWnd, WM_NULL, 0, 0);
+}
 
 // Forward declarations of helper functions
 bool CreateDeviceD3D(HWND hWnd);
@@ -29,8 +44,13 @@ void CleanupRenderTarget();
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 // Main code
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    // pick the game before any window opens, --list-games doesn't need one
+    int exitCode = 0;
+    if (!ClassGame::ParseCommandLine(argc, argv, exitCode))
+        return exitCode;
+
     // Make process DPI aware and obtain main monitor scale
     ImGui_ImplWin32_EnableDpiAwareness();
     float main_scale = ImGui_ImplWin32_GetDpiScaleForMonitor(::MonitorFromPoint(POINT{ 0, 0 }, MONITOR_DEFAULTTOPRIMARY));
@@ -106,7 +126,10 @@ int main(int, char**)
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
     // Our state
+    g_hWnd = hwnd;
+    ClassGame::SetWakeMainLoop(WakeMainLoop);
     ClassGame::GameStartUp();
+    int framesSinceEvents = 0;
 
     // Main loop
     bool done = false;
@@ -114,41 +137,52 @@ int main(int, char**)
     {
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
-        MSG msg;
-        while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE))
-        {
-            ::TranslateMessage(&msg);
-            ::DispatchMessage(&msg);
-            if (msg.message == WM_QUIT)
-                done = true;
+        // the sleep comes before the frame starts, so it counts in no phase and no frame
+        if (!ClassGame::GameNeedsFrames() && framesSinceEvents >= kFramesAfterEvents) {
+            ::MsgWaitForMultipleObjects(0, nullptr, FALSE, io.WantTextInput ? kTextInputTimeoutMs : kIdleTimeoutMs, QS_ALLINPUT);
+            framesSinceEvents = 0;
         }
-        if (done)
-            break;
-
-        // Handle window being minimized or screen locked
-        if (g_SwapChainOccluded && g_pSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED)
+        framesSinceEvents++;
+        FrameProfiler::instance().beginFrame();
         {
-            ::Sleep(10);
-            continue;
+            ScopedFrameTimer timer(kPhaseEvents);
+            MSG msg;
+            while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE))
+            {
+                ::TranslateMessage(&msg);
+                ::DispatchMessage(&msg);
+                if (msg.message == WM_QUIT)
+                    done = true;
+            }
+            if (done)
+                break;
+
+            // Handle window being minimized or screen locked
+            if (g_SwapChainOccluded && g_pSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED)
+            {
+                ::Sleep(10);
+                continue;
+            }
+            g_SwapChainOccluded = false;
+
+            // Handle window resize (we don't resize directly in the WM_SIZE handler)
+            if (g_ResizeWidth != 0 && g_ResizeHeight != 0)
+            {
+                CleanupRenderTarget();
+                g_pSwapChain->ResizeBuffers(0, g_ResizeWidth, g_ResizeHeight, DXGI_FORMAT_UNKNOWN, 0);
+                g_ResizeWidth = g_ResizeHeight = 0;
+                CreateRenderTarget();
+            }
+
+            // Start the Dear ImGui frame
+            ImGui_ImplDX11_NewFrame();
+            ImGui_ImplWin32_NewFrame();
+            ImGui::NewFrame();
         }
-        g_SwapChainOccluded = false;
-
-        // Handle window resize (we don't resize directly in the WM_SIZE handler)
-        if (g_ResizeWidth != 0 && g_ResizeHeight != 0)
-        {
-            CleanupRenderTarget();
-            g_pSwapChain->ResizeBuffers(0, g_ResizeWidth, g_ResizeHeight, DXGI_FORMAT_UNKNOWN, 0);
-            g_ResizeWidth = g_ResizeHeight = 0;
-            CreateRenderTarget();
-        }
-
-        // Start the Dear ImGui frame
-        ImGui_ImplDX11_NewFrame();
-        ImGui_ImplWin32_NewFrame();
-        ImGui::NewFrame();
         ClassGame::RenderGame();
 
         // Rendering
+        ScopedFrameTimer renderTimer(kPhaseRender);
         ImGui::Render();
         const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
         g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
@@ -163,12 +197,14 @@ int main(int, char**)
         }
 
         // Present
+        ScopedFrameTimer presentTimer(kPhaseSwap);
         HRESULT hr = g_pSwapChain->Present(1, 0);   // Present with vsync
         //HRESULT hr = g_pSwapChain->Present(0, 0); // Present without vsync
         g_SwapChainOccluded = (hr == DXGI_STATUS_OCCLUDED);
     }
 
     // Cleanup
+    ClassGame::GameShutDown();
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
@@ -0,0 +1,608 @@
+//
+// engine benchmarks and self checks
+//
+// usage: bench <command> [args]
+//
+//   batch [boards]     checks every SIMD batch path against the scalar reference
+//                      on random 4x4 boards and reports boards/sec for each
+//   connect4 [seconds] the connect four solver plays itself with a per-move time
+//                      budget, reports nodes/sec and the move where the game was solved
+//   perft [depth]      counts chess move paths from the standard test positions, checks
+//                      them against the published numbers and reports moves/sec
+//   perft <depth> <fen>  splits the count for one position by first move
+//   chess [depth]      searches each bench position to a fixed depth, reports the
+//                      time to reach every depth and nodes/sec
+//   checkers [depth]   counts move paths from the start (checked against the published
+//                      numbers), then the search plays itself to a fixed depth (10)
+//   gomoku [depth]     plays out a few seeded openings into middle games and times the
+//                      VCF and a fixed depth search (6 by default) on each, per move
+//   qubic [seconds]    the 4x4x4 search plays itself with a per-move time budget,
+//                      reports the depth of every move and nodes/sec
+//   reversi [depth]    checks the AVX2 move and flip path against the scalar one and
+//                      times both, counts move paths from the start (checked against
+//                      the published numbers), then times a fixed depth search (8 by
+//                      default) at 30 empties and the exact solver at 14
+//   ultimate [seconds] random ultimate tic-tac-toe playouts/sec from the empty board
+//                      and a middle game, then the MCTS searching each of them
+//
+
+#include "../classes/BoardBatch.h"
+#include "../classes/ChessEngine.h"
+#include "../classes/ChessPosition.h"
+#include "../classes/CheckersSearch.h"
+#include "../classes/ConnectFourSolver.h"
+#include "../classes/GomokuSearch.h"
+#include "../classes/QubicSearch.h"
+#include "../classes/ReversiSearch.h"
+#include "../classes/UltimateMCTS.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int benchBatch(int argc, char **argv)
+{
+    size_t count = argc > 0 ? (size_t)atoll(argv[0]) : 1 << 22;
+    BoardBatch batch(4, 4, 4);
+
+    // random non-overlapping stone layouts
+    std::mt19937 rng(12345);
+    std::vector<uint32_t> first(count), second(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = rng() & batch.fullMask();
+        uint32_t b = rng() & batch.fullMask() & ~a;
+        first[i] = a;
+        second[i] = b;
+    }
+
+    std::vector<uint8_t> reference(count);
+    int failures = 0;
+    for (BoardBatchPath path : { kBatchScalar, kBatchSSE2, kBatchAVX2 }) {
+        if (path > BoardBatch::bestPath()) {
+            std::cout << BoardBatch::pathName(path) << ": not supported on this cpu" << std::endl;
+            continue;
+        }
+        std::vector<uint8_t> results(count);
+        auto start = std::chrono::steady_clock::now();
+        batch.evaluate(first.data(), second.data(), results.data(), count, path);
+        double seconds = secondsSince(start);
+
+        if (path == kBatchScalar) {
+            reference = results;
+        } else if (memcmp(reference.data(), results.data(), count) != 0) {
+            std::cout << BoardBatch::pathName(path) << ": MISMATCH against scalar reference" << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << BoardBatch::pathName(path) << ": " << (double)count / seconds / 1e6 << "M boards/sec" << std::endl;
+    }
+    return failures ? 1 : 0;
+}
+
+static int benchConnectFour(int argc, char **argv)
+{
+    double budget = argc > 0 ? atof(argv[0]) : 1.0;
+    ConnectFourSolver solver;
+    solver.setTimeBudget(budget);
+
+    ConnectFourBoard board;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    int solvedAt = -1;
+    int winner = -1;
+    while (!board.isFull()) {
+        int column = solver.findBestMove(board);
+        nodes += solver.stats().nodes;
+        seconds += solver.stats().seconds;
+        if (solver.solved() && solvedAt < 0) {
+            solvedAt = board.moves();
+            std::cout << "solved at move " << solvedAt << ", score " << solver.score() << " for the player to move" << std::endl;
+        }
+        bool won = board.isWinningMove(column);
+        board.play(column);
+        if (won) {
+            winner = 1 - board.currentPlayer();
+            break;
+        }
+    }
+
+    std::cout << (winner < 0 ? std::string("draw") : "player " + std::to_string(winner) + " wins") << " after " << board.moves() << " moves" << std::endl;
+    std::cout << nodes << " nodes in " << seconds << "s, " << (seconds > 0.0 ? (double)nodes / seconds / 1e6 : 0.0) << "M nodes/sec" << std::endl;
+    return 0;
+}
+
+//
+// the usual move generator test positions with their known perft counts for depth 1 to 5
+//
+struct PerftPosition
+{
+    const char  *name;
+    const char  *fen;
+    uint64_t    counts[5];
+};
+
+static const PerftPosition perftPositions[] = {
+    { "start", kChessStartFen,
+      { 20, 400, 8902, 197281, 4865609 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      { 48, 2039, 97862, 4085603, 193690690 } },
+    { "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      { 14, 191, 2812, 43238, 674624 } },
+    { "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      { 6, 264, 9467, 422333, 15833292 } },
+    { "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+      { 44, 1486, 62379, 2103487, 89941194 } },
+    { "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+      { 46, 2079, 89890, 3894594, 164075551 } },
+};
+
+static int benchPerft(int argc, char **argv)
+{
+    int depth = argc > 0 ? atoi(argv[0]) : 4;
+    if (depth < 1) {
+        depth = 1;
+    }
+
+    if (argc > 1) {
+        // everything after the depth is the fen
+        std::string fen;
+        for (int i = 1; i < argc; i++) {
+            fen += std::string(i > 1 ? " " : "") + argv[i];
+        }
+        ChessPosition position;
+        if (!position.setFen(fen)) {
+            std::cerr << "bad fen: " << fen << std::endl;
+            return 1;
+        }
+        ChessMoveList list;
+        position.generateMoves(list);
+        uint64_t total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (ChessMove move : list) {
+            ChessPosition next = position;
+            next.makeMove(move);
+            uint64_t nodes = next.perft(depth - 1);
+            std::cout << move.uci() << ": " << nodes << std::endl;
+            total += nodes;
+        }
+        double seconds = secondsSince(start);
+        std::cout << "total " << total << " in " << seconds << "s, " << (double)total / seconds / 1e6 << "M moves/sec" << std::endl;
+        return 0;
+    }
+
+    if (depth > 5) {
+        depth = 5;
+    }
+    int failures = 0;
+    uint64_t total = 0;
+    double totalSeconds = 0.0;
+    for (auto &test : perftPositions) {
+        ChessPosition position;
+        position.setFen(test.fen);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = position.perft(depth);
+        double seconds = secondsSince(start);
+        total += nodes;
+        totalSeconds += seconds;
+
+        bool ok = nodes == test.counts[depth - 1];
+        failures += ok ? 0 : 1;
+        std::cout << test.name << " depth " << depth << ": " << nodes << (ok ? " ok" : " WRONG, expected " + std::to_string(test.counts[depth - 1]))
+                  << ", " << (double)nodes / seconds / 1e6 << "M moves/sec" << std::endl;
+    }
+    std::cout << total << " moves in " << totalSeconds << "s, " << (double)total / totalSeconds / 1e6 << "M moves/sec" << std::endl;
+    return failures ? 1 : 0;
+}
+
+// the perft positions plus a few quieter middle games and end games
+static const char *chessBenchPositions[] = {
+    "rnbqkb1r/pp1p1ppp/4pn2/2p5/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 0 4",
+    "r2q1rk1/ppp2ppp/2np1n2/2b1p1B1/2B1P1b1/2NP1N2/PPP2PPP/R2Q1RK1 w - - 0 8",
+    "r1bqr1k1/pp1nbppp/2p2n2/3p2B1/3P4/2NBP3/PPQ2PPP/R3K1NR w KQ - 4 9",
+    "8/5pk1/6p1/8/8/6P1/5PK1/3R4 w - - 0 1",
+    "8/8/4k3/8/2p5/8/B2K4/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3Q2K1 w - - 0 1",
+};
+
+static int benchChess(int argc, char **argv)
+{
+    int depth = argc > 0 ? atoi(argv[0]) : 9;
+    std::vector<std::string> fens;
+    for (auto &test : perftPositions) {
+        fens.push_back(test.fen);
+    }
+    for (const char *fen : chessBenchPositions) {
+        fens.push_back(fen);
+    }
+
+    ChessEngine engine;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    for (auto &fen : fens) {
+        ChessPosition position;
+        position.setFen(fen);
+        // every position starts from an empty table so the numbers don't depend on the order
+        engine.newGame();
+        ChessMove move = engine.findBestMove(position, depth, 0.0);
+        const SearchStats &stats = engine.stats();
+        nodes += stats.nodes;
+        seconds += stats.seconds;
+
+        std::cout << fen << std::endl;
+        std::cout << "  best " << move.uci() << " score " << stats.score << " nodes " << stats.nodes
+                  << " " << stats.nodesPerSecond() / 1e6 << "M nodes/sec" << std::endl << "  ms to depth:";
+        for (double time : engine.depthSeconds()) {
+            std::cout << " " << (int)(time * 1000.0);
+        }
+        std::cout << std::endl;
+    }
+    std::cout << nodes << " nodes in " << seconds << "s, " << (double)nodes / seconds / 1e6 << "M nodes/sec" << std::endl;
+    return 0;
+}
+
+static uint64_t checkersPerft(const CheckersPosition &position, int depth)
+{
+    CheckersMoveList list;
+    position.generateMoves(list);
+    if (depth == 1) {
+        return list.count;
+    }
+    uint64_t nodes = 0;
+    for (const CheckersMove &move : list) {
+        CheckersPosition child = position;
+        child.makeMove(move);
+        nodes += checkersPerft(child, depth - 1);
+    }
+    return nodes;
+}
+
+static int benchCheckers(int argc, char **argv)
+{
+    int depth = argc > 0 ? atoi(argv[0]) : 10;
+
+    // move paths from the starting position for depth 1 to 10
+    const uint64_t perftCounts[10] = { 7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564 };
+    CheckersPosition start;
+    auto perftStart = std::chrono::steady_clock::now();
+    int failures = 0;
+    uint64_t total = 0;
+    for (int d = 1; d <= 10; d++) {
+        uint64_t nodes = checkersPerft(start, d);
+        total += nodes;
+        failures += nodes == perftCounts[d - 1] ? 0 : 1;
+        if (nodes != perftCounts[d - 1]) {
+            std::cout << "perft " << d << ": " << nodes << " WRONG, expected " << perftCounts[d - 1] << std::endl;
+        }
+    }
+    double perftSeconds = secondsSince(perftStart);
+    std::cout << "perft 1-10 " << (failures ? "FAILED" : "ok") << ", " << (double)total / perftSeconds / 1e6 << "M moves/sec" << std::endl;
+
+    CheckersSearch search;
+    search.setTimeBudget(0.0);
+    CheckersPosition position;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    CheckersMove move;
+    int plies = 0;
+    while (!position.isDraw() && plies < 200 && search.findBestMove(position, depth, move)) {
+        nodes += search.stats().nodes;
+        seconds += search.stats().seconds;
+        position.makeMove(move);
+        plies++;
+    }
+    CheckersMoveList list;
+    position.generateMoves(list);
+    std::cout << (list.count == 0 ? "player " + std::to_string(1 - position.sideToMove()) + " wins" : std::string("draw")) << " after " << plies << " plies" << std::endl;
+    std::cout << nodes << " nodes in " << seconds << "s, " << (seconds > 0.0 ? (double)nodes / seconds / 1e6 : 0.0) << "M nodes/sec" << std::endl;
+    return failures ? 1 : 0;
+}
+
+static int benchGomoku(int argc, char **argv)
+{
+    int depth = argc > 0 ? atoi(argv[0]) : 6;
+    const int positions = 12;
+    const int middleGameMoves = 24;
+
+    // a few random stones around the center, then a quick search plays on to the middle game
+    GomokuSearch search;
+    search.setTimeBudget(0.0);
+    std::mt19937 rng(2024);
+    std::vector<double> vcfTimes, searchTimes;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    for (int p = 0; p < positions; p++) {
+        GomokuBoard board;
+        while (board.moves() < 4) {
+            int cell = (5 + rng() % 5) * GomokuBoard::kSize + 5 + rng() % 5;
+            if (board.isEmpty(cell)) {
+                board.play(cell);
+            }
+        }
+        while (board.moves() < middleGameMoves && !board.isOver()) {
+            board.play(search.findBestMove(board, 2));
+        }
+        if (board.isOver()) {
+            continue;
+        }
+
+        search.clearTable();
+        auto start = std::chrono::steady_clock::now();
+        int vcfMove = search.findVCF(board, 16);
+        vcfTimes.push_back(secondsSince(start));
+
+        int move = search.findBestMove(board, depth);
+        const SearchStats &stats = search.stats();
+        searchTimes.push_back(stats.seconds);
+        nodes += stats.nodes;
+        seconds += stats.seconds;
+        std::cout << "position " << p << ": vcf " << (vcfMove >= 0 ? "found" : "none") << " in " << vcfTimes.back() * 1000.0 << "ms, best "
+                  << move << " score " << stats.score << " in " << stats.seconds * 1000.0 << "ms, " << stats.nodes << " nodes" << std::endl;
+    }
+    if (searchTimes.empty()) {
+        return 1;
+    }
+
+    for (auto *times : { &vcfTimes, &searchTimes }) {
+        std::sort(times->begin(), times->end());
+        double total = 0.0;
+        for (double time : *times) {
+            total += time;
+        }
+        std::cout << (times == &vcfTimes ? "vcf" : "search depth " + std::to_string(depth)) << " ms per move: mean " << total / times->size() * 1000.0
+                  << " median " << (*times)[times->size() / 2] * 1000.0 << " max " << times->back() * 1000.0 << std::endl;
+    }
+    std::cout << nodes << " nodes in " << seconds << "s, " << (seconds > 0.0 ? (double)nodes / seconds / 1e6 : 0.0) << "M nodes/sec" << std::endl;
+    return 0;
+}
+
+static int benchQubic(int argc, char **argv)
+{
+    double budget = argc > 0 ? atof(argv[0]) : 1.0;
+    QubicSearch search;
+    search.setTimeBudget(budget);
+
+    QubicBoard board;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    std::cout << "depth per move:";
+    while (!board.isOver()) {
+        int cell = search.findBestMove(board);
+        nodes += search.stats().nodes;
+        seconds += search.stats().seconds;
+        std::cout << " " << search.stats().depthLimit << (search.solved() ? "*" : "");
+        board.play(cell);
+    }
+    std::cout << std::endl;
+
+    std::cout << (board.winner() < 0 ? std::string("draw") : "player " + std::to_string(board.winner()) + " wins") << " after " << board.moves() << " moves" << std::endl;
+    std::cout << nodes << " nodes in " << seconds << "s, " << (seconds > 0.0 ? (double)nodes / seconds / 1e6 : 0.0) << "M nodes/sec" << std::endl;
+    return 0;
+}
+
+// a pass counts as a move of its own, a finished game as one leaf
+static uint64_t reversiPerft(uint64_t own, uint64_t opp, int depth, bool passed)
+{
+    uint64_t moves = ReversiBoard::movesFor(own, opp);
+    if (!moves) {
+        if (passed) {
+            return 1;
+        }
+        return depth == 1 ? 1 : reversiPerft(opp, own, depth - 1, true);
+    }
+    if (depth == 1) {
+        return std::popcount(moves);
+    }
+    uint64_t nodes = 0;
+    while (moves) {
+        int square = std::countr_zero(moves);
+        moves &= moves - 1;
+        uint64_t flips = ReversiBoard::flipsFor(own, opp, square);
+        nodes += reversiPerft(opp & ~flips, own | flips | (1ull << square), depth - 1, false);
+    }
+    return nodes;
+}
+
+static void printMilliseconds(const std::string &label, std::vector<double> &times)
+{
+    std::sort(times.begin(), times.end());
+    double total = 0.0;
+    for (double time : times) {
+        total += time;
+    }
+    std::cout << label << " ms per move: mean " << total / times.size() * 1000.0 << " median " << times[times.size() / 2] * 1000.0
+              << " max " << times.back() * 1000.0 << std::endl;
+}
+
+static int benchReversi(int argc, char **argv)
+{
+    int depth = argc > 0 ? atoi(argv[0]) : 8;
+    int failures = 0;
+
+    // random boards, every path has to agree with the scalar one on moves and on the flips of every empty square
+    const int boards = 1 << 18;
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> own(boards), opp(boards);
+    for (int i = 0; i < boards; i++) {
+        own[i] = rng() & rng();
+        opp[i] = rng() & ~own[i];
+    }
+    for (ReversiPath path : { kReversiScalar, kReversiAVX2 }) {
+        int mismatches = 0;
+        for (int i = 0; i < boards; i++) {
+            mismatches += ReversiBoard::movesFor(own[i], opp[i], path) != ReversiBoard::movesFor(own[i], opp[i], kReversiScalar);
+            for (int square = 0; square < 64; square++) {
+                if (!((own[i] | opp[i]) >> square & 1)) {
+                    mismatches += ReversiBoard::flipsFor(own[i], opp[i], square, path) != ReversiBoard::flipsFor(own[i], opp[i], square, kReversiScalar);
+                }
+            }
+        }
+
+        // moves, then the flips of each of them, the way the search uses them
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < boards; i++) {
+            uint64_t moves = ReversiBoard::movesFor(own[i], opp[i], path);
+            checksum += moves;
+            while (moves) {
+                int square = std::countr_zero(moves);
+                moves &= moves - 1;
+                checksum ^= ReversiBoard::flipsFor(own[i], opp[i], square, path);
+            }
+        }
+        double seconds = secondsSince(start);
+        failures += mismatches ? 1 : 0;
+        std::cout << ReversiBoard::pathName(path) << (path != kReversiScalar && ReversiBoard::bestPath() != path ? " (not on this cpu, scalar ran)" : "")
+                  << ": " << (mismatches ? std::to_string(mismatches) + " mismatches" : std::string("ok")) << ", "
+                  << boards / seconds / 1e6 << "M boards/sec (checksum " << (checksum & 0xFFFF) << ")" << std::endl;
+    }
+
+    const uint64_t perftCounts[9] = { 4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288 };
+    ReversiBoard board;
+    uint64_t total = 0;
+    auto perftStart = std::chrono::steady_clock::now();
+    for (int d = 1; d <= 9; d++) {
+        uint64_t nodes = reversiPerft(board.discs(0), board.discs(1), d, false);
+        total += nodes;
+        if (nodes != perftCounts[d - 1]) {
+            failures++;
+            std::cout << "perft " << d << ": " << nodes << " WRONG, expected " << perftCounts[d - 1] << std::endl;
+        }
+    }
+    double perftSeconds = secondsSince(perftStart);
+    std::cout << "perft 1-9 " << (failures ? "FAILED" : "ok") << ", " << (double)total / perftSeconds / 1e6 << "M moves/sec" << std::endl;
+
+    // random openings, then a quick search plays on to the middle game and again to the endgame
+    ReversiSearch search;
+    search.setTimeBudget(0.0);
+    std::mt19937 openings(2024);
+    std::vector<double> searchTimes, solveTimes;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    for (int p = 0; p < 12; p++) {
+        board.reset();
+        for (int ply = 0; ply < 8 && !board.isOver(); ply++) {
+            uint64_t moves = board.moves();
+            if (!moves) {
+                board.pass();
+                continue;
+            }
+            for (int skip = openings() % std::popcount(moves); skip > 0; skip--) {
+                moves &= moves - 1;
+            }
+            board.play(std::countr_zero(moves));
+        }
+        for (int target : { 30, ReversiSearch::kEndgameEmpties }) {
+            while (board.emptyCount() > target && !board.isOver()) {
+                if (board.mustPass()) {
+                    board.pass();
+                } else {
+                    board.play(search.findBestMove(board, 4));
+                }
+            }
+            if (board.isOver() || board.mustPass()) {
+                break;
+            }
+            search.clearTable();
+            int move = search.findBestMove(board, depth);
+            const SearchStats &stats = search.stats();
+            (target == 30 ? searchTimes : solveTimes).push_back(stats.seconds);
+            nodes += stats.nodes;
+            seconds += stats.seconds;
+            std::cout << "position " << p << " at " << board.emptyCount() << " empties: best " << move << " score " << stats.score
+                      << (search.solved() ? " (exact)" : "") << " in " << stats.seconds * 1000.0 << "ms, " << stats.nodes << " nodes" << std::endl;
+        }
+    }
+    if (searchTimes.empty() || solveTimes.empty()) {
+        return 1;
+    }
+    printMilliseconds("search depth " + std::to_string(depth), searchTimes);
+    printMilliseconds("solve " + std::to_string(ReversiSearch::kEndgameEmpties) + " empties", solveTimes);
+    std::cout << nodes << " nodes in " << seconds << "s, " << (seconds > 0.0 ? (double)nodes / seconds / 1e6 : 0.0) << "M nodes/sec" << std::endl;
+    return failures ? 1 : 0;
+}
+
+static int benchUltimate(int argc, char **argv)
+{
+    double seconds = argc > 0 ? atof(argv[0]) : 2.0;
+
+    // the empty board and the position after 20 random moves
+    uint64_t rng = 12345;
+    UltimateBoard middleGame;
+    while (middleGame.moves() < 20) {
+        middleGame = UltimateBoard();
+        while (middleGame.moves() < 20 && !middleGame.isOver()) {
+            middleGame.play(middleGame.randomMove(rng));
+        }
+    }
+    const UltimateBoard positions[2] = { UltimateBoard(), middleGame };
+    const char *names[2] = { "empty board", "after 20 moves" };
+
+    for (int i = 0; i < 2; i++) {
+        uint64_t playouts = 0;
+        int wins[3] = { 0, 0, 0 };
+        auto start = std::chrono::steady_clock::now();
+        while (secondsSince(start) < seconds) {
+            for (int n = 0; n < 1024; n++) {
+                UltimateBoard board = positions[i];
+                wins[board.playout(rng) + 1]++;
+            }
+            playouts += 1024;
+        }
+        double elapsed = secondsSince(start);
+        std::cout << names[i] << ": " << playouts << " playouts, " << (double)playouts / elapsed / 1e6 << "M playouts/sec"
+                  << " (X " << wins[1] << " O " << wins[2] << " drawn " << wins[0] << ")" << std::endl;
+
+        UltimateMCTS search;
+        int move = search.findBestMove(positions[i], seconds);
+        const SearchStats &stats = search.stats();
+        std::cout << "  mcts best " << move << " win rate " << stats.score / 10.0 << "% tree " << stats.expanded
+                  << " nodes, " << stats.nodesPerSecond() / 1e6 << "M playouts/sec" << std::endl;
+    }
+    return 0;
+}
+
+struct BenchCommand
+{
+    const char  *name;
+    int         (*run)(int argc, char **argv);
+};
+
+static const BenchCommand benchCommands[] = {
+    { "batch", benchBatch },
+    { "connect4", benchConnectFour },
+    { "perft", benchPerft },
+    { "chess", benchChess },
+    { "checkers", benchCheckers },
+    { "gomoku", benchGomoku },
+    { "qubic", benchQubic },
+    { "reversi", benchReversi },
+    { "ultimate", benchUltimate },
+};
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2) {
+        for (auto &command : benchCommands) {
+            if (strcmp(argv[1], command.name) == 0) {
+                return command.run(argc - 2, argv + 2);
+            }
+        }
+    }
+    std::cerr << "usage: " << argv[0] << " <command> [args]" << std::endl << "commands:";
+    for (auto &command : benchCommands) {
+        std::cerr << " " << command.name;
+    }
+    std::cerr << std::endl;
+    return 1;
+}
@@ -0,0 +1,106 @@
+//
+// summaries of binary game logs
+//
+// usage: gamelog <file> [--print N]
+//
+// maps a log written by selfplay or tournament --record, walks every game in
+// it and prints, per game id, the games, results and average length, then the
+// bytes per game and move and how fast the log was read. --print N also lists
+// the first N games with their moves.
+//
+
+#include "../classes/GameRecord.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+struct GameLogTotals
+{
+    long long   games = 0;
+    long long   wins[2] = { 0, 0 };
+    long long   draws = 0;
+    long long   plies = 0;
+    double      seconds = 0.0;
+};
+
+static void printGame(const GameRecordView &view)
+{
+    const char *result = view.winner < 0 ? "draw" : (view.winner == 0 ? "1-0" : "0-1");
+    printf("@%llu %.*s %dx%d, %.*s vs %.*s, %s in %d plies, seed %llu, %.3fs:", (unsigned long long)view.offset,
+           (int)view.gameId.size(), view.gameId.data(), view.width, view.height,
+           (int)view.engines[0].size(), view.engines[0].data(), (int)view.engines[1].size(), view.engines[1].data(),
+           result, view.plies, (unsigned long long)view.seed, view.durationMicros / 1e6);
+    GameRecordCursor moves = view.moves();
+    uint32_t move;
+    while (moves.next(move)) {
+        printf(" %u", move);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file> [--print N]\n", argv[0]);
+        return 1;
+    }
+    int print = 0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--print") == 0) {
+            print = atoi(argv[i + 1]);
+        }
+    }
+
+    GameRecordReader reader;
+    if (!reader.open(argv[1])) {
+        fprintf(stderr, "can't read a game log from %s\n", argv[1]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::map<std::string, GameLogTotals> totals;
+    long long games = 0;
+    long long moveCount = 0;
+    uint64_t checksum = 0;
+    GameRecordView view;
+    while (reader.next(view)) {
+        // decode every move, so the time below is what a real pass over the log costs
+        GameRecordCursor moves = view.moves();
+        uint32_t move;
+        while (moves.next(move)) {
+            checksum = checksum * 31 + move;
+            moveCount++;
+        }
+        GameLogTotals &total = totals[std::string(view.gameId)];
+        total.games++;
+        if (view.winner < 0) total.draws++;
+        else total.wins[view.winner & 1]++;
+        total.plies += view.plies;
+        total.seconds += view.durationMicros / 1e6;
+        if (games < print) {
+            printGame(view);
+        }
+        games++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto &entry : totals) {
+        const GameLogTotals &total = entry.second;
+        printf("%-10s %lld games, first player %lld, second %lld, draws %lld, %.1f plies per game, %.3fs per game\n",
+               entry.first.c_str(), total.games, total.wins[0], total.wins[1], total.draws,
+               (double)total.plies / total.games, total.seconds / total.games);
+    }
+    printf("%lld games, %lld moves in %llu bytes: %.1f bytes per game, %.2f per move\n", games, moveCount,
+           (unsigned long long)reader.size(), games ? (double)reader.size() / games : 0.0,
+           moveCount ? (double)reader.size() / moveCount : 0.0);
+    printf("read in %.3fs, %.0f games/sec, %.0f MB/sec (checksum %016llx)\n", seconds, seconds > 0.0 ? games / seconds : 0.0,
+           seconds > 0.0 ? reader.size() / seconds / 1e6 : 0.0, (unsigned long long)checksum);
+    if (reader.damaged()) {
+        printf("the log is cut short, the last record didn't decode\n");
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+//
+// opening books from game logs
+//
+// usage: openingbook build <log> <game id> <output> [--plies N] [--min-games N] [--threads N]
+//        openingbook show <book> [move ...]
+//
+//   build  replays every game of that kind in a log written with --record, the
+//          first N plies of each (12 by default), and keeps the moves played at
+//          least --min-games times (3 by default) that scored close to the best
+//          one from the same position. the game picks up books/<game id>.book
+//          from the directory it is run in
+//   show   plays the moves from the start and lists the book moves there with
+//          the share of the picks each one gets
+//
+// a log from strong engines with a few --random-plies makes a book with some
+// variety: selfplay --game connect4 --games 5000 --random-plies 2 --record c4.bin
+//
+
+#include "../classes/OpeningBook.h"
+#include "../classes/SelfPlay.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int usage(const char *program)
+{
+    fprintf(stderr, "usage: %s build <log> <game id> <output> [--plies N] [--min-games N] [--threads N]\n"
+                    "       %s show <book> [move ...]\n", program, program);
+    return 1;
+}
+
+static int build(int argc, char **argv)
+{
+    if (argc < 5) {
+        return usage(argv[0]);
+    }
+    int plies = 12;
+    int minGames = 3;
+    int threads = 0;
+    for (int i = 5; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--plies") == 0) plies = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--min-games") == 0) minGames = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+        else return usage(argv[0]);
+    }
+
+    OpeningBookStats stats;
+    if (!OpeningBook::build(argv[2], argv[3], argv[4], plies, minGames, threads, stats)) {
+        return 1;
+    }
+    printf("%llu of %llu games replayed (%llu rejected), %llu positions seen, %llu kept with %llu moves, %.2fs\n",
+           (unsigned long long)stats.log.gamesUsed, (unsigned long long)stats.log.gamesRead, (unsigned long long)stats.log.gamesRejected,
+           (unsigned long long)stats.log.positions, (unsigned long long)stats.positions, (unsigned long long)stats.moves, stats.log.seconds);
+    return 0;
+}
+
+static int show(int argc, char **argv)
+{
+    if (argc < 3) {
+        return usage(argv[0]);
+    }
+    OpeningBook book;
+    if (!book.open(argv[2])) {
+        fprintf(stderr, "can't read an opening book from %s\n", argv[2]);
+        return 1;
+    }
+    SelfPlayGame *game = SelfPlayGame::create(book.gameId());
+    if (!game) {
+        fprintf(stderr, "no rules for '%s'\n", book.gameId().c_str());
+        return 1;
+    }
+
+    game->restart();
+    std::vector<int> legal;
+    for (int i = 3; i < argc; i++) {
+        int move = atoi(argv[i]);
+        game->legalMoves(legal);
+        if (game->isOver() || std::find(legal.begin(), legal.end(), move) == legal.end()) {
+            fprintf(stderr, "%d isn't a legal move after %d moves\n", move, i - 3);
+            delete game;
+            return 1;
+        }
+        game->play(move);
+    }
+
+    printf("%s, %llu positions and %llu moves to ply %d\n", book.gameId().c_str(), (unsigned long long)book.positionCount(),
+           (unsigned long long)book.moveCount(), book.maxPlies());
+    int symmetry;
+    const BookPosition *position = book.find(game->canonicalKey(symmetry));
+    if (!position) {
+        printf("out of book\n");
+        delete game;
+        return 0;
+    }
+    const BookMove *moves = book.moves(*position);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < position->moveCount; i++) {
+        total += moves[i].weight;
+    }
+    for (uint32_t i = 0; i < position->moveCount; i++) {
+        printf("  %-6d %5.1f%%\n", game->mapMove(moves[i].move, symmetry, true), 100.0 * moves[i].weight / total);
+    }
+    delete game;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "build") == 0) return build(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "show") == 0) return show(argc, argv);
+    return usage(argv[0]);
+}
@@ -0,0 +1,200 @@
+//
+// position databases from game logs
+//
+// usage: positiondb build <log> <game id> <output> [--plies N] [--threads N]
+//        positiondb probe <database> [move ...]
+//        positiondb bench <database> [probes]
+//
+//   build  replays every game of that kind in a log written with --record, the
+//          first N plies of each (20 by default), and writes the position table
+//   probe  plays the moves (the game's own move ints, as gamelog --print shows
+//          them) from the start and prints how the position scored, its best
+//          reply, and the same for the position every legal move leads to,
+//          mirror image moves together
+//   bench  times lookups of positions in the table and of ones that aren't
+//
+
+#include "../classes/PositionDatabase.h"
+#include "../classes/SelfPlay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static int usage(const char *program)
+{
+    fprintf(stderr, "usage: %s build <log> <game id> <output> [--plies N] [--threads N]\n"
+                    "       %s probe <database> [move ...]\n"
+                    "       %s bench <database> [probes]\n", program, program, program);
+    return 1;
+}
+
+static void printEntry(const char *label, const PositionEntry *entry)
+{
+    if (!entry) {
+        printf("%-12s never seen\n", label);
+        return;
+    }
+    printf("%-12s %u games, +%u =%u -%u for the side to move, score %.3f, first seen at ply %u\n", label,
+           entry->games(), entry->wins, entry->draws, entry->losses, entry->score(), entry->ply);
+}
+
+static int build(int argc, char **argv)
+{
+    if (argc < 5) {
+        return usage(argv[0]);
+    }
+    int plies = 20;
+    int threads = 0;
+    for (int i = 5; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--plies") == 0) plies = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+        else return usage(argv[0]);
+    }
+
+    PositionBuildStats stats;
+    if (!PositionDatabase::build(argv[2], argv[3], argv[4], plies, threads, stats)) {
+        return 1;
+    }
+    printf("%llu of %llu games replayed (%llu rejected), %llu positions, %llu position/move pairs, %.2fs, %.0f games/sec\n",
+           (unsigned long long)stats.gamesUsed, (unsigned long long)stats.gamesRead, (unsigned long long)stats.gamesRejected,
+           (unsigned long long)stats.positions, (unsigned long long)stats.replies, stats.seconds,
+           stats.seconds > 0.0 ? stats.gamesUsed / stats.seconds : 0.0);
+    return 0;
+}
+
+static int probe(int argc, char **argv)
+{
+    if (argc < 3) {
+        return usage(argv[0]);
+    }
+    PositionDatabase database;
+    if (!database.open(argv[2])) {
+        fprintf(stderr, "can't read a position database from %s\n", argv[2]);
+        return 1;
+    }
+    SelfPlayGame *game = SelfPlayGame::create(database.gameId());
+    if (!game) {
+        fprintf(stderr, "no rules for '%s'\n", database.gameId().c_str());
+        return 1;
+    }
+
+    game->restart();
+    std::vector<int> legal;
+    for (int i = 3; i < argc; i++) {
+        int move = atoi(argv[i]);
+        game->legalMoves(legal);
+        if (game->isOver() || std::find(legal.begin(), legal.end(), move) == legal.end()) {
+            fprintf(stderr, "%d isn't a legal move after %d moves\n", move, i - 3);
+            delete game;
+            return 1;
+        }
+        game->play(move);
+    }
+
+    int symmetry;
+    uint64_t key = game->canonicalKey(symmetry);
+    const PositionEntry *entry = database.probe(key);
+    printf("%s, %llu games to ply %d, position %016llx (symmetry %d)\n", database.gameId().c_str(),
+           (unsigned long long)database.games(), database.maxPlies(), (unsigned long long)key, symmetry);
+    printEntry("position", entry);
+    if (entry && entry->bestReply >= 0) {
+        printf("best reply   %d, played %u times\n", game->mapMove(entry->bestReply, symmetry, true), entry->bestReplyGames);
+    }
+
+    // the positions each legal move leads to, scored for the side that made the
+    // move. moves that are mirror images of each other through a symmetry of
+    // this position lead to the same canonical position, so they share a line
+    // instead of each claiming its games. the counts are for the position, games
+    // that got there by another move order count too
+    game->legalMoves(legal);
+    std::vector<int> line;
+    for (int i = 3; i < argc; i++) {
+        line.push_back(atoi(argv[i]));
+    }
+    std::vector<uint64_t> childKeys;
+    std::vector<std::string> childMoves;
+    for (int move : legal) {
+        game->restart();
+        for (int played : line) {
+            game->play(played);
+        }
+        game->play(move);
+        int childSymmetry;
+        uint64_t childKey = game->canonicalKey(childSymmetry);
+        size_t child = std::find(childKeys.begin(), childKeys.end(), childKey) - childKeys.begin();
+        if (child == childKeys.size()) {
+            childKeys.push_back(childKey);
+            childMoves.push_back(std::to_string(move));
+        } else {
+            childMoves[child] += '/';
+            childMoves[child] += std::to_string(move);
+        }
+    }
+    for (size_t i = 0; i < childKeys.size(); i++) {
+        const PositionEntry *child = database.probe(childKeys[i]);
+        if (child) {
+            printf("  %-10s %u games reached it, score %.3f for the mover\n", childMoves[i].c_str(), child->games(), 1.0 - child->score());
+        }
+    }
+    delete game;
+    return 0;
+}
+
+static int bench(int argc, char **argv)
+{
+    if (argc < 3) {
+        return usage(argv[0]);
+    }
+    PositionDatabase database;
+    if (!database.open(argv[2])) {
+        fprintf(stderr, "can't read a position database from %s\n", argv[2]);
+        return 1;
+    }
+    int probes = argc > 3 ? atoi(argv[3]) : 1000000;
+
+    std::vector<uint64_t> present;
+    for (uint64_t slot = 0; slot < database.capacity(); slot++) {
+        if (database.entries()[slot].key) {
+            present.push_back(database.entries()[slot].key);
+        }
+    }
+    if (present.empty()) {
+        fprintf(stderr, "the database is empty\n");
+        return 1;
+    }
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> hits(probes), misses(probes);
+    for (int i = 0; i < probes; i++) {
+        hits[i] = present[rng() % present.size()];
+        misses[i] = rng() | 1;
+    }
+
+    const char *names[2] = { "present", "missing" };
+    std::vector<uint64_t> *keys[2] = { &hits, &misses };
+    for (int pass = 0; pass < 2; pass++) {
+        uint64_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t key : *keys[pass]) {
+            found += database.probe(key) != nullptr;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%s: %d probes, %llu found, %.1f ns per probe\n", names[pass], probes, (unsigned long long)found,
+               seconds * 1e9 / probes);
+    }
+    printf("%llu positions in %llu slots\n", (unsigned long long)database.positions(), (unsigned long long)database.capacity());
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "build") == 0) return build(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "probe") == 0) return probe(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) return bench(argc, argv);
+    return usage(argv[0]);
+}
@@ -0,0 +1,159 @@
+//
+// headless AI against AI matches
+//
+// usage: selfplay --game <id> [--games N] [--first spec] [--second spec]
+//                 [--random-plies N] [--seed N] [--record file] [--verbose]
+//
+// plays N games (10 by default) between engine A (--first) and engine B
+// (--second), swapping who moves first every game, and reports wins, draws,
+// game length and nodes/sec for each engine. an engine spec is "random" or any
+// of depth=N, time=S, playouts=N separated by commas, e.g.
+//
+//   selfplay --game reversi --games 20 --first depth=6 --second time=0.05
+//
+// every game starts with --random-plies uniformly random moves (2 by default)
+// taken from the seed, so the same command line plays the same games.
+// --record appends every game to a binary game log (see GameRecord).
+// games go by the ids in GameIds.h, the same ones the window's --game takes.
+//
+
+#include "../classes/GameIds.h"
+#include "../classes/GameRecord.h"
+#include "../classes/SelfPlay.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+static void usage(const char *program)
+{
+    std::cerr << "usage: " << program << " --game <id> [--games N] [--first spec] [--second spec]"
+              << " [--random-plies N] [--seed N] [--record file] [--verbose]" << std::endl << "games:";
+    for (const std::string &id : gameIds()) {
+        std::cerr << " " << id;
+    }
+    std::cerr << std::endl << "tic-tac-toe on other boards: tictactoe-WxH-K, e.g. tictactoe-4x4-4" << std::endl;
+}
+
+static double perSecond(double count, double seconds)
+{
+    return seconds > 0.0 ? count / seconds : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    std::string id;
+    int games = 10;
+    int randomPlies = 2;
+    uint64_t seed = 1;
+    bool verbose = false;
+    std::string recordPath;
+    SelfPlayEngine engines[2];
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+            continue;
+        }
+        if (!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--game") == 0) {
+            id = value;
+        } else if (strcmp(argv[i], "--games") == 0) {
+            games = atoi(value);
+        } else if (strcmp(argv[i], "--first") == 0 || strcmp(argv[i], "--second") == 0) {
+            int engine = strcmp(argv[i], "--first") == 0 ? 0 : 1;
+            if (!SelfPlayEngine::parse(value, engines[engine])) {
+                std::cerr << "bad engine spec '" << value << "'" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--random-plies") == 0) {
+            randomPlies = atoi(value);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(value, nullptr, 10);
+        } else if (strcmp(argv[i], "--record") == 0) {
+            recordPath = value;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    SelfPlayGame *game = SelfPlayGame::create(id);
+    if (!game) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    GameRecordWriter log;
+    if (!recordPath.empty() && !log.open(recordPath)) {
+        std::cerr << "can't write a game log to " << recordPath << std::endl;
+        delete game;
+        return 1;
+    }
+
+    std::cout << id << ": " << games << " games, A = " << engines[0].describe()
+              << ", B = " << engines[1].describe() << std::endl;
+
+    // wins for A, B and draws
+    int wins[2] = { 0, 0 };
+    int draws = 0;
+    long long totalPlies = 0;
+    double searchSeconds[2] = { 0.0, 0.0 };
+    uint64_t nodes[2] = { 0, 0 };
+    auto start = std::chrono::steady_clock::now();
+
+    for (int g = 0; g < games; g++) {
+        // A moves first in the even games, B in the odd ones
+        int aSide = g & 1;
+        SelfPlayEngine sides[2] = { engines[aSide], engines[1 - aSide] };
+        SelfPlayResult result = playSelfPlayGame(*game, sides, randomPlies, seed + g);
+        if (log.isOpen()) {
+            std::string names[2] = { sides[0].describe(), sides[1].describe() };
+            GameRecord record;
+            makeGameRecord(*game, id, result, names, seed + g, record);
+            log.append(record);
+        }
+
+        const char *outcome = "draw";
+        if (result.winner < 0) {
+            draws++;
+        } else {
+            int engine = result.winner == aSide ? 0 : 1;
+            wins[engine]++;
+            outcome = engine == 0 ? "A wins" : "B wins";
+        }
+        totalPlies += result.plies;
+        for (int side = 0; side < 2; side++) {
+            int engine = side == aSide ? 0 : 1;
+            searchSeconds[engine] += result.searchSeconds[side];
+            nodes[engine] += result.nodes[side];
+        }
+        if (verbose) {
+            std::cout << "  game " << std::setw(3) << g + 1 << ": " << (aSide == 0 ? "A" : "B") << " first, "
+                      << outcome << " in " << result.plies << " plies, "
+                      << std::fixed << std::setprecision(2) << result.seconds << "s" << std::endl;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(1)
+              << "  A " << wins[0] << " wins, B " << wins[1] << " wins, " << draws << " draws" << std::endl
+              << "  " << (games > 0 ? (double)totalPlies / games : 0.0) << " plies per game" << std::endl;
+    for (int engine = 0; engine < 2; engine++) {
+        std::cout << "  " << (engine == 0 ? "A" : "B") << ": " << std::setprecision(0)
+                  << perSecond((double)nodes[engine], searchSeconds[engine]) << " nodes/sec over "
+                  << std::setprecision(2) << searchSeconds[engine] << "s" << std::endl;
+    }
+    std::cout << "  " << std::setprecision(2) << perSecond(games, seconds) << " games/sec" << std::endl;
+
+    delete game;
+    return 0;
+}
@@ -0,0 +1,57 @@
+//
+// offline tablebase generator for m,n,k games
+//
+// usage: tablebase <width> <height> <k> [output file] [threads]
+//
+// e.g. "tablebase 3 3 3" writes resources/tictactoe_3x3_3.tb, which the
+// TicTacToe AI maps at startup instead of searching from scratch.
+//
+
+#include "../classes/Tablebase.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const char *resultName(int result)
+{
+    switch (result) {
+        case kTablebaseWin:  return "win";
+        case kTablebaseLoss: return "loss";
+        case kTablebaseDraw: return "draw";
+        default:             return "invalid";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " <width> <height> <k> [output file] [threads]" << std::endl;
+        return 1;
+    }
+    int width = atoi(argv[1]);
+    int height = atoi(argv[2]);
+    int k = atoi(argv[3]);
+    std::string path = argc > 4 ? argv[4] : "resources/" + Tablebase::fileName(width, height, k);
+    int threads = argc > 5 ? atoi(argv[5]) : 0;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!Tablebase::generate(width, height, k, path, threads)) {
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Tablebase table;
+    if (!table.open(path)) {
+        std::cerr << "unable to map " << path << " after writing it" << std::endl;
+        return 1;
+    }
+    std::vector<int> empty(width * height, 0);
+    uint8_t root = table.probe(empty.data());
+    std::cout << path << ": " << width << "x" << height << " k=" << k
+              << " solved in " << seconds << "s, first player "
+              << resultName(Tablebase::resultOf(root)) << " in " << Tablebase::distanceOf(root) << " plies" << std::endl;
+    return 0;
+}
@@ -0,0 +1,193 @@
+//
+// engine configurations against each other on every core
+//
+// usage: tournament --game <id> --engine [name:]spec --engine [name:]spec ...
+//                   [--gauntlet] [--games N] [--threads N] [--seed N]
+//                   [--random-plies N] [--sprt elo0,elo1[,alpha,beta]] [--record file]
+//                   [--trace file]
+//
+// every engine plays every other (or with --gauntlet, the first engine plays
+// each of the rest) N games (10 by default), in pairs on the same opening with
+// the colors swapped. a spec is the same as selfplay's: "random" or any of
+// depth=N, time=S, playouts=N separated by commas, e.g.
+//
+//   tournament --game connect4 --engine d4:depth=4 --engine d8:depth=8 --engine t:time=0.05
+//   tournament --game reversi --gauntlet --games 400 --sprt 0,20 --engine new:depth=6 --engine old:depth=5
+//
+// --threads 0 (the default) runs a game on every core. with --sprt a pairing
+// stops once it is clear whether the first engine is elo0 or elo1 stronger.
+// the same seed plays the same games, apart from engines limited by time.
+// --record appends every game played to a binary game log (see GameRecord).
+// games go by the ids in GameIds.h, the same ones the window's --game takes.
+// --trace saves a Chrome trace of every worker's games and searches (see Trace).
+//
+
+#include "../classes/GameIds.h"
+#include "../classes/GameRecord.h"
+#include "../classes/Tournament.h"
+#include "../classes/Trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void usage(const char *program)
+{
+    std::cerr << "usage: " << program << " --game <id> --engine [name:]spec --engine [name:]spec ..."
+              << " [--gauntlet] [--games N] [--threads N] [--seed N] [--random-plies N] [--sprt elo0,elo1[,alpha,beta]] [--record file] [--trace file]"
+              << std::endl << "games:";
+    for (const std::string &id : gameIds()) {
+        std::cerr << " " << id;
+    }
+    std::cerr << std::endl << "tic-tac-toe on other boards: tictactoe-WxH-K, e.g. tictactoe-4x4-4" << std::endl;
+}
+
+static void showProgress(int played, int total)
+{
+    fprintf(stderr, "\r%d/%d games", played, total);
+    if (played == total) {
+        fprintf(stderr, "\n");
+    }
+}
+
+static const char *sprtName(Sprt::Result result)
+{
+    switch (result) {
+        case Sprt::kAcceptH0: return "H0 accepted";
+        case Sprt::kAcceptH1: return "H1 accepted";
+        default:              return "undecided";
+    }
+}
+
+static void printScore(const std::string &label, const MatchScore &score)
+{
+    EloEstimate elo = estimateElo(score);
+    printf("  %-24s +%d =%d -%d  score %.3f  Elo %+.0f [%+.0f, %+.0f]", label.c_str(),
+           score.wins, score.draws, score.losses, score.score(), elo.elo, elo.low, elo.high);
+}
+
+int main(int argc, char **argv)
+{
+    TournamentSettings settings;
+    std::vector<TournamentEngine> engines;
+    GameRecordWriter log;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--gauntlet") == 0) {
+            settings.roundRobin = false;
+            continue;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--game") == 0) {
+            settings.gameId = value;
+        } else if (strcmp(argv[i], "--engine") == 0) {
+            TournamentEngine engine;
+            if (!TournamentEngine::parse(value, engine)) {
+                std::cerr << "bad engine '" << value << "'" << std::endl;
+                return 1;
+            }
+            engines.push_back(engine);
+        } else if (strcmp(argv[i], "--games") == 0) {
+            settings.gamesPerPairing = atoi(value);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            settings.threads = atoi(value);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            settings.seed = strtoull(value, nullptr, 10);
+        } else if (strcmp(argv[i], "--random-plies") == 0) {
+            settings.randomPlies = atoi(value);
+        } else if (strcmp(argv[i], "--sprt") == 0) {
+            if (!Sprt::parse(value, settings.sprt)) {
+                std::cerr << "bad SPRT bounds '" << value << "'" << std::endl;
+                return 1;
+            }
+            settings.useSprt = true;
+        } else if (strcmp(argv[i], "--record") == 0) {
+            if (!log.open(value)) {
+                std::cerr << "can't write a game log to " << value << std::endl;
+                return 1;
+            }
+            settings.log = &log;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            tracePath = value;
+            Trace::setEnabled(true);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    TournamentResult result;
+    if (!runTournament(settings, engines, result, showProgress)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("%s %s, %d engines, %d threads, seed %llu\n", settings.gameId.c_str(), settings.roundRobin ? "round robin" : "gauntlet",
+           (int)engines.size(), result.threads, (unsigned long long)settings.seed);
+    for (const TournamentEngine &engine : engines) {
+        printf("  %-12s %s\n", engine.name.c_str(), engine.engine.describe().c_str());
+    }
+
+    printf("pairings, scored for the first engine:\n");
+    for (const TournamentPairing &pairing : result.pairings) {
+        printScore(engines[pairing.first].name + " vs " + engines[pairing.second].name, pairing.score);
+        if (settings.useSprt) {
+            printf("  SPRT %s, llr %.2f in [%.2f, %.2f]", sprtName(pairing.sprtResult), settings.sprt.llr(pairing.score),
+                   settings.sprt.lowerBound(), settings.sprt.upperBound());
+        }
+        printf("\n");
+    }
+
+    // each engine's results against the whole field
+    std::vector<MatchScore> totals(engines.size());
+    for (const TournamentPairing &pairing : result.pairings) {
+        MatchScore &first = totals[pairing.first];
+        MatchScore &second = totals[pairing.second];
+        first.wins += pairing.score.wins;
+        first.draws += pairing.score.draws;
+        first.losses += pairing.score.losses;
+        second.wins += pairing.score.losses;
+        second.draws += pairing.score.draws;
+        second.losses += pairing.score.wins;
+    }
+    std::vector<int> order(engines.size());
+    for (int i = 0; i < (int)order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return totals[a].score() > totals[b].score(); });
+    printf("standings against the field:\n");
+    for (int engine : order) {
+        printScore(engines[engine].name, totals[engine]);
+        printf("\n");
+    }
+
+    long long plies = 0;
+    for (const TournamentPairing &pairing : result.pairings) {
+        plies += pairing.plies;
+    }
+    double busy = result.seconds > 0.0 ? result.searchSeconds / (result.seconds * result.threads) : 0.0;
+    printf("%d games in %.2fs, %.1f games/sec, %.1f plies per game, %.0f nodes/sec per thread, threads searching %.0f%% of the time\n",
+           result.gamesPlayed, result.seconds, result.seconds > 0.0 ? result.gamesPlayed / result.seconds : 0.0,
+           result.gamesPlayed > 0 ? (double)plies / result.gamesPlayed : 0.0,
+           result.searchSeconds > 0.0 ? result.nodes / result.searchSeconds : 0.0, busy * 100.0);
+
+    if (!tracePath.empty()) {
+        size_t events = Trace::pending();
+        if (!Trace::write(tracePath)) {
+            std::cerr << "can't write a trace to " << tracePath << std::endl;
+            return 1;
+        }
+        printf("%zu trace events saved to %s\n", events, tracePath.c_str());
+    }
+    return 0;
+}